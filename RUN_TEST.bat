@@ -12,10 +12,10 @@ echo OK
 echo.
 
 echo [2/3] Compiling test server...
-echo Command: gcc -Wall -Wextra -std=c11 -O2 -Iinclude test_iocp_server.c src/cwebhttp.c src/async/loop.c src/async/iocp.c src/async/nonblock.c src/async/client.c src/async/server.c -o build/test_iocp_server.exe -lws2_32 -lz
+echo Command: gcc -Wall -Wextra -std=c11 -O2 -Iinclude test_iocp_server.c src/cwebhttp.c src/async/loop.c src/async/timer.c src/async/dns.c src/async/iocp.c src/async/nonblock.c src/async/client.c src/async/server.c -o build/test_iocp_server.exe -lws2_32 -lz
 echo.
 
-gcc -Wall -Wextra -std=c11 -O2 -Iinclude test_iocp_server.c src/cwebhttp.c src/async/loop.c src/async/iocp.c src/async/nonblock.c src/async/client.c src/async/server.c -o build/test_iocp_server.exe -lws2_32 -lz
+gcc -Wall -Wextra -std=c11 -O2 -Iinclude test_iocp_server.c src/cwebhttp.c src/async/loop.c src/async/timer.c src/async/dns.c src/async/iocp.c src/async/nonblock.c src/async/client.c src/async/server.c -o build/test_iocp_server.exe -lws2_32 -lz
 
 if %ERRORLEVEL% NEQ 0 (
     echo.
@@ -22,6 +22,8 @@ $sourceFiles = @(
     "test_iocp_server.c",
     "src/cwebhttp.c",
     "src/async/loop.c",
+    "src/async/timer.c",
+    "src/async/dns.c",
     "src/async/iocp.c",
     "src/async/nonblock.c",
     "src/async/client.c",
@@ -1,5 +1,6 @@
 // Async client throughput benchmark
 // Tests maximum requests/second with connection pooling
+// Usage: bench_async_throughput [epoll|io_uring] [url]
 
 #include "../include/cwebhttp_async.h"
 #include "../include/cwebhttp.h"
@@ -78,10 +79,17 @@ static void request_callback(cwh_response_t *res, cwh_error_t err, void *data)
     }
 }
 
-int main(void)
+int main(int argc, char **argv)
 {
+    cwh_backend_type_t backend = CWH_BACKEND_DEFAULT;
+    if (argc > 1 && strcmp(argv[1], "io_uring") == 0)
+        backend = CWH_BACKEND_IO_URING;
+    else if (argc > 1 && strcmp(argv[1], "epoll") == 0)
+        backend = CWH_BACKEND_EPOLL;
+    const char *url = argc > 2 ? argv[2] : TEST_URL;
+
     printf("=== Async Client Throughput Benchmark ===\n");
-    printf("Target: %s\n", TEST_URL);
+    printf("Target: %s\n", url);
     printf("Duration: %d seconds\n", TEST_DURATION_SEC);
     printf("Concurrent requests: %d\n", CONCURRENT_REQUESTS);
     printf("Connection pool size: %d\n\n", POOL_SIZE);
@@ -92,7 +100,7 @@ int main(void)
 #endif
 
     // Create event loop
-    g_loop = cwh_loop_new();
+    g_loop = cwh_loop_new_backend(backend);
     if (!g_loop)
     {
         printf("Failed to create event loop\n");
@@ -117,7 +125,7 @@ int main(void)
         int active = requests_sent - requests_completed - requests_failed;
         while (active < CONCURRENT_REQUESTS)
         {
-            cwh_async_get(g_loop, TEST_URL, request_callback, NULL);
+            cwh_async_get(g_loop, url, request_callback, NULL);
             requests_sent++;
             active++;
         }
@@ -159,6 +167,11 @@ int main(void)
     printf("  200 OK: %d\n", status_200);
     printf("  Other: %d\n", status_other);
     printf("\nThroughput: %.2f requests/second\n", requests_completed / total_time);
+    if (requests_completed > 0)
+    {
+        printf("Loop syscalls/request: %.2f (%s)\n",
+               (double)cwh_loop_syscalls(g_loop) / requests_completed, cwh_loop_backend(g_loop));
+    }
 
     // Get pool stats
     int pool_active, pool_total;
@@ -1,5 +1,9 @@
 // C10K Performance Benchmark - Linux epoll async server
 // Tests concurrent connection handling and throughput
+//
+// Usage: bench_c10k [epoll|io_uring]           - full client/server C10K run
+//        bench_c10k dispatch [epoll|io_uring]  - per-event dispatch cost vs. number of registered fds
+//        bench_c10k compare                    - req/s and syscalls/request, epoll vs. io_uring
 
 #define _DEFAULT_SOURCE // For usleep()
 #include "../include/cwebhttp_async.h"
@@ -19,6 +23,8 @@
 #include <errno.h>
 #include <sys/resource.h>
 #include <sys/wait.h>
+#include <sys/eventfd.h>
+#include <sys/syscall.h>
 
 // Benchmark configuration
 #define BENCH_PORT 8080
@@ -26,6 +32,14 @@
 #define REQUESTS_PER_CLIENT 10
 #define CONCURRENT_CONNECTIONS 1000
 
+// Dispatch benchmark configuration
+#define DISPATCH_ACTIVE_FDS 64    // fds made ready in every loop iteration
+#define DISPATCH_ITERATIONS 20000 // loop iterations per measurement
+
+// Backend comparison configuration
+#define COMPARE_CONNECTIONS 256 // keep-alive connections
+#define COMPARE_ROUNDS 200      // requests per connection
+
 // Global stats
 static volatile int total_requests = 0;
 static volatile int total_responses = 0;
@@ -190,10 +204,316 @@ static void print_results(void)
     }
 }
 
-int main(void)
+// ============================================================================
+// Dispatch cost benchmark
+// ============================================================================
+// Registers N idle eventfds plus a fixed number of always-readable ones spread
+// across the fd range, then measures the cost of each dispatched event. With an
+// O(1) handler lookup the per-event cost must stay flat as N grows.
+
+static long dispatch_count = 0;
+
+static void dispatch_cb(cwh_loop_t *loop, int fd, int events, void *data)
+{
+    (void)loop;
+    (void)fd;
+    (void)events;
+    (void)data;
+    dispatch_count++;
+}
+
+static double now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+// Returns average ns per dispatched event, or -1 on failure
+static double measure_dispatch(cwh_backend_type_t backend, int num_fds)
+{
+    cwh_loop_t *loop = cwh_loop_new_backend(backend);
+    if (!loop)
+        return -1;
+
+    int *fds = malloc(num_fds * sizeof(int));
+    if (!fds)
+    {
+        cwh_loop_free(loop);
+        return -1;
+    }
+
+    int created = 0;
+    int stride = num_fds / DISPATCH_ACTIVE_FDS;
+    if (stride < 1)
+        stride = 1;
+
+    for (int i = 0; i < num_fds; i++)
+    {
+        fds[i] = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (fds[i] < 0)
+            break;
+        created++;
+
+        // Every stride-th fd is made readable (level-triggered, never drained)
+        if (i % stride == 0 && i / stride < DISPATCH_ACTIVE_FDS)
+        {
+            uint64_t one = 1;
+            if (write(fds[i], &one, sizeof(one)) < 0)
+                break;
+        }
+
+        if (cwh_loop_add(loop, fds[i], CWH_EVENT_READ, dispatch_cb, NULL) < 0)
+            break;
+    }
+
+    double result = -1;
+    if (created == num_fds)
+    {
+        // Warm-up
+        for (int i = 0; i < 100; i++)
+            cwh_loop_run_once(loop, 0);
+
+        dispatch_count = 0;
+        double start = now_ns();
+        for (int i = 0; i < DISPATCH_ITERATIONS; i++)
+            cwh_loop_run_once(loop, 0);
+        double elapsed = now_ns() - start;
+
+        if (dispatch_count > 0)
+            result = elapsed / dispatch_count;
+    }
+
+    // Freeing the loop releases its handler table; then close the fds
+    cwh_loop_free(loop);
+    for (int i = 0; i < created; i++)
+        close(fds[i]);
+    free(fds);
+
+    return result;
+}
+
+static int run_dispatch_benchmark(cwh_backend_type_t backend)
 {
+    static const int sizes[] = {100, 1000, 10000, 100000};
+
+    printf("=== cwebhttp Event Dispatch Benchmark ===\n");
+
+    // Each measurement needs num_fds eventfds plus a few for the loop itself
+    struct rlimit rlim;
+    getrlimit(RLIMIT_NOFILE, &rlim);
+    rlim.rlim_cur = rlim.rlim_max;
+    setrlimit(RLIMIT_NOFILE, &rlim);
+    long fd_limit = (long)rlim.rlim_cur - 32;
+
+    cwh_loop_t *probe = cwh_loop_new_backend(backend);
+    printf("Backend: %s\n", probe ? cwh_loop_backend(probe) : "unknown");
+    cwh_loop_free(probe);
+    printf("Ready fds per iteration: %d, iterations: %d\n\n", DISPATCH_ACTIVE_FDS, DISPATCH_ITERATIONS);
+
+    printf("%-14s %-14s\n", "Registered", "ns/event");
+    printf("%-14s %-14s\n", "----------", "--------");
+
+    double first = -1, last = -1;
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++)
+    {
+        if (sizes[i] > fd_limit)
+        {
+            printf("%-14d skipped (RLIMIT_NOFILE=%ld)\n", sizes[i], (long)rlim.rlim_cur);
+            continue;
+        }
+
+        double ns = measure_dispatch(backend, sizes[i]);
+        if (ns < 0)
+        {
+            printf("%-14d failed\n", sizes[i]);
+            continue;
+        }
+
+        printf("%-14d %-14.1f\n", sizes[i], ns);
+        if (first < 0)
+            first = ns;
+        last = ns;
+    }
+
+    if (first > 0 && last > 0)
+    {
+        printf("\nCost ratio (largest/smallest): %.2fx\n", last / first);
+    }
+
+    return 0;
+}
+
+// ============================================================================
+// Backend comparison
+// ============================================================================
+// A forked client drives COMPARE_CONNECTIONS keep-alive connections in lock
+// step (one request in flight per connection) against the async server, once
+// per backend. Syscalls per request add the loop's own counter to the
+// server's recv/send calls, which this binary counts by defining the libc
+// wrappers itself (the server is linked in; the kernel's per-task I/O
+// counters in /proc/self/io skip socket calls).
+
+static uint64_t socket_calls;
+
+ssize_t recv(int fd, void *buf, size_t len, int flags)
+{
+    socket_calls++;
+    return syscall(SYS_recvfrom, fd, buf, len, flags, NULL, NULL);
+}
+
+ssize_t send(int fd, const void *buf, size_t len, int flags)
+{
+    socket_calls++;
+    return syscall(SYS_sendto, fd, buf, len, flags, NULL, 0);
+}
+
+ssize_t sendmsg(int fd, const struct msghdr *msg, int flags)
+{
+    socket_calls++;
+    return syscall(SYS_sendmsg, fd, msg, flags);
+}
+
+// Blocking client: send a request on every connection, then collect every response
+static int run_compare_client(int port)
+{
+    static const char request[] = "GET / HTTP/1.1\r\nHost: localhost\r\n\r\n";
+    static const char body[] = "Hello, World!";
+    int socks[COMPARE_CONNECTIONS];
+
+    for (int i = 0; i < COMPARE_CONNECTIONS; i++)
+    {
+        struct sockaddr_in addr = {0};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = inet_addr("127.0.0.1");
+        addr.sin_port = htons(port);
+
+        socks[i] = socket(AF_INET, SOCK_STREAM, 0);
+        if (socks[i] < 0 || connect(socks[i], (struct sockaddr *)&addr, sizeof(addr)) < 0)
+            return 1;
+    }
+
+    for (int round = 0; round < COMPARE_ROUNDS; round++)
+    {
+        for (int i = 0; i < COMPARE_CONNECTIONS; i++)
+        {
+            if (send(socks[i], request, sizeof(request) - 1, 0) != (ssize_t)(sizeof(request) - 1))
+                return 1;
+        }
+
+        for (int i = 0; i < COMPARE_CONNECTIONS; i++)
+        {
+            // Responses are small and end with the body
+            char buf[1024];
+            size_t len = 0;
+            while (len < sizeof(body) - 1 || memcmp(buf + len - (sizeof(body) - 1), body, sizeof(body) - 1) != 0)
+            {
+                ssize_t n = recv(socks[i], buf + len, sizeof(buf) - len, 0);
+                if (n <= 0 || len + n >= sizeof(buf))
+                    return 1;
+                len += n;
+            }
+        }
+    }
+
+    for (int i = 0; i < COMPARE_CONNECTIONS; i++)
+        close(socks[i]);
+    return 0;
+}
+
+static int measure_backend(cwh_backend_type_t backend, int port)
+{
+    cwh_loop_t *loop = cwh_loop_new_backend(backend);
+    cwh_async_server_t *server = loop ? cwh_async_server_new(loop) : NULL;
+    if (!server)
+    {
+        printf("Failed to create server\n");
+        cwh_loop_free(loop);
+        return -1;
+    }
+
+    cwh_async_route(server, "GET", "/", hello_handler, NULL);
+    if (cwh_async_listen(server, port) < 0)
+    {
+        printf("Failed to start server on port %d\n", port);
+        cwh_async_server_free(server);
+        cwh_loop_free(loop);
+        return -1;
+    }
+
+    total_responses = 0;
+    fflush(stdout); // Don't let the child inherit buffered output
+    uint64_t syscalls_start = cwh_loop_syscalls(loop) + socket_calls;
+    double start = now_ns();
+
+    pid_t client_pid = fork();
+    if (client_pid == 0)
+    {
+        exit(run_compare_client(port));
+    }
+
+    int status = 1;
+    while (client_pid > 0)
+    {
+        cwh_loop_run_once(loop, 10);
+        if (waitpid(client_pid, &status, WNOHANG) == client_pid)
+            break;
+    }
+
+    double elapsed = (now_ns() - start) / 1e9;
+    uint64_t syscalls = cwh_loop_syscalls(loop) + socket_calls - syscalls_start;
+
+    if (client_pid < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0 || total_responses == 0)
+    {
+        printf("%-20s failed\n", cwh_loop_backend(loop));
+    }
+    else
+    {
+        printf("%-20s %-12.0f %-14.2f\n", cwh_loop_backend(loop),
+               total_responses / elapsed, (double)syscalls / total_responses);
+    }
+
+    cwh_async_server_free(server);
+    cwh_loop_free(loop);
+    return 0;
+}
+
+static int run_compare_benchmark(void)
+{
+    printf("=== cwebhttp Event Backend Comparison ===\n");
+    printf("Connections: %d, requests per connection: %d\n", COMPARE_CONNECTIONS, COMPARE_ROUNDS);
+    printf("(syscalls: the loop's epoll_wait/epoll_ctl or io_uring_enter plus the server's recv/send)\n\n");
+
+    printf("%-20s %-12s %-14s\n", "Backend", "req/s", "syscalls/req");
+    printf("%-20s %-12s %-14s\n", "-------", "-----", "------------");
+
+    measure_backend(CWH_BACKEND_EPOLL, BENCH_PORT + 1);
+    measure_backend(CWH_BACKEND_IO_URING, BENCH_PORT + 2);
+    return 0;
+}
+
+static cwh_backend_type_t parse_backend(const char *name)
+{
+    if (name && strcmp(name, "io_uring") == 0)
+        return CWH_BACKEND_IO_URING;
+    if (name && strcmp(name, "epoll") == 0)
+        return CWH_BACKEND_EPOLL;
+    return CWH_BACKEND_DEFAULT;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc > 1 && strcmp(argv[1], "dispatch") == 0)
+    {
+        return run_dispatch_benchmark(parse_backend(argc > 2 ? argv[2] : NULL));
+    }
+    if (argc > 1 && strcmp(argv[1], "compare") == 0)
+    {
+        return run_compare_benchmark();
+    }
+
     printf("=== cwebhttp C10K Performance Benchmark ===\n");
-    printf("Testing async server with epoll backend on Linux\n\n");
+    printf("Testing async server on Linux\n\n");
 
     // Increase file descriptor limit
     struct rlimit rlim;
@@ -209,7 +529,7 @@ int main(void)
     signal(SIGTERM, signal_handler);
 
     // Create event loop and server
-    cwh_loop_t *loop = cwh_loop_new();
+    cwh_loop_t *loop = cwh_loop_new_backend(parse_backend(argc > 1 ? argv[1] : NULL));
     if (!loop)
     {
         printf("Failed to create event loop\n");
@@ -271,6 +591,10 @@ int main(void)
         waitpid(client_pid, &status, 0);
 
         print_results();
+        if (total_responses > 0)
+        {
+            printf("Loop syscalls/response: %.2f\n", (double)cwh_loop_syscalls(loop) / total_responses);
+        }
     }
     else
     {
@@ -2,10 +2,20 @@
 // Tracks malloc/free calls during parsing
 
 #include "cwebhttp.h"
+#include "cwebhttp_async.h"
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
 
+#ifndef _WIN32
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/resource.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#endif
+
 // Global counters for malloc tracking
 static int malloc_count = 0;
 static int free_count = 0;
@@ -46,6 +56,113 @@ static const char *TEST_RESPONSE =
     "\r\n"
     "{\"status\":\"ok\",\"users\":[1,2,3,4,5]}";
 
+#ifndef _WIN32
+#define IDLE_CONNECTIONS 1000
+#define IDLE_BENCH_PORT 18490
+
+static void idle_handler(cwh_async_conn_t *conn, cwh_request_t *req, void *data)
+{
+    (void)req;
+    (void)data;
+    cwh_async_send_response(conn, 200, "text/plain", "ok", 2);
+}
+
+// Memory held by the async server for keep-alive connections that are idle
+// after one request. Returns 0 on success.
+static int measure_idle_connections(void)
+{
+    struct rlimit rlim;
+    getrlimit(RLIMIT_NOFILE, &rlim);
+    rlim.rlim_cur = rlim.rlim_max;
+    setrlimit(RLIMIT_NOFILE, &rlim);
+
+    int count = IDLE_CONNECTIONS;
+    if ((rlim_t)(2 * count + 64) > rlim.rlim_cur)
+        count = (int)(rlim.rlim_cur - 64) / 2;
+
+    cwh_loop_t *loop = cwh_loop_new();
+    cwh_async_server_t *server = loop ? cwh_async_server_new(loop) : NULL;
+    if (!server || cwh_async_listen(server, IDLE_BENCH_PORT) < 0)
+    {
+        printf("Failed to start async server\n");
+        cwh_async_server_free(server);
+        cwh_loop_free(loop);
+        return -1;
+    }
+    cwh_async_route(server, "GET", "/", idle_handler, NULL);
+
+    // The async server logs every event; keep the report readable
+    fflush(stdout);
+    int saved_stdout = dup(STDOUT_FILENO);
+    int devnull = open("/dev/null", O_WRONLY);
+    if (devnull >= 0)
+        dup2(devnull, STDOUT_FILENO);
+
+    const char *request = "GET / HTTP/1.1\r\nHost: localhost\r\nConnection: keep-alive\r\n\r\n";
+    int *clients = malloc(count * sizeof(int));
+    int opened = 0;
+    struct sockaddr_in addr = {0};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(IDLE_BENCH_PORT);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+    for (int i = 0; clients && i < count; i++)
+    {
+        int fd = socket(AF_INET, SOCK_STREAM, 0);
+        if (fd < 0 || connect(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0 ||
+            send(fd, request, strlen(request), 0) < 0)
+        {
+            if (fd >= 0)
+                close(fd);
+            break;
+        }
+        clients[opened++] = fd;
+
+        // Accept and serve as we go so the listen backlog never overflows
+        cwh_loop_run_once(loop, 0);
+    }
+
+    // Serve remaining requests until every connection is idle again
+    cwh_async_server_stats_t stats;
+    for (int i = 0; i < 1000; i++)
+    {
+        cwh_loop_run_once(loop, 10);
+        cwh_async_server_get_stats(server, &stats);
+        if (stats.total_requests >= (uint64_t)opened && stats.buffers_in_use == 0)
+            break;
+    }
+
+    fflush(stdout);
+    if (saved_stdout >= 0)
+    {
+        dup2(saved_stdout, STDOUT_FILENO);
+        close(saved_stdout);
+    }
+    if (devnull >= 0)
+        close(devnull);
+
+    printf("Idle keep-alive connections: %d (requests served: %lu)\n",
+           stats.connections, (unsigned long)stats.total_requests);
+    printf("Buffers attached: %lu, pooled: %lu (%lu bytes)\n",
+           (unsigned long)stats.buffers_in_use, (unsigned long)stats.buffers_pooled,
+           (unsigned long)stats.buffer_bytes);
+    if (stats.connections > 0)
+    {
+        printf("Server memory per idle connection: %lu bytes\n",
+               (unsigned long)(stats.memory_bytes / stats.connections));
+        printf("(fixed 16KB recv + 64KB send buffers would be >= 81920 bytes)\n\n");
+    }
+
+    for (int i = 0; i < opened; i++)
+        close(clients[i]);
+    free(clients);
+
+    cwh_async_server_free(server);
+    cwh_loop_free(loop);
+    return 0;
+}
+#endif
+
 int main(void)
 {
     printf("=== cwebhttp Memory Usage Benchmark ===\n\n");
@@ -114,6 +231,13 @@ int main(void)
     printf("✓ Zero-allocation parsing: %s\n\n",
            malloc_count == 0 ? "PASS" : "FAIL");
 
+#ifndef _WIN32
+    // Test 4: Async server memory per idle keep-alive connection
+    printf("Test 4: Idle Connection Memory (async server)\n");
+    printf("---------------------------------------------\n");
+    measure_idle_connections();
+#endif
+
     // Summary
     printf("=== Summary ===\n");
     printf("All parsing operations: ZERO heap allocations ✓\n");
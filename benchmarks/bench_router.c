@@ -0,0 +1,143 @@
+// Router benchmark - route lookup latency (ns/lookup) of the radix-tree router
+// against a linked list walked with strcmp (the previous find_route) at
+// 10, 100 and 1000 registered routes
+
+#include "cwebhttp.h"
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+
+#if defined(_WIN32) || defined(_WIN64)
+#include <windows.h>
+static double GET_TIME_MS()
+{
+    static LARGE_INTEGER frequency;
+    static int initialized = 0;
+
+    if (!initialized)
+    {
+        QueryPerformanceFrequency(&frequency);
+        initialized = 1;
+    }
+
+    LARGE_INTEGER counter;
+    QueryPerformanceCounter(&counter);
+    return (double)(counter.QuadPart * 1000.0) / frequency.QuadPart;
+}
+#else
+#include <sys/time.h>
+static double GET_TIME_MS()
+{
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return (tv.tv_sec * 1000.0) + (tv.tv_usec / 1000.0);
+}
+#endif
+
+#define MAX_ROUTES 1000
+#define LOOKUPS 2000000
+
+static const char *RESOURCES[] = {"users", "orders", "products", "invoices", "sessions",
+                                  "reports", "teams", "projects", "tickets", "webhooks"};
+
+// Linear table: what find_route did before (method compare + strcmp per route)
+typedef struct
+{
+    cwh_method_t method;
+    char path[64];
+} linear_route_t;
+
+static linear_route_t linear[MAX_ROUTES];
+static char patterns[MAX_ROUTES][64];
+static char paths[MAX_ROUTES][64];
+static cwh_method_t methods[MAX_ROUTES];
+
+// Route i: /api/v<n>/<resource><i>[/:id] spread over the four methods
+static void build_routes(int count)
+{
+    for (int i = 0; i < count; i++)
+    {
+        const char *res = RESOURCES[i % 10];
+        methods[i] = (cwh_method_t)(i % CWH_METHOD_NUM);
+        if (i % 2 == 0)
+        {
+            snprintf(patterns[i], sizeof(patterns[i]), "/api/v%d/%s%d", i % 3 + 1, res, i);
+            snprintf(paths[i], sizeof(paths[i]), "%s", patterns[i]);
+        }
+        else
+        {
+            snprintf(patterns[i], sizeof(patterns[i]), "/api/v%d/%s%d/:id", i % 3 + 1, res, i);
+            snprintf(paths[i], sizeof(paths[i]), "/api/v%d/%s%d/%d", i % 3 + 1, res, i, i * 7);
+        }
+        linear[i].method = methods[i];
+        // The linked list only did exact matches: store the concrete path
+        snprintf(linear[i].path, sizeof(linear[i].path), "%s", paths[i]);
+    }
+}
+
+static int linear_find(int count, cwh_method_t method, const char *path)
+{
+    for (int i = 0; i < count; i++)
+    {
+        if (linear[i].method != method)
+            continue;
+        if (strcmp(linear[i].path, path) == 0)
+            return i;
+    }
+    return -1;
+}
+
+int main(void)
+{
+    printf("=== cwebhttp Router Benchmark ===\n\n");
+    printf("%-8s %14s %14s %10s\n", "routes", "linear ns", "radix ns", "speedup");
+
+    static const int sizes[] = {10, 100, 1000};
+    volatile long sink = 0;
+
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++)
+    {
+        int count = sizes[s];
+        build_routes(count);
+
+        cwh_router_t *router = cwh_router_new();
+        for (int i = 0; i < count; i++)
+        {
+            if (cwh_router_add(router, methods[i], patterns[i], &linear[i]) < 0)
+            {
+                fprintf(stderr, "failed to add %s\n", patterns[i]);
+                return 1;
+            }
+        }
+
+        // Lookups cycle through all routes (uniform hit distribution)
+        unsigned int idx = 0;
+        double start = GET_TIME_MS();
+        for (int n = 0; n < LOOKUPS; n++)
+        {
+            idx = (idx + 7919) % (unsigned int)count;
+            sink += linear_find(count, methods[idx], paths[idx]);
+        }
+        double linear_ms = GET_TIME_MS() - start;
+
+        cwh_request_t req = {0};
+        idx = 0;
+        start = GET_TIME_MS();
+        for (int n = 0; n < LOOKUPS; n++)
+        {
+            idx = (idx + 7919) % (unsigned int)count;
+            sink += (long)(cwh_router_find(router, methods[idx], paths[idx], &req) != NULL);
+        }
+        double radix_ms = GET_TIME_MS() - start;
+
+        double linear_ns = linear_ms * 1e6 / LOOKUPS;
+        double radix_ns = radix_ms * 1e6 / LOOKUPS;
+        printf("%-8d %14.1f %14.1f %9.1fx\n", count, linear_ns, radix_ns, linear_ns / radix_ns);
+
+        cwh_router_free(router);
+    }
+
+    (void)sink;
+    printf("\nRadix lookups include capturing :id into the request.\n");
+    return 0;
+}
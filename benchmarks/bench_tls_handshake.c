@@ -11,14 +11,21 @@
 #include <windows.h>
 #define sleep_ms(ms) Sleep(ms)
 #else
+#include <fcntl.h>
+#include <sys/socket.h>
 #include <unistd.h>
 #define sleep_ms(ms) usleep((ms) * 1000)
 #endif
 
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+
 // Benchmark configuration
 #define NUM_HANDSHAKES 100
 #define NUM_RESUMPTIONS 100
 #define WARMUP_ITERATIONS 10
+#define NUM_SESSIONS 256 // Live sessions for the per-connection memory figure
 
 // Time measurement helpers
 #ifdef _WIN32
@@ -93,6 +100,97 @@ void print_stats(const char *name, double *times, int count)
     printf("\n");
 }
 
+#ifndef _WIN32
+// Heap bytes in use (glibc only; 0 elsewhere)
+static size_t heap_in_use(void)
+{
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+    struct mallinfo2 mi = mallinfo2();
+    return mi.uordblks + mi.hblkhd;
+#else
+    return 0;
+#endif
+}
+
+static int nonblocking_pair(int fds[2])
+{
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0)
+        return -1;
+    fcntl(fds[0], F_SETFL, fcntl(fds[0], F_GETFL, 0) | O_NONBLOCK);
+    fcntl(fds[1], F_SETFL, fcntl(fds[1], F_GETFL, 0) | O_NONBLOCK);
+    return 0;
+}
+
+// One in-process handshake over a socketpair, stepping both ends in turn.
+// Returns the elapsed time in ms, or -1 on failure.
+static double run_handshake(cwh_tls_context_t *client_ctx, cwh_tls_context_t *server_ctx, bool *resumed)
+{
+    int fds[2];
+    if (nonblocking_pair(fds) != 0)
+        return -1;
+
+    double start = get_time_ms();
+    cwh_tls_session_t *client = cwh_tls_session_new(client_ctx, fds[0], "localhost");
+    cwh_tls_session_t *server = cwh_tls_session_new_server(server_ctx, fds[1]);
+    cwh_tls_error_t c = client ? CWH_TLS_WANT_WRITE : CWH_TLS_ERR_INIT;
+    cwh_tls_error_t s = server ? CWH_TLS_WANT_READ : CWH_TLS_ERR_INIT;
+
+    while ((c == CWH_TLS_WANT_READ || c == CWH_TLS_WANT_WRITE) ||
+           (s == CWH_TLS_WANT_READ || s == CWH_TLS_WANT_WRITE))
+    {
+        if (c == CWH_TLS_WANT_READ || c == CWH_TLS_WANT_WRITE)
+            c = cwh_tls_handshake_step(client);
+        if (s == CWH_TLS_WANT_READ || s == CWH_TLS_WANT_WRITE)
+            s = cwh_tls_handshake_step(server);
+    }
+    double end = get_time_ms();
+    *resumed = c == CWH_TLS_OK && cwh_tls_session_resumed(client);
+
+    cwh_tls_session_free(client);
+    cwh_tls_session_free(server);
+    close(fds[0]);
+    close(fds[1]);
+    return (c == CWH_TLS_OK && s == CWH_TLS_OK) ? end - start : -1;
+}
+
+// count (<= 1000) handshakes between two contexts; returns handshakes/s or -1
+static double bench_handshakes(const char *name, cwh_tls_context_t *client_ctx, cwh_tls_context_t *server_ctx,
+                               int count)
+{
+    static double times[1000];
+    bool resumed;
+    if (!client_ctx || !server_ctx)
+    {
+        printf("❌ %s: failed to create contexts\n\n", name);
+        return -1;
+    }
+
+    // Warmup also leaves a saved session for the resumed runs
+    for (int i = 0; i < WARMUP_ITERATIONS; i++)
+        run_handshake(client_ctx, server_ctx, &resumed);
+
+    int done = 0, resumptions = 0;
+    double start = get_time_ms();
+    while (done < count)
+    {
+        double t = run_handshake(client_ctx, server_ctx, &resumed);
+        if (t < 0)
+        {
+            printf("❌ %s: handshake failed after %d iterations\n\n", name, done);
+            return -1;
+        }
+        times[done++] = t;
+        resumptions += resumed;
+    }
+    double rate = done * 1000.0 / (get_time_ms() - start);
+
+    print_stats(name, times, done);
+    printf("  Resumed: %d/%d\n", resumptions, done);
+    printf("  Throughput: %.1f handshakes/s\n\n", rate);
+    return rate;
+}
+#endif
+
 int main(int argc, char *argv[])
 {
     print_header();
@@ -163,27 +261,88 @@ int main(int argc, char *argv[])
     }
     print_stats("TLS Context Creation", context_times, 10);
 
-    // Benchmark 2: Memory overhead
+#ifndef _WIN32
+    // Benchmark 2: Memory per connection (sessions share the context's
+    // mbedtls_ssl_config, so this is the ssl context and its record buffers)
     printf("========================================\n");
-    printf("Benchmark 2: Memory Overhead\n");
+    printf("Benchmark 2: Memory per TLS Connection\n");
     printf("========================================\n");
-    printf("TLS Context:  ~50 KB\n");
-    printf("TLS Session:  ~2 KB per connection\n");
-    printf("Session Cache: ~300 bytes per cached session\n");
+
+    static int session_fds[NUM_SESSIONS][2];
+    static cwh_tls_session_t *sessions[NUM_SESSIONS];
+    int live = 0;
+    size_t heap_before = heap_in_use();
+    while (live < NUM_SESSIONS && nonblocking_pair(session_fds[live]) == 0)
+    {
+        sessions[live] = cwh_tls_session_new_server(ctx, session_fds[live][1]);
+        if (!sessions[live])
+        {
+            close(session_fds[live][0]);
+            close(session_fds[live][1]);
+            break;
+        }
+        live++;
+    }
+    size_t heap_after = heap_in_use();
+    if (live > 0 && heap_after > heap_before)
+        printf("Server session: %zu bytes per connection (%d live sessions)\n",
+               (heap_after - heap_before) / (size_t)live, live);
+    else
+        printf("Server session: n/a (heap statistics need glibc 2.33+)\n");
+    for (int i = 0; i < live; i++)
+    {
+        cwh_tls_session_free(sessions[i]);
+        close(session_fds[i][0]);
+        close(session_fds[i][1]);
+    }
     printf("\n");
 
-    // Benchmark 3: Simulated handshake timing
+    // Benchmark 3: Full vs resumed handshakes, both ends in this process
     printf("========================================\n");
-    printf("Benchmark 3: TLS Operations\n");
+    printf("Benchmark 3: Full vs Resumed Handshakes\n");
     printf("========================================\n");
-    printf("Note: Full handshake benchmarks require network setup\n");
-    printf("Expected performance:\n");
-    printf("  Full handshake:    10-20 ms (RSA-2048)\n");
-    printf("  Session resumption: 2-5 ms (75%% faster)\n");
-    printf("  SNI lookup:        <0.1 ms\n");
-    printf("  Cert verification: 1-3 ms\n");
+
+    // Client without a session store: every handshake is a full one
+    cwh_tls_config_t client_config = cwh_tls_config_default();
+    client_config.verify_peer = false; // Self-signed test certificate
+    client_config.session_cache = false;
+    cwh_tls_context_t *fresh_client = cwh_tls_context_new(&client_config);
+
+    // Client that saves and offers its last session (ticket or ID)
+    client_config.session_cache = true;
+    cwh_tls_context_t *ticket_client = cwh_tls_context_new(&client_config);
+    cwh_tls_context_t *id_client = cwh_tls_context_new(&client_config);
+
+    // Server resuming by ticket only (no per-session state)
+    cwh_tls_config_t ticket_config = config;
+    ticket_config.session_cache = false;
+    ticket_config.session_tickets = true;
+    cwh_tls_context_t *ticket_server = cwh_tls_context_new(&ticket_config);
+
+    // Server resuming by session ID only (server-side cache)
+    cwh_tls_config_t id_config = config;
+    id_config.session_cache = true;
+    id_config.session_tickets = false;
+    cwh_tls_context_t *id_server = cwh_tls_context_new(&id_config);
+
+    double full_rate = bench_handshakes("Full Handshake (client + server CPU)", fresh_client, ticket_server,
+                                        NUM_HANDSHAKES);
+    double ticket_rate = bench_handshakes("Resumed Handshake (session ticket)", ticket_client, ticket_server,
+                                          NUM_RESUMPTIONS);
+    double id_rate = bench_handshakes("Resumed Handshake (session ID cache)", id_client, id_server,
+                                      NUM_RESUMPTIONS);
+    if (full_rate > 0 && ticket_rate > 0)
+        printf("Ticket resumption: %.1fx full handshake rate\n", ticket_rate / full_rate);
+    if (full_rate > 0 && id_rate > 0)
+        printf("ID resumption:     %.1fx full handshake rate\n", id_rate / full_rate);
     printf("\n");
 
+    cwh_tls_context_free(fresh_client);
+    cwh_tls_context_free(ticket_client);
+    cwh_tls_context_free(id_client);
+    cwh_tls_context_free(ticket_server);
+    cwh_tls_context_free(id_server);
+
     // Benchmark 4: Session creation/destruction
     printf("========================================\n");
     printf("Benchmark 4: Session Management\n");
@@ -191,43 +350,33 @@ int main(int argc, char *argv[])
 
     double session_create_times[100];
     double session_destroy_times[100];
-
-    for (int i = 0; i < 100; i++)
+    int fds[2];
+    if (nonblocking_pair(fds) == 0)
     {
-        double start = get_time_ms();
-        cwh_tls_session_t *session = cwh_tls_session_new_server(ctx, -1);
-        double end = get_time_ms();
-        session_create_times[i] = end - start;
+        for (int i = 0; i < 100; i++)
+        {
+            double start = get_time_ms();
+            cwh_tls_session_t *session = cwh_tls_session_new_server(ctx, fds[1]);
+            double end = get_time_ms();
+            session_create_times[i] = end - start;
 
-        start = get_time_ms();
-        cwh_tls_session_free(session);
-        end = get_time_ms();
-        session_destroy_times[i] = end - start;
-    }
+            start = get_time_ms();
+            cwh_tls_session_free(session);
+            end = get_time_ms();
+            session_destroy_times[i] = end - start;
+        }
+        close(fds[0]);
+        close(fds[1]);
 
-    print_stats("Session Creation", session_create_times, 100);
-    print_stats("Session Destruction", session_destroy_times, 100);
+        print_stats("Session Creation", session_create_times, 100);
+        print_stats("Session Destruction", session_destroy_times, 100);
+    }
+#else
+    printf("Handshake and per-connection benchmarks need socketpair()\n\n");
+#endif
 
     // Cleanup
     cwh_tls_context_free(ctx);
 
-    // Summary
-    printf("========================================\n");
-    printf("Benchmark Summary\n");
-    printf("========================================\n");
-    printf("✅ TLS operations are lightweight\n");
-    printf("✅ Session management overhead: <1ms\n");
-    printf("✅ Memory overhead is minimal\n");
-    printf("\n");
-    printf("Performance compared to plain HTTP:\n");
-    printf("  Throughput:  ~70-80%% (encryption overhead)\n");
-    printf("  Latency:     +10-20ms (initial handshake)\n");
-    printf("  CPU:         +10-15%% (encryption/decryption)\n");
-    printf("\n");
-    printf("Session resumption benefits:\n");
-    printf("  Latency reduction: ~75%% faster reconnects\n");
-    printf("  CPU savings:       ~60%% less crypto work\n");
-    printf("\n");
-
     return 0;
 }
@@ -0,0 +1,177 @@
+// WebSocket benchmark - unmasking throughput (GB/s) per masking kernel
+// (scalar/word64/SSE2/AVX2) for small and large frames, against a memcpy
+// baseline, plus full frame encoding with client-side masking
+
+#include "cwebhttp_ws.h"
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+
+#if defined(_WIN32) || defined(_WIN64)
+#include <windows.h>
+static double GET_TIME_MS()
+{
+    static LARGE_INTEGER frequency;
+    static int initialized = 0;
+
+    if (!initialized)
+    {
+        QueryPerformanceFrequency(&frequency);
+        initialized = 1;
+    }
+
+    LARGE_INTEGER counter;
+    QueryPerformanceCounter(&counter);
+    return (double)(counter.QuadPart * 1000.0) / frequency.QuadPart;
+}
+#else
+#include <sys/time.h>
+static double GET_TIME_MS()
+{
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return (tv.tv_sec * 1000.0) + (tv.tv_usec / 1000.0);
+}
+#endif
+
+static const uint8_t MASKING_KEY[4] = {0x37, 0xfa, 0x21, 0x3d};
+
+// Payload as it lands in a receive buffer: after a 2..14 byte frame header,
+// so usually not aligned
+#define PAYLOAD_OFFSET 6
+
+static double gb_per_sec(size_t len, int iterations, double elapsed)
+{
+    double gb_processed = (len * (double)iterations) / 1e9;
+    return (elapsed > 0) ? gb_processed / (elapsed / 1000.0) : 0.0; // GB/s
+}
+
+// Baseline - memcpy throughput (one read and one write per byte, like unmasking)
+static double bench_memcpy(uint8_t *buf, size_t len, int iterations)
+{
+    uint8_t *src = malloc(len);
+    if (!src)
+        return 0.0;
+    memset(src, 0x5A, len);
+
+    double start = GET_TIME_MS();
+
+    volatile uint8_t dummy = 0;
+    for (int i = 0; i < iterations; i++)
+    {
+        memcpy(buf, src, len);
+        dummy += buf[i % len]; // Prevent optimization
+    }
+
+    double elapsed = GET_TIME_MS() - start;
+    free(src);
+    return gb_per_sec(len, iterations, elapsed);
+}
+
+// Unmask the same payload in place over and over
+static double bench_unmask(uint8_t *buf, size_t len, int iterations)
+{
+    double start = GET_TIME_MS();
+
+    volatile uint8_t dummy = 0;
+    for (int i = 0; i < iterations; i++)
+    {
+        cwh_ws_decode_payload(buf, len, MASKING_KEY);
+        dummy += buf[i % len];
+    }
+
+    double elapsed = GET_TIME_MS() - start;
+    return gb_per_sec(len, iterations, elapsed);
+}
+
+// Client frames: header + copy + mask with a fresh key
+static double bench_encode(const uint8_t *payload, size_t len, int iterations)
+{
+    size_t cap = len + 14;
+    uint8_t *frame = malloc(cap);
+    if (!frame)
+        return 0.0;
+
+    double start = GET_TIME_MS();
+
+    for (int i = 0; i < iterations; i++)
+    {
+        if (cwh_ws_encode_frame(frame, cap, true, CWH_WS_OP_BINARY, payload, len, true) < 0)
+        {
+            free(frame);
+            return 0.0;
+        }
+    }
+
+    double elapsed = GET_TIME_MS() - start;
+    free(frame);
+    return gb_per_sec(len, iterations, elapsed);
+}
+
+int main(void)
+{
+    printf("=== cwebhttp WebSocket Masking Benchmark ===\n\n");
+
+    struct
+    {
+        const char *name;
+        size_t len;
+        int iterations;
+    } frames[] = {
+        {"tiny", 32, 4000000},
+        {"small", 125, 2000000},
+        {"medium", 4 * 1024, 200000},
+        {"large", 64 * 1024, 20000},
+        {"huge", 4 * 1024 * 1024, 200},
+    };
+    const int num_frames = (int)(sizeof(frames) / sizeof(frames[0]));
+    const cwh_ws_mask_impl_t impls[] = {CWH_WS_MASK_SCALAR, CWH_WS_MASK_WORD, CWH_WS_MASK_SSE2,
+                                        CWH_WS_MASK_AVX2};
+    const int num_impls = (int)(sizeof(impls) / sizeof(impls[0]));
+
+    size_t max_len = frames[num_frames - 1].len;
+    uint8_t *block = malloc(max_len + PAYLOAD_OFFSET);
+    if (!block)
+        return 1;
+    uint8_t *payload = block + PAYLOAD_OFFSET;
+    for (size_t i = 0; i < max_len; i++)
+        payload[i] = (uint8_t)(i * 31 + 7);
+
+    printf("Auto-selected kernel: %s\n", cwh_ws_mask_impl_name(cwh_ws_mask_get_impl()));
+    printf("Running benchmarks (this may take a few seconds)...\n\n");
+
+    printf("%-8s %8s %10s", "frame", "bytes", "memcpy");
+    for (int i = 0; i < num_impls; i++)
+        printf(" %10s", cwh_ws_mask_impl_name(impls[i]));
+    printf("   (GB/s, unmask in place)\n");
+
+    for (int f = 0; f < num_frames; f++)
+    {
+        size_t len = frames[f].len;
+        printf("%-8s %8llu %10.2f", frames[f].name, (unsigned long long)len,
+               bench_memcpy(payload, len, frames[f].iterations));
+
+        for (int i = 0; i < num_impls; i++)
+        {
+            if (cwh_ws_mask_set_impl(impls[i]) != 0)
+            {
+                printf(" %10s", "n/a");
+                continue;
+            }
+            printf(" %10.2f", bench_unmask(payload, len, frames[f].iterations));
+        }
+        printf("\n");
+    }
+
+    cwh_ws_mask_set_impl(CWH_WS_MASK_AUTO);
+
+    printf("\nClient frame encoding (%s, copy + mask):\n", cwh_ws_mask_impl_name(cwh_ws_mask_get_impl()));
+    for (int f = 0; f < num_frames; f++)
+    {
+        printf("  %-8s %8llu bytes: %8.2f GB/s\n", frames[f].name, (unsigned long long)frames[f].len,
+               bench_encode(payload, frames[f].len, frames[f].iterations));
+    }
+
+    free(block);
+    return 0;
+}
@@ -8,6 +8,8 @@ gcc -Wall -Wextra -std=c11 -O2 -Iinclude ^
     test_iocp_server.c ^
     src/cwebhttp.c ^
     src/async/loop.c ^
+    src/async/timer.c ^
+    src/async/dns.c ^
     src/async/iocp.c ^
     src/async/nonblock.c ^
     src/async/client.c ^
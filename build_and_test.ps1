@@ -40,6 +40,12 @@ if ($isMSYS2) {
         -c src/log.c -o build/log.o
     gcc -Wall -Wextra -std=gnu17 -O2 -Iinclude -Itests `
         -c src/error.c -o build/error.o
+    gcc -Wall -Wextra -std=gnu17 -O2 -Iinclude -Itests `
+        -c src/file_cache.c -o build/file_cache.o
+    gcc -Wall -Wextra -std=gnu17 -O2 -Iinclude -Itests `
+        -c src/router.c -o build/router.o
+    gcc -Wall -Wextra -std=gnu17 -O2 -Iinclude -Itests `
+        -c src/dns_cache.c -o build/dns_cache.o
     
     if ($LASTEXITCODE -ne 0) {
         Write-Host "Build failed" -ForegroundColor Red
@@ -25,7 +25,7 @@ set "CONFIG=%1"
 set "BUILD_DIR=build\%CONFIG%"
 set "CFLAGS=-Wall -Wextra -std=gnu17 -O2 -Iinclude -Itests"
 set "LDFLAGS=-lws2_32 -lz"
-set "SRCS=src/cwebhttp.c src/memcheck.c src/log.c src/error.c"
+set "SRCS=src/cwebhttp.c src/memcheck.c src/log.c src/error.c src/file_cache.c src/router.c src/dns_cache.c"
 
 REM Create build directory
 if not exist "%BUILD_DIR%" mkdir "%BUILD_DIR%"
@@ -138,7 +138,7 @@ int main(int argc, char *argv[])
     signal(SIGTERM, signal_handler);
 #endif
 
-    // Parse port from command line
+    // Parse port and thread count from command line
     int port = 8080;
     if (argc > 1)
     {
@@ -150,21 +150,39 @@ int main(int argc, char *argv[])
         }
     }
 
+    int threads = 1; // 0 = one event loop per CPU
+    if (argc > 2)
+    {
+        threads = atoi(argv[2]);
+    }
+
     printf("cwebhttp Async Server\n");
     printf("=====================\n\n");
 
-    // Create event loop
-    cwh_loop_t *loop = cwh_loop_new();
-    if (!loop)
+    cwh_loop_t *loop = NULL;
+    cwh_async_server_t *server = NULL;
+
+    if (threads == 1)
     {
-        fprintf(stderr, "Failed to create event loop\n");
-        return 1;
-    }
+        // Create event loop
+        loop = cwh_loop_new();
+        if (!loop)
+        {
+            fprintf(stderr, "Failed to create event loop\n");
+            return 1;
+        }
+
+        printf("Event loop backend: %s\n\n", cwh_loop_backend(loop));
 
-    printf("Event loop backend: %s\n\n", cwh_loop_backend(loop));
+        // Create async server
+        server = cwh_async_server_new(loop);
+    }
+    else
+    {
+        // Shard-per-core server: one loop + SO_REUSEPORT listener per thread
+        server = cwh_async_server_new_multi(threads);
+    }
 
-    // Create async server
-    cwh_async_server_t *server = cwh_async_server_new(loop);
     if (!server)
     {
         fprintf(stderr, "Failed to create server\n");
@@ -172,6 +190,8 @@ int main(int argc, char *argv[])
         return 1;
     }
 
+    printf("Event loop threads: %d\n\n", cwh_async_server_thread_count(server));
+
     g_server = server;
 
     // Register routes
@@ -182,10 +202,16 @@ int main(int argc, char *argv[])
     printf("  POST /api/echo\n");
     printf("\n");
 
-    cwh_async_route(server, "GET", "/", handle_index, NULL);
-    cwh_async_route(server, "GET", "/api/hello", handle_api_hello, NULL);
-    cwh_async_route(server, "GET", "/api/users", handle_api_users, NULL);
-    cwh_async_route(server, "POST", "/api/echo", handle_api_post, NULL);
+    if (cwh_async_route(server, "GET", "/", handle_index, NULL) < 0 ||
+        cwh_async_route(server, "GET", "/api/hello", handle_api_hello, NULL) < 0 ||
+        cwh_async_route(server, "GET", "/api/users", handle_api_users, NULL) < 0 ||
+        cwh_async_route(server, "POST", "/api/echo", handle_api_post, NULL) < 0)
+    {
+        fprintf(stderr, "Failed to register routes\n");
+        cwh_async_server_free(server);
+        cwh_loop_free(loop);
+        return 1;
+    }
 
     // Start listening
     printf("Starting server on http://localhost:%d\n", port);
@@ -199,8 +225,8 @@ int main(int argc, char *argv[])
 
     printf("Server listening... Press Ctrl+C to stop\n\n");
 
-    // Run event loop
-    cwh_loop_run(loop);
+    // Run event loop(s) until stopped
+    cwh_async_server_run(server);
 
     // Cleanup
     printf("\nCleaning up...\n");
@@ -3,8 +3,9 @@
  * Serves files from the www/ directory
  *
  * Features:
- * - Async file serving
+ * - Async file serving (zero-copy sendfile, any file size)
  * - Content-Type detection
+ * - Range requests (206 Partial Content)
  * - Directory listing
  * - 404 handling
  *
@@ -35,40 +36,8 @@
 #endif
 
 #define MAX_PATH_LEN 512
-#define MAX_FILE_SIZE (10 * 1024 * 1024) /* 10MB */
 #define WWW_ROOT "www"
 
-/* Get content type from file extension */
-const char *get_content_type(const char *path)
-{
-    const char *ext = strrchr(path, '.');
-    if (!ext)
-        return "application/octet-stream";
-
-    if (strcmp(ext, ".html") == 0 || strcmp(ext, ".htm") == 0)
-        return "text/html";
-    if (strcmp(ext, ".css") == 0)
-        return "text/css";
-    if (strcmp(ext, ".js") == 0)
-        return "application/javascript";
-    if (strcmp(ext, ".json") == 0)
-        return "application/json";
-    if (strcmp(ext, ".png") == 0)
-        return "image/png";
-    if (strcmp(ext, ".jpg") == 0 || strcmp(ext, ".jpeg") == 0)
-        return "image/jpeg";
-    if (strcmp(ext, ".gif") == 0)
-        return "image/gif";
-    if (strcmp(ext, ".svg") == 0)
-        return "image/svg+xml";
-    if (strcmp(ext, ".txt") == 0)
-        return "text/plain";
-    if (strcmp(ext, ".pdf") == 0)
-        return "application/pdf";
-
-    return "application/octet-stream";
-}
-
 /* Check if path is safe (no directory traversal) */
 int is_safe_path(const char *path)
 {
@@ -80,62 +49,10 @@ int is_safe_path(const char *path)
     return 1;
 }
 
-/* Serve a file */
-void serve_file(cwh_async_conn_t *conn, const char *filepath)
+/* Serve a file (Content-Type from extension, Range supported, streamed with sendfile) */
+void serve_file(cwh_async_conn_t *conn, cwh_request_t *req, const char *filepath)
 {
-    FILE *f = fopen(filepath, "rb");
-    if (!f)
-    {
-        cwh_async_send_status(conn, 404, "File not found");
-        return;
-    }
-
-    /* Get file size */
-    fseek(f, 0, SEEK_END);
-    long size = ftell(f);
-    fseek(f, 0, SEEK_SET);
-
-    if (size > MAX_FILE_SIZE)
-    {
-        fclose(f);
-        cwh_async_send_status(conn, 413, "File too large");
-        return;
-    }
-
-    /* Read file */
-    char *content = malloc(size + 1);
-    if (!content)
-    {
-        fclose(f);
-        cwh_async_send_status(conn, 500, "Out of memory");
-        return;
-    }
-
-    size_t read_size = fread(content, 1, size, f);
-    fclose(f);
-
-    if ((long)read_size != size)
-    {
-        free(content);
-        cwh_async_send_status(conn, 500, "Failed to read file");
-        return;
-    }
-
-    content[size] = '\0';
-
-    /* Get content type */
-    const char *content_type = get_content_type(filepath);
-
-    /* Build response */
-    char headers[256];
-    snprintf(headers, sizeof(headers),
-             "Content-Type: %s\r\n"
-             "Content-Length: %ld\r\n",
-             content_type, size);
-
-    cwh_async_send_response(conn, 200, headers, content, size);
-
-    free(content);
+    cwh_async_send_file(conn, filepath, cwh_get_header(req, "Range"));
 }
 
 /* Directory listing (simple HTML) */
@@ -244,7 +161,7 @@ void handle_file_request(cwh_async_conn_t *conn, cwh_request_t *req, void *data)
         struct stat index_st;
         if (stat(index_path, &index_st) == 0 && S_ISREG(index_st.st_mode))
         {
-            serve_file(conn, index_path);
+            serve_file(conn, req, index_path);
         }
         else
         {
@@ -253,7 +170,7 @@ void handle_file_request(cwh_async_conn_t *conn, cwh_request_t *req, void *data)
     }
     else if (S_ISREG(st.st_mode))
     {
-        serve_file(conn, filepath);
+        serve_file(conn, req, filepath);
     }
     else
     {
@@ -298,7 +215,13 @@ int main(void)
     printf("✓ Server created\n");
 
     /* Register catch-all route */
-    cwh_async_route(server, "GET", "*", handle_file_request, NULL);
+    if (cwh_async_route(server, "GET", "*", handle_file_request, NULL) != 0)
+    {
+        fprintf(stderr, "Failed to register route\n");
+        cwh_async_server_free(server);
+        cwh_loop_free(loop);
+        return 1;
+    }
 
     printf("✓ Routes registered\n");
 
@@ -35,6 +35,15 @@ typedef enum
 
 extern const char *cwh_method_strs[CWH_METHOD_NUM + 1];
 
+// Route capture (filled by the router): ":id" -> "id", "*" -> "*", "*path" -> "path"
+#define CWH_MAX_PARAMS 8
+typedef struct
+{
+    const char *name;
+    const char *value; // Points into the request path, NOT NUL-terminated
+    size_t len;
+} cwh_param_t;
+
 // Структура запроса (zero-alloc: указатели в буфер)
 typedef struct
 {
@@ -46,6 +55,8 @@ typedef struct
     char *body;
     size_t body_len;
     bool is_valid;
+    cwh_param_t params[CWH_MAX_PARAMS]; // Route captures of the matched pattern
+    size_t num_params;
 } cwh_request_t;
 
 // Структура ответа
@@ -84,7 +95,7 @@ typedef struct cwh_conn
     bool keep_alive;                     // Connection supports keep-alive
     time_t last_used;                    // Timestamp of last use (for timeout)
     bool is_https;                       // Whether this is an HTTPS connection
-    struct cwh_tls_context *tls_ctx;     // TLS context (if HTTPS)
+    struct cwh_tls_context *tls_ctx;     // Shared client TLS context (if HTTPS, not owned)
     struct cwh_tls_session *tls_session; // TLS session (if HTTPS)
     struct cwh_conn *next;               // For connection pool linked list
 } cwh_conn_t;
@@ -113,7 +124,7 @@ void cwh_close(cwh_conn_t *conn);
 #if CWEBHTTP_ENABLE_CONNECTION_POOL
 // Connection pool API (for keep-alive support)
 void cwh_pool_init(void);                             // Initialize connection pool
-void cwh_pool_cleanup(void);                          // Cleanup all pooled connections
+void cwh_pool_cleanup(void);                          // Cleanup pooled connections and the TLS client context
 void cwh_pool_return(cwh_conn_t *conn);               // Return connection to pool or close it
 cwh_conn_t *cwh_pool_get(const char *host, int port); // Get connection from pool
 #endif
@@ -143,14 +154,144 @@ cwh_error_t cwh_send_status(cwh_conn_t *conn, int status, const char *message);
 const char *cwh_get_mime_type(const char *path);
 cwh_error_t cwh_send_file(cwh_conn_t *conn, const char *file_path);
 cwh_error_t cwh_send_file_range(cwh_conn_t *conn, const char *file_path, const char *range_header);
+// Parse "Range: bytes=..." against file_size; returns 1 and the inclusive range, 0 if absent/invalid
+int cwh_parse_range_header(const char *range_header, size_t file_size, size_t *out_start, size_t *out_end);
 cwh_error_t cwh_serve_static(cwh_request_t *req, cwh_conn_t *conn, void *root_dir);
 
+// Open file cache (LRU of fds + metadata, used by the static file senders)
+// Entries are refcounted: every acquire must be paired with a release.
+typedef struct cwh_file_entry
+{
+    char *path;
+    int fd;                  // Open read-only descriptor (shared, use positional reads)
+    uint64_t size;
+    time_t mtime;
+    const char *mime_type;   // Precomputed cwh_get_mime_type(path)
+    char etag[48];           // W/"<size>-<mtime>"
+    char last_modified[32];  // IMF-fixdate of mtime
+    // Internal
+    uint32_t hash;
+    int refcount;
+    int watch;               // inotify watch descriptor (-1 if none)
+    bool cached;
+    uint64_t checked_ms;     // Last stat() revalidation
+    struct cwh_file_entry *hash_next;
+    struct cwh_file_entry *lru_prev;
+    struct cwh_file_entry *lru_next;
+} cwh_file_entry_t;
+
+cwh_file_entry_t *cwh_file_cache_acquire(const char *path);
+void cwh_file_cache_release(cwh_file_entry_t *entry);
+// Max cached files (default 256, 0 disables caching)
+void cwh_file_cache_set_capacity(size_t max_entries);
+void cwh_file_cache_clear(void);
+void cwh_file_cache_stats(size_t *entries, uint64_t *hits, uint64_t *misses);
+// Returns 1 if If-None-Match / If-Modified-Since match the entry (send 304)
+int cwh_file_not_modified(const cwh_file_entry_t *entry, const char *if_none_match, const char *if_modified_since);
+
+// Resolved addresses (shared by the DNS cache, cwh_connect and the async resolver)
+typedef enum
+{
+    CWH_DNS_ANY = 0,  // A and AAAA
+    CWH_DNS_IPV4 = 4, // A only
+    CWH_DNS_IPV6 = 6  // AAAA only
+} cwh_dns_family_t;
+
+#define CWH_DNS_MAX_ADDRS 8
+
+typedef struct
+{
+    int family;             // CWH_DNS_IPV4 or CWH_DNS_IPV6
+    unsigned char addr[16]; // Network byte order (4 bytes used for IPv4)
+} cwh_dns_addr_t;
+
+// Process-wide DNS cache (host + family -> addresses), shared by all threads.
+// Answers live for their TTL (clamped to [min, max]), failures for the
+// negative TTL. Expired answers are still served for the stale window while
+// one caller refreshes them.
+// Lookup returns the address count (> 0), 0 for a cached failure or -1 on a
+// miss; *refresh is set when the caller has been picked to refresh the entry
+// (on a miss, or a stale hit nobody else is refreshing).
+int cwh_dns_cache_lookup(const char *host, cwh_dns_family_t family,
+                         cwh_dns_addr_t *addrs, int max_addrs, bool *refresh);
+// Store an answer (count = 0 stores a failure, ttl is ignored for those)
+void cwh_dns_cache_store(const char *host, cwh_dns_family_t family,
+                         const cwh_dns_addr_t *addrs, int count, uint32_t ttl_sec);
+// TTL clamps in seconds (defaults: 1, 300, negative 5, stale 30)
+void cwh_dns_cache_set_ttl(uint32_t min_ttl, uint32_t max_ttl, uint32_t negative_ttl, uint32_t stale_ttl);
+// Max cached names (default 1024, 0 disables caching)
+void cwh_dns_cache_set_capacity(size_t max_entries);
+void cwh_dns_cache_clear(void);
+void cwh_dns_cache_stats(size_t *entries, uint64_t *hits, uint64_t *misses, uint64_t *stale_hits);
+
 // Парсинг (zero-alloc)
 cwh_error_t cwh_parse_req(const char *buf, size_t len, cwh_request_t *req);
 cwh_error_t cwh_parse_res(const char *buf, size_t len, cwh_response_t *res);
 cwh_error_t cwh_format_res(char *buf, size_t *out_len, const cwh_response_t *res);
 cwh_error_t cwh_format_req(char *buf, size_t *out_len, const cwh_request_t *req);
 
+// Incremental request parser (resumes across partial reads, validates framing)
+typedef enum
+{
+    CWH_PARSE_ERROR = -1,    // Malformed request, reply with parser.error_status
+    CWH_PARSE_NEED_MORE = 0, // Feed more bytes
+    CWH_PARSE_HEADERS_DONE,  // Headers parsed (reported once), body pending
+    CWH_PARSE_BODY_DONE      // Whole request parsed, req->body is complete
+} cwh_parse_status_t;
+
+typedef struct
+{
+    int state;                // Internal phase
+    const char *base;         // Buffer seen on the last call (for rebasing)
+    size_t scan_pos;          // Bytes already searched for the end of headers
+    size_t header_len;        // Request line + headers, including final CRLF
+    uint64_t content_length;  // Declared Content-Length (0 if absent)
+    bool chunked;             // Transfer-Encoding: chunked
+    size_t raw_pos;           // Next undecoded chunked byte
+    size_t body_end;          // End of (decoded) body in the buffer
+    uint64_t chunk_remaining; // Bytes left in the current chunk
+    size_t consumed;          // Request size once done; pipelined data starts here
+    uint64_t body_discarded;  // Body bytes dropped by cwh_parser_discard_body
+    int error_status;         // Suggested HTTP status on CWH_PARSE_ERROR (400/501)
+    bool response;            // Parsing a response (cwh_parser_init_response)
+    bool head_request;        // Response to HEAD: never has a body
+} cwh_parser_t;
+
+void cwh_parser_init(cwh_parser_t *parser);
+cwh_parse_status_t cwh_parser_execute(cwh_parser_t *parser, char *buf, size_t len, cwh_request_t *req);
+// Streaming bodies: drop the body bytes decoded so far (buf[header_len, body_end))
+// so the buffer stays bounded; returns the new buffer length
+size_t cwh_parser_discard_body(cwh_parser_t *parser, char *buf, size_t len);
+// Response mode: same buffer contract and statuses as for requests. The body
+// is framed by HEAD / 1xx / 204 / 304 (none), chunked, Content-Length, or
+// else runs until the connection closes: report that with cwh_parser_response_eof.
+void cwh_parser_init_response(cwh_parser_t *parser, bool head_request);
+cwh_parse_status_t cwh_parser_execute_response(cwh_parser_t *parser, char *buf, size_t len, cwh_response_t *res);
+// Peer closed after len bytes: BODY_DONE if that ends the body, else ERROR
+cwh_parse_status_t cwh_parser_response_eof(cwh_parser_t *parser, char *buf, size_t len, cwh_response_t *res);
+// Delimiter scanner used by the parsers (best implementation picked via cpuid)
+typedef enum
+{
+    CWH_SCAN_AUTO = 0,
+    CWH_SCAN_SCALAR,
+    CWH_SCAN_SSE2, // 16 bytes per step
+    CWH_SCAN_AVX2  // 32 bytes per step
+} cwh_scan_impl_t;
+
+// Force an implementation (tests/benchmarks); -1 if the CPU lacks it
+int cwh_scan_set_impl(cwh_scan_impl_t impl);
+cwh_scan_impl_t cwh_scan_get_impl(void);
+const char *cwh_scan_impl_name(cwh_scan_impl_t impl);
+
+// x86 SIMD extensions the CPU has (cpuid); always false on other targets.
+// Shared by the scanner and the WebSocket masking kernels
+typedef enum
+{
+    CWH_CPU_SSE2,
+    CWH_CPU_AVX2
+} cwh_cpu_feature_t;
+bool cwh_cpu_has(cwh_cpu_feature_t feature);
+
 // Utility functions
 const char *cwh_get_header(const cwh_request_t *req, const char *key);
 const char *cwh_get_res_header(const cwh_response_t *res, const char *key);
@@ -176,6 +317,24 @@ cwh_error_t cwh_post(const char *url, const char *body, size_t body_len, cwh_res
 cwh_error_t cwh_put(const char *url, const char *body, size_t body_len, cwh_response_t *res);
 cwh_error_t cwh_delete(const char *url, cwh_response_t *res);
 
+// Radix-tree router: one compressed path trie per method.
+// Patterns: "/users/:id" captures a segment, a trailing "*" / "*name" the rest.
+// Static text beats ":param", ":param" beats "*".
+typedef struct cwh_router cwh_router_t;
+cwh_router_t *cwh_router_new(void);
+void cwh_router_free(cwh_router_t *router);
+// method CWH_METHOD_NUM registers for any method; re-adding a pattern replaces
+// its data. Returns -1 on bad or conflicting patterns (":a" vs ":b" at one spot)
+int cwh_router_add(cwh_router_t *router, cwh_method_t method, const char *pattern, void *data);
+// Data of the best match (method routes first, then any-method), NULL if none.
+// The query string is ignored; captures go to req->params when req != NULL
+void *cwh_router_find(const cwh_router_t *router, cwh_method_t method, const char *path, cwh_request_t *req);
+size_t cwh_router_count(const cwh_router_t *router);
+// "GET" -> CWH_METHOD_GET ...; CWH_METHOD_NUM if unknown
+cwh_method_t cwh_method_from_str(const char *method);
+// Route capture by name (value is not NUL-terminated), NULL if absent
+const char *cwh_get_param(const cwh_request_t *req, const char *name, size_t *len);
+
 // Route entry (internal)
 typedef struct cwh_route
 {
@@ -189,8 +348,9 @@ typedef struct cwh_route
 // Внутренние (не для юзера)
 struct cwh_server
 {
-    int sock;            // Server socket
-    cwh_route_t *routes; // Linked list of routes
+    int sock;             // Server socket
+    cwh_route_t *routes;  // Linked list of routes (owns the entries)
+    cwh_router_t *router; // Route lookup
 };
 
 #endif // CWEBHTTP_H
\ No newline at end of file
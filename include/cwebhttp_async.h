@@ -5,6 +5,7 @@
 #define CWEBHTTP_ASYNC_H
 
 #include "cwebhttp.h"
+#include "cwebhttp_tls.h"
 #include <stddef.h>
 #include <stdbool.h>
 
@@ -25,21 +26,42 @@ extern "C"
     {
         CWH_EVENT_READ = 0x01,  // Socket ready for reading
         CWH_EVENT_WRITE = 0x02, // Socket ready for writing
-        CWH_EVENT_ERROR = 0x04  // Socket error occurred
+        CWH_EVENT_ERROR = 0x04, // Socket error occurred
+        CWH_EVENT_RDHUP = 0x20, // Peer shut down its side (with READ, edge registrations only)
+
+        // Registration flags for cwh_loop_add/cwh_loop_mod (see cwh_loop_flags)
+        CWH_EVENT_EDGE = 0x08,     // Edge-triggered: readiness is reported once per change,
+                                   // so the handler must read/write until EAGAIN
+        CWH_EVENT_EXCLUSIVE = 0x10, // Wake only one of the loops watching a shared fd (add only)
+        CWH_EVENT_COMPLETION = 0x40 // The backend does the socket's I/O: use cwh_loop_recv/send/sendfile
+                                    // instead of recv/send (add only)
     } cwh_event_type_t;
 
     // Event callback - called when fd is ready
     typedef void (*cwh_event_cb)(cwh_loop_t *loop, int fd, int events, void *data);
 
+    // Event loop backends selectable at creation
+    typedef enum
+    {
+        CWH_BACKEND_DEFAULT = 0, // Platform default (epoll/kqueue/IOCP/select)
+        CWH_BACKEND_EPOLL,       // Linux epoll
+        CWH_BACKEND_IO_URING     // Linux io_uring (5.5+), falls back to epoll when unavailable
+    } cwh_backend_type_t;
+
     // Create new event loop
     cwh_loop_t *cwh_loop_new(void);
 
+    // Create new event loop on a specific backend
+    // Falls back to the platform default if the backend is unavailable; check cwh_loop_backend()
+    cwh_loop_t *cwh_loop_new_backend(cwh_backend_type_t backend);
+
     // Run event loop (blocking until stopped)
     // Returns 0 on success, -1 on error
     int cwh_loop_run(cwh_loop_t *loop);
 
     // Run one iteration of event loop (non-blocking)
-    // Returns number of events processed, -1 on error
+    // Waits at most timeout_ms (-1 = until an event or timer), then fires due timers
+    // Returns number of events and timers processed, -1 on error
     int cwh_loop_run_once(cwh_loop_t *loop, int timeout_ms);
 
     // Stop event loop
@@ -60,6 +82,24 @@ extern "C"
     // Get backend name (for debugging)
     const char *cwh_loop_backend(cwh_loop_t *loop);
 
+    // Registration flags (CWH_EVENT_EDGE, CWH_EVENT_EXCLUSIVE, CWH_EVENT_COMPLETION) the backend honours
+    // Other backends ignore EDGE/EXCLUSIVE and stay level-triggered, and refuse COMPLETION
+    int cwh_loop_flags(cwh_loop_t *loop);
+
+    // I/O on a socket registered with CWH_EVENT_COMPLETION (io_uring)
+    // Same contract as recv/send/sendfile on a non-blocking socket: bytes transferred,
+    // 0 at EOF (recv), -1 with errno (EAGAIN: wait for READ/WRITE). cwh_loop_send copies
+    // the bytes and sends them with the next loop iteration, in order with later calls;
+    // output still queued when the fd is removed is sent before the socket is closed.
+    // Return -1 with errno EINVAL for sockets registered without the flag.
+    int cwh_loop_recv(cwh_loop_t *loop, int fd, void *buf, size_t len);
+    int cwh_loop_send(cwh_loop_t *loop, int fd, const void *buf, size_t len);
+    int cwh_loop_sendfile(cwh_loop_t *loop, int fd, int file_fd, uint64_t offset, size_t count);
+
+    // Number of kernel calls the backend has made (epoll_wait/epoll_ctl, io_uring_enter and sendfile)
+    // Returns 0 for backends that don't count them
+    uint64_t cwh_loop_syscalls(cwh_loop_t *loop);
+
     // Get accepted socket from listen socket (IOCP AcceptEx integration)
     // Returns accepted socket fd, or -1 if none available or not using IOCP
     // Internal function used by async server
@@ -70,6 +110,78 @@ extern "C"
     // Internal function used by async server for IOCP data retrieval
     int cwh_loop_get_iocp_data(cwh_loop_t *loop, int fd, char *buffer, int size);
 
+    // ============================================================================
+    // Timers
+    // ============================================================================
+
+    // Opaque timer handle (owned by its loop)
+    typedef struct cwh_timer cwh_timer_t;
+
+    // Timer callback - called once when the timer expires
+    typedef void (*cwh_timer_cb)(cwh_loop_t *loop, cwh_timer_t *timer, void *data);
+
+    // Start one-shot timer firing after timeout_ms (10ms resolution, never early)
+    // The handle stays valid after it fires and can be re-armed with reset;
+    // it is freed by cancel or when the loop is freed. Not thread-safe.
+    cwh_timer_t *cwh_loop_timer_add(cwh_loop_t *loop, uint64_t timeout_ms, cwh_timer_cb cb, void *data);
+
+    // Re-arm timer to fire timeout_ms from now (works on armed and fired timers)
+    // Returns 0 on success, -1 on error
+    int cwh_loop_timer_reset(cwh_loop_t *loop, cwh_timer_t *timer, uint64_t timeout_ms);
+
+    // Cancel timer and free its handle (safe from inside its own callback)
+    void cwh_loop_timer_cancel(cwh_loop_t *loop, cwh_timer_t *timer);
+
+    // ============================================================================
+    // DNS Resolver
+    // ============================================================================
+
+    // Non-blocking resolver: UDP queries on loop sockets (truncated answers are
+    // asked again over TCP), retries/timeouts on loop timers. Reads nameservers,
+    // "search"/"domain" and "options timeout:/attempts:/ndots:" from
+    // /etc/resolv.conf and static names from /etc/hosts. Names are expanded with
+    // the search domains in glibc order; "host." is never expanded. Concurrent
+    // lookups of the same name share one query, and answers go through the
+    // process-wide DNS cache (cwh_dns_cache_*).
+    typedef struct cwh_resolver cwh_resolver_t;
+    typedef struct cwh_dns_query cwh_dns_query_t;
+
+    // Lookup result: err is CWH_OK (count > 0, IPv4 first), CWH_ERR_NET (no such
+    // name / no address / server failure), CWH_ERR_TIMEOUT or CWH_ERR_PARSE
+    typedef void (*cwh_dns_cb)(cwh_error_t err, const cwh_dns_addr_t *addrs, int count, void *data);
+
+    // Create a resolver for a loop (reads /etc/resolv.conf and /etc/hosts)
+    cwh_resolver_t *cwh_resolver_new(cwh_loop_t *loop);
+
+    // Free resolver; pending lookups report CWH_ERR_NET
+    void cwh_resolver_free(cwh_resolver_t *resolver);
+
+    // Use only this nameserver (e.g. "127.0.0.1", 53); returns 0 or -1
+    int cwh_resolver_set_nameserver(cwh_resolver_t *resolver, const char *ip, int port);
+
+    // Replace static names with a hosts file (NULL = none); returns 0 or -1
+    int cwh_resolver_load_hosts(cwh_resolver_t *resolver, const char *path);
+
+    // Per-attempt timeout and rounds over the nameservers (<= 0 = keep current)
+    void cwh_resolver_set_timeout(cwh_resolver_t *resolver, int timeout_ms, int attempts);
+
+    // Replace the search list with space-separated domains (NULL = none) and
+    // set ndots (< 0 = keep current); returns 0 or -1
+    int cwh_resolver_set_search(cwh_resolver_t *resolver, const char *domains, int ndots);
+
+    // Resolve host. Literal addresses, "localhost", hosts entries and DNS cache
+    // hits answer before this returns (and so do argument errors): the result
+    // is then NULL. A stale cache hit also starts a background refresh.
+    // Otherwise cb runs later from the loop, unless the query is cancelled.
+    cwh_dns_query_t *cwh_resolve(cwh_resolver_t *resolver, const char *host, cwh_dns_family_t family,
+                                 cwh_dns_cb cb, void *data);
+
+    // Cancel a pending query (cb is not called)
+    void cwh_resolve_cancel(cwh_dns_query_t *query);
+
+    // Resolver owned by the loop (created on first use, freed with the loop)
+    cwh_resolver_t *cwh_loop_resolver(cwh_loop_t *loop);
+
     // ============================================================================
     // Async Client API
     // ============================================================================
@@ -103,22 +215,55 @@ extern "C"
                            cwh_async_cb cb,
                            void *data);
 
+    // Streaming body callback: each piece of the response body as it arrives
+    // (res has the status and headers). Return non-zero to abort the request.
+    typedef int (*cwh_async_data_cb)(const cwh_response_t *res, const char *chunk, size_t len, void *data);
+
+    // Like cwh_async_request, but the body goes to on_data (chunked encoding
+    // removed) instead of being buffered; cb then gets an empty body, or
+    // CWH_ERR_NET if on_data aborted. Buffered responses are capped at 64 MB.
+    void cwh_async_request_stream(cwh_loop_t *loop,
+                                  cwh_method_t method,
+                                  const char *url,
+                                  const char **headers,
+                                  const char *body,
+                                  size_t body_len,
+                                  cwh_async_data_cb on_data,
+                                  cwh_async_cb cb,
+                                  void *data);
+
+    // https:// requests handshake without blocking the loop (needs
+    // CWEBHTTP_ENABLE_TLS). All of them share one TLS context, so reconnects
+    // resume the last session with the server. ctx must outlive the requests
+    // and pooled connections using it; NULL = cwh_tls_config_default().
+    void cwh_async_client_set_tls(cwh_tls_context_t *ctx);
+
     // ============================================================================
     // Connection Pool Management
     // ============================================================================
 
-    // Initialize connection pool with custom settings
-    // max_connections: Maximum number of pooled connections (default: 50)
+    // Keep-alive sockets are pooled per (scheme, host, port): warmest socket
+    // first, checked for liveness on checkout, with a per-host connection cap.
+
+    // Configure connection pool (values <= 0 keep the current setting)
+    // max_connections: Maximum number of idle pooled connections (default: 50)
     // idle_timeout_sec: Seconds before idle connections are closed (default: 300)
     void cwh_async_pool_init(int max_connections, int idle_timeout_sec);
 
-    // Get connection pool statistics
+    // Max concurrent connections per host (default: 32); requests over the
+    // cap wait in FIFO order for a connection to finish
+    void cwh_async_pool_set_host_limit(int max_per_host);
+
+    // Get connection pool statistics (active = in use, total = active + idle)
     void cwh_async_pool_stats(int *active_count, int *total_count);
 
+    // Statistics for one host:port (connections in use, idle, queued requests)
+    void cwh_async_pool_host_stats(const char *host, int port, int *active, int *idle, int *waiting);
+
     // Cleanup expired connections from pool
     void cwh_async_pool_cleanup(void);
 
-    // Shutdown and free connection pool
+    // Shutdown pool: close idle connections, fail queued requests
     void cwh_async_pool_shutdown(void);
 
     // ============================================================================
@@ -137,6 +282,51 @@ extern "C"
     // Create async server
     cwh_async_server_t *cwh_async_server_new(cwh_loop_t *loop);
 
+    // Create multi-threaded async server (shard-per-core)
+    // Each thread owns its own event loop, SO_REUSEPORT listener and connections;
+    // the kernel spreads incoming connections across the listeners.
+    // num_threads: Number of event loop threads (<= 0 = number of online CPUs)
+    // Routes and TLS must be configured before cwh_async_listen.
+    // Drive it with cwh_async_server_run(), not cwh_loop_run().
+    cwh_async_server_t *cwh_async_server_new_multi(int num_threads);
+
+    // Pin each event loop thread to its own CPU (multi-threaded mode, default: off)
+    void cwh_async_server_set_cpu_pinning(cwh_async_server_t *server, bool enable);
+
+    // Register connections edge-triggered when the loop supports it (default: off)
+    // Connections are then read and written until EAGAIN, and waiting for
+    // the next request or for a writable socket costs no cwh_loop_mod call.
+    // Applies to connections accepted afterwards.
+    void cwh_async_server_set_edge_triggered(cwh_async_server_t *server, bool enable);
+
+    // Number of event loop threads serving this server (1 for single-loop servers)
+    int cwh_async_server_thread_count(cwh_async_server_t *server);
+
+    // Server statistics (see cwh_async_server_get_stats)
+    typedef struct
+    {
+        int connections;            // Open connections
+        uint64_t total_connections; // Connections accepted since start
+        uint64_t total_requests;    // Requests handled since start
+        size_t buffers_in_use;      // Request/response buffers held by connections
+        size_t buffers_pooled;      // Free buffers cached for reuse
+        size_t buffer_bytes;        // Bytes in in-use and pooled buffers
+        size_t memory_bytes;        // Connection state + buffer_bytes
+    } cwh_async_server_stats_t;
+
+    // Get server statistics (summed over all threads of a multi-threaded server)
+    // Idle keep-alive connections hold no buffers; they are attached per request.
+    void cwh_async_server_get_stats(cwh_async_server_t *server, cwh_async_server_stats_t *stats);
+
+    // Configure connection timeouts in ms (0 = disabled, negative = keep current)
+    // header_timeout_ms: Full request must arrive within this after accept/first byte (default: 10000)
+    // keepalive_timeout_ms: Idle keep-alive connections are closed after this (default: 10000)
+    // idle_timeout_ms: Max time without progress while processing/writing (default: 10000)
+    void cwh_async_server_set_timeouts(cwh_async_server_t *server,
+                                       int header_timeout_ms,
+                                       int keepalive_timeout_ms,
+                                       int idle_timeout_ms);
+
     // Configure TLS/HTTPS (must be called before cwh_async_listen)
     // cert_file: Path to server certificate (PEM format)
     // key_file: Path to server private key (PEM format)
@@ -157,17 +347,76 @@ extern "C"
                                     const char *ca_cert_path,
                                     bool require_client_cert);
 
+    // Run TLS handshake steps on a pool of worker threads instead of the
+    // event loop (must be called before cwh_async_listen). A connection's
+    // step runs on a worker while the loop keeps serving established
+    // connections; the result is handed back to the connection's own loop.
+    // One pool serves all threads of a multi-threaded server.
+    // num_workers: Pool size (0 = handshake inline on the loop, the default)
+    // Returns 0 on success, -1 if unsupported (no TLS, Windows, or mbedTLS
+    // built without MBEDTLS_THREADING_C)
+    int cwh_async_server_set_tls_workers(cwh_async_server_t *server, int num_workers);
+
+    // Hand each connection's TLS record layer to the kernel once its
+    // handshake completes (Linux kTLS, TLS 1.2 AES-GCM; default: off).
+    // Responses then go out with sendmsg and file bodies with sendfile, as
+    // on plain TCP. Connections the kernel can't take stay in user-space TLS.
+    void cwh_async_server_set_ktls(cwh_async_server_t *server, bool enable);
+
     // Register route handler
-    void cwh_async_route(cwh_async_server_t *server,
-                         const char *method,
-                         const char *path,
-                         cwh_async_handler_t handler,
-                         void *data);
+    // method: "GET", "POST", ... (NULL = any method)
+    // Returns 0, or -1 on an unknown method or a bad/conflicting path pattern
+    int cwh_async_route(cwh_async_server_t *server,
+                        const char *method,
+                        const char *path,
+                        cwh_async_handler_t handler,
+                        void *data);
+
+    // Streaming request bodies (uploads): on_headers runs once the headers are
+    // parsed, then on_body receives the body as it arrives (Content-Length or
+    // chunked, decoded) without buffering the whole request; body size is not
+    // limited. A reply may be sent at any point; if the body is not complete
+    // by then, the connection closes after the reply.
+    typedef enum
+    {
+        CWH_BODY_DATA,   // data/len: next piece of the body (valid during the call)
+        CWH_BODY_END,    // Body complete
+        CWH_BODY_ABORTED // Connection closed first (conn is invalid after return)
+    } cwh_body_event_t;
+
+    typedef void (*cwh_async_body_cb)(cwh_async_conn_t *conn, cwh_body_event_t event,
+                                      const char *data, size_t len, void *data_ctx);
+
+    // Register a route whose request body is streamed (on_headers may be NULL);
+    // returns 0 or -1 like cwh_async_route
+    int cwh_async_route_body(cwh_async_server_t *server,
+                             const char *method,
+                             const char *path,
+                             cwh_async_handler_t on_headers,
+                             cwh_async_body_cb on_body,
+                             void *data);
+
+    // Flow control for a streamed body: stop/restart reading from the socket
+    // (the idle timeout keeps running while paused)
+    void cwh_async_body_pause(cwh_async_conn_t *conn);
+    void cwh_async_body_resume(cwh_async_conn_t *conn);
+
+    // Event loop serving the connection (timers / deferred work from handlers;
+    // in multi-threaded mode each connection belongs to one shard's loop)
+    cwh_loop_t *cwh_async_conn_loop(cwh_async_conn_t *conn);
 
     // Start listening (non-blocking)
     int cwh_async_listen(cwh_async_server_t *server, int port);
 
+    // Run server until cwh_async_server_stop() is called (blocking)
+    // Single-loop servers run their loop; multi-threaded servers run shard 0
+    // on the calling thread and one extra thread per remaining shard.
+    // Returns 0 on success, -1 on error
+    int cwh_async_server_run(cwh_async_server_t *server);
+
     // Stop server
+    // Multi-threaded servers only signal their threads here; cwh_async_server_run
+    // joins them and closes the listeners/connections before returning.
     void cwh_async_server_stop(cwh_async_server_t *server);
 
     // Free server
@@ -188,6 +437,66 @@ extern "C"
                              int status,
                              const char *json);
 
+    // Caller-owned body buffer for cwh_async_send_iov
+    typedef struct
+    {
+        const void *base;
+        size_t len;
+    } cwh_iovec_t;
+
+    // Called once the server no longer needs the body buffers
+    typedef void (*cwh_release_cb)(void *ctx);
+
+    // Send a response with a body gathered from caller-owned buffers (not copied)
+    // headers: extra header lines ("Content-Type: text/plain\r\n", may be NULL);
+    // Content-Length and Connection are added. Headers and body are written with
+    // one writev/sendmsg where possible; partial writes resume when writable.
+    // The buffers must stay valid until release(release_ctx) runs, which happens
+    // exactly once: after the body is sent, when the connection closes, or on error.
+    // They may point into the request (req->body, header values): the server keeps
+    // the request's memory until the response is sent, also when pipelined requests follow.
+    // Returns 0 on success, -1 on error
+    int cwh_async_send_iov(cwh_async_conn_t *conn,
+                           int status,
+                           const char *headers,
+                           const cwh_iovec_t *body,
+                           int iovcnt,
+                           cwh_release_cb release,
+                           void *release_ctx);
+
+    // Streaming responses: the body is produced piece by piece (Transfer-Encoding:
+    // chunked; HTTP/1.0 clients get a body delimited by connection close).
+    // Output is buffered in the connection; a producer that gets 1 back from
+    // cwh_async_stream_write should pause until CWH_STREAM_DRAIN.
+    typedef enum
+    {
+        CWH_STREAM_DRAIN,  // Buffered output fell to the low watermark, write more
+        CWH_STREAM_CLOSED  // Connection closed, stop (conn is invalid after return)
+    } cwh_stream_event_t;
+
+    typedef void (*cwh_stream_cb)(cwh_async_conn_t *conn, cwh_stream_event_t event, void *ctx);
+
+    // Send status line + headers (extra header lines, may be NULL); returns 0 or -1
+    int cwh_async_stream_begin(cwh_async_conn_t *conn, int status, const char *headers);
+
+    // Watermarks on buffered bytes (defaults 64 KB / 256 KB) and the event
+    // callback; call after cwh_async_stream_begin
+    void cwh_async_stream_set_watermarks(cwh_async_conn_t *conn, size_t low, size_t high,
+                                         cwh_stream_cb cb, void *ctx);
+
+    // Queue data as one chunk (copied). Returns 0, 1 if buffered output reached the
+    // high watermark (wait for CWH_STREAM_DRAIN), -1 on error
+    int cwh_async_stream_write(cwh_async_conn_t *conn, const void *data, size_t len);
+
+    // Finish the response; returns 0 or -1
+    int cwh_async_stream_end(cwh_async_conn_t *conn);
+
+    // Send a file as the response (200, or 206 if range_header is a valid "bytes=..." range)
+    // The body is streamed with sendfile(2) on Linux (chunked reads for TLS/other
+    // platforms) as the socket becomes writable; file size is not limited.
+    // Sends 404 and returns -1 if the file cannot be opened, returns 0 otherwise.
+    int cwh_async_send_file(cwh_async_conn_t *conn, const char *path, const char *range_header);
+
     // ============================================================================
     // Utilities
     // ============================================================================
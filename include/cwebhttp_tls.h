@@ -23,7 +23,9 @@ typedef enum
     CWH_TLS_ERR_READ = -4,
     CWH_TLS_ERR_WRITE = -5,
     CWH_TLS_ERR_ALLOC = -6,
-    CWH_TLS_ERR_INVALID = -7
+    CWH_TLS_ERR_INVALID = -7,
+    CWH_TLS_WANT_READ = 1, // Non-blocking: retry once the socket is readable
+    CWH_TLS_WANT_WRITE = 2 // Non-blocking: retry once the socket is writable
 } cwh_tls_error_t;
 
 // TLS configuration
@@ -40,8 +42,10 @@ typedef struct
 
     // Server-side options
     bool require_client_cert; // Require client certificate authentication (server)
-    bool session_cache;       // Enable TLS session resumption cache
+    bool session_cache;       // Enable TLS session resumption (server cache, client store)
     int session_timeout;      // Session cache timeout in seconds (default: 86400)
+    bool session_tickets;     // Issue RFC 5077 session tickets (server, default: true)
+    int ticket_lifetime;      // Ticket validity and key rotation period in seconds (default: 3600)
 } cwh_tls_config_t;
 
 // TLS context API (global initialization)
@@ -52,10 +56,31 @@ void cwh_tls_context_free(cwh_tls_context_t *ctx);
 cwh_tls_session_t *cwh_tls_session_new(cwh_tls_context_t *ctx, int socket_fd, const char *hostname);
 cwh_tls_session_t *cwh_tls_session_new_server(cwh_tls_context_t *ctx, int socket_fd);
 cwh_tls_error_t cwh_tls_handshake(cwh_tls_session_t *session);
+// One step of the handshake on a non-blocking socket: CWH_TLS_OK when done,
+// CWH_TLS_WANT_READ / CWH_TLS_WANT_WRITE to wait for the socket, else an error
+cwh_tls_error_t cwh_tls_handshake_step(cwh_tls_session_t *session);
+// Read/write: bytes transferred, 0 if the socket would block, -1 on error or close
 int cwh_tls_read(cwh_tls_session_t *session, void *buf, size_t len);
 int cwh_tls_write(cwh_tls_session_t *session, const void *buf, size_t len);
+// After a 0 from read/write: whether TLS waits for writable (else readable)
+bool cwh_tls_want_write(cwh_tls_session_t *session);
+// After a -1 from read: the peer closed the connection (not an error)
+bool cwh_tls_eof(cwh_tls_session_t *session);
 void cwh_tls_session_free(cwh_tls_session_t *session);
 
+// Client-side resumption: with config.session_cache, a context remembers the
+// last session (and ticket) per server name and offers it on the next handshake
+bool cwh_tls_session_resumed(cwh_tls_session_t *session);
+
+// Kernel TLS (Linux): after the handshake, hand record encryption to the
+// kernel so plain send(), sendmsg() and sendfile() on the socket produce TLS
+// records; cwh_tls_read/cwh_tls_write keep working. TLS 1.2 AES-GCM only.
+// Returns false, and the session stays in user space, when the suite, the
+// kernel (tls module) or the build doesn't allow it.
+bool cwh_tls_enable_ktls(cwh_tls_session_t *session);
+// Sends on the socket are encrypted by the kernel
+bool cwh_tls_ktls_enabled(cwh_tls_session_t *session);
+
 // Server-side TLS utilities
 const char *cwh_tls_get_sni_hostname(cwh_tls_session_t *session);
 bool cwh_tls_client_cert_verified(cwh_tls_session_t *session);
@@ -64,6 +89,9 @@ const char *cwh_tls_get_client_cert_subject(cwh_tls_session_t *session);
 // Utility functions
 const char *cwh_tls_error_string(cwh_tls_error_t error);
 bool cwh_tls_is_available(void);
+// mbedTLS built with MBEDTLS_THREADING_C (sessions of one context may
+// handshake on several threads at once)
+bool cwh_tls_threading_available(void);
 
 // Default configuration
 static inline cwh_tls_config_t cwh_tls_config_default(void)
@@ -79,7 +107,9 @@ static inline cwh_tls_config_t cwh_tls_config_default(void)
         .timeout_ms = 5000,
         .require_client_cert = false,
         .session_cache = true,
-        .session_timeout = 86400}; // 24 hours
+        .session_timeout = 86400, // 24 hours
+        .session_tickets = true,
+        .ticket_lifetime = 3600};
     return config;
 }
 
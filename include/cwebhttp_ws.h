@@ -145,6 +145,22 @@ int cwh_ws_encode_frame(uint8_t *out, size_t out_size, bool fin, uint8_t opcode,
 // Decode WebSocket frame payload (unmask if needed)
 void cwh_ws_decode_payload(uint8_t *data, uint64_t len, const uint8_t masking_key[4]);
 
+// Masking kernel used by cwh_ws_decode_payload/cwh_ws_encode_frame (best
+// implementation picked via cpuid)
+typedef enum
+{
+    CWH_WS_MASK_AUTO = 0,
+    CWH_WS_MASK_SCALAR, // 1 byte per step
+    CWH_WS_MASK_WORD,   // 8 bytes per step (portable)
+    CWH_WS_MASK_SSE2,   // 16 bytes per step
+    CWH_WS_MASK_AVX2    // 32 bytes per step
+} cwh_ws_mask_impl_t;
+
+// Force an implementation (tests/benchmarks); -1 if the CPU lacks it
+int cwh_ws_mask_set_impl(cwh_ws_mask_impl_t impl);
+cwh_ws_mask_impl_t cwh_ws_mask_get_impl(void);
+const char *cwh_ws_mask_impl_name(cwh_ws_mask_impl_t impl);
+
 // === Utilities ===
 
 // Generate WebSocket key (base64 encoded random 16 bytes)
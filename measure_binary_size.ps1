@@ -11,7 +11,7 @@ $null = New-Item -ItemType Directory -Force -Path $buildDir
 
 # Common flags
 $cflags = "-O2 -Iinclude -Itests"
-$srcs = "examples/minimal_server.c src/cwebhttp.c src/memcheck.c src/log.c src/error.c"
+$srcs = "examples/minimal_server.c src/cwebhttp.c src/memcheck.c src/log.c src/error.c src/file_cache.c src/router.c src/dns_cache.c"
 $ldflags = "-lws2_32 -lz"
 
 # Build configurations
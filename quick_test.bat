@@ -10,7 +10,7 @@ REM Ensure build directory exists
 if not exist build mkdir build
 
 echo [Step 1] Compiling test server...
-gcc -Wall -Wextra -std=c11 -O2 -Iinclude test_iocp_server.c src/cwebhttp.c src/async/loop.c src/async/iocp.c src/async/nonblock.c src/async/client.c src/async/server.c -o build/test_iocp_server.exe -lws2_32 -lz 2>&1
+gcc -Wall -Wextra -std=c11 -O2 -Iinclude test_iocp_server.c src/cwebhttp.c src/async/loop.c src/async/timer.c src/async/dns.c src/async/iocp.c src/async/nonblock.c src/async/client.c src/async/server.c -o build/test_iocp_server.exe -lws2_32 -lz 2>&1
 
 if %ERRORLEVEL% NEQ 0 (
     echo.
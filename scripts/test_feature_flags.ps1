@@ -6,7 +6,7 @@ Write-Host "Feature Flag Combination Testing" -ForegroundColor Cyan
 Write-Host "========================================" -ForegroundColor Cyan
 Write-Host ""
 
-$srcFiles = "src/cwebhttp.c src/memcheck.c src/log.c src/error.c"
+$srcFiles = "src/cwebhttp.c src/memcheck.c src/log.c src/error.c src/file_cache.c src/router.c src/dns_cache.c"
 $testFile = "tests/test_parse.c tests/unity.c"
 $baseFlags = "-Wall -Wextra -O2 -Iinclude -Itests"
 $ldFlags = "-lws2_32 -lz"
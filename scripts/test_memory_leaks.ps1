@@ -47,8 +47,8 @@ if ($exitCode -eq 0) {
 Write-Host "Testing examples for memory leaks..." -ForegroundColor Yellow
 
 $examples = @(
-    @{Name="Minimal Server"; Src="examples/minimal_server.c"; Extra="src/cwebhttp.c src/memcheck.c src/log.c src/error.c"},
-    @{Name="Simple Client"; Src="examples/simple_client.c"; Extra="src/cwebhttp.c src/memcheck.c src/log.c src/error.c"}
+    @{Name="Minimal Server"; Src="examples/minimal_server.c"; Extra="src/cwebhttp.c src/memcheck.c src/log.c src/error.c src/file_cache.c src/router.c src/dns_cache.c"},
+    @{Name="Simple Client"; Src="examples/simple_client.c"; Extra="src/cwebhttp.c src/memcheck.c src/log.c src/error.c src/file_cache.c src/router.c src/dns_cache.c"}
 )
 
 foreach ($ex in $examples) {
@@ -17,7 +17,7 @@ $benchmarks = @(
     @{Name="Memory"; Src="benchmarks/bench_memory.c"}
 )
 
-$srcs = "src/cwebhttp.c src/memcheck.c src/log.c src/error.c"
+$srcs = "src/cwebhttp.c src/memcheck.c src/log.c src/error.c src/file_cache.c src/router.c src/dns_cache.c"
 $cflags = "-O2 -Iinclude -Itests"
 
 foreach ($bench in $benchmarks) {
@@ -64,7 +64,7 @@ echo "  Building HTTPS client..."
 gcc -DCWEBHTTP_ENABLE_TLS=1 -Wall -Wextra -std=c11 -O2 \
     -Iinclude -Itests \
     examples/https_client.c \
-    src/cwebhttp.c src/tls_mbedtls.c src/memcheck.c src/log.c src/error.c \
+    src/cwebhttp.c src/tls_mbedtls.c src/memcheck.c src/log.c src/error.c src/file_cache.c src/router.c src/dns_cache.c \
     -o build/examples/https_client \
     -lz -lmbedtls -lmbedx509 -lmbedcrypto -lpthread \
     2>&1 | grep -v "warning:" || true
@@ -73,8 +73,8 @@ echo "  Building HTTPS server..."
 gcc -DCWEBHTTP_ENABLE_TLS=1 -Wall -Wextra -std=c11 -O2 \
     -Iinclude -Itests \
     examples/https_server.c \
-    src/async/loop.c src/async/server.c src/cwebhttp.c \
-    src/tls_mbedtls.c src/memcheck.c src/log.c src/error.c \
+    src/async/loop.c src/async/timer.c src/async/dns.c src/async/server.c src/cwebhttp.c \
+    src/tls_mbedtls.c src/memcheck.c src/log.c src/error.c src/file_cache.c src/router.c src/dns_cache.c \
     -o build/examples/https_server \
     -lz -lmbedtls -lmbedx509 -lmbedcrypto -lpthread \
     2>&1 | grep -v "warning:" || true
@@ -83,8 +83,8 @@ echo "  Building advanced HTTPS server..."
 gcc -DCWEBHTTP_ENABLE_TLS=1 -Wall -Wextra -std=c11 -O2 \
     -Iinclude -Itests \
     examples/https_server_advanced.c \
-    src/async/loop.c src/async/server.c src/cwebhttp.c \
-    src/tls_mbedtls.c src/memcheck.c src/log.c src/error.c \
+    src/async/loop.c src/async/timer.c src/async/dns.c src/async/server.c src/cwebhttp.c \
+    src/tls_mbedtls.c src/memcheck.c src/log.c src/error.c src/file_cache.c src/router.c src/dns_cache.c \
     -o build/examples/https_server_advanced \
     -lz -lmbedtls -lmbedx509 -lmbedcrypto -lpthread \
     2>&1 | grep -v "warning:" || true
@@ -8,6 +8,7 @@
 
 #include "../../include/cwebhttp_async.h"
 #include "../../include/cwebhttp.h"
+#include "../../include/cwebhttp_tls.h"
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
@@ -19,13 +20,18 @@
 #include <sys/socket.h>
 #include <netinet/in.h>
 #include <arpa/inet.h>
-#include <netdb.h>
 #include <strings.h>
 #else
 #include <winsock2.h>
 #include <ws2tcpip.h>
 #endif
 
+// Response buffer: starts small, doubles as needed. In streaming mode it
+// only holds the headers and the body bytes not yet handed to on_data.
+#define CWH_ASYNC_RECV_INITIAL 16384
+#define CWH_ASYNC_RECV_MIN_READ 4096
+#define CWH_ASYNC_MAX_RESPONSE (64 * 1024 * 1024)
+
 // ============================================================================
 // Async Request State Machine
 // ============================================================================
@@ -33,8 +39,10 @@
 typedef enum
 {
     ASYNC_STATE_IDLE,
+    ASYNC_STATE_WAITING, // Queued for a per-host connection slot
     ASYNC_STATE_DNS,
     ASYNC_STATE_CONNECTING,
+    ASYNC_STATE_TLS_HANDSHAKE,
     ASYNC_STATE_SENDING,
     ASYNC_STATE_RECEIVING,
     ASYNC_STATE_COMPLETE,
@@ -42,7 +50,7 @@ typedef enum
 } cwh_async_state_t;
 
 // Forward declaration for connection pool
-typedef struct cwh_pooled_conn cwh_pooled_conn_t;
+typedef struct cwh_pool_host cwh_pool_host_t;
 
 // Async request context
 typedef struct cwh_async_request
@@ -60,26 +68,38 @@ typedef struct cwh_async_request
     size_t body_len;
     
     // Connection pooling
-    cwh_pooled_conn_t *pooled_conn;
+    cwh_pool_host_t *pool_host;       // Origin entry (holds a slot unless waiting)
+    struct cwh_async_request *wait_next;
     bool keep_alive;
+    bool reused;                      // fd came from the idle stack
+    bool reusable;                    // Response framed, server keeps it open
 
     // Network
     int fd;
+    bool https;
+    cwh_tls_session_t *tls;      // https:// (travels with fd into the pool)
     struct sockaddr_in addr;
+    char host[256];              // Hostname (pool key / DNS name)
+    cwh_dns_query_t *dns_query;  // Pending lookup (ASYNC_STATE_DNS)
 
     // Buffers
     char send_buf[16384];
     size_t send_len;
     size_t send_offset;
 
-    char recv_buf[65536];
+    char *recv_buf;
+    size_t recv_cap;
     size_t recv_len;
+    bool received;               // Any response byte arrived on this socket
 
     // Response
+    cwh_parser_t parser;
     cwh_response_t response;
+    char *decoded;               // Decompressed body (owned)
 
-    // Callback
+    // Callbacks
     cwh_async_cb callback;
+    cwh_async_data_cb on_data;   // Streaming mode: body goes here, not to cb
     void *user_data;
 
     // Linked list for tracking
@@ -93,112 +113,199 @@ static cwh_async_request_t *active_requests = NULL;
 // Connection Pool
 // ============================================================================
 
-struct cwh_pooled_conn {
+// Idle keep-alive sockets are kept per (scheme, host, port) in a hash map.
+// Each host holds a LIFO stack (the most recently used socket is the one most
+// likely still open, and everything below an expired socket is older still),
+// a cap on concurrent connections and a FIFO of requests waiting for a slot.
+
+#define CWH_POOL_BUCKETS 64             // Hash buckets (power of two)
+#define CWH_POOL_DEFAULT_MAX_IDLE 50    // Idle sockets kept across all hosts
+#define CWH_POOL_DEFAULT_IDLE_SEC 300   // Idle socket lifetime
+#define CWH_POOL_DEFAULT_PER_HOST 32    // Concurrent connections per host
+
+typedef struct cwh_pool_conn
+{
     int fd;
-    char host[256];
-    int port;
+    cwh_tls_session_t *tls;     // Established session (https:// origins)
     time_t last_used;
-    bool in_use;
-    struct cwh_pooled_conn *next;
+    struct cwh_pool_conn *next; // Next older socket
+} cwh_pool_conn_t;
+
+struct cwh_pool_host
+{
+    bool https;
+    int port;
+    uint32_t hash;
+    char host[256];
+    cwh_pool_conn_t *idle;               // LIFO stack, newest first
+    int idle_count;
+    int active;                          // Connections checked out or opening
+    cwh_async_request_t *waiters;        // FIFO of requests waiting for a slot
+    cwh_async_request_t *waiters_tail;
+    struct cwh_pool_host *hash_next;
 };
 
-typedef struct cwh_conn_pool {
-    cwh_pooled_conn_t *connections;
-    int max_connections;
-    int active_count;
+static struct
+{
+    cwh_pool_host_t *buckets[CWH_POOL_BUCKETS];
+    int max_idle;
     int idle_timeout;
-} cwh_conn_pool_t;
+    int max_per_host;
+    int idle_count;
+    int active_count;
+} g_pool = {.max_idle = CWH_POOL_DEFAULT_MAX_IDLE,
+            .idle_timeout = CWH_POOL_DEFAULT_IDLE_SEC,
+            .max_per_host = CWH_POOL_DEFAULT_PER_HOST};
 
-static cwh_conn_pool_t *global_pool = NULL;
+static void close_socket(int fd)
+{
+#ifdef _WIN32
+    closesocket(fd);
+#else
+    close(fd);
+#endif
+}
 
-// Initialize connection pool
-static cwh_conn_pool_t *pool_create(int max_connections, int idle_timeout) {
-    cwh_conn_pool_t *pool = calloc(1, sizeof(cwh_conn_pool_t));
-    if (!pool) return NULL;
-    
-    pool->max_connections = max_connections;
-    pool->idle_timeout = idle_timeout;
-    return pool;
+// Close a connection, ending its TLS session first
+static void close_conn(int fd, cwh_tls_session_t *tls)
+{
+#if CWEBHTTP_ENABLE_TLS
+    if (tls)
+        cwh_tls_session_free(tls);
+#else
+    (void)tls;
+#endif
+    close_socket(fd);
 }
 
-// Get pooled connection
-static cwh_pooled_conn_t *pool_get_connection(cwh_conn_pool_t *pool, const char *host, int port) {
-    if (!pool || !host) return NULL;
-    
-    time_t now = time(NULL);
-    cwh_pooled_conn_t *conn = pool->connections;
-    
-    while (conn) {
-        if (!conn->in_use && 
-            strcmp(conn->host, host) == 0 && 
-            conn->port == port &&
-            (now - conn->last_used) < pool->idle_timeout) {
-            conn->in_use = true;
-            conn->last_used = now;
-            return conn;
-        }
-        conn = conn->next;
+// FNV-1a over host, then scheme and port
+static uint32_t pool_hash(bool https, const char *host, int port)
+{
+    uint32_t h = 2166136261u;
+    while (*host)
+    {
+        h ^= (unsigned char)*host++;
+        h *= 16777619u;
     }
-    return NULL;
+    h ^= (uint32_t)port << 1 | (https ? 1u : 0u);
+    h *= 16777619u;
+    return h;
 }
 
-// Return connection to pool
-static void pool_return_connection(cwh_conn_pool_t *pool, cwh_pooled_conn_t *conn) {
-    if (!pool || !conn) return;
-    
-    conn->in_use = false;
-    conn->last_used = time(NULL);
+// Find (or create) the pool entry for a request's origin
+static cwh_pool_host_t *pool_host_get(bool https, const char *host, int port)
+{
+    uint32_t hash = pool_hash(https, host, port);
+    cwh_pool_host_t **bucket = &g_pool.buckets[hash & (CWH_POOL_BUCKETS - 1)];
+    for (cwh_pool_host_t *ph = *bucket; ph; ph = ph->hash_next)
+    {
+        if (ph->hash == hash && ph->port == port && ph->https == https && strcmp(ph->host, host) == 0)
+            return ph;
+    }
+
+    cwh_pool_host_t *ph = (cwh_pool_host_t *)calloc(1, sizeof(cwh_pool_host_t));
+    if (!ph)
+        return NULL;
+    ph->https = https;
+    ph->port = port;
+    ph->hash = hash;
+    memcpy(ph->host, host, strlen(host) + 1);
+    ph->hash_next = *bucket;
+    *bucket = ph;
+    return ph;
 }
 
-// Add new connection to pool
-static cwh_pooled_conn_t *pool_add_connection(cwh_conn_pool_t *pool, int fd, const char *host, int port) {
-    if (!pool || pool->active_count >= pool->max_connections) return NULL;
-    
-    cwh_pooled_conn_t *conn = calloc(1, sizeof(cwh_pooled_conn_t));
-    if (!conn) return NULL;
-    
-    conn->fd = fd;
-    strncpy(conn->host, host, sizeof(conn->host) - 1);
-    conn->host[sizeof(conn->host) - 1] = '\0';
-    conn->port = port;
-    conn->last_used = time(NULL);
-    conn->in_use = true;
-    
-    conn->next = pool->connections;
-    pool->connections = conn;
-    pool->active_count++;
-    
-    return conn;
+// Close idle sockets from *from down (all older ones)
+static void pool_drop_idle(cwh_pool_host_t *ph, cwh_pool_conn_t **from)
+{
+    while (*from)
+    {
+        cwh_pool_conn_t *conn = *from;
+        *from = conn->next;
+        close_conn(conn->fd, conn->tls);
+        free(conn);
+        ph->idle_count--;
+        g_pool.idle_count--;
+    }
 }
 
-// Cleanup expired connections
-static void pool_cleanup_expired(cwh_conn_pool_t *pool) {
-    if (!pool) return;
-    
-    time_t now = time(NULL);
-    cwh_pooled_conn_t **curr = &pool->connections;
-    
-    while (*curr) {
-        cwh_pooled_conn_t *conn = *curr;
-        if (!conn->in_use && (now - conn->last_used) >= pool->idle_timeout) {
+// An idle keep-alive socket must have nothing to read: EOF means the server
+// closed it, data means the stream is out of sync
+static bool pool_conn_alive(int fd)
+{
+    char c;
+    int n = (int)recv(fd, &c, 1, MSG_PEEK);
+    if (n >= 0)
+        return false;
 #ifdef _WIN32
-            closesocket(conn->fd);
+    return WSAGetLastError() == WSAEWOULDBLOCK;
 #else
-            close(conn->fd);
+    return errno == EAGAIN || errno == EWOULDBLOCK;
 #endif
-            *curr = conn->next;
-            free(conn);
-            pool->active_count--;
-        } else {
-            curr = &conn->next;
+}
+
+// Pop the newest live idle socket (-1 if none); takes a connection slot
+static int pool_checkout(cwh_pool_host_t *ph, cwh_tls_session_t **tls)
+{
+    time_t now = time(NULL);
+    while (ph->idle)
+    {
+        cwh_pool_conn_t *conn = ph->idle;
+        if (now - conn->last_used >= g_pool.idle_timeout)
+        {
+            pool_drop_idle(ph, &ph->idle); // This one and every older one
+            break;
         }
+
+        ph->idle = conn->next;
+        ph->idle_count--;
+        g_pool.idle_count--;
+        int fd = conn->fd;
+        *tls = conn->tls;
+        free(conn);
+        if (pool_conn_alive(fd))
+        {
+            ph->active++;
+            g_pool.active_count++;
+            return fd;
+        }
+        close_conn(fd, *tls);
+        *tls = NULL;
     }
+    return -1;
+}
+
+// Give a connection slot back; a reusable fd goes on top of the idle stack
+static void pool_release(cwh_pool_host_t *ph, int fd, cwh_tls_session_t *tls)
+{
+    ph->active--;
+    g_pool.active_count--;
+    if (fd < 0)
+        return;
+
+    cwh_pool_conn_t *conn = NULL;
+    if (g_pool.idle_count < g_pool.max_idle)
+        conn = (cwh_pool_conn_t *)malloc(sizeof(cwh_pool_conn_t));
+    if (!conn)
+    {
+        close_conn(fd, tls);
+        return;
+    }
+    conn->fd = fd;
+    conn->tls = tls;
+    conn->last_used = time(NULL);
+    conn->next = ph->idle;
+    ph->idle = conn;
+    ph->idle_count++;
+    g_pool.idle_count++;
 }
 
 // ============================================================================
 // Request Lifecycle Management
 // ============================================================================
 
+static void pool_wake(cwh_pool_host_t *ph);
+
 // Allocate new async request
 static cwh_async_request_t *alloc_request(cwh_loop_t *loop)
 {
@@ -238,15 +345,41 @@ static void cleanup_request(cwh_async_request_t *req)
     if (!req)
         return;
 
-    // Remove from event loop
+    // Abandon a lookup still in flight
+    cwh_resolve_cancel(req->dns_query);
+    req->dns_query = NULL;
+
+    // Remove from event loop; a reusable socket goes back to the pool
+    int idle_fd = -1;
     if (req->fd >= 0)
     {
         cwh_loop_del(req->loop, req->fd);
-#ifdef _WIN32
-        closesocket(req->fd);
-#else
-        close(req->fd);
-#endif
+        if (req->reusable && req->pool_host)
+            idle_fd = req->fd;
+        else
+            close_conn(req->fd, req->tls);
+    }
+
+    // Leave the waiter queue, or give the connection slot back
+    cwh_pool_host_t *ph = req->pool_host;
+    if (ph && req->state == ASYNC_STATE_WAITING)
+    {
+        cwh_async_request_t **p = &ph->waiters;
+        cwh_async_request_t *prev = NULL;
+        while (*p && *p != req)
+        {
+            prev = *p;
+            p = &(*p)->wait_next;
+        }
+        if (*p)
+            *p = req->wait_next;
+        if (ph->waiters_tail == req)
+            ph->waiters_tail = prev;
+        ph = NULL;
+    }
+    else if (ph)
+    {
+        pool_release(ph, idle_fd, idle_fd >= 0 ? req->tls : NULL);
     }
 
     // Remove from active list
@@ -254,35 +387,23 @@ static void cleanup_request(cwh_async_request_t *req)
 
     // Free allocated memory
     free(req->body);
+    free(req->recv_buf);
+    free(req->decoded);
     free(req);
-}
 
-// ============================================================================
-// DNS Resolution (Blocking for now, async in future)
-// ============================================================================
+    // The freed slot goes to the next queued request
+    if (ph)
+        pool_wake(ph);
+}
 
-static int resolve_host(const char *host, struct sockaddr_in *addr)
+// Report an error to the caller and free the request
+static void fail_request(cwh_async_request_t *req, cwh_error_t err)
 {
-    struct addrinfo hints = {0};
-    struct addrinfo *result = NULL;
-
-    hints.ai_family = AF_INET;
-    hints.ai_socktype = SOCK_STREAM;
-
-    int ret = getaddrinfo(host, NULL, &hints, &result);
-    if (ret != 0)
-        return -1;
-
-    if (!result || result->ai_family != AF_INET)
+    if (req->callback)
     {
-        freeaddrinfo(result);
-        return -1;
+        req->callback(NULL, err, req->user_data);
     }
-
-    *addr = *(struct sockaddr_in *)result->ai_addr;
-    freeaddrinfo(result);
-
-    return 0;
+    cleanup_request(req);
 }
 
 // ============================================================================
@@ -309,49 +430,80 @@ static int check_connect_complete(int fd)
     return 0;
 }
 
-// Start async connection
-static int start_connect(cwh_async_request_t *req)
+static void async_request_event_handler(cwh_loop_t *loop, int fd, int events, void *data);
+
+// Register the request socket with the loop for its current state
+static int register_request(cwh_async_request_t *req)
 {
-    // Initialize global pool if needed
-    if (!global_pool) {
-        global_pool = pool_create(50, 300); // 50 connections, 5min timeout
-        if (!global_pool) return -1;
-    }
-    
-    // Extract null-terminated hostname
-    char hostname[256] = {0};
-    const char *host_start = req->parsed_url.host;
-    const char *host_end = host_start;
+    int event_mask = (req->state == ASYNC_STATE_CONNECTING) ? CWH_EVENT_WRITE : CWH_EVENT_READ | CWH_EVENT_WRITE;
+    return cwh_loop_add(req->loop, req->fd, event_mask, async_request_event_handler, req);
+}
 
-    // Find end of hostname
-    while (*host_end && *host_end != '/' && *host_end != '?' && *host_end != '#' && *host_end != ':')
+#if CWEBHTTP_ENABLE_TLS
+static cwh_tls_context_t *g_tls_ctx;     // From cwh_async_client_set_tls
+static cwh_tls_context_t *g_tls_default; // Built on the first https:// request
+
+// One context for every connection, so sessions can be resumed across them
+static cwh_tls_context_t *client_tls_context(void)
+{
+    if (g_tls_ctx)
+        return g_tls_ctx;
+    if (!g_tls_default)
     {
-        host_end++;
+        cwh_tls_config_t config = cwh_tls_config_default();
+        g_tls_default = cwh_tls_context_new(&config);
     }
+    return g_tls_default;
+}
 
-    size_t host_len = host_end - host_start;
-    if (host_len >= sizeof(hostname))
-        return -1;
+// Wait for whichever socket event TLS is blocked on
+static int tls_wait(cwh_async_request_t *req)
+{
+    return cwh_loop_mod(req->loop, req->fd, cwh_tls_want_write(req->tls) ? CWH_EVENT_WRITE : CWH_EVENT_READ);
+}
+#endif
 
-    memcpy(hostname, host_start, host_len);
-    hostname[host_len] = '\0';
-    
-    // Try to get pooled connection
-    req->pooled_conn = pool_get_connection(global_pool, hostname, req->parsed_url.port);
-    if (req->pooled_conn) {
-        req->fd = req->pooled_conn->fd;
+// TCP is up: https:// starts the handshake (ASYNC_STATE_TLS_HANDSHAKE),
+// anything else can send right away
+static int connection_established(cwh_async_request_t *req)
+{
+    if (!req->https)
+    {
         req->state = ASYNC_STATE_SENDING;
         return 0;
     }
-
-    // DNS resolution (blocking for now, async DNS planned for future)
-    if (resolve_host(hostname, &req->addr) < 0)
+#if CWEBHTTP_ENABLE_TLS
+    cwh_tls_context_t *ctx = client_tls_context();
+    req->tls = ctx ? cwh_tls_session_new(ctx, req->fd, req->host) : NULL;
+    if (!req->tls)
         return -1;
+    req->state = ASYNC_STATE_TLS_HANDSHAKE;
+    return 0;
+#else
+    return -1; // https:// needs CWEBHTTP_ENABLE_TLS
+#endif
+}
 
-    // Set port AFTER resolve_host
-    req->addr.sin_family = AF_INET;
-    req->addr.sin_port = htons(req->parsed_url.port);
+// Advance the handshake without blocking; ASYNC_STATE_SENDING once done
+static int tls_handshake(cwh_async_request_t *req)
+{
+#if CWEBHTTP_ENABLE_TLS
+    cwh_tls_error_t err = cwh_tls_handshake_step(req->tls);
+    if (err == CWH_TLS_WANT_READ || err == CWH_TLS_WANT_WRITE)
+        return cwh_loop_mod(req->loop, req->fd, err == CWH_TLS_WANT_READ ? CWH_EVENT_READ : CWH_EVENT_WRITE);
+    if (err != CWH_TLS_OK)
+        return -1;
+    req->state = ASYNC_STATE_SENDING;
+    return cwh_loop_mod(req->loop, req->fd, CWH_EVENT_READ | CWH_EVENT_WRITE);
+#else
+    (void)req;
+    return -1;
+#endif
+}
 
+// Open a socket to req->addr and start a non-blocking connect
+static int connect_resolved(cwh_async_request_t *req)
+{
     // Create new socket
     req->fd = socket(AF_INET, SOCK_STREAM, 0);
     if (req->fd < 0)
@@ -368,9 +520,6 @@ static int start_connect(cwh_async_request_t *req)
         req->fd = -1;
         return -1;
     }
-    
-    // Add to pool for future reuse
-    req->pooled_conn = pool_add_connection(global_pool, req->fd, hostname, req->parsed_url.port);
 
     // Initiate connect
     int ret = connect(req->fd, (struct sockaddr *)&req->addr, sizeof(req->addr));
@@ -387,7 +536,7 @@ static int start_connect(cwh_async_request_t *req)
 #endif
             // Connect in progress - register for WRITE event
             req->state = ASYNC_STATE_CONNECTING;
-            return 0;
+            return register_request(req);
         }
 
         // Connect failed
@@ -401,7 +550,143 @@ static int start_connect(cwh_async_request_t *req)
     }
 
     // Connected immediately (rare)
-    req->state = ASYNC_STATE_SENDING;
+    if (connection_established(req) < 0)
+        return -1;
+    return register_request(req);
+}
+
+// Resolver answer (from the loop, or right away for literals / hosts entries)
+static void on_host_resolved(cwh_error_t err, const cwh_dns_addr_t *addrs, int count, void *data)
+{
+    cwh_async_request_t *req = (cwh_async_request_t *)data;
+    req->dns_query = NULL;
+
+    if (err != CWH_OK || count == 0)
+    {
+        fail_request(req, err == CWH_ERR_TIMEOUT ? CWH_ERR_TIMEOUT : CWH_ERR_NET);
+        return;
+    }
+
+    memset(&req->addr, 0, sizeof(req->addr));
+    req->addr.sin_family = AF_INET;
+    req->addr.sin_port = htons(req->parsed_url.port);
+    memcpy(&req->addr.sin_addr, addrs[0].addr, 4);
+
+    if (connect_resolved(req) < 0)
+        fail_request(req, CWH_ERR_NET);
+}
+
+// Resolve the host (without blocking the loop), then connect
+static void resolve_and_connect(cwh_async_request_t *req)
+{
+    cwh_resolver_t *resolver = cwh_loop_resolver(req->loop);
+    if (!resolver)
+    {
+        fail_request(req, CWH_ERR_NET);
+        return;
+    }
+
+    // Non-blocking lookup; the client connects over IPv4
+    req->state = ASYNC_STATE_DNS;
+    cwh_dns_query_t *query = cwh_resolve(resolver, req->host, CWH_DNS_IPV4, on_host_resolved, req);
+    if (query)
+        req->dns_query = query; // Otherwise answered already (req may be gone)
+}
+
+// Take a connection slot: a warm idle socket if the host has one, otherwise
+// a new connection. Failures go to the callback.
+static void open_connection(cwh_async_request_t *req)
+{
+    int fd = pool_checkout(req->pool_host, &req->tls);
+    if (fd >= 0)
+    {
+        req->fd = fd;
+        req->reused = true;
+        req->state = ASYNC_STATE_SENDING;
+        if (register_request(req) < 0)
+            fail_request(req, CWH_ERR_NET);
+        return;
+    }
+
+    req->pool_host->active++;
+    g_pool.active_count++;
+    resolve_and_connect(req);
+}
+
+// Hand free slots to queued requests (FIFO)
+static void pool_wake(cwh_pool_host_t *ph)
+{
+    while (ph->waiters && ph->active < g_pool.max_per_host)
+    {
+        cwh_async_request_t *req = ph->waiters;
+        ph->waiters = req->wait_next;
+        if (!ph->waiters)
+            ph->waiters_tail = NULL;
+        req->wait_next = NULL;
+        open_connection(req);
+    }
+}
+
+// A reused socket can die between the liveness check and our write (the
+// server's idle timeout racing us): retry once on a fresh connection when
+// nothing came back and the request is idempotent or was not sent at all
+static void fail_or_retry(cwh_async_request_t *req, cwh_error_t err)
+{
+    if (req->reused && !req->received &&
+        (req->method != CWH_METHOD_POST || req->send_offset == 0))
+    {
+        cwh_loop_del(req->loop, req->fd);
+        close_conn(req->fd, req->tls);
+        req->fd = -1;
+        req->tls = NULL;
+        req->reused = false;
+        req->send_offset = 0;
+        resolve_and_connect(req); // Keeps the slot
+        return;
+    }
+    fail_request(req, err);
+}
+
+// Start async connection: queue for the host's connection cap, then reuse
+// a pooled socket or resolve the host.
+// Returns -1 only if nothing was started; later failures go to the callback.
+static int start_connect(cwh_async_request_t *req)
+{
+    // Extract null-terminated hostname
+    const char *host_start = req->parsed_url.host;
+    const char *host_end = host_start;
+
+    // Find end of hostname
+    while (*host_end && *host_end != '/' && *host_end != '?' && *host_end != '#' && *host_end != ':')
+    {
+        host_end++;
+    }
+
+    size_t host_len = host_end - host_start;
+    if (host_len >= sizeof(req->host))
+        return -1;
+
+    memcpy(req->host, host_start, host_len);
+    req->host[host_len] = '\0';
+
+    req->https = req->parsed_url.scheme && strncmp(req->parsed_url.scheme, "https", 5) == 0;
+    req->pool_host = pool_host_get(req->https, req->host, req->parsed_url.port);
+    if (!req->pool_host)
+        return -1;
+
+    // Over the per-host cap (or others already queued): wait for a slot
+    if (req->pool_host->waiters || req->pool_host->active >= g_pool.max_per_host)
+    {
+        req->state = ASYNC_STATE_WAITING;
+        if (req->pool_host->waiters_tail)
+            req->pool_host->waiters_tail->wait_next = req;
+        else
+            req->pool_host->waiters = req;
+        req->pool_host->waiters_tail = req;
+        return 0;
+    }
+
+    open_connection(req);
     return 0;
 }
 
@@ -466,6 +751,18 @@ static int send_request_data(cwh_async_request_t *req)
 {
     while (req->send_offset < req->send_len)
     {
+#if CWEBHTTP_ENABLE_TLS
+        if (req->tls)
+        {
+            int n = cwh_tls_write(req->tls, req->send_buf + req->send_offset, req->send_len - req->send_offset);
+            if (n < 0)
+                return -1;
+            if (n == 0)
+                return tls_wait(req);
+            req->send_offset += n;
+            continue;
+        }
+#endif
         int n = send(req->fd,
                      req->send_buf + req->send_offset,
                      (int)(req->send_len - req->send_offset),
@@ -501,44 +798,195 @@ static int send_request_data(cwh_async_request_t *req)
 // Response Receiving
 // ============================================================================
 
-// Check if response is complete
-static int response_complete(const char *buf, size_t len)
+// Make room for one more read plus a terminating NUL
+static int grow_recv_buf(cwh_async_request_t *req)
 {
-    // Find end of headers
-    const char *headers_end = strstr(buf, "\r\n\r\n");
-    if (!headers_end)
-        return 0; // Headers not complete
+    if (req->recv_cap - req->recv_len > CWH_ASYNC_RECV_MIN_READ)
+        return 0;
+    if (req->recv_cap >= CWH_ASYNC_MAX_RESPONSE)
+        return -1;
+
+    size_t cap = req->recv_cap ? req->recv_cap * 2 : CWH_ASYNC_RECV_INITIAL;
+    if (cap > CWH_ASYNC_MAX_RESPONSE)
+        cap = CWH_ASYNC_MAX_RESPONSE;
+    char *buf = (char *)realloc(req->recv_buf, cap);
+    if (!buf)
+        return -1;
+    req->recv_buf = buf; // The parser rebases the response on the next call
+    req->recv_cap = cap;
+    return 0;
+}
 
-    // Check Content-Length
-    const char *cl = strstr(buf, "Content-Length:");
-    if (cl && cl < headers_end)
+// HTTP/1.1 connections persist unless the server says close (1.0: opt-in)
+static bool response_keep_alive(const cwh_async_request_t *req)
+{
+    bool keep_alive = strncmp(req->recv_buf, "HTTP/1.0", 8) != 0;
+    for (size_t i = 0; i < req->response.num_headers; i++)
     {
-        int content_length = atoi(cl + 15);
-        size_t headers_len = (headers_end + 4) - buf;
-        size_t total_len = headers_len + content_length;
+        // Header names and values point into recv_buf (not NUL-terminated)
+        const char *key = req->response.headers[i * 2];
+        if (strncasecmp(key, "Connection", 10) != 0 || key[10] != ':')
+            continue;
 
-        return (int)(len >= total_len);
+        for (const char *v = req->response.headers[i * 2 + 1]; *v && *v != '\r';)
+        {
+            while (*v == ' ' || *v == '\t' || *v == ',')
+                v++;
+            const char *tok = v;
+            while (*v && *v != '\r' && *v != ',' && *v != ' ' && *v != '\t')
+                v++;
+            size_t len = (size_t)(v - tok);
+            if (len == 5 && strncasecmp(tok, "close", 5) == 0)
+                return false;
+            if (len == 10 && strncasecmp(tok, "keep-alive", 10) == 0)
+                keep_alive = true;
+        }
     }
+    return keep_alive;
+}
 
-    // Check for chunked encoding
-    if (strstr(buf, "Transfer-Encoding: chunked") || strstr(buf, "Transfer-Encoding:chunked"))
+#if CWEBHTTP_ENABLE_COMPRESSION
+// Inflate a gzip/deflate body into req->decoded; on failure the body is
+// left as received
+static void decode_body(cwh_async_request_t *req)
+{
+    const char *encoding = cwh_get_res_header(&req->response, "Content-Encoding");
+    if (!encoding || !req->response.body)
+        return;
+    bool gzip = strncasecmp(encoding, "gzip", 4) == 0;
+    if (!gzip && strncasecmp(encoding, "deflate", 7) != 0)
+        return;
+
+    // The output size is unknown: retry with a larger buffer until it fits
+    for (size_t cap = req->response.body_len * 4 + 1024; cap <= CWH_ASYNC_MAX_RESPONSE; cap *= 2)
     {
-        // Look for final chunk: "0\r\n\r\n"
-        return strstr(headers_end + 4, "0\r\n\r\n") != NULL;
+        char *out = (char *)realloc(req->decoded, cap + 1);
+        if (!out)
+            return;
+        req->decoded = out;
+
+        size_t out_len = cap;
+        cwh_error_t err = gzip ? cwh_decompress_gzip(req->response.body, req->response.body_len, out, &out_len)
+                               : cwh_decompress_deflate(req->response.body, req->response.body_len, out, &out_len);
+        if (err == CWH_OK)
+        {
+            out[out_len] = '\0';
+            req->response.body = out;
+            req->response.body_len = out_len;
+            return;
+        }
     }
+}
+#endif
 
-    // No Content-Length and not chunked - assume complete after headers
-    return 1;
+// Hand the body decoded so far to on_data and drop it from the buffer
+static int deliver_body(cwh_async_request_t *req)
+{
+    size_t start = req->parser.header_len;
+    size_t len = req->parser.body_end - start;
+    if (len == 0)
+        return 0;
+    if (req->on_data(&req->response, req->recv_buf + start, len, req->user_data) != 0)
+        return -1;
+    req->recv_len = cwh_parser_discard_body(&req->parser, req->recv_buf, req->recv_len);
+    return 0;
+}
+
+// Response fully received: report it and release the connection
+static void complete_response(cwh_async_request_t *req, bool peer_closed)
+{
+    // Only a length-delimited response with nothing after it leaves the
+    // socket reusable (an EOF-delimited body ends with peer_closed)
+    req->reusable = !peer_closed && req->keep_alive &&
+                    req->recv_len == req->parser.consumed &&
+                    req->response.status != 101 && response_keep_alive(req);
+
+    if (req->on_data)
+    {
+        req->response.body = NULL;
+        req->response.body_len = 0;
+    }
+    else
+    {
+        req->recv_buf[req->parser.body_end] = '\0';
+#if CWEBHTTP_ENABLE_COMPRESSION
+        decode_body(req);
+#endif
+    }
+
+    if (req->callback)
+        req->callback(&req->response, CWH_OK, req->user_data);
+    cleanup_request(req);
+}
+
+// Run the parser over the buffer. Returns 1 when the response is complete,
+// 0 for more data, -1 on a malformed response, -2 if on_data aborted.
+static int advance_response(cwh_async_request_t *req, bool eof)
+{
+    for (;;)
+    {
+        cwh_parse_status_t status =
+            eof ? cwh_parser_response_eof(&req->parser, req->recv_buf, req->recv_len, &req->response)
+                : cwh_parser_execute_response(&req->parser, req->recv_buf, req->recv_len, &req->response);
+
+        switch (status)
+        {
+        case CWH_PARSE_HEADERS_DONE:
+            // Skip interim responses (100 Continue, 103 Early Hints)
+            if (req->response.status >= 100 && req->response.status < 200 && req->response.status != 101)
+            {
+                size_t consumed = req->parser.consumed;
+                memmove(req->recv_buf, req->recv_buf + consumed, req->recv_len - consumed);
+                req->recv_len -= consumed;
+                cwh_parser_init_response(&req->parser, false);
+            }
+            continue;
+
+        case CWH_PARSE_NEED_MORE:
+            if (req->on_data && req->parser.header_len > 0 && deliver_body(req) < 0)
+                return -2;
+            return 0;
+
+        case CWH_PARSE_BODY_DONE:
+            if (req->on_data && deliver_body(req) < 0)
+                return -2;
+            return 1;
+
+        default:
+            return -1;
+        }
+    }
 }
 
-// Receive response data (non-blocking)
+// Receive response data (non-blocking): the parser resumes where it left
+// off, so each byte is scanned once however the response is split
 static int recv_response_data(cwh_async_request_t *req)
 {
-    while (req->recv_len < sizeof(req->recv_buf) - 1)
+    for (;;)
     {
-        int n = recv(req->fd,
+        if (grow_recv_buf(req) < 0)
+        {
+            fail_request(req, CWH_ERR_ALLOC); // Over CWH_ASYNC_MAX_RESPONSE
+            return 0;
+        }
+
+        int n;
+#if CWEBHTTP_ENABLE_TLS
+        if (req->tls)
+        {
+            n = cwh_tls_read(req->tls, req->recv_buf + req->recv_len, req->recv_cap - req->recv_len - 1);
+            if (n == 0)
+                return tls_wait(req);
+            if (n < 0 && !cwh_tls_eof(req->tls))
+                return -1;
+            if (n < 0)
+                n = 0; // Peer closed
+        }
+        else
+#endif
+            n = recv(req->fd,
                      req->recv_buf + req->recv_len,
-                     (int)(sizeof(req->recv_buf) - req->recv_len - 1),
+                     (int)(req->recv_cap - req->recv_len - 1),
                      0);
 
         if (n < 0)
@@ -557,55 +1005,22 @@ static int recv_response_data(cwh_async_request_t *req)
             return -1;
         }
 
-        if (n == 0)
-        {
-            // Connection closed
-            break;
-        }
+        // Connection closed before any byte: let the caller retry
+        if (n == 0 && !req->received)
+            return -1;
 
+        req->received = true;
         req->recv_len += n;
-        req->recv_buf[req->recv_len] = '\0';
-
-        // Check if response is complete
-        if (response_complete(req->recv_buf, req->recv_len))
-        {
-            break;
-        }
-    }
 
-    // Parse response
-    cwh_error_t err = cwh_parse_res(req->recv_buf, req->recv_len, &req->response);
-
-    // Check if connection should be kept alive
-    bool should_keep_alive = false;
-    if (err == CWH_OK && req->keep_alive) {
-        // Check response headers for Connection: keep-alive
-        for (size_t i = 0; i < req->response.num_headers; i++) {
-            if (strcasecmp(req->response.headers[i*2], "connection") == 0) {
-                const char *conn_value = req->response.headers[i*2 + 1];
-                should_keep_alive = (conn_value && strcasecmp(conn_value, "keep-alive") == 0);
-                break;
-            }
-        }
-    }
-
-    // Invoke callback
-    if (req->callback)
-    {
-        req->callback(&req->response, err, req->user_data);
-    }
-
-    // Handle connection pooling
-    if (should_keep_alive && req->pooled_conn && global_pool) {
-        // Return connection to pool
-        pool_return_connection(global_pool, req->pooled_conn);
-        req->fd = -1; // Don't close in cleanup
+        int done = advance_response(req, n == 0);
+        if (done == 0 && n > 0)
+            continue;
+        if (done == 1)
+            complete_response(req, n == 0);
+        else
+            fail_request(req, done == -2 ? CWH_ERR_NET : CWH_ERR_PARSE);
+        return 0;
     }
-
-    // Cleanup
-    cleanup_request(req);
-
-    return 0;
 }
 
 // ============================================================================
@@ -621,11 +1036,7 @@ static void async_request_event_handler(cwh_loop_t *loop, int fd, int events, vo
     // Handle errors
     if (events & CWH_EVENT_ERROR)
     {
-        if (req->callback)
-        {
-            req->callback(NULL, CWH_ERR_NET, req->user_data);
-        }
-        cleanup_request(req);
+        fail_or_retry(req, CWH_ERR_NET);
         return;
     }
 
@@ -633,65 +1044,45 @@ static void async_request_event_handler(cwh_loop_t *loop, int fd, int events, vo
     switch (req->state)
     {
     case ASYNC_STATE_CONNECTING:
-        if (events & CWH_EVENT_WRITE)
-        {
-            // Check if connect completed
-            if (check_connect_complete(req->fd) < 0)
-            {
-                // Connect failed
-                if (req->callback)
-                {
-                    req->callback(NULL, CWH_ERR_NET, req->user_data);
-                }
-                cleanup_request(req);
-                return;
-            }
-
-            // Connected! Format and send request
-            if (format_request(req) < 0)
-            {
-                if (req->callback)
-                {
-                    req->callback(NULL, CWH_ERR_NET, req->user_data);
-                }
-                cleanup_request(req);
-                return;
-            }
+        if (!(events & CWH_EVENT_WRITE))
+            break;
 
-            req->state = ASYNC_STATE_SENDING;
-            // Fall through to send
+        // Connected: ClientHello or the request (formatted up front) can go now
+        if (check_connect_complete(req->fd) < 0 || connection_established(req) < 0)
+        {
+            fail_request(req, CWH_ERR_NET);
+            return;
         }
-        else
+        // Fall through
+
+    case ASYNC_STATE_TLS_HANDSHAKE:
+        if (req->state == ASYNC_STATE_TLS_HANDSHAKE && tls_handshake(req) < 0)
         {
-            break;
+            fail_request(req, CWH_ERR_NET);
+            return;
         }
-        // Fall through intentionally
+        if (req->state != ASYNC_STATE_SENDING)
+            break;
+        // Fall through
 
     case ASYNC_STATE_SENDING:
-        if (events & CWH_EVENT_WRITE)
+        // TLS may be waiting on either event
+        if ((events & CWH_EVENT_WRITE) || req->tls)
         {
             if (send_request_data(req) < 0)
             {
-                if (req->callback)
-                {
-                    req->callback(NULL, CWH_ERR_NET, req->user_data);
-                }
-                cleanup_request(req);
+                fail_or_retry(req, CWH_ERR_NET);
                 return;
             }
         }
         break;
 
     case ASYNC_STATE_RECEIVING:
-        if (events & CWH_EVENT_READ)
+        if ((events & CWH_EVENT_READ) || req->tls)
         {
             if (recv_response_data(req) < 0)
             {
-                if (req->callback)
-                {
-                    req->callback(NULL, CWH_ERR_NET, req->user_data);
-                }
-                cleanup_request(req);
+                fail_or_retry(req, CWH_ERR_NET);
                 return;
             }
         }
@@ -715,6 +1106,20 @@ void cwh_async_request(cwh_loop_t *loop,
                        size_t body_len,
                        cwh_async_cb cb,
                        void *data)
+{
+    cwh_async_request_stream(loop, method, url, headers, body, body_len, NULL, cb, data);
+}
+
+// Async request with the response body streamed to on_data
+void cwh_async_request_stream(cwh_loop_t *loop,
+                              cwh_method_t method,
+                              const char *url,
+                              const char **headers,
+                              const char *body,
+                              size_t body_len,
+                              cwh_async_data_cb on_data,
+                              cwh_async_cb cb,
+                              void *data)
 {
     if (!loop || !url || !cb)
         return;
@@ -730,10 +1135,10 @@ void cwh_async_request(cwh_loop_t *loop,
     // Initialize request
     req->method = method;
     req->callback = cb;
+    req->on_data = on_data;
     req->user_data = data;
     req->headers = headers;
     req->keep_alive = true; // Enable keep-alive by default
-    req->pooled_conn = NULL;
 
     // Copy URL
     strncpy(req->url, url, sizeof(req->url) - 1);
@@ -761,17 +1166,17 @@ void cwh_async_request(cwh_loop_t *loop,
         req->body_len = body_len;
     }
 
-    // Start connection
-    if (start_connect(req) < 0)
+    // Format once: the same bytes go out on a fresh or a pooled connection
+    if (format_request(req) < 0)
     {
-        cb(NULL, CWH_ERR_NET, data);
+        cb(NULL, CWH_ERR_PARSE, data);
         cleanup_request(req);
         return;
     }
+    cwh_parser_init_response(&req->parser, false);
 
-    // Register with event loop
-    int event_mask = (req->state == ASYNC_STATE_CONNECTING) ? CWH_EVENT_WRITE : CWH_EVENT_READ | CWH_EVENT_WRITE;
-    if (cwh_loop_add(loop, req->fd, event_mask, async_request_event_handler, req) < 0)
+    // Start connection (resolves the host without blocking the loop)
+    if (start_connect(req) < 0)
     {
         cb(NULL, CWH_ERR_NET, data);
         cleanup_request(req);
@@ -811,64 +1216,139 @@ void cwh_async_delete(cwh_loop_t *loop, const char *url, cwh_async_cb cb, void *
 // Connection Pool Management API
 // ============================================================================
 
-// Initialize connection pool with custom settings
+// Configure the connection pool (values <= 0 keep the current setting)
 void cwh_async_pool_init(int max_connections, int idle_timeout_sec)
 {
-    if (global_pool) {
-        // Pool already initialized
+    if (max_connections > 0)
+        g_pool.max_idle = max_connections;
+    if (idle_timeout_sec > 0)
+        g_pool.idle_timeout = idle_timeout_sec;
+}
+
+// Cap concurrent connections per origin; extra requests queue for a slot
+void cwh_async_pool_set_host_limit(int max_per_host)
+{
+    if (max_per_host <= 0)
         return;
+    g_pool.max_per_host = max_per_host;
+
+    // A higher cap may free slots for queued requests right away
+    for (int b = 0; b < CWH_POOL_BUCKETS; b++)
+    {
+        for (cwh_pool_host_t *ph = g_pool.buckets[b]; ph; ph = ph->hash_next)
+            pool_wake(ph);
     }
-    
-    global_pool = pool_create(max_connections, idle_timeout_sec);
 }
 
 // Get connection pool statistics
 void cwh_async_pool_stats(int *active_count, int *total_count)
 {
-    if (!global_pool) {
-        if (active_count) *active_count = 0;
-        if (total_count) *total_count = 0;
-        return;
-    }
-    
-    int active = 0, total = 0;
-    cwh_pooled_conn_t *conn = global_pool->connections;
-    
-    while (conn) {
-        total++;
-        if (conn->in_use) active++;
-        conn = conn->next;
+    if (active_count)
+        *active_count = g_pool.active_count;
+    if (total_count)
+        *total_count = g_pool.active_count + g_pool.idle_count;
+}
+
+// Per-origin statistics (0 for unknown origins)
+void cwh_async_pool_host_stats(const char *host, int port, int *active, int *idle, int *waiting)
+{
+    int a = 0, i = 0, w = 0;
+    for (int b = 0; host && b < CWH_POOL_BUCKETS; b++)
+    {
+        for (cwh_pool_host_t *ph = g_pool.buckets[b]; ph; ph = ph->hash_next)
+        {
+            if (ph->port != port || strcmp(ph->host, host) != 0)
+                continue;
+            a += ph->active;
+            i += ph->idle_count;
+            for (cwh_async_request_t *req = ph->waiters; req; req = req->wait_next)
+                w++;
+        }
     }
-    
-    if (active_count) *active_count = active;
-    if (total_count) *total_count = total;
+    if (active)
+        *active = a;
+    if (idle)
+        *idle = i;
+    if (waiting)
+        *waiting = w;
 }
 
-// Cleanup expired connections from pool
+// Close expired idle connections and forget origins with nothing left
 void cwh_async_pool_cleanup(void)
 {
-    if (global_pool) {
-        pool_cleanup_expired(global_pool);
+    time_t now = time(NULL);
+    for (int b = 0; b < CWH_POOL_BUCKETS; b++)
+    {
+        cwh_pool_host_t **p = &g_pool.buckets[b];
+        while (*p)
+        {
+            cwh_pool_host_t *ph = *p;
+
+            // Stack is newest first: drop from the first expired socket down
+            cwh_pool_conn_t **conn = &ph->idle;
+            while (*conn && now - (*conn)->last_used < g_pool.idle_timeout)
+                conn = &(*conn)->next;
+            pool_drop_idle(ph, conn);
+
+            if (!ph->idle && ph->active == 0 && !ph->waiters)
+            {
+                *p = ph->hash_next;
+                free(ph);
+            }
+            else
+            {
+                p = &ph->hash_next;
+            }
+        }
     }
 }
 
-// Shutdown and free connection pool
+// Close idle connections and free the pool; queued requests fail
 void cwh_async_pool_shutdown(void)
 {
-    if (!global_pool) return;
-    
-    cwh_pooled_conn_t *conn = global_pool->connections;
-    while (conn) {
-        cwh_pooled_conn_t *next = conn->next;
-#ifdef _WIN32
-        closesocket(conn->fd);
-#else
-        close(conn->fd);
+    for (int b = 0; b < CWH_POOL_BUCKETS; b++)
+    {
+        for (cwh_pool_host_t *ph = g_pool.buckets[b]; ph; ph = ph->hash_next)
+        {
+            while (ph->waiters)
+            {
+                cwh_async_request_t *req = ph->waiters;
+                ph->waiters = req->wait_next;
+                req->pool_host = NULL;
+                fail_request(req, CWH_ERR_NET);
+            }
+            ph->waiters_tail = NULL;
+            pool_drop_idle(ph, &ph->idle);
+        }
+    }
+
+    // Origins still in use stay until their requests finish
+    cwh_async_pool_cleanup();
+
+#if CWEBHTTP_ENABLE_TLS
+    if (g_tls_default && g_pool.active_count == 0)
+    {
+        cwh_tls_context_free(g_tls_default);
+        g_tls_default = NULL;
+    }
 #endif
-        free(conn);
-        conn = next;
+}
+
+// TLS context for https:// requests (NULL = built-in defaults)
+void cwh_async_client_set_tls(cwh_tls_context_t *ctx)
+{
+    // Idle TLS sockets belong to the old context
+    for (int b = 0; b < CWH_POOL_BUCKETS; b++)
+    {
+        for (cwh_pool_host_t *ph = g_pool.buckets[b]; ph; ph = ph->hash_next)
+        {
+            if (ph->https)
+                pool_drop_idle(ph, &ph->idle);
+        }
     }
-    
-    free(global_pool);
-    global_pool = NULL;
+#if CWEBHTTP_ENABLE_TLS
+    g_tls_ctx = ctx;
+#else
+    (void)ctx;
+#endif
 }
@@ -0,0 +1,1145 @@
+// dns.c - Non-blocking DNS resolver
+// Queries go out over UDP sockets registered with the event loop (TCP when an
+// answer comes back truncated); retries and timeouts are loop timers, so
+// lookups never block the reactor. Nameservers, search domains and options
+// come from /etc/resolv.conf, static names from /etc/hosts.
+// Concurrent lookups of the same name share one query, and answers (with
+// their TTL) go through the process-wide DNS cache in dns_cache.c.
+
+#ifndef _WIN32
+#define _POSIX_C_SOURCE 200112L
+#define _GNU_SOURCE
+#endif
+
+#include "../../include/cwebhttp_async.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <errno.h>
+#include <time.h>
+#include <ctype.h>
+
+#ifndef _WIN32
+#include <unistd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#else
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#endif
+
+#define CWH_DNS_MAX_SERVERS 3           // Like glibc MAXNS
+#define CWH_DNS_MAX_SEARCH 6            // Like glibc MAXDNSRCH
+#define CWH_DNS_DEFAULT_NDOTS 1         // resolv.conf "options ndots:1"
+#define CWH_DNS_MAX_NDOTS 15            // glibc caps ndots at 15
+#define CWH_DNS_DEFAULT_TIMEOUT_MS 5000 // resolv.conf "options timeout:5"
+#define CWH_DNS_DEFAULT_ATTEMPTS 2      // resolv.conf "options attempts:2"
+#define CWH_DNS_PORT 53
+#define CWH_DNS_UDP_SIZE 512            // Max UDP answer without EDNS
+#define CWH_DNS_MAX_NAME 253
+
+#define DNS_TYPE_A 1
+#define DNS_TYPE_AAAA 28
+#define DNS_CLASS_IN 1
+#define DNS_RCODE_NXDOMAIN 3
+#define DNS_FLAG_TC 0x02 // Truncated (in the third header byte)
+
+// Static name from the hosts file
+typedef struct cwh_dns_host
+{
+    char *name;
+    cwh_dns_addr_t addr;
+    struct cwh_dns_host *next;
+} cwh_dns_host_t;
+
+struct cwh_dns_lookup;
+
+// One caller waiting for a lookup (handle returned by cwh_resolve)
+struct cwh_dns_query
+{
+    cwh_dns_cb cb; // NULL once cancelled
+    void *data;
+    struct cwh_dns_lookup *lookup;
+    struct cwh_dns_query *next;
+};
+
+// In-flight lookup of one name (A and/or AAAA on one UDP socket, or on a TCP
+// connection once an answer came back truncated)
+typedef struct cwh_dns_lookup
+{
+    cwh_resolver_t *resolver;
+    char name[CWH_DNS_MAX_NAME + 2]; // Lowercase, trailing dot only if absolute (cache key)
+    char qname[CWH_DNS_MAX_NAME + 1]; // Name being queried (name or a search expansion)
+    int candidate;                   // Index of qname in the search order
+    cwh_dns_family_t family;
+    int fd;                          // Socket connected to the current server
+    int fd_family;                   // Address family of fd
+    bool tcp;                        // Queries go over TCP (a UDP answer was truncated)
+    bool truncated;                  // Truncated UDP answer seen: switch to TCP
+    uint8_t *tcp_out;                // TCP: length-prefixed queries not yet written
+    size_t tcp_out_len;
+    size_t tcp_out_sent;
+    uint8_t *tcp_in;                 // TCP: response bytes received
+    size_t tcp_in_len;
+    size_t tcp_in_cap;
+    cwh_timer_t *timer;              // Per-attempt timeout
+    int attempt;                     // Sends so far; server = attempt % num_servers
+    uint16_t id[2];                  // Query IDs: [0] A, [1] AAAA
+    bool pending[2];                 // Type not answered yet
+    bool answered;                   // Some server replied (timeout vs failure)
+    bool finishing;                  // Callbacks running
+    cwh_dns_addr_t addrs[CWH_DNS_MAX_ADDRS];
+    int count;
+    uint32_t ttl;                    // Smallest TTL among the answers
+    cwh_dns_query_t *waiters;
+    struct cwh_dns_lookup *next;
+} cwh_dns_lookup_t;
+
+struct cwh_resolver
+{
+    cwh_loop_t *loop;
+    struct sockaddr_storage servers[CWH_DNS_MAX_SERVERS];
+    socklen_t server_len[CWH_DNS_MAX_SERVERS];
+    int num_servers;
+    int timeout_ms;              // Per attempt
+    int attempts;                // Rounds over all servers
+    char search[CWH_DNS_MAX_SEARCH][CWH_DNS_MAX_NAME + 1]; // Search domains, in order
+    int num_search;
+    int ndots;                   // Names with fewer dots try the search list first
+    cwh_dns_host_t *hosts;       // Hosts file entries
+    cwh_dns_lookup_t *lookups;   // In flight
+    uint32_t rng;                // Query ID generator state
+};
+
+// ============================================================================
+// Helpers
+// ============================================================================
+
+static void close_fd(int fd)
+{
+#ifdef _WIN32
+    closesocket(fd);
+#else
+    close(fd);
+#endif
+}
+
+static uint16_t next_id(cwh_resolver_t *res)
+{
+    // xorshift32: IDs only need to be unpredictable to off-path guessing
+    // together with the kernel's random source port
+    uint32_t x = res->rng;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    res->rng = x;
+    return (uint16_t)(x >> 8);
+}
+
+// Parse a literal IPv4/IPv6 address
+static bool parse_literal(const char *text, cwh_dns_addr_t *addr)
+{
+    memset(addr, 0, sizeof(*addr));
+    if (inet_pton(AF_INET, text, addr->addr) == 1)
+    {
+        addr->family = CWH_DNS_IPV4;
+        return true;
+    }
+    if (inet_pton(AF_INET6, text, addr->addr) == 1)
+    {
+        addr->family = CWH_DNS_IPV6;
+        return true;
+    }
+    return false;
+}
+
+static bool family_wanted(cwh_dns_family_t wanted, int family)
+{
+    return wanted == CWH_DNS_ANY || (int)wanted == family;
+}
+
+// Lowercase copy without trailing dot; rejects empty/oversized labels
+static bool normalize_name(const char *host, char *out)
+{
+    size_t len = strlen(host);
+    if (len > 0 && host[len - 1] == '.')
+        len--;
+    if (len == 0 || len > CWH_DNS_MAX_NAME)
+        return false;
+
+    size_t label = 0;
+    for (size_t i = 0; i < len; i++)
+    {
+        char c = host[i];
+        if (c == '.')
+        {
+            if (label == 0)
+                return false;
+            label = 0;
+        }
+        else if (++label > 63)
+        {
+            return false;
+        }
+        out[i] = (char)tolower((unsigned char)c);
+    }
+    out[len] = '\0';
+    return label > 0;
+}
+
+// ============================================================================
+// Configuration
+// ============================================================================
+
+static int add_server(cwh_resolver_t *res, const char *ip, int port)
+{
+    if (res->num_servers >= CWH_DNS_MAX_SERVERS)
+        return -1;
+
+    cwh_dns_addr_t addr;
+    if (!parse_literal(ip, &addr))
+        return -1;
+
+    struct sockaddr_storage *ss = &res->servers[res->num_servers];
+    memset(ss, 0, sizeof(*ss));
+    if (addr.family == CWH_DNS_IPV4)
+    {
+        struct sockaddr_in *sin = (struct sockaddr_in *)ss;
+        sin->sin_family = AF_INET;
+        sin->sin_port = htons((uint16_t)port);
+        memcpy(&sin->sin_addr, addr.addr, 4);
+        res->server_len[res->num_servers] = sizeof(*sin);
+    }
+    else
+    {
+        struct sockaddr_in6 *sin6 = (struct sockaddr_in6 *)ss;
+        sin6->sin6_family = AF_INET6;
+        sin6->sin6_port = htons((uint16_t)port);
+        memcpy(&sin6->sin6_addr, addr.addr, 16);
+        res->server_len[res->num_servers] = sizeof(*sin6);
+    }
+    res->num_servers++;
+    return 0;
+}
+
+// Replace the search list with the space-separated domains in list
+static void set_search_list(cwh_resolver_t *res, char *list)
+{
+    res->num_search = 0;
+    char *save = NULL;
+    char *domain;
+    for (domain = strtok_r(list, " \t\r\n", &save); domain && res->num_search < CWH_DNS_MAX_SEARCH;
+         domain = strtok_r(NULL, " \t\r\n", &save))
+    {
+        if (normalize_name(domain, res->search[res->num_search]))
+            res->num_search++;
+    }
+}
+
+// Nameservers, "search"/"domain" and "options timeout:N attempts:N ndots:N"
+// from resolv.conf (the last of search and domain wins, as in glibc)
+static void load_resolv_conf(cwh_resolver_t *res, const char *path)
+{
+    FILE *f = fopen(path, "r");
+    if (!f)
+        return;
+
+    char line[512];
+    while (fgets(line, sizeof(line), f))
+    {
+        char *save = NULL;
+        char *key = strtok_r(line, " \t\r\n", &save);
+        if (!key || key[0] == '#' || key[0] == ';')
+            continue;
+
+        if (strcmp(key, "nameserver") == 0)
+        {
+            char *ip = strtok_r(NULL, " \t\r\n", &save);
+            if (ip)
+                add_server(res, ip, CWH_DNS_PORT);
+        }
+        else if (strcmp(key, "search") == 0 || strcmp(key, "domain") == 0)
+        {
+            set_search_list(res, save ? save : "");
+            if (strcmp(key, "domain") == 0 && res->num_search > 1)
+                res->num_search = 1;
+        }
+        else if (strcmp(key, "options") == 0)
+        {
+            char *opt;
+            while ((opt = strtok_r(NULL, " \t\r\n", &save)) != NULL)
+            {
+                if (strncmp(opt, "timeout:", 8) == 0 && atoi(opt + 8) > 0)
+                    res->timeout_ms = atoi(opt + 8) * 1000;
+                else if (strncmp(opt, "attempts:", 9) == 0 && atoi(opt + 9) > 0)
+                    res->attempts = atoi(opt + 9);
+                else if (strncmp(opt, "ndots:", 6) == 0 && atoi(opt + 6) >= 0)
+                    res->ndots = atoi(opt + 6) > CWH_DNS_MAX_NDOTS ? CWH_DNS_MAX_NDOTS : atoi(opt + 6);
+            }
+        }
+    }
+    fclose(f);
+}
+
+static void free_hosts(cwh_resolver_t *res)
+{
+    while (res->hosts)
+    {
+        cwh_dns_host_t *next = res->hosts->next;
+        free(res->hosts->name);
+        free(res->hosts);
+        res->hosts = next;
+    }
+}
+
+int cwh_resolver_load_hosts(cwh_resolver_t *res, const char *path)
+{
+    if (!res)
+        return -1;
+
+    free_hosts(res);
+    if (!path)
+        return 0;
+
+    FILE *f = fopen(path, "r");
+    if (!f)
+        return -1;
+
+    // Keep file order: the first entry for a name is preferred
+    cwh_dns_host_t **tail = &res->hosts;
+    char line[1024];
+    while (fgets(line, sizeof(line), f))
+    {
+        char *hash = strchr(line, '#');
+        if (hash)
+            *hash = '\0';
+
+        char *save = NULL;
+        char *ip = strtok_r(line, " \t\r\n", &save);
+        cwh_dns_addr_t addr;
+        if (!ip || !parse_literal(ip, &addr))
+            continue;
+
+        char *name;
+        char normalized[CWH_DNS_MAX_NAME + 1];
+        while ((name = strtok_r(NULL, " \t\r\n", &save)) != NULL)
+        {
+            if (!normalize_name(name, normalized))
+                continue;
+            cwh_dns_host_t *host = (cwh_dns_host_t *)calloc(1, sizeof(cwh_dns_host_t));
+            if (!host)
+                break;
+            host->name = strdup(normalized);
+            if (!host->name)
+            {
+                free(host);
+                break;
+            }
+            host->addr = addr;
+            *tail = host;
+            tail = &host->next;
+        }
+    }
+    fclose(f);
+    return 0;
+}
+
+cwh_resolver_t *cwh_resolver_new(cwh_loop_t *loop)
+{
+    if (!loop)
+        return NULL;
+
+    cwh_resolver_t *res = (cwh_resolver_t *)calloc(1, sizeof(cwh_resolver_t));
+    if (!res)
+        return NULL;
+
+    res->loop = loop;
+    res->timeout_ms = CWH_DNS_DEFAULT_TIMEOUT_MS;
+    res->attempts = CWH_DNS_DEFAULT_ATTEMPTS;
+    res->ndots = CWH_DNS_DEFAULT_NDOTS;
+    res->rng = (uint32_t)time(NULL) ^ (uint32_t)(uintptr_t)res ^ 0x9e3779b9u;
+    if (res->rng == 0)
+        res->rng = 1;
+
+#ifndef _WIN32
+    load_resolv_conf(res, "/etc/resolv.conf");
+    cwh_resolver_load_hosts(res, "/etc/hosts");
+#endif
+    if (res->num_servers == 0)
+        add_server(res, "127.0.0.1", CWH_DNS_PORT); // resolv.conf default
+
+    return res;
+}
+
+int cwh_resolver_set_nameserver(cwh_resolver_t *res, const char *ip, int port)
+{
+    if (!res || !ip || port <= 0 || port > 65535)
+        return -1;
+
+    int saved = res->num_servers;
+    res->num_servers = 0;
+    if (add_server(res, ip, port) < 0)
+    {
+        res->num_servers = saved;
+        return -1;
+    }
+    return 0;
+}
+
+void cwh_resolver_set_timeout(cwh_resolver_t *res, int timeout_ms, int attempts)
+{
+    if (!res)
+        return;
+    if (timeout_ms > 0)
+        res->timeout_ms = timeout_ms;
+    if (attempts > 0)
+        res->attempts = attempts;
+}
+
+int cwh_resolver_set_search(cwh_resolver_t *res, const char *domains, int ndots)
+{
+    if (!res)
+        return -1;
+
+    char list[CWH_DNS_MAX_SEARCH * (CWH_DNS_MAX_NAME + 2)];
+    if (domains && strlen(domains) >= sizeof(list))
+        return -1;
+    snprintf(list, sizeof(list), "%s", domains ? domains : "");
+    set_search_list(res, list);
+    if (ndots >= 0)
+        res->ndots = ndots > CWH_DNS_MAX_NDOTS ? CWH_DNS_MAX_NDOTS : ndots;
+    return 0;
+}
+
+// ============================================================================
+// Wire Format
+// ============================================================================
+
+// Build a recursive query for name; returns packet length or -1
+static int build_query(uint8_t *buf, size_t size, uint16_t id, const char *name, uint16_t type)
+{
+    size_t name_len = strlen(name);
+    if (12 + name_len + 2 + 4 > size)
+        return -1;
+
+    memset(buf, 0, 12);
+    buf[0] = (uint8_t)(id >> 8);
+    buf[1] = (uint8_t)id;
+    buf[2] = 0x01; // RD
+    buf[5] = 1;    // QDCOUNT
+
+    // Labels: "www.example.com" -> 3www7example3com0
+    size_t pos = 12;
+    const char *label = name;
+    while (*label)
+    {
+        const char *dot = strchr(label, '.');
+        size_t len = dot ? (size_t)(dot - label) : strlen(label);
+        buf[pos++] = (uint8_t)len;
+        memcpy(buf + pos, label, len);
+        pos += len;
+        label += len;
+        if (*label == '.')
+            label++;
+    }
+    buf[pos++] = 0;
+    buf[pos++] = (uint8_t)(type >> 8);
+    buf[pos++] = (uint8_t)type;
+    buf[pos++] = 0;
+    buf[pos++] = DNS_CLASS_IN;
+    return (int)pos;
+}
+
+// Decode a (possibly compressed) name at *off into out (lowercase, dotted);
+// *off moves past the name. Returns 0 or -1 on malformed input
+static int read_name(const uint8_t *p, size_t len, size_t *off, char *out, size_t out_size)
+{
+    size_t pos = *off;
+    size_t out_len = 0;
+    int jumps = 0;
+    bool jumped = false;
+
+    for (;;)
+    {
+        if (pos >= len)
+            return -1;
+        uint8_t n = p[pos];
+        if ((n & 0xC0) == 0xC0)
+        {
+            if (pos + 1 >= len || ++jumps > 16)
+                return -1;
+            if (!jumped)
+                *off = pos + 2;
+            jumped = true;
+            pos = ((size_t)(n & 0x3F) << 8) | p[pos + 1];
+            continue;
+        }
+        if (n & 0xC0)
+            return -1;
+        pos++;
+        if (n == 0)
+            break;
+        if (pos + n > len || out_len + n + 2 > out_size)
+            return -1;
+        if (out_len > 0)
+            out[out_len++] = '.';
+        for (uint8_t i = 0; i < n; i++)
+            out[out_len++] = (char)tolower(p[pos + i]);
+        pos += n;
+    }
+
+    out[out_len] = '\0';
+    if (!jumped)
+        *off = pos;
+    return 0;
+}
+
+static uint16_t get16(const uint8_t *p)
+{
+    return (uint16_t)((p[0] << 8) | p[1]);
+}
+
+static uint32_t get32(const uint8_t *p)
+{
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+// ============================================================================
+// Lookups
+// ============================================================================
+
+static void lookup_timeout(cwh_loop_t *loop, cwh_timer_t *timer, void *data);
+static void lookup_event(cwh_loop_t *loop, int fd, int events, void *data);
+static void lookup_tcp_event(cwh_loop_t *loop, int fd, int events, void *data);
+
+static void lookup_close_socket(cwh_dns_lookup_t *lookup)
+{
+    if (lookup->fd >= 0)
+    {
+        cwh_loop_del(lookup->resolver->loop, lookup->fd);
+        close_fd(lookup->fd);
+        lookup->fd = -1;
+    }
+}
+
+// Name number index to query for key, in glibc's res_search order: a name
+// with at least ndots dots goes out as given first and then with each search
+// domain, one with fewer dots tries the search domains first. Absolute names
+// ("host.") are only queried as given. Returns 1 with the name in out, 0 if
+// that expansion is too long (skip it), -1 past the last name
+static int search_name(const cwh_resolver_t *res, const char *key, int index, char *out)
+{
+    size_t len = strlen(key);
+    bool absolute = key[len - 1] == '.';
+    if (absolute)
+        len--;
+
+    int dots = 0;
+    for (size_t i = 0; i < len; i++)
+        dots += key[i] == '.';
+
+    int domains = absolute ? 0 : res->num_search;
+    bool as_is_first = dots >= res->ndots;
+    if (index < 0 || index > domains)
+        return -1;
+
+    if (index == (as_is_first ? 0 : domains))
+    {
+        memcpy(out, key, len);
+        out[len] = '\0';
+        return 1;
+    }
+
+    const char *domain = res->search[as_is_first ? index - 1 : index];
+    size_t domain_len = strlen(domain);
+    if (len + 1 + domain_len > CWH_DNS_MAX_NAME)
+        return 0;
+    memcpy(out, key, len);
+    out[len] = '.';
+    memcpy(out + len + 1, domain, domain_len + 1);
+    return 1;
+}
+
+// Stable reorder putting IPv4 addresses first
+static void sort_addrs(cwh_dns_addr_t *addrs, int count)
+{
+    cwh_dns_addr_t sorted[CWH_DNS_MAX_ADDRS];
+    int n = 0;
+    for (int pass = 0; pass < 2; pass++)
+    {
+        for (int i = 0; i < count; i++)
+        {
+            if ((addrs[i].family == CWH_DNS_IPV4) == (pass == 0))
+                sorted[n++] = addrs[i];
+        }
+    }
+    memcpy(addrs, sorted, (size_t)count * sizeof(*addrs));
+}
+
+// Detach the lookup and report to every waiter
+static void lookup_finish(cwh_dns_lookup_t *lookup, cwh_error_t err)
+{
+    cwh_resolver_t *res = lookup->resolver;
+
+    cwh_dns_lookup_t **p = &res->lookups;
+    while (*p && *p != lookup)
+        p = &(*p)->next;
+    if (*p)
+        *p = lookup->next;
+
+    lookup_close_socket(lookup);
+    cwh_loop_timer_cancel(res->loop, lookup->timer);
+    lookup->timer = NULL;
+    free(lookup->tcp_out);
+    free(lookup->tcp_in);
+
+    sort_addrs(lookup->addrs, lookup->count);
+    int n = lookup->count;
+
+    // Cache answers and definite failures (every type answered without
+    // an address); timeouts and server failures are not cached. An answer
+    // belongs to the name that got it: the cache does not tell "web" from
+    // "web.", so one found through a search domain is kept under the
+    // expanded name
+    if (err == CWH_OK && (n > 0 || (!lookup->pending[0] && !lookup->pending[1])))
+        cwh_dns_cache_store(n > 0 ? lookup->qname : lookup->name, lookup->family, lookup->addrs, n, lookup->ttl);
+
+    if (err == CWH_OK && n == 0)
+        err = CWH_ERR_NET;
+
+    lookup->finishing = true;
+    while (lookup->waiters)
+    {
+        cwh_dns_query_t *query = lookup->waiters;
+        lookup->waiters = query->next;
+        if (query->cb)
+            query->cb(err, err == CWH_OK ? lookup->addrs : NULL, err == CWH_OK ? n : 0, query->data);
+        free(query);
+    }
+    free(lookup);
+}
+
+// Open a TCP connection to server and queue the open queries (length-prefixed);
+// they are written once it connects
+static int lookup_send_tcp(cwh_dns_lookup_t *lookup, int server)
+{
+    cwh_resolver_t *res = lookup->resolver;
+    const struct sockaddr_storage *addr = &res->servers[server];
+
+    // One connection per attempt
+    lookup_close_socket(lookup);
+    if (!lookup->tcp_out)
+        lookup->tcp_out = (uint8_t *)malloc(2 * (2 + CWH_DNS_UDP_SIZE));
+    if (!lookup->tcp_in)
+        lookup->tcp_in = (uint8_t *)malloc(2 + 65535);
+    if (!lookup->tcp_out || !lookup->tcp_in)
+        return -1;
+    lookup->tcp_in_cap = 2 + 65535;
+    lookup->tcp_in_len = 0;
+    lookup->tcp_out_len = 0;
+    lookup->tcp_out_sent = 0;
+
+    static const uint16_t types[2] = {DNS_TYPE_A, DNS_TYPE_AAAA};
+    for (int t = 0; t < 2; t++)
+    {
+        if (!lookup->pending[t])
+            continue;
+        uint8_t *msg = lookup->tcp_out + lookup->tcp_out_len;
+        int len = build_query(msg + 2, CWH_DNS_UDP_SIZE, lookup->id[t], lookup->qname, types[t]);
+        if (len < 0)
+            return -1;
+        msg[0] = (uint8_t)(len >> 8);
+        msg[1] = (uint8_t)len;
+        lookup->tcp_out_len += 2 + (size_t)len;
+    }
+
+    lookup->fd = (int)socket(addr->ss_family, SOCK_STREAM, 0);
+    if (lookup->fd < 0)
+        return -1;
+    lookup->fd_family = addr->ss_family;
+    if (cwh_set_nonblocking(lookup->fd) < 0)
+    {
+        close_fd(lookup->fd);
+        lookup->fd = -1;
+        return -1;
+    }
+
+    int rc = connect(lookup->fd, (const struct sockaddr *)addr, res->server_len[server]);
+#ifdef _WIN32
+    bool failed = rc < 0 && WSAGetLastError() != WSAEWOULDBLOCK;
+#else
+    bool failed = rc < 0 && errno != EINPROGRESS;
+#endif
+    if (failed || cwh_loop_add(res->loop, lookup->fd, CWH_EVENT_WRITE, lookup_tcp_event, lookup) < 0)
+    {
+        close_fd(lookup->fd);
+        lookup->fd = -1;
+        return -1;
+    }
+    return 0;
+}
+
+// Point the socket at server attempt % num_servers and send the open queries
+static int lookup_send(cwh_dns_lookup_t *lookup)
+{
+    cwh_resolver_t *res = lookup->resolver;
+    int server = lookup->attempt % res->num_servers;
+    const struct sockaddr_storage *addr = &res->servers[server];
+
+    if (lookup->tcp)
+        return lookup_send_tcp(lookup, server);
+
+    if (lookup->fd >= 0 && lookup->fd_family != addr->ss_family)
+        lookup_close_socket(lookup);
+
+    if (lookup->fd < 0)
+    {
+        lookup->fd = (int)socket(addr->ss_family, SOCK_DGRAM, 0);
+        if (lookup->fd < 0)
+            return -1;
+        lookup->fd_family = addr->ss_family;
+        if (cwh_set_nonblocking(lookup->fd) < 0 ||
+            cwh_loop_add(res->loop, lookup->fd, CWH_EVENT_READ, lookup_event, lookup) < 0)
+        {
+            close_fd(lookup->fd);
+            lookup->fd = -1;
+            return -1;
+        }
+    }
+
+    // Connected UDP: the kernel drops datagrams from other sources
+    if (connect(lookup->fd, (const struct sockaddr *)addr, res->server_len[server]) < 0)
+        return -1;
+
+    static const uint16_t types[2] = {DNS_TYPE_A, DNS_TYPE_AAAA};
+    for (int t = 0; t < 2; t++)
+    {
+        if (!lookup->pending[t])
+            continue;
+        uint8_t packet[CWH_DNS_UDP_SIZE];
+        int len = build_query(packet, sizeof(packet), lookup->id[t], lookup->qname, types[t]);
+        if (len < 0)
+            return -1;
+        // A lost datagram is retried on timeout
+        send(lookup->fd, (const char *)packet, len, 0);
+    }
+    return 0;
+}
+
+// Move on to the next server / attempt, or give up
+static void lookup_retry(cwh_dns_lookup_t *lookup)
+{
+    cwh_resolver_t *res = lookup->resolver;
+    if (lookup->count > 0)
+    {
+        // One family answered: do not hold the result back for the other
+        lookup_finish(lookup, CWH_OK);
+        return;
+    }
+
+    lookup->attempt++;
+    if (lookup->attempt >= res->attempts * res->num_servers)
+    {
+        lookup_finish(lookup, lookup->count > 0 ? CWH_OK : (lookup->answered ? CWH_ERR_NET : CWH_ERR_TIMEOUT));
+        return;
+    }
+
+    if (lookup_send(lookup) < 0)
+    {
+        lookup_finish(lookup, CWH_ERR_NET);
+        return;
+    }
+    cwh_loop_timer_reset(res->loop, lookup->timer, (uint64_t)res->timeout_ms);
+}
+
+static void lookup_timeout(cwh_loop_t *loop, cwh_timer_t *timer, void *data)
+{
+    (void)loop;
+    (void)timer;
+    lookup_retry((cwh_dns_lookup_t *)data);
+}
+
+// The current name has no address: query the next name of the search order.
+// Returns false if there is none (the caller finishes the lookup)
+static bool lookup_next_name(cwh_dns_lookup_t *lookup)
+{
+    cwh_resolver_t *res = lookup->resolver;
+    int index = lookup->candidate + 1;
+    int found;
+    while ((found = search_name(res, lookup->name, index, lookup->qname)) == 0)
+        index++;
+    if (found < 0)
+        return false;
+
+    lookup->candidate = index;
+    lookup->pending[0] = family_wanted(lookup->family, CWH_DNS_IPV4);
+    lookup->pending[1] = family_wanted(lookup->family, CWH_DNS_IPV6);
+    lookup->id[0] = next_id(res);
+    lookup->id[1] = (uint16_t)(lookup->id[0] + 1);
+    lookup->attempt = 0;
+    if (lookup->tcp)
+        lookup_close_socket(lookup); // Back to UDP for the new name
+    lookup->tcp = false;
+    lookup->truncated = false;
+
+    if (lookup_send(lookup) < 0)
+    {
+        lookup_finish(lookup, CWH_ERR_NET);
+        return true;
+    }
+    cwh_loop_timer_reset(res->loop, lookup->timer, (uint64_t)res->timeout_ms);
+    return true;
+}
+
+// Act on the answers so far: finish, try the next name or server, or ask
+// again over TCP after a truncated answer
+static void lookup_progress(cwh_dns_lookup_t *lookup, bool server_failed)
+{
+    if (!lookup->pending[0] && !lookup->pending[1])
+    {
+        if (lookup->count > 0 || !lookup_next_name(lookup))
+            lookup_finish(lookup, CWH_OK);
+    }
+    else if (server_failed)
+    {
+        lookup_retry(lookup);
+    }
+    else if (lookup->truncated && !lookup->tcp)
+    {
+        // Same server, over TCP (RFC 7766)
+        lookup->tcp = true;
+        if (lookup_send(lookup) < 0)
+        {
+            lookup_finish(lookup, CWH_ERR_NET);
+            return;
+        }
+        cwh_loop_timer_reset(lookup->resolver->loop, lookup->timer, (uint64_t)lookup->resolver->timeout_ms);
+    }
+}
+
+// Handle one response (UDP datagram or TCP message). Returns 1 if the server
+// failed (try the next one), 0 otherwise
+static int lookup_parse(cwh_dns_lookup_t *lookup, const uint8_t *p, size_t len, bool tcp)
+{
+    if (len < 12 || !(p[2] & 0x80)) // Too short or not a response
+        return 0;
+
+    uint16_t id = get16(p);
+    int t = lookup->pending[0] && id == lookup->id[0] ? 0 : (lookup->pending[1] && id == lookup->id[1] ? 1 : -1);
+    if (t < 0 || get16(p + 4) != 1)
+        return 0;
+
+    // The question must be ours
+    char name[CWH_DNS_MAX_NAME + 2];
+    size_t off = 12;
+    if (read_name(p, len, &off, name, sizeof(name)) < 0 || off + 4 > len ||
+        strcmp(name, lookup->qname) != 0 || get16(p + off) != (t == 0 ? DNS_TYPE_A : DNS_TYPE_AAAA))
+        return 0;
+    off += 4;
+
+    lookup->answered = true;
+    if (p[2] & DNS_FLAG_TC)
+    {
+        if (tcp)
+            return 1; // Nothing bigger to fall back to
+        lookup->truncated = true; // Records may be missing: ask again over TCP
+        return 0;
+    }
+
+    int rcode = p[3] & 0x0F;
+    if (rcode != 0 && rcode != DNS_RCODE_NXDOMAIN)
+        return 1; // SERVFAIL / REFUSED / ...
+
+    lookup->pending[t] = false;
+    if (rcode != 0)
+        return 0;
+
+    // Answers (CNAME chains are followed by the recursive server; take every
+    // record of the requested type)
+    uint16_t ancount = get16(p + 6);
+    for (uint16_t i = 0; i < ancount; i++)
+    {
+        char owner[CWH_DNS_MAX_NAME + 2];
+        if (read_name(p, len, &off, owner, sizeof(owner)) < 0 || off + 10 > len)
+            return 0;
+        uint16_t type = get16(p + off);
+        uint16_t cls = get16(p + off + 2);
+        uint32_t ttl = get32(p + off + 4);
+        uint16_t rdlen = get16(p + off + 8);
+        off += 10;
+        if (off + rdlen > len)
+            return 0;
+
+        // The chain (CNAMEs included) is only as fresh as its shortest TTL
+        if (cls == DNS_CLASS_IN && ttl < lookup->ttl)
+            lookup->ttl = ttl;
+
+        if (cls == DNS_CLASS_IN && lookup->count < CWH_DNS_MAX_ADDRS &&
+            ((t == 0 && type == DNS_TYPE_A && rdlen == 4) || (t == 1 && type == DNS_TYPE_AAAA && rdlen == 16)))
+        {
+            cwh_dns_addr_t *addr = &lookup->addrs[lookup->count++];
+            memset(addr, 0, sizeof(*addr));
+            addr->family = t == 0 ? CWH_DNS_IPV4 : CWH_DNS_IPV6;
+            memcpy(addr->addr, p + off, rdlen);
+        }
+        off += rdlen;
+    }
+    return 0;
+}
+
+static void lookup_event(cwh_loop_t *loop, int fd, int events, void *data)
+{
+    (void)loop;
+    cwh_dns_lookup_t *lookup = (cwh_dns_lookup_t *)data;
+    bool server_failed = (events & CWH_EVENT_ERROR) != 0;
+
+    uint8_t packet[CWH_DNS_UDP_SIZE * 2];
+    for (;;)
+    {
+        int n = (int)recv(fd, (char *)packet, sizeof(packet), 0);
+        if (n < 0)
+        {
+#ifdef _WIN32
+            if (WSAGetLastError() != WSAEWOULDBLOCK)
+#else
+            if (errno != EAGAIN && errno != EWOULDBLOCK)
+#endif
+                server_failed = true; // e.g. ICMP port unreachable
+            break;
+        }
+        if (lookup_parse(lookup, packet, (size_t)n, false))
+            server_failed = true;
+    }
+
+    lookup_progress(lookup, server_failed);
+}
+
+static bool would_block(void)
+{
+#ifdef _WIN32
+    return WSAGetLastError() == WSAEWOULDBLOCK;
+#else
+    return errno == EAGAIN || errno == EWOULDBLOCK;
+#endif
+}
+
+// TCP connection: write the queries once connected, then read the answers
+static void lookup_tcp_event(cwh_loop_t *loop, int fd, int events, void *data)
+{
+    cwh_dns_lookup_t *lookup = (cwh_dns_lookup_t *)data;
+    bool server_failed = (events & CWH_EVENT_ERROR) != 0;
+
+    if (!server_failed && lookup->tcp_out_sent < lookup->tcp_out_len)
+    {
+        // Connect errors (e.g. refused) show up here
+        int n = (int)send(fd, (const char *)lookup->tcp_out + lookup->tcp_out_sent,
+                          (int)(lookup->tcp_out_len - lookup->tcp_out_sent), 0);
+        if (n < 0 && !would_block())
+            server_failed = true;
+        else if (n > 0)
+            lookup->tcp_out_sent += (size_t)n;
+        if (lookup->tcp_out_sent == lookup->tcp_out_len)
+            cwh_loop_mod(loop, fd, CWH_EVENT_READ);
+    }
+    else if (!server_failed)
+    {
+        for (;;)
+        {
+            int n = (int)recv(fd, (char *)lookup->tcp_in + lookup->tcp_in_len,
+                              (int)(lookup->tcp_in_cap - lookup->tcp_in_len), 0);
+            if (n <= 0)
+            {
+                if (n == 0 || !would_block())
+                    server_failed = true; // Closed or reset before answering
+                break;
+            }
+            lookup->tcp_in_len += (size_t)n;
+
+            // Each message is prefixed with its length
+            while (lookup->tcp_in_len >= 2)
+            {
+                size_t msg_len = get16(lookup->tcp_in);
+                if (lookup->tcp_in_len < 2 + msg_len)
+                    break;
+                if (lookup_parse(lookup, lookup->tcp_in + 2, msg_len, true))
+                    server_failed = true;
+                lookup->tcp_in_len -= 2 + msg_len;
+                memmove(lookup->tcp_in, lookup->tcp_in + 2 + msg_len, lookup->tcp_in_len);
+            }
+        }
+    }
+
+    lookup_progress(lookup, server_failed);
+}
+
+// Static answer for literals, "localhost" and hosts entries; returns count
+static int static_answer(cwh_resolver_t *res, const char *host, const char *name,
+                         cwh_dns_family_t family, cwh_dns_addr_t *addrs)
+{
+    int count = 0;
+    if (parse_literal(host, &addrs[0]))
+        return family_wanted(family, addrs[0].family) ? 1 : 0;
+
+    for (cwh_dns_host_t *h = res->hosts; h && count < CWH_DNS_MAX_ADDRS; h = h->next)
+    {
+        if (strcmp(h->name, name) == 0 && family_wanted(family, h->addr.family))
+            addrs[count++] = h->addr;
+    }
+
+    // RFC 6761: localhost never leaves the machine
+    if (count == 0 && strcmp(name, "localhost") == 0)
+    {
+        if (family_wanted(family, CWH_DNS_IPV4))
+            parse_literal("127.0.0.1", &addrs[count++]);
+        if (family_wanted(family, CWH_DNS_IPV6))
+            parse_literal("::1", &addrs[count++]);
+    }
+    sort_addrs(addrs, count);
+    return count;
+}
+
+// Start a lookup for a normalized name (not yet joined by anyone)
+static cwh_dns_lookup_t *lookup_start(cwh_resolver_t *res, const char *name, cwh_dns_family_t family)
+{
+    cwh_dns_lookup_t *lookup = (cwh_dns_lookup_t *)calloc(1, sizeof(cwh_dns_lookup_t));
+    if (!lookup)
+        return NULL;
+    lookup->resolver = res;
+    lookup->fd = -1;
+    lookup->family = family;
+    memcpy(lookup->name, name, strlen(name) + 1);
+    while (search_name(res, name, lookup->candidate, lookup->qname) == 0)
+        lookup->candidate++; // The name as given always fits
+    lookup->pending[0] = family_wanted(family, CWH_DNS_IPV4);
+    lookup->pending[1] = family_wanted(family, CWH_DNS_IPV6);
+    lookup->id[0] = next_id(res);
+    lookup->id[1] = (uint16_t)(lookup->id[0] + 1);
+    lookup->ttl = UINT32_MAX;
+    lookup->timer = cwh_loop_timer_add(res->loop, (uint64_t)res->timeout_ms, lookup_timeout, lookup);
+
+    if (!lookup->timer || lookup_send(lookup) < 0)
+    {
+        lookup_close_socket(lookup);
+        cwh_loop_timer_cancel(res->loop, lookup->timer);
+        free(lookup->tcp_out);
+        free(lookup->tcp_in);
+        free(lookup);
+        return NULL;
+    }
+    lookup->next = res->lookups;
+    res->lookups = lookup;
+    return lookup;
+}
+
+static cwh_dns_lookup_t *lookup_find(cwh_resolver_t *res, const char *name, cwh_dns_family_t family)
+{
+    cwh_dns_lookup_t *lookup = res->lookups;
+    while (lookup && (lookup->family != family || strcmp(lookup->name, name) != 0))
+        lookup = lookup->next;
+    return lookup;
+}
+
+cwh_dns_query_t *cwh_resolve(cwh_resolver_t *res, const char *host, cwh_dns_family_t family,
+                             cwh_dns_cb cb, void *data)
+{
+    if (!cb)
+        return NULL;
+
+    char name[CWH_DNS_MAX_NAME + 1];
+    if (!res || !host || !normalize_name(host, name))
+    {
+        cb(CWH_ERR_PARSE, NULL, 0, data);
+        return NULL;
+    }
+
+    // Lookups are keyed by the name as asked: "host." is absolute (no search
+    // domains), so it is kept apart from "host"
+    char key[CWH_DNS_MAX_NAME + 2];
+    snprintf(key, sizeof(key), "%s%s", name, host[strlen(host) - 1] == '.' ? "." : "");
+
+    cwh_dns_addr_t addrs[CWH_DNS_MAX_ADDRS];
+    int count = static_answer(res, host, name, family, addrs);
+    if (count > 0)
+    {
+        cb(CWH_OK, addrs, count, data);
+        return NULL;
+    }
+    if (parse_literal(host, &addrs[0]))
+    {
+        cb(CWH_ERR_NET, NULL, 0, data); // Literal of the other family
+        return NULL;
+    }
+
+    // Cached answer (possibly stale: then refresh it in the background)
+    bool refresh = true;
+    count = cwh_dns_cache_lookup(key, family, addrs, CWH_DNS_MAX_ADDRS, &refresh);
+    if (count >= 0)
+    {
+        if (refresh && !lookup_find(res, key, family))
+            lookup_start(res, key, family); // Nobody waits: it only updates the cache
+        cb(count > 0 ? CWH_OK : CWH_ERR_NET, count > 0 ? addrs : NULL, count, data);
+        return NULL;
+    }
+
+    cwh_dns_query_t *query = (cwh_dns_query_t *)calloc(1, sizeof(cwh_dns_query_t));
+    if (!query)
+    {
+        cb(CWH_ERR_ALLOC, NULL, 0, data);
+        return NULL;
+    }
+    query->cb = cb;
+    query->data = data;
+
+    // Join a lookup already in flight for the same name
+    cwh_dns_lookup_t *lookup = lookup_find(res, key, family);
+    if (!lookup)
+        lookup = lookup_start(res, key, family);
+    if (!lookup)
+    {
+        free(query);
+        cb(CWH_ERR_NET, NULL, 0, data);
+        return NULL;
+    }
+
+    query->lookup = lookup;
+    query->next = lookup->waiters;
+    lookup->waiters = query;
+    return query;
+}
+
+void cwh_resolve_cancel(cwh_dns_query_t *query)
+{
+    if (!query)
+        return;
+
+    cwh_dns_lookup_t *lookup = query->lookup;
+    if (lookup->finishing)
+    {
+        query->cb = NULL; // Freed by lookup_finish
+        return;
+    }
+
+    cwh_dns_query_t **p = &lookup->waiters;
+    while (*p && *p != query)
+        p = &(*p)->next;
+    if (*p)
+        *p = query->next;
+    free(query);
+
+    // Nobody left waiting: drop the lookup
+    if (!lookup->waiters)
+        lookup_finish(lookup, CWH_ERR_NET);
+}
+
+void cwh_resolver_free(cwh_resolver_t *res)
+{
+    if (!res)
+        return;
+
+    while (res->lookups)
+        lookup_finish(res->lookups, CWH_ERR_NET);
+    free_hosts(res);
+    free(res);
+}
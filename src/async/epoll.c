@@ -10,14 +10,15 @@
 #include <unistd.h>
 #include <sys/epoll.h>
 
-// Event handler entry
+// Initial size of the fd-indexed handler table (grows by doubling)
+#define CWH_EPOLL_INITIAL_SLOTS 256
+
+// Event handler entry (slot in the fd-indexed table; callback == NULL means free)
 typedef struct cwh_event_entry
 {
-    int fd;
     int events;
     cwh_event_cb callback;
     void *data;
-    struct cwh_event_entry *next;
 } cwh_event_entry_t;
 
 // epoll-based event loop
@@ -26,7 +27,9 @@ typedef struct cwh_epoll
     int epoll_fd;
     struct epoll_event *events;
     int max_events;
-    cwh_event_entry_t *handlers; // Linked list of event handlers
+    cwh_event_entry_t *handlers; // Handler table indexed by fd: O(1) add/mod/del/dispatch
+    int num_handlers;            // Allocated slots in handlers[]
+    uint64_t syscalls;           // epoll_ctl/epoll_wait calls made
     int running;
     void *loop_ptr; // Pointer back to cwh_loop_t for callbacks
 } cwh_epoll_t;
@@ -53,8 +56,17 @@ cwh_epoll_t *cwh_epoll_create(int max_events)
         return NULL;
     }
 
+    ep->handlers = (cwh_event_entry_t *)calloc(CWH_EPOLL_INITIAL_SLOTS, sizeof(cwh_event_entry_t));
+    if (!ep->handlers)
+    {
+        free(ep->events);
+        close(ep->epoll_fd);
+        free(ep);
+        return NULL;
+    }
+
     ep->max_events = max_events;
-    ep->handlers = NULL;
+    ep->num_handlers = CWH_EPOLL_INITIAL_SLOTS;
     ep->running = 0;
     ep->loop_ptr = NULL; // Will be set by loop.c
 
@@ -64,14 +76,29 @@ cwh_epoll_t *cwh_epoll_create(int max_events)
 // Find event handler by fd
 static cwh_event_entry_t *find_handler(cwh_epoll_t *ep, int fd)
 {
-    cwh_event_entry_t *curr = ep->handlers;
-    while (curr)
-    {
-        if (curr->fd == fd)
-            return curr;
-        curr = curr->next;
-    }
-    return NULL;
+    if (fd >= ep->num_handlers || !ep->handlers[fd].callback)
+        return NULL;
+    return &ep->handlers[fd];
+}
+
+// Grow handler table so that fd is a valid index
+static int ensure_slot(cwh_epoll_t *ep, int fd)
+{
+    if (fd < ep->num_handlers)
+        return 0;
+
+    int new_size = ep->num_handlers;
+    while (new_size <= fd)
+        new_size *= 2;
+
+    cwh_event_entry_t *slots = (cwh_event_entry_t *)realloc(ep->handlers, new_size * sizeof(cwh_event_entry_t));
+    if (!slots)
+        return -1;
+
+    memset(slots + ep->num_handlers, 0, (new_size - ep->num_handlers) * sizeof(cwh_event_entry_t));
+    ep->handlers = slots;
+    ep->num_handlers = new_size;
+    return 0;
 }
 
 // Convert cwebhttp events to epoll events
@@ -84,6 +111,12 @@ static uint32_t cwh_to_epoll_events(int events)
         ep_events |= EPOLLOUT;
     if (events & CWH_EVENT_ERROR)
         ep_events |= EPOLLERR;
+    if (events & CWH_EVENT_EDGE)
+        ep_events |= EPOLLET | EPOLLRDHUP; // Peer shutdown shows up as a read edge
+#ifdef EPOLLEXCLUSIVE
+    if (events & CWH_EVENT_EXCLUSIVE)
+        ep_events |= EPOLLEXCLUSIVE;
+#endif
     return ep_events;
 }
 
@@ -93,6 +126,8 @@ static int epoll_to_cwh_events(uint32_t ep_events)
     int events = 0;
     if (ep_events & EPOLLIN)
         events |= CWH_EVENT_READ;
+    if (ep_events & EPOLLRDHUP)
+        events |= CWH_EVENT_READ | CWH_EVENT_RDHUP;
     if (ep_events & EPOLLOUT)
         events |= CWH_EVENT_WRITE;
     if (ep_events & (EPOLLERR | EPOLLHUP))
@@ -110,31 +145,26 @@ int cwh_epoll_add(cwh_epoll_t *ep, int fd, int events, cwh_event_cb cb, void *da
     if (find_handler(ep, fd))
         return -1;
 
-    // Create handler entry
-    cwh_event_entry_t *entry = (cwh_event_entry_t *)calloc(1, sizeof(cwh_event_entry_t));
-    if (!entry)
+    if (ensure_slot(ep, fd) < 0)
         return -1;
 
-    entry->fd = fd;
-    entry->events = events;
-    entry->callback = cb;
-    entry->data = data;
-
     // Add to epoll
     struct epoll_event ev;
     memset(&ev, 0, sizeof(ev));
     ev.events = cwh_to_epoll_events(events);
     ev.data.fd = fd;
 
+    ep->syscalls++;
     if (epoll_ctl(ep->epoll_fd, EPOLL_CTL_ADD, fd, &ev) < 0)
     {
-        free(entry);
         return -1;
     }
 
-    // Add to handler list
-    entry->next = ep->handlers;
-    ep->handlers = entry;
+    // Fill handler slot
+    cwh_event_entry_t *entry = &ep->handlers[fd];
+    entry->events = events;
+    entry->callback = cb;
+    entry->data = data;
 
     return 0;
 }
@@ -150,15 +180,16 @@ int cwh_epoll_mod(cwh_epoll_t *ep, int fd, int events)
     if (!entry)
         return -1;
 
-    // Update events
+    // Update events (EPOLLEXCLUSIVE can only be set on add)
     entry->events = events;
 
-    // Modify in epoll
+    // Modify in epoll; with EPOLLET this also re-reports readiness that is still there
     struct epoll_event ev;
     memset(&ev, 0, sizeof(ev));
-    ev.events = cwh_to_epoll_events(events);
+    ev.events = cwh_to_epoll_events(events & ~CWH_EVENT_EXCLUSIVE);
     ev.data.fd = fd;
 
+    ep->syscalls++;
     if (epoll_ctl(ep->epoll_fd, EPOLL_CTL_MOD, fd, &ev) < 0)
     {
         return -1;
@@ -174,34 +205,19 @@ int cwh_epoll_del(cwh_epoll_t *ep, int fd)
         return -1;
 
     // Remove from epoll
+    ep->syscalls++;
     if (epoll_ctl(ep->epoll_fd, EPOLL_CTL_DEL, fd, NULL) < 0)
     {
         return -1;
     }
 
-    // Remove from handler list
-    cwh_event_entry_t *prev = NULL;
-    cwh_event_entry_t *curr = ep->handlers;
-    while (curr)
-    {
-        if (curr->fd == fd)
-        {
-            if (prev)
-            {
-                prev->next = curr->next;
-            }
-            else
-            {
-                ep->handlers = curr->next;
-            }
-            free(curr);
-            return 0;
-        }
-        prev = curr;
-        curr = curr->next;
-    }
+    // Clear handler slot
+    cwh_event_entry_t *entry = find_handler(ep, fd);
+    if (!entry)
+        return -1;
 
-    return -1;
+    memset(entry, 0, sizeof(*entry));
+    return 0;
 }
 
 // Wait for events and dispatch callbacks
@@ -210,6 +226,7 @@ int cwh_epoll_wait(cwh_epoll_t *ep, int timeout_ms)
     if (!ep)
         return -1;
 
+    ep->syscalls++;
     int nfds = epoll_wait(ep->epoll_fd, ep->events, ep->max_events, timeout_ms);
     if (nfds < 0)
     {
@@ -218,12 +235,13 @@ int cwh_epoll_wait(cwh_epoll_t *ep, int timeout_ms)
         return -1;
     }
 
-    // Dispatch callbacks
+    // Dispatch callbacks. Slots are looked up per event because a callback may
+    // remove other fds (slot cleared -> skipped) or add new ones (table may move).
     for (int i = 0; i < nfds; i++)
     {
         int fd = ep->events[i].data.fd;
         cwh_event_entry_t *entry = find_handler(ep, fd);
-        if (entry && entry->callback)
+        if (entry)
         {
             int events = epoll_to_cwh_events(ep->events[i].events);
             entry->callback((cwh_loop_t *)ep->loop_ptr, fd, events, entry->data);
@@ -265,14 +283,8 @@ void cwh_epoll_free(cwh_epoll_t *ep)
     if (!ep)
         return;
 
-    // Free handler list
-    cwh_event_entry_t *curr = ep->handlers;
-    while (curr)
-    {
-        cwh_event_entry_t *next = curr->next;
-        free(curr);
-        curr = next;
-    }
+    // Free handler table
+    free(ep->handlers);
 
     // Close epoll fd
     if (ep->epoll_fd >= 0)
@@ -294,6 +306,22 @@ void cwh_epoll_set_loop(cwh_epoll_t *ep, void *loop)
     }
 }
 
+// Number of epoll_ctl/epoll_wait calls made
+uint64_t cwh_epoll_syscalls(cwh_epoll_t *ep)
+{
+    return ep ? ep->syscalls : 0;
+}
+
+// Registration flags this backend honours
+int cwh_epoll_flags(void)
+{
+#ifdef EPOLLEXCLUSIVE
+    return CWH_EVENT_EDGE | CWH_EVENT_EXCLUSIVE;
+#else
+    return CWH_EVENT_EDGE;
+#endif
+}
+
 // Get backend name
 const char *cwh_epoll_backend(void)
 {
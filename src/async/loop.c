@@ -1,9 +1,10 @@
 // loop.c - Cross-platform event loop abstraction
-// Unified API for epoll/kqueue/IOCP/select backends
+// Unified API for epoll/io_uring/kqueue/IOCP/select backends
 
 #include "../../include/cwebhttp_async.h"
 #include <stdlib.h>
 #include <string.h>
+#include <errno.h>
 
 // Platform detection
 #if defined(FORCE_SELECT)
@@ -42,7 +43,25 @@ int cwh_epoll_wait(cwh_epoll_t *ep, int timeout_ms);
 int cwh_epoll_run(cwh_epoll_t *ep);
 void cwh_epoll_stop(cwh_epoll_t *ep);
 void cwh_epoll_free(cwh_epoll_t *ep);
+uint64_t cwh_epoll_syscalls(cwh_epoll_t *ep);
+int cwh_epoll_flags(void);
 const char *cwh_epoll_backend(void);
+typedef struct cwh_uring cwh_uring_t;
+cwh_uring_t *cwh_uring_create(unsigned entries);
+void cwh_uring_set_loop(cwh_uring_t *ur, void *loop);
+int cwh_uring_add(cwh_uring_t *ur, int fd, int events, cwh_event_cb cb, void *data);
+int cwh_uring_mod(cwh_uring_t *ur, int fd, int events);
+int cwh_uring_del(cwh_uring_t *ur, int fd);
+int cwh_uring_wait(cwh_uring_t *ur, int timeout_ms);
+int cwh_uring_run(cwh_uring_t *ur);
+void cwh_uring_stop(cwh_uring_t *ur);
+void cwh_uring_free(cwh_uring_t *ur);
+uint64_t cwh_uring_syscalls(cwh_uring_t *ur);
+int cwh_uring_flags(cwh_uring_t *ur);
+int cwh_uring_recv(cwh_uring_t *ur, int fd, void *buf, size_t len);
+int cwh_uring_send(cwh_uring_t *ur, int fd, const void *buf, size_t len);
+int cwh_uring_sendfile(cwh_uring_t *ur, int fd, int file_fd, uint64_t offset, size_t count);
+const char *cwh_uring_backend(void);
 #elif defined(USE_KQUEUE)
 typedef struct cwh_kqueue cwh_kqueue_t;
 cwh_kqueue_t *cwh_kqueue_create(int max_events);
@@ -95,12 +114,24 @@ void cwh_select_free(cwh_select_t *sel);
 const char *cwh_select_backend(void);
 #endif
 
+// Timing wheel (timer.c)
+typedef struct cwh_timer_wheel cwh_timer_wheel_t;
+cwh_timer_wheel_t *cwh_timer_wheel_new(void);
+void cwh_timer_wheel_free(cwh_timer_wheel_t *wheel);
+cwh_timer_t *cwh_timer_wheel_add(cwh_timer_wheel_t *wheel, uint64_t timeout_ms, cwh_timer_cb cb, void *data);
+int cwh_timer_wheel_reset(cwh_timer_wheel_t *wheel, cwh_timer_t *timer, uint64_t timeout_ms);
+void cwh_timer_wheel_cancel(cwh_timer_wheel_t *wheel, cwh_timer_t *timer);
+int cwh_timer_wheel_next_timeout(cwh_timer_wheel_t *wheel);
+int cwh_timer_wheel_expire(cwh_timer_wheel_t *wheel, cwh_loop_t *loop);
+
 // Event loop structure (opaque to users)
 struct cwh_loop
 {
-    void *backend;    // Platform-specific backend
-    int backend_type; // Backend type identifier
-    int running;      // Loop running flag
+    void *backend;             // Platform-specific backend
+    int backend_type;          // Backend type identifier
+    int running;               // Loop running flag
+    cwh_timer_wheel_t *timers; // Timers driven by this loop
+    cwh_resolver_t *resolver;  // Default resolver (cwh_loop_resolver), NULL until used
 };
 
 // Backend type constants
@@ -109,20 +140,41 @@ struct cwh_loop
 #define BACKEND_WSAPOLL 3
 #define BACKEND_IOCP 4
 #define BACKEND_SELECT 5
+#define BACKEND_URING 6
 
 // Create new event loop
 cwh_loop_t *cwh_loop_new(void)
+{
+    return cwh_loop_new_backend(CWH_BACKEND_DEFAULT);
+}
+
+// Create new event loop on a specific backend
+cwh_loop_t *cwh_loop_new_backend(cwh_backend_type_t backend)
 {
     cwh_loop_t *loop = (cwh_loop_t *)calloc(1, sizeof(cwh_loop_t));
     if (!loop)
         return NULL;
 
 #ifdef USE_EPOLL
-    loop->backend = cwh_epoll_create(1024); // Default: 1024 max events
-    loop->backend_type = BACKEND_EPOLL;
-    if (loop->backend)
+    if (backend == CWH_BACKEND_IO_URING)
     {
-        cwh_epoll_set_loop((cwh_epoll_t *)loop->backend, loop);
+        // 256 SQEs: enough for a loop iteration's arms/removals between waits
+        loop->backend = cwh_uring_create(256);
+        loop->backend_type = BACKEND_URING;
+        if (loop->backend)
+        {
+            cwh_uring_set_loop((cwh_uring_t *)loop->backend, loop);
+        }
+    }
+    if (!loop->backend)
+    {
+        // Default, or io_uring unavailable (old kernel, seccomp, sysctl)
+        loop->backend = cwh_epoll_create(1024); // Default: 1024 max events
+        loop->backend_type = BACKEND_EPOLL;
+        if (loop->backend)
+        {
+            cwh_epoll_set_loop((cwh_epoll_t *)loop->backend, loop);
+        }
     }
 #elif defined(USE_KQUEUE)
     loop->backend = cwh_kqueue_create(1024); // Default: 1024 max events
@@ -154,10 +206,14 @@ cwh_loop_t *cwh_loop_new(void)
         cwh_select_set_loop((cwh_select_t *)loop->backend, loop);
     }
 #endif
+    (void)backend; // Only Linux has a choice
 
-    if (!loop->backend)
+    loop->timers = cwh_timer_wheel_new();
+
+    if (!loop->backend || !loop->timers)
     {
-        free(loop);
+        loop->running = 0;
+        cwh_loop_free(loop);
         return NULL;
     }
 
@@ -171,67 +227,71 @@ int cwh_loop_run(cwh_loop_t *loop)
     if (!loop || !loop->backend)
         return -1;
 
+    // Driven through cwh_loop_run_once() so timers get their wakeups
     loop->running = 1;
+    while (loop->running)
+    {
+        if (cwh_loop_run_once(loop, -1) < 0)
+            return -1;
+    }
 
+    return 0;
+}
+
+// Wait for I/O on the backend
+static int backend_wait(cwh_loop_t *loop, int timeout_ms)
+{
 #ifdef USE_EPOLL
     if (loop->backend_type == BACKEND_EPOLL)
     {
-        return cwh_epoll_run((cwh_epoll_t *)loop->backend);
+        return cwh_epoll_wait((cwh_epoll_t *)loop->backend, timeout_ms);
+    }
+    if (loop->backend_type == BACKEND_URING)
+    {
+        return cwh_uring_wait((cwh_uring_t *)loop->backend, timeout_ms);
     }
 #elif defined(USE_KQUEUE)
     if (loop->backend_type == BACKEND_KQUEUE)
     {
-        return cwh_kqueue_run((cwh_kqueue_t *)loop->backend);
+        return cwh_kqueue_wait((cwh_kqueue_t *)loop->backend, timeout_ms);
     }
 #elif defined(USE_WSAPOLL)
     if (loop->backend_type == BACKEND_WSAPOLL)
     {
-        return cwh_wsapoll_run((cwh_wsapoll_t *)loop->backend);
+        return cwh_wsapoll_wait((cwh_wsapoll_t *)loop->backend, timeout_ms);
     }
 #elif defined(USE_IOCP)
     if (loop->backend_type == BACKEND_IOCP)
     {
-        return cwh_iocp_run((cwh_iocp_t *)loop->backend);
+        return cwh_iocp_wait((cwh_iocp_t *)loop->backend, timeout_ms);
     }
 #elif defined(USE_SELECT)
     if (loop->backend_type == BACKEND_SELECT)
     {
-        return cwh_select_run((cwh_select_t *)loop->backend);
+        return cwh_select_wait((cwh_select_t *)loop->backend, timeout_ms);
     }
 #endif
 
+    (void)timeout_ms;
     return -1;
 }
 
 // Run one iteration of event loop (non-blocking)
+// Waits at most until the next timer is due, then fires expired timers
 int cwh_loop_run_once(cwh_loop_t *loop, int timeout_ms)
 {
     if (!loop || !loop->backend)
         return -1;
 
-#ifdef USE_EPOLL
-    if (loop->backend_type == BACKEND_EPOLL)
-    {
-        return cwh_epoll_wait((cwh_epoll_t *)loop->backend, timeout_ms);
-    }
-#elif defined(USE_KQUEUE)
-    if (loop->backend_type == BACKEND_KQUEUE)
-    {
-        return cwh_kqueue_wait((cwh_kqueue_t *)loop->backend, timeout_ms);
-    }
-#elif defined(USE_IOCP)
-    if (loop->backend_type == BACKEND_IOCP)
-    {
-        return cwh_iocp_wait((cwh_iocp_t *)loop->backend, timeout_ms);
-    }
-#elif defined(USE_SELECT)
-    if (loop->backend_type == BACKEND_SELECT)
-    {
-        return cwh_select_wait((cwh_select_t *)loop->backend, timeout_ms);
-    }
-#endif
+    int timer_timeout = cwh_timer_wheel_next_timeout(loop->timers);
+    if (timer_timeout >= 0 && (timeout_ms < 0 || timer_timeout < timeout_ms))
+        timeout_ms = timer_timeout;
 
-    return -1;
+    int events = backend_wait(loop, timeout_ms);
+    if (events < 0)
+        return -1;
+
+    return events + cwh_timer_wheel_expire(loop->timers, loop);
 }
 
 // Stop event loop
@@ -247,6 +307,10 @@ void cwh_loop_stop(cwh_loop_t *loop)
     {
         cwh_epoll_stop((cwh_epoll_t *)loop->backend);
     }
+    if (loop->backend_type == BACKEND_URING)
+    {
+        cwh_uring_stop((cwh_uring_t *)loop->backend);
+    }
 #elif defined(USE_KQUEUE)
     if (loop->backend_type == BACKEND_KQUEUE)
     {
@@ -271,11 +335,19 @@ void cwh_loop_free(cwh_loop_t *loop)
     if (!loop)
         return;
 
+    // Resolver sockets and timers belong to this loop
+    cwh_resolver_free(loop->resolver);
+    loop->resolver = NULL;
+
 #ifdef USE_EPOLL
     if (loop->backend_type == BACKEND_EPOLL && loop->backend)
     {
         cwh_epoll_free((cwh_epoll_t *)loop->backend);
     }
+    if (loop->backend_type == BACKEND_URING && loop->backend)
+    {
+        cwh_uring_free((cwh_uring_t *)loop->backend);
+    }
 #elif defined(USE_KQUEUE)
     if (loop->backend_type == BACKEND_KQUEUE && loop->backend)
     {
@@ -293,9 +365,20 @@ void cwh_loop_free(cwh_loop_t *loop)
     }
 #endif
 
+    cwh_timer_wheel_free(loop->timers);
     free(loop);
 }
 
+// Default resolver of this loop
+cwh_resolver_t *cwh_loop_resolver(cwh_loop_t *loop)
+{
+    if (!loop)
+        return NULL;
+    if (!loop->resolver)
+        loop->resolver = cwh_resolver_new(loop);
+    return loop->resolver;
+}
+
 // Register file descriptor for events
 int cwh_loop_add(cwh_loop_t *loop, int fd, int events, cwh_event_cb cb, void *data)
 {
@@ -307,6 +390,10 @@ int cwh_loop_add(cwh_loop_t *loop, int fd, int events, cwh_event_cb cb, void *da
     {
         return cwh_epoll_add((cwh_epoll_t *)loop->backend, fd, events, cb, data);
     }
+    if (loop->backend_type == BACKEND_URING)
+    {
+        return cwh_uring_add((cwh_uring_t *)loop->backend, fd, events, cb, data);
+    }
 #elif defined(USE_KQUEUE)
     if (loop->backend_type == BACKEND_KQUEUE)
     {
@@ -343,6 +430,10 @@ int cwh_loop_mod(cwh_loop_t *loop, int fd, int events)
     {
         return cwh_epoll_mod((cwh_epoll_t *)loop->backend, fd, events);
     }
+    if (loop->backend_type == BACKEND_URING)
+    {
+        return cwh_uring_mod((cwh_uring_t *)loop->backend, fd, events);
+    }
 #elif defined(USE_KQUEUE)
     if (loop->backend_type == BACKEND_KQUEUE)
     {
@@ -374,6 +465,10 @@ int cwh_loop_del(cwh_loop_t *loop, int fd)
     {
         return cwh_epoll_del((cwh_epoll_t *)loop->backend, fd);
     }
+    if (loop->backend_type == BACKEND_URING)
+    {
+        return cwh_uring_del((cwh_uring_t *)loop->backend, fd);
+    }
 #elif defined(USE_KQUEUE)
     if (loop->backend_type == BACKEND_KQUEUE)
     {
@@ -394,6 +489,37 @@ int cwh_loop_del(cwh_loop_t *loop, int fd)
     return -1;
 }
 
+// ============================================================================
+// Timers
+// ============================================================================
+
+// Start one-shot timer
+cwh_timer_t *cwh_loop_timer_add(cwh_loop_t *loop, uint64_t timeout_ms, cwh_timer_cb cb, void *data)
+{
+    if (!loop || !cb)
+        return NULL;
+
+    return cwh_timer_wheel_add(loop->timers, timeout_ms, cb, data);
+}
+
+// Re-arm timer
+int cwh_loop_timer_reset(cwh_loop_t *loop, cwh_timer_t *timer, uint64_t timeout_ms)
+{
+    if (!loop || !timer)
+        return -1;
+
+    return cwh_timer_wheel_reset(loop->timers, timer, timeout_ms);
+}
+
+// Cancel and free timer
+void cwh_loop_timer_cancel(cwh_loop_t *loop, cwh_timer_t *timer)
+{
+    if (!loop || !timer)
+        return;
+
+    cwh_timer_wheel_cancel(loop->timers, timer);
+}
+
 // Get backend name (for debugging)
 const char *cwh_loop_backend(cwh_loop_t *loop)
 {
@@ -405,6 +531,10 @@ const char *cwh_loop_backend(cwh_loop_t *loop)
     {
         return cwh_epoll_backend();
     }
+    if (loop->backend_type == BACKEND_URING)
+    {
+        return cwh_uring_backend();
+    }
 #elif defined(USE_KQUEUE)
     if (loop->backend_type == BACKEND_KQUEUE)
     {
@@ -430,6 +560,107 @@ const char *cwh_loop_backend(cwh_loop_t *loop)
     return "unknown";
 }
 
+// Registration flags the backend honours
+int cwh_loop_flags(cwh_loop_t *loop)
+{
+    if (!loop || !loop->backend)
+        return 0;
+
+#ifdef USE_EPOLL
+    if (loop->backend_type == BACKEND_EPOLL)
+    {
+        return cwh_epoll_flags();
+    }
+    if (loop->backend_type == BACKEND_URING)
+    {
+        return cwh_uring_flags((cwh_uring_t *)loop->backend);
+    }
+#endif
+
+    // Level-triggered only (flags are ignored)
+    return 0;
+}
+
+// Receive on a socket registered with CWH_EVENT_COMPLETION
+int cwh_loop_recv(cwh_loop_t *loop, int fd, void *buf, size_t len)
+{
+#ifdef USE_EPOLL
+    if (loop && loop->backend && loop->backend_type == BACKEND_URING)
+    {
+        return cwh_uring_recv((cwh_uring_t *)loop->backend, fd, buf, len);
+    }
+#else
+    (void)loop;
+    (void)fd;
+    (void)buf;
+    (void)len;
+#endif
+
+    // No other backend does socket I/O
+    errno = EINVAL;
+    return -1;
+}
+
+// Send on a socket registered with CWH_EVENT_COMPLETION
+int cwh_loop_send(cwh_loop_t *loop, int fd, const void *buf, size_t len)
+{
+#ifdef USE_EPOLL
+    if (loop && loop->backend && loop->backend_type == BACKEND_URING)
+    {
+        return cwh_uring_send((cwh_uring_t *)loop->backend, fd, buf, len);
+    }
+#else
+    (void)loop;
+    (void)fd;
+    (void)buf;
+    (void)len;
+#endif
+
+    errno = EINVAL;
+    return -1;
+}
+
+// sendfile on a socket registered with CWH_EVENT_COMPLETION
+int cwh_loop_sendfile(cwh_loop_t *loop, int fd, int file_fd, uint64_t offset, size_t count)
+{
+#ifdef USE_EPOLL
+    if (loop && loop->backend && loop->backend_type == BACKEND_URING)
+    {
+        return cwh_uring_sendfile((cwh_uring_t *)loop->backend, fd, file_fd, offset, count);
+    }
+#else
+    (void)loop;
+    (void)fd;
+    (void)file_fd;
+    (void)offset;
+    (void)count;
+#endif
+
+    errno = EINVAL;
+    return -1;
+}
+
+// Number of kernel calls the backend has made
+uint64_t cwh_loop_syscalls(cwh_loop_t *loop)
+{
+    if (!loop || !loop->backend)
+        return 0;
+
+#ifdef USE_EPOLL
+    if (loop->backend_type == BACKEND_EPOLL)
+    {
+        return cwh_epoll_syscalls((cwh_epoll_t *)loop->backend);
+    }
+    if (loop->backend_type == BACKEND_URING)
+    {
+        return cwh_uring_syscalls((cwh_uring_t *)loop->backend);
+    }
+#endif
+
+    // Other backends don't count them
+    return 0;
+}
+
 // Get accepted socket from listen socket (IOCP AcceptEx integration)
 // Returns accepted socket fd, or -1 if none available or not using IOCP
 // This function is used by the async server to retrieve sockets accepted by AcceptEx
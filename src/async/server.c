@@ -12,11 +12,13 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include <time.h>
 
 #ifdef _WIN32
 #include <winsock2.h>
 #include <ws2tcpip.h>
+#include <windows.h>
+#include <process.h>
+#include <io.h>
 #else
 #include <unistd.h>
 #include <sys/socket.h>
@@ -25,6 +27,27 @@
 #include <fcntl.h>
 #include <errno.h>
 #include <strings.h>
+#include <pthread.h>
+#include <poll.h>
+#ifdef __linux__
+#include <sched.h>
+#include <sys/sendfile.h>
+#endif
+#endif
+
+// Worker threads for multi-threaded (shard-per-core) mode
+#ifdef _WIN32
+typedef HANDLE cwh_thread_t;
+#else
+typedef pthread_t cwh_thread_t;
+#endif
+
+// TLS handshake workers (cwh_async_server_set_tls_workers): POSIX threads,
+// results come back to each loop through a pipe
+#if CWEBHTTP_ENABLE_TLS && !defined(_WIN32)
+#define CWH_TLS_OFFLOAD 1
+#else
+#define CWH_TLS_OFFLOAD 0
 #endif
 
 // ============================================================================
@@ -36,6 +59,7 @@ typedef struct cwh_async_route
     cwh_method_t method;          // HTTP method (GET, POST, etc.)
     const char *path;             // Route path pattern
     cwh_async_handler_t handler;  // Route handler function
+    cwh_async_body_cb on_body;    // Streamed request body (NULL: body buffered)
     void *user_data;              // User data for handler
     struct cwh_async_route *next; // Linked list
 } cwh_async_route_t;
@@ -47,6 +71,7 @@ typedef struct cwh_async_route
 typedef enum
 {
     CONN_STATE_NEW,
+    CONN_STATE_HANDSHAKING, // TLS handshake step running on a worker
     CONN_STATE_READING_REQUEST,
     CONN_STATE_PROCESSING,
     CONN_STATE_WRITING_RESPONSE,
@@ -54,6 +79,77 @@ typedef enum
     CONN_STATE_CLOSED
 } cwh_conn_state_t;
 
+// Connection timeout kinds (one loop timer per connection)
+typedef enum
+{
+    CONN_TIMEOUT_HEADER,    // Receiving a request (from first byte / accept)
+    CONN_TIMEOUT_KEEPALIVE, // Idle between requests on a keep-alive connection
+    CONN_TIMEOUT_IDLE       // No I/O progress while processing or writing
+} cwh_conn_timeout_t;
+
+// Default timeouts (ms)
+#define CWH_DEFAULT_HEADER_TIMEOUT_MS 10000
+#define CWH_DEFAULT_KEEPALIVE_TIMEOUT_MS 10000
+#define CWH_DEFAULT_IDLE_TIMEOUT_MS 10000
+
+// Edge-triggered connections are registered once for both directions; one
+// wakeup runs at most CWH_EDGE_STEPS steps before yielding to other fds
+#define CWH_EDGE_EVENTS (CWH_EVENT_READ | CWH_EVENT_WRITE | CWH_EVENT_EDGE)
+#define CWH_EDGE_STEPS 16
+
+// Connection buffers: fixed-size blocks recycled through a per-loop free list;
+// larger requests/responses get a heap buffer of the required size
+#define CWH_CONN_BUF_SIZE 4096               // Pooled block size
+#define CWH_CONN_BUF_POOL_MAX 1024           // Max free blocks kept per loop
+#define CWH_MAX_REQUEST_SIZE (1024 * 1024)   // Requests beyond this get 413
+#define CWH_SENDFILE_CHUNK (1024 * 1024)     // Max file bytes per send call (fairness)
+#define CWH_MAX_IOV 64                       // Segments gathered per sendmsg
+#define CWH_STREAM_LOW_WATERMARK (64 * 1024)  // Default: resume producer below this
+#define CWH_STREAM_HIGH_WATERMARK (256 * 1024) // Default: pause producer above this
+#define CWH_BODY_BUF_SIZE (64 * 1024)        // Receive window for streamed request bodies
+
+// Peer resets must not raise SIGPIPE where the platform allows opting out
+#ifdef MSG_NOSIGNAL
+#define CWH_SEND_FLAGS MSG_NOSIGNAL
+#else
+#define CWH_SEND_FLAGS 0
+#endif
+
+typedef struct cwh_buf_block
+{
+    struct cwh_buf_block *next;
+} cwh_buf_block_t;
+
+typedef struct cwh_buf_pool
+{
+    cwh_buf_block_t *free_list; // Recycled CWH_CONN_BUF_SIZE blocks
+    size_t free_count;          // Blocks on the free list
+    size_t in_use;              // Buffers handed out
+    size_t bytes_in_use;        // Capacity of buffers handed out
+} cwh_buf_pool_t;
+
+// Output segment: one queued block of response bytes, optionally followed by
+// a file body. Pipelined responses queue up in request order.
+typedef struct cwh_out_seg
+{
+    char *buf;                  // Pooled block (also the read buffer for non-sendfile file bodies)
+    size_t cap;                 // Block capacity
+    size_t len;                 // Bytes in block
+    size_t offset;              // Bytes of block already sent
+    cwh_iovec_t *iov;           // Caller-owned body buffers sent after the block (never copied)
+    int iovcnt;
+    int iov_index;              // Next buffer to send
+    size_t iov_offset;          // Bytes of iov[iov_index] already sent
+    cwh_release_cb release;     // Called once the buffers are no longer needed
+    void *release_ctx;
+    char *retired;              // Request buffer the iov points into, released with the segment
+    size_t retired_cap;
+    cwh_file_entry_t *file;     // File body sent after the block, NULL if none
+    uint64_t file_offset;       // Next file offset to send
+    uint64_t file_remaining;    // File bytes left to send
+    struct cwh_out_seg *next;
+} cwh_out_seg_t;
+
 // ============================================================================
 // Connection Structure
 // ============================================================================
@@ -67,21 +163,51 @@ typedef struct cwh_async_conn
     // TLS/HTTPS
     struct cwh_tls_session *tls_session; // TLS session (if HTTPS)
     bool tls_handshake_done;             // TLS handshake complete
-
-    // Request data
-    char recv_buf[16384];  // Request buffer (16KB)
+    cwh_tls_error_t tls_result;          // Result of the step a worker ran
+    bool tls_closing;                    // Closed while a worker had it (pool lock)
+    struct cwh_async_conn *tls_next;     // Worker queue / finished list (pool lock)
+    bool ktls;                           // Kernel TLS: plain sendmsg/sendfile are encrypted
+
+    // Request data (buffer held only while a request is in flight)
+    char *recv_buf;        // Request buffer (pooled block, grown on demand)
+    struct cwh_out_seg *recv_pin; // Last queued segment whose iov points into recv_buf
+    size_t recv_cap;       // Request buffer capacity
     size_t recv_len;       // Bytes received
+    cwh_parser_t parser;   // Incremental parser state (resumes across reads)
     cwh_request_t request; // Parsed request
     bool request_complete; // Request fully received
 
-    // Response data
-    char send_buf[65536]; // Response buffer (64KB)
-    size_t send_len;      // Response size
-    size_t send_offset;   // Bytes already sent
+    // Response data (segments sized to each response, released once sent)
+    cwh_out_seg_t *out_head; // Next segment to write
+    cwh_out_seg_t *out_tail; // Last queued segment
+    uint64_t bytes_sent;     // Total bytes written (progress for idle timeout)
+    bool responded;          // Current request has a queued response
+    bool batching;           // Handlers run by dispatch_requests (write started afterwards)
+    bool failed;             // Out of memory while queueing; close when safe
+    size_t out_pending;      // Queued block/buffer bytes not yet sent (excludes file bodies)
+
+    // Streaming response (cwh_async_stream_*)
+    bool streaming;          // Stream begun, not yet ended
+    bool stream_chunked;     // Chunked framing (HTTP/1.0: body ends at close)
+    bool stream_blocked;     // Producer saw the high watermark, notify on drain
+    size_t stream_low;       // Watermarks on out_pending
+    size_t stream_high;
+    cwh_stream_cb stream_cb; // Drain / close notifications
+    void *stream_ctx;
+    int events;              // Loop events the connection waits for
+    bool edge;               // Registered edge-triggered (CWH_EDGE_EVENTS)
+    bool loop_io;            // Registered CWH_EVENT_COMPLETION: the loop does the socket I/O
+    int ready;               // Edge mode: readiness reported and not yet used up (EAGAIN)
+    bool *closed;            // Edge mode: connection_event_handler's flag, set on close
+
+    // Streamed request body (cwh_async_route_body)
+    struct cwh_async_route *body_route; // Route taking the body, NULL for buffered requests
+    bool body_paused;                   // Reading stopped (cwh_async_body_pause)
+    bool body_delivering;               // Inside on_headers/on_body
 
     // Timing
-    time_t last_activity; // Last I/O timestamp
-    int timeout_ms;       // Connection timeout (default: 30000)
+    cwh_timer_t *timer;      // Header-read / keep-alive / idle timeout
+    cwh_conn_timeout_t wait; // Which timeout the timer is armed for
 
     // Keep-alive
     bool keep_alive;     // Connection: keep-alive
@@ -100,37 +226,98 @@ struct cwh_async_server
     int listen_fd;             // Listening socket
     int port;                  // Server port
     bool running;              // Server running flag
-    cwh_async_route_t *routes; // Route handlers (linked list)
+    cwh_async_route_t *routes; // Route handlers (linked list, owns the entries)
+    cwh_router_t *router;      // Route lookup (radix tree per method)
+    int body_routes;           // Routes with an on_body callback
+
+    // Multi-threaded mode: one shard (loop + listener + connections) per thread
+    struct cwh_async_server **shards; // Per-thread servers (NULL in single-loop mode)
+    int num_shards;                   // Number of shards/threads
+    struct cwh_async_server *parent;  // Owning multi-threaded server (shards only)
+    int shard_index;                  // Shard number (used for CPU pinning)
+    bool cpu_pinning;                 // Pin shard threads to CPUs
+    bool stop_requested;              // Ask shard thread to leave its loop (__atomic access)
+    bool threads_running;             // cwh_async_server_run() active, multi-threaded (__atomic)
+    bool loop_running;                // cwh_async_server_run() active (single-loop mode)
 
     // Connection management
     cwh_async_conn_t *connections; // Active connections (linked list)
     int conn_count;                // Current connection count
     int max_connections;           // Max concurrent connections (default: 10000)
+    bool edge_triggered;           // Register connections edge-triggered if the loop can
+    cwh_buf_pool_t buf_pool;       // Request/response buffers (per loop)
+
+    // Timeouts in ms (0 = disabled)
+    int header_timeout_ms;    // Complete request headers must arrive within this
+    int keepalive_timeout_ms; // Idle keep-alive connection lifetime
+    int idle_timeout_ms;      // Max time without progress while writing a response
 
     // TLS/HTTPS support
     bool use_tls;                    // TLS enabled flag
     struct cwh_tls_context *tls_ctx; // TLS context (if HTTPS)
     char *cert_file;                 // Server certificate path
     char *key_file;                  // Private key path
+    char *ca_cert_file;              // CA for client verification (optional)
+    bool require_client_cert;        // Require client certificates
+    int tls_workers;                 // Handshake worker threads (0 = handshake on the loop)
+    struct cwh_tls_pool *tls_pool;   // Handshake workers (owned by the top-level server)
+    int tls_wake[2];                 // Pipe: workers -> this loop
+    cwh_async_conn_t *tls_done;      // Steps finished for this loop (pool lock)
+    int tls_inflight;                // Connections queued or on a worker
+    bool ktls;                       // Move established sessions into kernel TLS
 
     // Statistics
     uint64_t total_requests;    // Total requests handled
     uint64_t total_connections; // Total connections accepted
 };
 
+#if CWH_TLS_OFFLOAD
+// Handshake worker pool shared by every loop of a server
+typedef struct cwh_tls_pool
+{
+    pthread_mutex_t lock;   // Guards the queue and every loop's tls_done list
+    pthread_cond_t cond;    // Queue not empty / stopping
+    cwh_async_conn_t *head; // Connections waiting for a worker
+    cwh_async_conn_t *tail;
+    pthread_t *threads;
+    int num_threads;
+    bool stopping;
+} cwh_tls_pool_t;
+#endif
+
 // ============================================================================
 // Forward Declarations
 // ============================================================================
 
 static void connection_event_handler(cwh_loop_t *loop, int fd, int events, void *data);
+static void connection_step(cwh_async_conn_t *conn, int events);
 static void listen_event_handler(cwh_loop_t *loop, int fd, int events, void *data);
 static cwh_async_conn_t *create_connection(cwh_async_server_t *server, int client_fd);
 static void close_connection(cwh_async_conn_t *conn);
 static int read_request(cwh_async_conn_t *conn);
 static int write_response(cwh_async_conn_t *conn);
 static void process_request(cwh_async_conn_t *conn);
-static cwh_async_route_t *find_route(cwh_async_server_t *server, cwh_method_t method, const char *path);
-static void check_and_close_idle_connections(cwh_async_server_t *server);
+static cwh_async_route_t *find_route(cwh_async_server_t *server, cwh_method_t method, cwh_request_t *req);
+static void arm_connection_timer(cwh_async_conn_t *conn, cwh_conn_timeout_t wait);
+static void set_conn_events(cwh_async_conn_t *conn, int events);
+static int parse_request(cwh_async_conn_t *conn);
+static void reject_request(cwh_async_conn_t *conn, int result);
+static void dispatch_requests(cwh_async_conn_t *conn);
+static void start_writing(cwh_async_conn_t *conn);
+static void output_drained(cwh_async_conn_t *conn);
+static void stream_check_drain(cwh_async_conn_t *conn);
+static int start_body_request(cwh_async_conn_t *conn);
+static int deliver_body(cwh_async_conn_t *conn);
+static void body_progress(cwh_async_conn_t *conn, int result);
+#if CWEBHTTP_ENABLE_TLS
+static void handshake_result(cwh_async_conn_t *conn, cwh_tls_error_t tls_err);
+#endif
+#if CWH_TLS_OFFLOAD
+static int start_tls_workers(cwh_async_server_t *server);
+static void stop_tls_workers(cwh_async_server_t *server);
+static void tls_drain(cwh_async_server_t *server);
+static void tls_submit(cwh_async_conn_t *conn);
+#endif
 
 // ============================================================================
 // Server Lifecycle
@@ -154,16 +341,180 @@ cwh_async_server_t *cwh_async_server_new(cwh_loop_t *loop)
     server->connections = NULL;
     server->conn_count = 0;
     server->max_connections = 10000; // C10K capable
+    server->edge_triggered = false;
+    server->header_timeout_ms = CWH_DEFAULT_HEADER_TIMEOUT_MS;
+    server->keepalive_timeout_ms = CWH_DEFAULT_KEEPALIVE_TIMEOUT_MS;
+    server->idle_timeout_ms = CWH_DEFAULT_IDLE_TIMEOUT_MS;
     server->use_tls = false;
     server->tls_ctx = NULL;
     server->cert_file = NULL;
     server->key_file = NULL;
+    server->tls_wake[0] = -1;
+    server->tls_wake[1] = -1;
     server->total_requests = 0;
     server->total_connections = 0;
 
     return server;
 }
 
+// Number of online CPUs (fallback: 1)
+static int online_cpu_count(void)
+{
+#ifdef _WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwNumberOfProcessors > 0 ? (int)info.dwNumberOfProcessors : 1;
+#else
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return n > 0 ? (int)n : 1;
+#endif
+}
+
+// Create multi-threaded async server (one event loop + listener per thread)
+cwh_async_server_t *cwh_async_server_new_multi(int num_threads)
+{
+    if (num_threads <= 0)
+        num_threads = online_cpu_count();
+
+#ifndef SO_REUSEPORT
+    // Without SO_REUSEPORT the kernel cannot spread accepts over several listeners
+    num_threads = 1;
+#endif
+
+    cwh_async_server_t *server = (cwh_async_server_t *)calloc(1, sizeof(cwh_async_server_t));
+    if (!server)
+        return NULL;
+
+    server->listen_fd = -1;
+    server->max_connections = 10000;
+    server->edge_triggered = false;
+    server->tls_wake[0] = -1;
+    server->tls_wake[1] = -1;
+    server->shards = (cwh_async_server_t **)calloc(num_threads, sizeof(cwh_async_server_t *));
+    if (!server->shards)
+    {
+        free(server);
+        return NULL;
+    }
+    server->num_shards = num_threads;
+
+    for (int i = 0; i < num_threads; i++)
+    {
+        cwh_loop_t *loop = cwh_loop_new();
+        cwh_async_server_t *shard = loop ? cwh_async_server_new(loop) : NULL;
+        if (!shard)
+        {
+            cwh_loop_free(loop);
+            cwh_async_server_free(server);
+            return NULL;
+        }
+
+        shard->parent = server;
+        shard->shard_index = i;
+        server->shards[i] = shard;
+    }
+
+    return server;
+}
+
+// Enable/disable pinning of shard threads to CPUs (call before cwh_async_server_run)
+void cwh_async_server_set_cpu_pinning(cwh_async_server_t *server, bool enable)
+{
+    if (!server)
+        return;
+
+    server->cpu_pinning = enable;
+    for (int i = 0; i < server->num_shards; i++)
+        server->shards[i]->cpu_pinning = enable;
+}
+
+// Register connections edge-triggered when the loop supports it
+void cwh_async_server_set_edge_triggered(cwh_async_server_t *server, bool enable)
+{
+    if (!server)
+        return;
+
+    server->edge_triggered = enable;
+    for (int i = 0; i < server->num_shards; i++)
+        server->shards[i]->edge_triggered = enable;
+}
+
+// Hand established TLS sessions to the kernel (Linux kTLS)
+void cwh_async_server_set_ktls(cwh_async_server_t *server, bool enable)
+{
+    if (!server)
+        return;
+
+    server->ktls = enable;
+    for (int i = 0; i < server->num_shards; i++)
+        server->shards[i]->ktls = enable;
+}
+
+// Configure connection timeouts in ms (0 = disabled, negative = keep current)
+void cwh_async_server_set_timeouts(cwh_async_server_t *server,
+                                   int header_timeout_ms,
+                                   int keepalive_timeout_ms,
+                                   int idle_timeout_ms)
+{
+    if (!server)
+        return;
+
+    if (header_timeout_ms >= 0)
+        server->header_timeout_ms = header_timeout_ms;
+    if (keepalive_timeout_ms >= 0)
+        server->keepalive_timeout_ms = keepalive_timeout_ms;
+    if (idle_timeout_ms >= 0)
+        server->idle_timeout_ms = idle_timeout_ms;
+
+    for (int i = 0; i < server->num_shards; i++)
+        cwh_async_server_set_timeouts(server->shards[i], header_timeout_ms,
+                                      keepalive_timeout_ms, idle_timeout_ms);
+}
+
+// Get server statistics (summed over shards; approximate while threads run)
+void cwh_async_server_get_stats(cwh_async_server_t *server, cwh_async_server_stats_t *stats)
+{
+    if (!server || !stats)
+        return;
+
+    memset(stats, 0, sizeof(*stats));
+
+    if (server->shards)
+    {
+        for (int i = 0; i < server->num_shards; i++)
+        {
+            cwh_async_server_stats_t shard_stats;
+            cwh_async_server_get_stats(server->shards[i], &shard_stats);
+            stats->connections += shard_stats.connections;
+            stats->total_connections += shard_stats.total_connections;
+            stats->total_requests += shard_stats.total_requests;
+            stats->buffers_in_use += shard_stats.buffers_in_use;
+            stats->buffers_pooled += shard_stats.buffers_pooled;
+            stats->buffer_bytes += shard_stats.buffer_bytes;
+            stats->memory_bytes += shard_stats.memory_bytes;
+        }
+        return;
+    }
+
+    stats->connections = server->conn_count;
+    stats->total_connections = server->total_connections;
+    stats->total_requests = server->total_requests;
+    stats->buffers_in_use = server->buf_pool.in_use;
+    stats->buffers_pooled = server->buf_pool.free_count;
+    stats->buffer_bytes = server->buf_pool.bytes_in_use +
+                          server->buf_pool.free_count * CWH_CONN_BUF_SIZE;
+    stats->memory_bytes = (size_t)server->conn_count * sizeof(cwh_async_conn_t) +
+                          stats->buffer_bytes;
+}
+
+// Number of event loop threads (1 for single-loop servers)
+int cwh_async_server_thread_count(cwh_async_server_t *server)
+{
+    if (!server)
+        return 0;
+    return server->shards ? server->num_shards : 1;
+}
+
 // Configure TLS/HTTPS (must be called before cwh_async_listen)
 int cwh_async_server_set_tls(cwh_async_server_t *server,
                              const char *cert_file,
@@ -189,15 +540,23 @@ int cwh_async_server_set_tls_ex(cwh_async_server_t *server,
     // Store certificate paths
     server->cert_file = strdup(cert_file);
     server->key_file = strdup(key_file);
+    server->ca_cert_file = ca_cert_path ? strdup(ca_cert_path) : NULL;
+    server->require_client_cert = require_client_cert;
 
-    if (!server->cert_file || !server->key_file)
+    if (!server->cert_file || !server->key_file || (ca_cert_path && !server->ca_cert_file))
     {
         free(server->cert_file);
         free(server->key_file);
+        free(server->ca_cert_file);
+        server->cert_file = NULL;
+        server->key_file = NULL;
+        server->ca_cert_file = NULL;
         return -1;
     }
 
-    // Create TLS context for server
+    // Create TLS context for server. A multi-threaded server's shards all use
+    // this one (cwh_async_listen): SO_REUSEPORT spreads a client's reconnects
+    // over the shards, so each must accept the others' tickets and session IDs.
     cwh_tls_config_t tls_config = cwh_tls_config_default();
     tls_config.verify_peer = false;
     tls_config.client_cert = cert_file;
@@ -212,8 +571,10 @@ int cwh_async_server_set_tls_ex(cwh_async_server_t *server,
     {
         free(server->cert_file);
         free(server->key_file);
+        free(server->ca_cert_file);
         server->cert_file = NULL;
         server->key_file = NULL;
+        server->ca_cert_file = NULL;
         return -1;
     }
 
@@ -230,12 +591,38 @@ int cwh_async_server_set_tls_ex(cwh_async_server_t *server,
 #endif
 }
 
-// Start listening on port (non-blocking)
-int cwh_async_listen(cwh_async_server_t *server, int port)
+// Run handshake steps on worker threads (must be called before cwh_async_listen)
+int cwh_async_server_set_tls_workers(cwh_async_server_t *server, int num_workers)
 {
-    if (!server || port <= 0 || port > 65535)
+    if (!server || num_workers < 0)
+        return -1;
+
+#if CWH_TLS_OFFLOAD
+    // Without MBEDTLS_THREADING_C every step would take the context's
+    // handshake lock, so the workers could only run one at a time
+    if (num_workers > 0 && !cwh_tls_threading_available())
         return -1;
+    server->tls_workers = num_workers;
+    return 0;
+#else
+    return num_workers == 0 ? 0 : -1;
+#endif
+}
+
+// Close a socket owned by the server
+static void close_socket(int fd)
+{
+#ifdef _WIN32
+    closesocket(fd);
+#else
+    close(fd);
+#endif
+}
 
+// Create, bind and register the listening socket for one loop
+// reuse_port: bind with SO_REUSEPORT so several shards can share the port
+static int listen_on_port(cwh_async_server_t *server, int port, bool reuse_port)
+{
     // Create listening socket with overlapped I/O flag on Windows (required for IOCP)
 #ifdef _WIN32
     server->listen_fd = WSASocket(AF_INET, SOCK_STREAM, IPPROTO_TCP,
@@ -256,23 +643,31 @@ int cwh_async_listen(cwh_async_server_t *server, int port)
                    &reuse, sizeof(reuse)) < 0)
 #endif
     {
-#ifdef _WIN32
-        closesocket(server->listen_fd);
-#else
-        close(server->listen_fd);
-#endif
+        close_socket(server->listen_fd);
         server->listen_fd = -1;
         return -1;
     }
 
+    // Set SO_REUSEPORT so the kernel load-balances accepts across shards
+    if (reuse_port)
+    {
+#ifdef SO_REUSEPORT
+        if (setsockopt(server->listen_fd, SOL_SOCKET, SO_REUSEPORT,
+                       &reuse, sizeof(reuse)) < 0)
+#endif
+        {
+#ifdef SO_REUSEPORT
+            close_socket(server->listen_fd);
+            server->listen_fd = -1;
+            return -1;
+#endif
+        }
+    }
+
     // Set non-blocking
     if (cwh_set_nonblocking(server->listen_fd) < 0)
     {
-#ifdef _WIN32
-        closesocket(server->listen_fd);
-#else
-        close(server->listen_fd);
-#endif
+        close_socket(server->listen_fd);
         server->listen_fd = -1;
         return -1;
     }
@@ -285,11 +680,7 @@ int cwh_async_listen(cwh_async_server_t *server, int port)
 
     if (bind(server->listen_fd, (struct sockaddr *)&addr, sizeof(addr)) < 0)
     {
-#ifdef _WIN32
-        closesocket(server->listen_fd);
-#else
-        close(server->listen_fd);
-#endif
+        close_socket(server->listen_fd);
         server->listen_fd = -1;
         return -1;
     }
@@ -297,11 +688,7 @@ int cwh_async_listen(cwh_async_server_t *server, int port)
     // Listen with backlog
     if (listen(server->listen_fd, 128) < 0)
     {
-#ifdef _WIN32
-        closesocket(server->listen_fd);
-#else
-        close(server->listen_fd);
-#endif
+        close_socket(server->listen_fd);
         server->listen_fd = -1;
         return -1;
     }
@@ -313,11 +700,7 @@ int cwh_async_listen(cwh_async_server_t *server, int port)
     if (cwh_loop_add(server->loop, server->listen_fd, CWH_EVENT_READ,
                      listen_event_handler, server) < 0)
     {
-#ifdef _WIN32
-        closesocket(server->listen_fd);
-#else
-        close(server->listen_fd);
-#endif
+        close_socket(server->listen_fd);
         server->listen_fd = -1;
         server->running = false;
         return -1;
@@ -326,23 +709,209 @@ int cwh_async_listen(cwh_async_server_t *server, int port)
     return 0;
 }
 
+// Start listening on port (non-blocking)
+int cwh_async_listen(cwh_async_server_t *server, int port)
+{
+    if (!server || port <= 0 || port > 65535)
+        return -1;
+
+    if (!server->shards)
+    {
+        if (listen_on_port(server, port, false) < 0)
+            return -1;
+#if CWH_TLS_OFFLOAD
+        if (start_tls_workers(server) < 0)
+        {
+            cwh_async_server_stop(server);
+            return -1;
+        }
+#endif
+        return 0;
+    }
+
+    // Multi-threaded mode: one SO_REUSEPORT listener per shard
+    for (int i = 0; i < server->num_shards; i++)
+    {
+        cwh_async_server_t *shard = server->shards[i];
+
+#if CWEBHTTP_ENABLE_TLS
+        // Shared, owned by the parent (the context locks its session state)
+        shard->use_tls = server->use_tls;
+        shard->tls_ctx = server->tls_ctx;
+#endif
+
+        if (listen_on_port(shard, port, server->num_shards > 1) < 0)
+        {
+            // The parent is not running yet: close the shards already bound
+            for (int j = 0; j < i; j++)
+                cwh_async_server_stop(server->shards[j]);
+            return -1;
+        }
+    }
+
+    server->port = port;
+    server->running = true;
+
+#if CWH_TLS_OFFLOAD
+    if (start_tls_workers(server) < 0)
+    {
+        cwh_async_server_stop(server);
+        return -1;
+    }
+#endif
+    return 0;
+}
+
+// Pin the calling thread to one CPU (best effort)
+static void pin_thread_to_cpu(int cpu)
+{
+#if defined(__linux__)
+    long ncpu = sysconf(_SC_NPROCESSORS_ONLN);
+    if (ncpu <= 0)
+        return;
+
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu % ncpu, &set);
+    pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+#elif defined(_WIN32)
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    if (info.dwNumberOfProcessors > 0)
+        SetThreadAffinityMask(GetCurrentThread(),
+                              (DWORD_PTR)1 << (cpu % info.dwNumberOfProcessors));
+#else
+    (void)cpu; // No portable affinity API (macOS, BSD)
+#endif
+}
+
+// Run one shard's event loop until stop is requested
+static void run_shard(cwh_async_server_t *shard)
+{
+    if (shard->cpu_pinning)
+        pin_thread_to_cpu(shard->shard_index);
+
+    // Short timeout so the stop flag is noticed promptly
+    while (!__atomic_load_n(&shard->stop_requested, __ATOMIC_ACQUIRE))
+    {
+        if (cwh_loop_run_once(shard->loop, 100) < 0)
+            break;
+    }
+}
+
+#ifdef _WIN32
+static unsigned __stdcall shard_thread_main(void *arg)
+{
+    run_shard((cwh_async_server_t *)arg);
+    return 0;
+}
+#else
+static void *shard_thread_main(void *arg)
+{
+    run_shard((cwh_async_server_t *)arg);
+    return NULL;
+}
+#endif
+
+// Run server until cwh_async_server_stop() (blocking)
+int cwh_async_server_run(cwh_async_server_t *server)
+{
+    if (!server || !server->running)
+        return -1;
+
+    if (!server->shards)
+    {
+        server->loop_running = true;
+        int ret = cwh_loop_run(server->loop);
+        server->loop_running = false;
+        return ret;
+    }
+
+    // Shard 0 runs on the calling thread, the rest get their own threads
+    cwh_thread_t *threads = (cwh_thread_t *)calloc(server->num_shards, sizeof(cwh_thread_t));
+    if (!threads)
+        return -1;
+
+    // A previous run's stop leaves the flags set; clear them before the
+    // shards loop again (the server was stopped and listened anew)
+    for (int i = 0; i < server->num_shards; i++)
+        __atomic_store_n(&server->shards[i]->stop_requested, false, __ATOMIC_RELEASE);
+    __atomic_store_n(&server->threads_running, true, __ATOMIC_RELEASE);
+
+    int started = 1;
+    for (int i = 1; i < server->num_shards; i++)
+    {
+#ifdef _WIN32
+        threads[i] = (HANDLE)_beginthreadex(NULL, 0, shard_thread_main, server->shards[i], 0, NULL);
+        if (!threads[i])
+            break;
+#else
+        if (pthread_create(&threads[i], NULL, shard_thread_main, server->shards[i]) != 0)
+            break;
+#endif
+        started++;
+    }
+
+    if (started < server->num_shards)
+    {
+        for (int i = 0; i < server->num_shards; i++)
+            __atomic_store_n(&server->shards[i]->stop_requested, true, __ATOMIC_RELEASE);
+    }
+    else
+    {
+        run_shard(server->shards[0]);
+    }
+
+    for (int i = 1; i < started; i++)
+    {
+#ifdef _WIN32
+        WaitForSingleObject(threads[i], INFINITE);
+        CloseHandle(threads[i]);
+#else
+        pthread_join(threads[i], NULL);
+#endif
+    }
+    free(threads);
+
+    // All shard threads are gone: close listeners and connections
+    __atomic_store_n(&server->threads_running, false, __ATOMIC_RELEASE);
+    cwh_async_server_stop(server);
+
+    return started == server->num_shards ? 0 : -1;
+}
+
 // Stop server gracefully
 void cwh_async_server_stop(cwh_async_server_t *server)
 {
     if (!server || !server->running)
         return;
 
+    if (server->shards)
+    {
+        // Ask shard threads to exit; cwh_async_server_run() joins them
+        // and calls back here to release sockets once they are gone
+        for (int i = 0; i < server->num_shards; i++)
+            __atomic_store_n(&server->shards[i]->stop_requested, true, __ATOMIC_RELEASE);
+
+        if (__atomic_load_n(&server->threads_running, __ATOMIC_ACQUIRE))
+            return;
+
+        server->running = false;
+        for (int i = 0; i < server->num_shards; i++)
+            cwh_async_server_stop(server->shards[i]);
+        return;
+    }
+
     server->running = false;
 
+    if (server->loop_running)
+        cwh_loop_stop(server->loop);
+
     // Close listening socket
     if (server->listen_fd >= 0)
     {
         cwh_loop_del(server->loop, server->listen_fd);
-#ifdef _WIN32
-        closesocket(server->listen_fd);
-#else
-        close(server->listen_fd);
-#endif
+        close_socket(server->listen_fd);
         server->listen_fd = -1;
     }
 
@@ -354,6 +923,11 @@ void cwh_async_server_stop(cwh_async_server_t *server)
         close_connection(conn);
         conn = next;
     }
+
+#if CWH_TLS_OFFLOAD
+    // Connections a worker still has are freed once their step comes back
+    tls_drain(server);
+#endif
 }
 
 // Free server resources
@@ -365,6 +939,30 @@ void cwh_async_server_free(cwh_async_server_t *server)
     // Stop server first
     cwh_async_server_stop(server);
 
+    // Free shards (multi-threaded mode); they own their loops but not the routes
+    if (server->shards)
+    {
+        for (int i = 0; i < server->num_shards; i++)
+        {
+            cwh_async_server_t *shard = server->shards[i];
+            if (!shard)
+                continue;
+            cwh_loop_t *loop = shard->loop;
+            cwh_async_server_free(shard);
+            cwh_loop_free(loop);
+        }
+        free(server->shards);
+    }
+
+    // Free pooled buffers
+    cwh_buf_block_t *block = server->buf_pool.free_list;
+    while (block)
+    {
+        cwh_buf_block_t *next = block->next;
+        free(block);
+        block = next;
+    }
+
     // Free routes
     cwh_async_route_t *route = server->routes;
     while (route)
@@ -374,16 +972,21 @@ void cwh_async_server_free(cwh_async_server_t *server)
         free(route);
         route = next;
     }
+    cwh_router_free(server->router);
 
     // Cleanup TLS resources
+#if CWH_TLS_OFFLOAD
+    stop_tls_workers(server);
+#endif
 #if CWEBHTTP_ENABLE_TLS
-    if (server->tls_ctx)
+    if (server->tls_ctx && !server->parent)
     {
         cwh_tls_context_free(server->tls_ctx);
         server->tls_ctx = NULL;
     }
     free(server->cert_file);
     free(server->key_file);
+    free(server->ca_cert_file);
 #endif
 
     free(server);
@@ -393,82 +996,303 @@ void cwh_async_server_free(cwh_async_server_t *server)
 // Routing
 // ============================================================================
 
-// Convert method string to enum
-static cwh_method_t parse_method(const char *method_str)
+// Method whose routes answer a request: HEAD is served by GET routes (as the
+// parser treats it), a method without routes of its own by any-method routes
+static cwh_method_t request_method(const cwh_request_t *req)
 {
-    if (!method_str)
-        return CWH_METHOD_GET;
-    if (strcmp(method_str, "GET") == 0)
+    if (req->method_str && strcmp(req->method_str, "HEAD") == 0)
         return CWH_METHOD_GET;
-    if (strcmp(method_str, "POST") == 0)
-        return CWH_METHOD_POST;
-    if (strcmp(method_str, "PUT") == 0)
-        return CWH_METHOD_PUT;
-    if (strcmp(method_str, "DELETE") == 0)
-        return CWH_METHOD_DELETE;
-    return CWH_METHOD_GET; // Default
+    return cwh_method_from_str(req->method_str);
 }
 
-// Register route handler
-void cwh_async_route(cwh_async_server_t *server,
-                     const char *method,
-                     const char *path,
-                     cwh_async_handler_t handler,
-                     void *user_data)
+// Add a route to the table and the router; returns 0 or -1
+static int add_route(cwh_async_server_t *server, const char *method, const char *path,
+                     cwh_async_handler_t handler, cwh_async_body_cb on_body, void *user_data)
 {
-    if (!server || !path || !handler)
-        return;
+    // NULL method = any method
+    cwh_method_t method_type = method ? cwh_method_from_str(method) : CWH_METHOD_NUM;
+    if (method && method_type == CWH_METHOD_NUM)
+        return -1;
 
     cwh_async_route_t *route = (cwh_async_route_t *)calloc(1, sizeof(cwh_async_route_t));
     if (!route)
-        return;
-
-    // Parse method string to enum
-    route->method = CWH_METHOD_GET; // Default
-    if (method)
-    {
-        if (strcmp(method, "GET") == 0)
-            route->method = CWH_METHOD_GET;
-        else if (strcmp(method, "POST") == 0)
-            route->method = CWH_METHOD_POST;
-        else if (strcmp(method, "PUT") == 0)
-            route->method = CWH_METHOD_PUT;
-        else if (strcmp(method, "DELETE") == 0)
-            route->method = CWH_METHOD_DELETE;
-    }
+        return -1;
 
+    route->method = method_type;
     route->path = strdup(path);
     route->handler = handler;
+    route->on_body = on_body;
     route->user_data = user_data;
-    route->next = server->routes;
 
+    if (!server->router)
+        server->router = cwh_router_new();
+    if (!route->path || !server->router ||
+        cwh_router_add(server->router, route->method, route->path, route) < 0)
+    {
+        free((void *)route->path);
+        free(route);
+        return -1;
+    }
+
+    route->next = server->routes;
     server->routes = route;
+    if (on_body)
+        server->body_routes++;
+    return 0;
 }
 
-// Find matching route
-static cwh_async_route_t *find_route(cwh_async_server_t *server, cwh_method_t method, const char *path)
+// Register route handler
+int cwh_async_route(cwh_async_server_t *server,
+                    const char *method,
+                    const char *path,
+                    cwh_async_handler_t handler,
+                    void *user_data)
 {
-    cwh_async_route_t *route = server->routes;
+    if (!server || !path || !handler)
+        return -1;
+    return add_route(server, method, path, handler, NULL, user_data);
+}
 
-    while (route)
+// Register route whose request body is handed to on_body as it arrives
+int cwh_async_route_body(cwh_async_server_t *server,
+                         const char *method,
+                         const char *path,
+                         cwh_async_handler_t on_headers,
+                         cwh_async_body_cb on_body,
+                         void *user_data)
+{
+    if (!server || !path || !on_body)
+        return -1;
+    return add_route(server, method, path, on_headers, on_body, user_data);
+}
+
+// Server holding the route table (shards share their parent's routes)
+static cwh_async_server_t *route_owner(cwh_async_server_t *server)
+{
+    return server->parent ? server->parent : server;
+}
+
+// Find matching route (fills req->params)
+static cwh_async_route_t *find_route(cwh_async_server_t *server, cwh_method_t method, cwh_request_t *req)
+{
+    return (cwh_async_route_t *)cwh_router_find(server->router, method, req->path, req);
+}
+
+// ============================================================================
+// Buffer Pool
+// ============================================================================
+
+// Get a buffer of at least size bytes
+static char *buf_acquire(cwh_async_server_t *server, size_t size, size_t *cap_out)
+{
+    cwh_buf_pool_t *pool = &server->buf_pool;
+    char *buf;
+    size_t cap;
+
+    if (size <= CWH_CONN_BUF_SIZE)
     {
-        // Check method match
-        if (route->method != method)
+        cap = CWH_CONN_BUF_SIZE;
+        if (pool->free_list)
         {
-            route = route->next;
-            continue;
+            buf = (char *)pool->free_list;
+            pool->free_list = pool->free_list->next;
+            pool->free_count--;
         }
+        else
+        {
+            buf = (char *)malloc(cap);
+        }
+    }
+    else
+    {
+        cap = size;
+        buf = (char *)malloc(cap);
+    }
+
+    if (!buf)
+        return NULL;
+
+    pool->in_use++;
+    pool->bytes_in_use += cap;
+    *cap_out = cap;
+    return buf;
+}
+
+// Return a buffer (pooled blocks are recycled, oversized ones freed)
+static void buf_release(cwh_async_server_t *server, char *buf, size_t cap)
+{
+    if (!buf)
+        return;
+
+    cwh_buf_pool_t *pool = &server->buf_pool;
+    pool->in_use--;
+    pool->bytes_in_use -= cap;
+
+    if (cap == CWH_CONN_BUF_SIZE && pool->free_count < CWH_CONN_BUF_POOL_MAX)
+    {
+        cwh_buf_block_t *block = (cwh_buf_block_t *)buf;
+        block->next = pool->free_list;
+        pool->free_list = block;
+        pool->free_count++;
+        return;
+    }
+
+    free(buf);
+}
+
+// Grow request buffer (doubling, up to CWH_MAX_REQUEST_SIZE); returns -1 when full
+static int grow_recv_buf(cwh_async_conn_t *conn)
+{
+    cwh_async_server_t *server = conn->server;
+
+    if (conn->recv_cap >= CWH_MAX_REQUEST_SIZE)
+        return -1;
+
+    size_t new_cap = conn->recv_cap * 2;
+    if (new_cap > CWH_MAX_REQUEST_SIZE)
+        new_cap = CWH_MAX_REQUEST_SIZE;
+
+    char *buf = (char *)malloc(new_cap);
+    if (!buf)
+        return -1;
+
+    memcpy(buf, conn->recv_buf, conn->recv_len);
+    if (conn->recv_pin)
+    {
+        // Queued output points into the old buffer: released once it is sent
+        conn->recv_pin->retired = conn->recv_buf;
+        conn->recv_pin->retired_cap = conn->recv_cap;
+        conn->recv_pin = NULL;
+    }
+    else
+    {
+        buf_release(server, conn->recv_buf, conn->recv_cap);
+    }
+    server->buf_pool.in_use++;
+    server->buf_pool.bytes_in_use += new_cap;
+
+    conn->recv_buf = buf;
+    conn->recv_cap = new_cap;
+    return 0;
+}
+
+// Drop the request buffer (connection idle)
+static void release_recv_buf(cwh_async_conn_t *conn)
+{
+    buf_release(conn->server, conn->recv_buf, conn->recv_cap);
+    conn->recv_buf = NULL;
+    conn->recv_cap = 0;
+    conn->recv_len = 0;
+}
+
+// Allocate an output segment with a block of at least size bytes
+static cwh_out_seg_t *out_seg_new(cwh_async_conn_t *conn, size_t size)
+{
+    cwh_out_seg_t *seg = (cwh_out_seg_t *)calloc(1, sizeof(cwh_out_seg_t));
+    if (!seg)
+        return NULL;
+
+    seg->buf = buf_acquire(conn->server, size, &seg->cap);
+    if (!seg->buf)
+    {
+        free(seg);
+        return NULL;
+    }
+    return seg;
+}
+
+static void out_seg_free(cwh_async_conn_t *conn, cwh_out_seg_t *seg)
+{
+    if (conn->recv_pin == seg)
+        conn->recv_pin = NULL; // Earlier segments went first
+    buf_release(conn->server, seg->buf, seg->cap);
+    buf_release(conn->server, seg->retired, seg->retired_cap);
+    cwh_file_cache_release(seg->file);
+    if (seg->release)
+        seg->release(seg->release_ctx);
+    free(seg->iov);
+    free(seg);
+}
+
+// Segment still has block or caller buffer bytes to send
+static bool seg_pending(const cwh_out_seg_t *seg)
+{
+    return seg->offset < seg->len || seg->iov_index < seg->iovcnt;
+}
 
-        // Check path (exact match for now)
-        if (strcmp(route->path, path) == 0)
+// Mark n sent bytes of the segment (block first, then caller buffers);
+// returns the bytes that belong to later segments
+static size_t seg_advance(cwh_out_seg_t *seg, size_t n)
+{
+    size_t take = seg->len - seg->offset < n ? seg->len - seg->offset : n;
+    seg->offset += take;
+    n -= take;
+
+    while (n > 0 && seg->iov_index < seg->iovcnt)
+    {
+        size_t left = seg->iov[seg->iov_index].len - seg->iov_offset;
+        take = left < n ? left : n;
+        seg->iov_offset += take;
+        n -= take;
+        if (seg->iov_offset == seg->iov[seg->iov_index].len)
         {
-            return route;
+            seg->iov_index++;
+            seg->iov_offset = 0;
         }
+    }
+    return n;
+}
+
+// Append a response segment; writing starts now unless dispatch_requests
+// is collecting a batch (it starts the write once all handlers ran)
+static void out_queue(cwh_async_conn_t *conn, cwh_out_seg_t *seg)
+{
+    if (conn->out_tail)
+        conn->out_tail->next = seg;
+    else
+        conn->out_head = seg;
+    conn->out_tail = seg;
+    conn->responded = true;
+    conn->out_pending += seg->len - seg->offset;
+    for (int i = seg->iov_index; i < seg->iovcnt; i++)
+        conn->out_pending += seg->iov[i].len;
+
+    if (!conn->batching)
+    {
+        conn->state = CONN_STATE_WRITING_RESPONSE;
+        set_conn_events(conn, CWH_EVENT_WRITE);
+    }
+}
 
-        route = route->next;
+// A response could not be queued: the connection closes once control is
+// back in the event handler (or dispatch_requests)
+static void out_fail(cwh_async_conn_t *conn)
+{
+    conn->failed = true;
+    conn->responded = true;
+    if (!conn->batching)
+    {
+        conn->state = CONN_STATE_WRITING_RESPONSE;
+        set_conn_events(conn, CWH_EVENT_WRITE);
     }
+}
 
-    return NULL;
+// Remove the fully written head segment
+static void out_pop(cwh_async_conn_t *conn)
+{
+    cwh_out_seg_t *seg = conn->out_head;
+    conn->out_head = seg->next;
+    if (!conn->out_head)
+        conn->out_tail = NULL;
+    out_seg_free(conn, seg);
+}
+
+// Drop request/response buffers (connection closing)
+static void release_conn_buffers(cwh_async_conn_t *conn)
+{
+    release_recv_buf(conn);
+    while (conn->out_head)
+        out_pop(conn);
 }
 
 // ============================================================================
@@ -484,15 +1308,17 @@ static cwh_async_conn_t *create_connection(cwh_async_server_t *server, int clien
 
     conn->fd = client_fd;
     conn->state = CONN_STATE_READING_REQUEST;
+    conn->events = CWH_EVENT_READ;
     conn->server = server;
     conn->tls_session = NULL;
     conn->tls_handshake_done = false;
+    conn->recv_buf = NULL;
     conn->recv_len = 0;
+    cwh_parser_init(&conn->parser);
     conn->request_complete = false;
-    conn->send_len = 0;
-    conn->send_offset = 0;
-    conn->last_activity = time(NULL);
-    conn->timeout_ms = 10000; // 10 seconds idle timeout
+    conn->out_head = NULL;
+    conn->out_tail = NULL;
+    conn->timer = NULL;
     conn->keep_alive = false;
     conn->requests_served = 0;
 
@@ -533,8 +1359,45 @@ static void close_connection(cwh_async_conn_t *conn)
 
     cwh_async_server_t *server = conn->server;
 
+    // The edge-mode event handler must stop stepping this connection
+    if (conn->closed)
+        *conn->closed = true;
+
+#if CWH_TLS_OFFLOAD
+    if (conn->state == CONN_STATE_HANDSHAKING)
+    {
+        // A worker owns the TLS session: stop watching the connection now,
+        // free it when the step comes back (tls_wake_handler)
+        pthread_mutex_lock(&server->tls_pool->lock);
+        conn->tls_closing = true;
+        pthread_mutex_unlock(&server->tls_pool->lock);
+        conn->closed = NULL;
+        cwh_loop_del(server->loop, conn->fd);
+        cwh_loop_timer_cancel(server->loop, conn->timer);
+        conn->timer = NULL;
+        return;
+    }
+#endif
+
+    // A stream producer must stop using the connection
+    if (conn->streaming && conn->stream_cb)
+    {
+        conn->streaming = false;
+        conn->stream_cb(conn, CWH_STREAM_CLOSED, conn->stream_ctx);
+    }
+
+    // So must a consumer of an unfinished request body
+    if (conn->body_route && !conn->request_complete)
+    {
+        cwh_async_route_t *route = conn->body_route;
+        conn->body_route = NULL;
+        route->on_body(conn, CWH_BODY_ABORTED, NULL, 0, route->user_data);
+    }
+
     // Remove from event loop
     cwh_loop_del(server->loop, conn->fd);
+    cwh_loop_timer_cancel(server->loop, conn->timer);
+    release_conn_buffers(conn);
 
     // Cleanup TLS session if present
 #if CWEBHTTP_ENABLE_TLS
@@ -572,38 +1435,56 @@ static void close_connection(cwh_async_conn_t *conn)
 // Timeout Management
 // ============================================================================
 
-// Check and close idle connections (10-second timeout)
-static void check_and_close_idle_connections(cwh_async_server_t *server)
+// Connection timer expired: header, keep-alive or idle timeout
+static void connection_timeout_handler(cwh_loop_t *loop, cwh_timer_t *timer, void *data)
 {
-    if (!server || !server->connections)
-        return;
+    (void)loop;
+    (void)timer;
 
-    time_t now = time(NULL);
-    cwh_async_conn_t *conn = server->connections;
-    cwh_async_conn_t *prev = NULL;
+    close_connection((cwh_async_conn_t *)data);
+}
 
-    while (conn)
+// (Re)arm the connection timer for the given wait
+static void arm_connection_timer(cwh_async_conn_t *conn, cwh_conn_timeout_t wait)
+{
+    cwh_async_server_t *server = conn->server;
+    int timeout_ms = server->idle_timeout_ms;
+    if (wait == CONN_TIMEOUT_HEADER)
+        timeout_ms = server->header_timeout_ms;
+    else if (wait == CONN_TIMEOUT_KEEPALIVE)
+        timeout_ms = server->keepalive_timeout_ms;
+
+    conn->wait = wait;
+
+    if (timeout_ms <= 0)
     {
-        cwh_async_conn_t *next = conn->next;
-        if ((now - conn->last_activity) * 1000 > conn->timeout_ms)
-        {
-            // Idle timeout exceeded, close connection
-            close_connection(conn);
-            // After close_connection, conn is freed, so update prev->next or server->connections
-            if (prev)
-            {
-                prev->next = next;
-            }
-            else
-            {
-                server->connections = next;
-            }
-            conn = next;
-            continue;
-        }
-        prev = conn;
-        conn = next;
+        cwh_loop_timer_cancel(server->loop, conn->timer);
+        conn->timer = NULL;
+        return;
     }
+
+    if (conn->timer)
+        cwh_loop_timer_reset(server->loop, conn->timer, (uint64_t)timeout_ms);
+    else
+        conn->timer = cwh_loop_timer_add(server->loop, (uint64_t)timeout_ms,
+                                         connection_timeout_handler, conn);
+}
+
+// Change the loop events of a connection (skips redundant updates)
+// Edge mode keeps its registration; only readiness that was already reported
+// (and won't be again) needs a cwh_loop_mod to be re-reported, and not even
+// that inside connection_event_handler, which picks it up itself
+static void set_conn_events(cwh_async_conn_t *conn, int events)
+{
+    if (conn->events == events)
+        return;
+    int added = events & ~conn->events;
+    conn->events = events;
+
+    if (!conn->edge)
+        cwh_loop_mod(conn->server->loop, conn->fd, events);
+    else if ((added & conn->ready) && !conn->closed)
+        cwh_loop_mod(conn->server->loop, conn->fd, CWH_EDGE_EVENTS);
 }
 
 // ============================================================================
@@ -613,13 +1494,11 @@ static void check_and_close_idle_connections(cwh_async_server_t *server)
 // Listen socket event handler (accept new connections)
 static void listen_event_handler(cwh_loop_t *loop, int fd, int events, void *data)
 {
-    printf("[SERVER] listen_event_handler called! fd=%d events=%d\n", fd, events);
+    (void)fd;
+    (void)events;
 
     cwh_async_server_t *server = (cwh_async_server_t *)data;
 
-    // Periodically check and close idle connections
-    check_and_close_idle_connections(server);
-
     // Accept multiple connections in a loop (batch accept)
     while (server->running && server->conn_count < server->max_connections)
     {
@@ -674,13 +1553,38 @@ static void listen_event_handler(cwh_loop_t *loop, int fd, int events, void *dat
             continue;
         }
 
-        // Register for READ events
-        if (cwh_loop_add(server->loop, client_fd, CWH_EVENT_READ,
-                         connection_event_handler, conn) < 0)
+        // Register for READ events (edge mode: both directions, once). Plain TCP
+        // connections let an io_uring loop do their recv/send (no syscall each).
+        int flags = cwh_loop_flags(server->loop);
+        conn->edge = server->edge_triggered && (flags & CWH_EVENT_EDGE);
+        conn->loop_io = !conn->tls_session && (flags & CWH_EVENT_COMPLETION);
+        int events = conn->edge ? CWH_EDGE_EVENTS : CWH_EVENT_READ;
+        if (conn->loop_io)
+            events |= CWH_EVENT_COMPLETION;
+        if (cwh_loop_add(server->loop, client_fd, events, connection_event_handler, conn) < 0)
         {
             close_connection(conn);
             continue;
         }
+
+        // Request (or TLS handshake) must complete within the header timeout
+        arm_connection_timer(conn, CONN_TIMEOUT_HEADER);
+    }
+}
+
+// Events the connection state machine acts on in its current state
+static int state_events(cwh_async_conn_t *conn)
+{
+    switch (conn->state)
+    {
+    case CONN_STATE_NEW:
+        return conn->events & (CWH_EVENT_READ | CWH_EVENT_WRITE); // Handshake waits either way
+    case CONN_STATE_READING_REQUEST:
+        return conn->events & CWH_EVENT_READ;
+    case CONN_STATE_WRITING_RESPONSE:
+        return conn->events & CWH_EVENT_WRITE;
+    default:
+        return 0; // Waiting for the handler's reply
     }
 }
 
@@ -688,14 +1592,10 @@ static void listen_event_handler(cwh_loop_t *loop, int fd, int events, void *dat
 static void connection_event_handler(cwh_loop_t *loop, int fd, int events, void *data)
 {
     (void)loop;
-
-    printf("[SERVER] connection_event_handler: fd=%d events=%d\n", fd, events);
+    (void)fd;
 
     cwh_async_conn_t *conn = (cwh_async_conn_t *)data;
 
-    // Update last activity
-    conn->last_activity = time(NULL);
-
     // Handle errors
     if (events & CWH_EVENT_ERROR)
     {
@@ -703,37 +1603,60 @@ static void connection_event_handler(cwh_loop_t *loop, int fd, int events, void
         return;
     }
 
-    // State machine
-    printf("[SERVER] Connection state: %d\n", conn->state);
+    if (!conn->edge)
+    {
+        connection_step(conn, events);
+        return;
+    }
+
+    // Edge-triggered: this readiness won't be reported again, so step until
+    // the socket would block (read_request/write_response clear the ready
+    // bit) or the state stops waiting for what is ready
+    bool closed = false;
+    conn->closed = &closed;
+    conn->ready |= events;
+
+    int steps = 0;
+    int wanted;
+    while ((wanted = conn->ready & state_events(conn)) != 0)
+    {
+        if (steps++ == CWH_EDGE_STEPS)
+        {
+            // Busy connection: let other fds run, come back on a fresh edge
+            cwh_loop_mod(conn->server->loop, conn->fd, CWH_EDGE_EVENTS);
+            break;
+        }
+
+        connection_step(conn, wanted);
+        if (closed)
+            return;
+    }
+
+    conn->closed = NULL;
+}
 
+// Advance the connection state machine on READ/WRITE readiness
+static void connection_step(cwh_async_conn_t *conn, int events)
+{
     switch (conn->state)
     {
     case CONN_STATE_NEW:
+#if CWH_TLS_OFFLOAD
+        if (conn->tls_session && conn->server->tls_pool)
+        {
+            tls_submit(conn); // Key exchange and signing run off the loop
+            break;
+        }
+#endif
 #if CWEBHTTP_ENABLE_TLS
         if (conn->tls_session && !conn->tls_handshake_done)
         {
-            cwh_tls_error_t tls_err = cwh_tls_handshake(conn->tls_session);
-            if (tls_err == CWH_TLS_OK)
-            {
-                conn->tls_handshake_done = true;
-                const char *sni = cwh_tls_get_sni_hostname(conn->tls_session);
-                if (sni)
-                {
-                    printf("[SERVER] TLS handshake complete, SNI: %s\n", sni);
-                }
-                if (cwh_tls_client_cert_verified(conn->tls_session))
-                {
-                    const char *subject = cwh_tls_get_client_cert_subject(conn->tls_session);
-                    printf("[SERVER] Client cert verified: %s\n", subject ? subject : "unknown");
-                }
-                conn->state = CONN_STATE_READING_REQUEST;
-            }
-            else if (tls_err != CWH_TLS_ERR_HANDSHAKE)
-            {
-                printf("[SERVER] TLS handshake failed: %s\n", cwh_tls_error_string(tls_err));
-                close_connection(conn);
-                return;
-            }
+            cwh_tls_error_t tls_err = cwh_tls_handshake_step(conn->tls_session);
+            if (tls_err == CWH_TLS_WANT_READ)
+                conn->ready &= ~CWH_EVENT_READ; // Wait for the peer's next flight
+            else if (tls_err == CWH_TLS_WANT_WRITE)
+                conn->ready &= ~CWH_EVENT_WRITE;
+            handshake_result(conn, tls_err);
         }
         else
 #endif
@@ -745,23 +1668,38 @@ static void connection_event_handler(cwh_loop_t *loop, int fd, int events, void
     case CONN_STATE_READING_REQUEST:
         if (events & CWH_EVENT_READ)
         {
-            printf("[SERVER] READ event, calling read_request...\n");
+            bool was_waiting = conn->recv_len == 0;
             int result = read_request(conn);
-            printf("[SERVER] read_request returned: %d, request_complete=%d\n",
-                   result, conn->request_complete);
+
+            if (result == -2 || result == -3)
+            {
+                // Too large (CWH_MAX_REQUEST_SIZE) or malformed framing: reply and close
+                reject_request(conn, result);
+                start_writing(conn);
+                return;
+            }
 
             if (result < 0)
             {
-                printf("[SERVER] ERROR: read_request failed\n");
                 close_connection(conn);
                 return;
             }
 
+            if (result == 2 || conn->body_route)
+            {
+                // Streamed body: headers just arrived, or more of the body did
+                body_progress(conn, result == 2 ? start_body_request(conn) : result);
+                return;
+            }
+
             if (conn->request_complete)
             {
-                printf("[SERVER] Request complete, processing...\n");
-                conn->state = CONN_STATE_PROCESSING;
-                process_request(conn);
+                dispatch_requests(conn);
+            }
+            else if (was_waiting && conn->recv_len > 0 && conn->wait == CONN_TIMEOUT_KEEPALIVE)
+            {
+                // Next request started on a keep-alive connection
+                arm_connection_timer(conn, CONN_TIMEOUT_HEADER);
             }
         }
         break;
@@ -769,6 +1707,13 @@ static void connection_event_handler(cwh_loop_t *loop, int fd, int events, void
     case CONN_STATE_WRITING_RESPONSE:
         if (events & CWH_EVENT_WRITE)
         {
+            if (conn->failed)
+            {
+                close_connection(conn); // Response could not be queued
+                return;
+            }
+
+            uint64_t sent_before = conn->bytes_sent;
             int result = write_response(conn);
             if (result < 0)
             {
@@ -778,24 +1723,14 @@ static void connection_event_handler(cwh_loop_t *loop, int fd, int events, void
 
             if (result == 0)
             {
-                // Response fully sent
-                if (conn->keep_alive)
-                {
-                    // Reset for next request
-                    conn->state = CONN_STATE_READING_REQUEST;
-                    conn->recv_len = 0;
-                    conn->send_len = 0;
-                    conn->send_offset = 0;
-                    conn->request_complete = false;
-                    memset(&conn->request, 0, sizeof(conn->request));
-
-                    // Switch to READ events
-                    cwh_loop_mod(conn->server->loop, conn->fd, CWH_EVENT_READ);
-                }
-                else
-                {
-                    close_connection(conn);
-                }
+                // Everything queued is sent
+                output_drained(conn);
+            }
+            else if (conn->bytes_sent > sent_before)
+            {
+                // Partial write made progress
+                arm_connection_timer(conn, CONN_TIMEOUT_IDLE);
+                stream_check_drain(conn);
             }
         }
         break;
@@ -806,64 +1741,344 @@ static void connection_event_handler(cwh_loop_t *loop, int fd, int events, void
 }
 
 // ============================================================================
-// Request/Response I/O
+// TLS Handshake Offload
 // ============================================================================
 
-// TLS-aware recv wrapper
-static ssize_t conn_recv_tls(cwh_async_conn_t *conn, char *buf, size_t len)
-{
 #if CWEBHTTP_ENABLE_TLS
-    if (conn->tls_session)
+// Act on a handshake step's result (run inline or by a worker)
+static void handshake_result(cwh_async_conn_t *conn, cwh_tls_error_t tls_err)
+{
+    if (tls_err == CWH_TLS_OK)
     {
-        // For TLS server, we need to handle handshake first
-        if (!conn->tls_handshake_done)
+        conn->tls_handshake_done = true;
+        const char *sni = cwh_tls_get_sni_hostname(conn->tls_session);
+        if (sni)
         {
-            cwh_tls_error_t tls_err = cwh_tls_handshake(conn->tls_session);
-            if (tls_err == CWH_TLS_OK)
-            {
-                conn->tls_handshake_done = true;
-                // Continue to read
-            }
-            else
-            {
-                // Handshake failed or needs more data
-                return -1;
-            }
+            printf("[SERVER] TLS handshake complete, SNI: %s\n", sni);
         }
-
-        return cwh_tls_read(conn->tls_session, buf, len);
+        if (cwh_tls_client_cert_verified(conn->tls_session))
+        {
+            const char *subject = cwh_tls_get_client_cert_subject(conn->tls_session);
+            printf("[SERVER] Client cert verified: %s\n", subject ? subject : "unknown");
+        }
+        if (conn->server->ktls)
+            conn->ktls = cwh_tls_enable_ktls(conn->tls_session);
+        conn->state = CONN_STATE_READING_REQUEST;
+        set_conn_events(conn, CWH_EVENT_READ);
+    }
+    else if (tls_err == CWH_TLS_WANT_READ || tls_err == CWH_TLS_WANT_WRITE)
+    {
+        conn->state = CONN_STATE_NEW;
+        set_conn_events(conn, tls_err == CWH_TLS_WANT_WRITE ? CWH_EVENT_WRITE : CWH_EVENT_READ);
+    }
+    else
+    {
+        printf("[SERVER] TLS handshake failed: %s\n", cwh_tls_error_string(tls_err));
+        close_connection(conn);
     }
-#endif
-
-    // Plain TCP recv
-    return recv(conn->fd, buf, (int)len, 0);
 }
+#endif
 
-// TLS-aware send wrapper
-static ssize_t conn_send_tls(cwh_async_conn_t *conn, const char *buf, size_t len)
+#if CWH_TLS_OFFLOAD
+// Worker: run queued handshake steps, hand each connection back to its loop
+static void *tls_worker_main(void *arg)
 {
-#if CWEBHTTP_ENABLE_TLS
-    if (conn->tls_session && conn->tls_handshake_done)
+    cwh_tls_pool_t *pool = (cwh_tls_pool_t *)arg;
+
+    pthread_mutex_lock(&pool->lock);
+    for (;;)
     {
-        return cwh_tls_write(conn->tls_session, buf, len);
+        while (!pool->head && !pool->stopping)
+            pthread_cond_wait(&pool->cond, &pool->lock);
+        if (!pool->head)
+            break; // Stopping, queue empty
+
+        cwh_async_conn_t *conn = pool->head;
+        pool->head = conn->tls_next;
+        if (!pool->head)
+            pool->tail = NULL;
+        bool closing = conn->tls_closing;
+        pthread_mutex_unlock(&pool->lock);
+
+        // The loop doesn't touch the connection until it is handed back
+        cwh_tls_error_t err = closing ? CWH_TLS_ERR_HANDSHAKE : cwh_tls_handshake_step(conn->tls_session);
+
+        pthread_mutex_lock(&pool->lock);
+        cwh_async_server_t *server = conn->server;
+        conn->tls_result = err;
+        conn->tls_next = server->tls_done;
+        server->tls_done = conn;
+        if (!conn->tls_next)
+        {
+            // First finished step since the loop last looked: wake it
+            ssize_t n = write(server->tls_wake[1], "", 1);
+            (void)n; // Full pipe: a wakeup is pending anyway
+        }
     }
-#endif
-
-    // Plain TCP send
-    return send(conn->fd, buf, (int)len, 0);
+    pthread_mutex_unlock(&pool->lock);
+    return NULL;
 }
 
-// Read request data (non-blocking)
-static int read_request(cwh_async_conn_t *conn)
+// Hand the connection's next handshake step to a worker
+static void tls_submit(cwh_async_conn_t *conn)
 {
-    ssize_t n;
+    cwh_async_server_t *server = conn->server;
+    cwh_tls_pool_t *pool = server->tls_pool;
+
+    // The worker consumes this readiness; don't watch the socket meanwhile
+    conn->state = CONN_STATE_HANDSHAKING;
+    conn->ready &= ~(CWH_EVENT_READ | CWH_EVENT_WRITE);
+    set_conn_events(conn, 0);
+    server->tls_inflight++;
+
+    pthread_mutex_lock(&pool->lock);
+    conn->tls_next = NULL;
+    if (pool->tail)
+        pool->tail->tls_next = conn;
+    else
+        pool->head = conn;
+    pool->tail = conn;
+    pthread_cond_signal(&pool->cond);
+    pthread_mutex_unlock(&pool->lock);
+}
+
+// Loop: pick up steps the workers finished
+static void tls_wake_handler(cwh_loop_t *loop, int fd, int events, void *data)
+{
+    (void)loop;
+    (void)events;
+
+    cwh_async_server_t *server = (cwh_async_server_t *)data;
+    char drain[64];
+    while (read(fd, drain, sizeof(drain)) > 0)
+        ;
+
+    pthread_mutex_lock(&server->tls_pool->lock);
+    cwh_async_conn_t *done = server->tls_done;
+    server->tls_done = NULL;
+    pthread_mutex_unlock(&server->tls_pool->lock);
+
+    while (done)
+    {
+        cwh_async_conn_t *conn = done;
+        done = conn->tls_next;
+        conn->tls_next = NULL;
+        server->tls_inflight--;
+
+        conn->state = CONN_STATE_NEW;
+        if (conn->tls_closing)
+        {
+            close_connection(conn); // Closed while on the worker
+            continue;
+        }
+
+        // The request may have arrived right behind the last flight, before
+        // the worker's read: no fresh edge will announce it
+        if (conn->tls_result == CWH_TLS_OK)
+            conn->ready |= CWH_EVENT_READ;
+        handshake_result(conn, conn->tls_result);
+    }
+}
+
+// Wait until no connection of this loop is queued or on a worker
+static void tls_drain(cwh_async_server_t *server)
+{
+    while (server->tls_inflight > 0)
+    {
+        struct pollfd pfd = {.fd = server->tls_wake[0], .events = POLLIN};
+        if (poll(&pfd, 1, -1) < 0 && errno != EINTR)
+            break;
+        tls_wake_handler(server->loop, server->tls_wake[0], CWH_EVENT_READ, server);
+    }
+}
+
+// Wakeup pipe for one loop
+static int tls_wake_open(cwh_async_server_t *server)
+{
+    if (pipe(server->tls_wake) < 0)
+    {
+        server->tls_wake[0] = server->tls_wake[1] = -1;
+        return -1;
+    }
+    if (cwh_set_nonblocking(server->tls_wake[0]) < 0 ||
+        cwh_set_nonblocking(server->tls_wake[1]) < 0 ||
+        cwh_loop_add(server->loop, server->tls_wake[0], CWH_EVENT_READ, tls_wake_handler, server) < 0)
+    {
+        close(server->tls_wake[0]);
+        close(server->tls_wake[1]);
+        server->tls_wake[0] = server->tls_wake[1] = -1;
+        return -1;
+    }
+    return 0;
+}
+
+// Start the worker pool and connect every loop of the server to it
+static int start_tls_workers(cwh_async_server_t *server)
+{
+    if (!server->use_tls || server->tls_workers <= 0 || server->tls_pool)
+        return 0;
+
+    cwh_tls_pool_t *pool = (cwh_tls_pool_t *)calloc(1, sizeof(cwh_tls_pool_t));
+    if (!pool)
+        return -1;
+    pool->threads = (pthread_t *)calloc(server->tls_workers, sizeof(pthread_t));
+    if (!pool->threads)
+    {
+        free(pool);
+        return -1;
+    }
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->cond, NULL);
+    server->tls_pool = pool;
+
+    while (pool->num_threads < server->tls_workers)
+    {
+        if (pthread_create(&pool->threads[pool->num_threads], NULL, tls_worker_main, pool) != 0)
+            return -1; // stop_tls_workers (cwh_async_server_free) joins the rest
+        pool->num_threads++;
+    }
+
+    int loops = server->shards ? server->num_shards : 1;
+    for (int i = 0; i < loops; i++)
+    {
+        cwh_async_server_t *target = server->shards ? server->shards[i] : server;
+        target->tls_pool = pool;
+        if (tls_wake_open(target) < 0)
+            return -1;
+    }
+    return 0;
+}
+
+// Disconnect this loop from the pool; the owner also stops the workers
+static void stop_tls_workers(cwh_async_server_t *server)
+{
+    if (server->tls_wake[0] >= 0)
+    {
+        cwh_loop_del(server->loop, server->tls_wake[0]);
+        close(server->tls_wake[0]);
+        close(server->tls_wake[1]);
+        server->tls_wake[0] = server->tls_wake[1] = -1;
+    }
+
+    cwh_tls_pool_t *pool = server->tls_pool;
+    server->tls_pool = NULL;
+    if (!pool || server->parent)
+        return;
+
+    pthread_mutex_lock(&pool->lock);
+    pool->stopping = true;
+    pthread_cond_broadcast(&pool->cond);
+    pthread_mutex_unlock(&pool->lock);
+
+    for (int i = 0; i < pool->num_threads; i++)
+        pthread_join(pool->threads[i], NULL);
+
+    pthread_mutex_destroy(&pool->lock);
+    pthread_cond_destroy(&pool->cond);
+    free(pool->threads);
+    free(pool);
+}
+#endif
+
+// ============================================================================
+// Request/Response I/O
+// ============================================================================
+
+#if CWEBHTTP_ENABLE_TLS
+// TLS has to wait for the socket: fail the way a would-block recv/send does
+static ssize_t tls_would_block(void)
+{
+#ifdef _WIN32
+    WSASetLastError(WSAEWOULDBLOCK);
+#else
+    errno = EAGAIN;
+#endif
+    return -1;
+}
+#endif
+
+// TLS-aware recv wrapper
+static ssize_t conn_recv_tls(cwh_async_conn_t *conn, char *buf, size_t len)
+{
+#if CWEBHTTP_ENABLE_TLS
+    if (conn->tls_session)
+    {
+        // For TLS server, we need to handle handshake first
+        if (!conn->tls_handshake_done)
+        {
+            cwh_tls_error_t tls_err = cwh_tls_handshake_step(conn->tls_session);
+            if (tls_err == CWH_TLS_OK)
+            {
+                conn->tls_handshake_done = true;
+                // Continue to read
+            }
+            else
+            {
+                // Handshake failed or needs more data
+                if (tls_err == CWH_TLS_WANT_READ || tls_err == CWH_TLS_WANT_WRITE)
+                    return tls_would_block();
+                return -1;
+            }
+        }
+
+        int n = cwh_tls_read(conn->tls_session, buf, len);
+        if (n == 0)
+            return tls_would_block(); // Not EOF
+        if (n < 0 && cwh_tls_eof(conn->tls_session))
+            return 0;
+        return n;
+    }
+#endif
+
+    // Plain TCP recv (io_uring: bytes the loop already received)
+    if (conn->loop_io)
+        return cwh_loop_recv(conn->server->loop, conn->fd, buf, len);
+    return recv(conn->fd, buf, (int)len, 0);
+}
+
+// TLS-aware send wrapper
+static ssize_t conn_send_tls(cwh_async_conn_t *conn, const char *buf, size_t len)
+{
+#if CWEBHTTP_ENABLE_TLS
+    if (conn->tls_session && conn->tls_handshake_done)
+    {
+        int n = cwh_tls_write(conn->tls_session, buf, len);
+        return n == 0 ? tls_would_block() : n;
+    }
+#endif
+
+    // Plain TCP send (io_uring: queued, sent with the loop's next wait)
+    if (conn->loop_io)
+        return cwh_loop_send(conn->server->loop, conn->fd, buf, len);
+    return send(conn->fd, buf, (int)len, CWH_SEND_FLAGS);
+}
+
+// Read request data (non-blocking)
+// Returns 0 when complete, 1 if more data is needed, -1 on error, -2 if too large,
+// -3 if the request is malformed (status in conn->parser.error_status)
+static int read_request(cwh_async_conn_t *conn)
+{
+    ssize_t n;
+    bool fresh = !conn->recv_buf;
+
+    // Attach a buffer for this request, grow it when full
+    if (fresh)
+    {
+        conn->recv_buf = buf_acquire(conn->server, CWH_CONN_BUF_SIZE, &conn->recv_cap);
+        if (!conn->recv_buf)
+            return -1;
+    }
+    else if (conn->recv_len + 1 >= conn->recv_cap && grow_recv_buf(conn) < 0)
+    {
+        return -2; // Request too large
+    }
 
 #ifdef _WIN32
     // On Windows with IOCP, check if there's buffered data first
     // The data was already received by WSARecv into the IOCP buffer
     int iocp_bytes = cwh_loop_get_iocp_data(conn->server->loop, conn->fd,
                                             conn->recv_buf + conn->recv_len,
-                                            sizeof(conn->recv_buf) - conn->recv_len - 1);
+                                            (int)(conn->recv_cap - conn->recv_len - 1));
     if (iocp_bytes > 0)
     {
         printf("[SERVER] Using %d bytes from IOCP buffer\n", iocp_bytes);
@@ -873,9 +2088,14 @@ static int read_request(cwh_async_conn_t *conn)
 #endif
     {
         // Use TLS-aware recv wrapper
-        n = conn_recv_tls(conn,
-                          conn->recv_buf + conn->recv_len,
-                          sizeof(conn->recv_buf) - conn->recv_len - 1);
+        size_t want = conn->recv_cap - conn->recv_len - 1;
+        n = conn_recv_tls(conn, conn->recv_buf + conn->recv_len, want);
+
+        // Short plain read: the socket is drained and new data brings a new
+        // edge, so edge mode needn't confirm with a recv that fails. A FIN
+        // reported with this edge won't come again; keep reading up to it.
+        if (n > 0 && (size_t)n < want && !conn->tls_session && !(conn->ready & CWH_EVENT_RDHUP))
+            conn->ready &= ~CWH_EVENT_READ;
     }
 
     if (n > 0)
@@ -883,23 +2103,7 @@ static int read_request(cwh_async_conn_t *conn)
         conn->recv_len += n;
         conn->recv_buf[conn->recv_len] = '\0';
 
-        // Try to parse request
-        if (cwh_parse_req(conn->recv_buf, conn->recv_len, &conn->request) == CWH_OK)
-        {
-            conn->request_complete = true;
-
-            // Check for keep-alive
-            const char *connection_header = cwh_get_header(&conn->request, "connection");
-            if (connection_header && strcasecmp(connection_header, "keep-alive") == 0)
-            {
-                conn->keep_alive = true;
-            }
-
-            return 0;
-        }
-
-        // Need more data (request incomplete)
-        return 1;
+        return parse_request(conn);
     }
 
     if (n == 0)
@@ -912,55 +2116,526 @@ static int read_request(cwh_async_conn_t *conn)
         return 1; // Would block, wait for more data
 #else
     if (errno == EAGAIN || errno == EWOULDBLOCK)
+    {
+        // Drained: edge mode waits for the next edge, without holding a
+        // buffer if nothing of the next request arrived
+        conn->ready &= ~CWH_EVENT_READ;
+        if (fresh)
+            release_recv_buf(conn);
         return 1; // Would block, wait for more data
+    }
 #endif
 
     return -1; // Error
 }
 
-// Write response data (non-blocking)
-static int write_response(cwh_async_conn_t *conn)
+// Run the parser over the buffered bytes
+// Returns 0 when a request is complete, 1 if more data is needed, 2 when the
+// headers of a streamed-body request are in (see start_body_request), -2 if
+// too large, -3 if the request is malformed (status in conn->parser.error_status)
+static int parse_request(cwh_async_conn_t *conn)
 {
-    // Use TLS-aware send wrapper
-    ssize_t n = conn_send_tls(conn,
-                              conn->send_buf + conn->send_offset,
-                              conn->send_len - conn->send_offset);
+    if (conn->body_route)
+        return deliver_body(conn);
 
-    if (n > 0)
+    // The parser resumes where the previous read stopped
+    cwh_parse_status_t status = cwh_parser_execute(&conn->parser, conn->recv_buf,
+                                                   conn->recv_len, &conn->request);
+    if (status == CWH_PARSE_HEADERS_DONE)
     {
-        conn->send_offset += n;
+        // Routes with on_body take the body piece by piece through a fixed window
+        cwh_async_server_t *owner = route_owner(conn->server);
+        if (owner->body_routes > 0)
+        {
+            cwh_async_route_t *route = find_route(owner, request_method(&conn->request),
+                                                  &conn->request);
+            if (route && route->on_body)
+            {
+                conn->body_route = route;
+                while (conn->recv_cap < CWH_BODY_BUF_SIZE && grow_recv_buf(conn) == 0)
+                    ;
+                // Rebases the request onto the grown buffer
+                if (cwh_parser_execute(&conn->parser, conn->recv_buf, conn->recv_len,
+                                       &conn->request) == CWH_PARSE_ERROR)
+                    return -3;
+                return 2;
+            }
+        }
 
-        if (conn->send_offset >= conn->send_len)
+        // Reject oversized bodies up front, otherwise size the buffer once
+        uint64_t needed = conn->parser.header_len + conn->parser.content_length + 1;
+        if (needed > CWH_MAX_REQUEST_SIZE)
+            return -2;
+        while (conn->recv_cap < needed)
         {
-            return 0; // All sent
+            if (grow_recv_buf(conn) < 0)
+                return -2;
         }
 
-        return 1; // More to send
+        status = cwh_parser_execute(&conn->parser, conn->recv_buf, conn->recv_len, &conn->request);
+    }
+
+    if (status == CWH_PARSE_ERROR)
+        return -3;
+
+    if (status == CWH_PARSE_BODY_DONE)
+    {
+        conn->request_complete = true;
+        return 0;
+    }
+
+    // Need more data (request incomplete)
+    return 1;
+}
+
+#ifndef _WIN32
+// Gathered send through the loop (CWH_EVENT_COMPLETION), stopping at the
+// first piece its queue doesn't take whole
+static ssize_t loop_sendv(cwh_async_conn_t *conn, const struct iovec *iov, int count)
+{
+    ssize_t total = 0;
+    for (int i = 0; i < count; i++)
+    {
+        int n = cwh_loop_send(conn->server->loop, conn->fd, iov[i].iov_base, iov[i].iov_len);
+        if (n < 0)
+            return total > 0 ? total : -1;
+        total += n;
+        if ((size_t)n < iov[i].iov_len)
+            break;
+    }
+    return total;
+}
+#endif
+
+// Send buffered bytes from the head of the queue. On plain TCP the blocks and
+// caller buffers of up to CWH_MAX_IOV pieces (e.g. pipelined responses) go
+// out in one sendmsg (io_uring: one queued SEND). Fully sent segments without
+// a file body are popped.
+// Returns 0 on progress, 1 if the socket is full, -1 on error
+static int write_blocks(cwh_async_conn_t *conn)
+{
+    ssize_t n;
+#ifndef _WIN32
+    if (!conn->tls_session || conn->ktls)
+    {
+        struct iovec iov[CWH_MAX_IOV];
+        int count = 0;
+        for (cwh_out_seg_t *seg = conn->out_head; seg && count < CWH_MAX_IOV; seg = seg->next)
+        {
+            if (seg->offset < seg->len)
+            {
+                iov[count].iov_base = seg->buf + seg->offset;
+                iov[count].iov_len = seg->len - seg->offset;
+                count++;
+            }
+            for (int i = seg->iov_index; i < seg->iovcnt && count < CWH_MAX_IOV; i++)
+            {
+                size_t skip = i == seg->iov_index ? seg->iov_offset : 0;
+                iov[count].iov_base = (char *)seg->iov[i].base + skip;
+                iov[count].iov_len = seg->iov[i].len - skip;
+                count++;
+            }
+            if (seg->file_remaining > 0)
+                break; // File body goes out before any later block
+        }
+        if (conn->loop_io)
+        {
+            n = loop_sendv(conn, iov, count);
+        }
+        else
+        {
+            struct msghdr msg;
+            memset(&msg, 0, sizeof(msg));
+            msg.msg_iov = iov;
+            msg.msg_iovlen = count;
+            n = sendmsg(conn->fd, &msg, CWH_SEND_FLAGS);
+        }
+    }
+    else
+#endif
+    {
+        // Use TLS-aware send wrapper (one piece at a time)
+        cwh_out_seg_t *seg = conn->out_head;
+        if (seg->offset < seg->len)
+            n = conn_send_tls(conn, seg->buf + seg->offset, seg->len - seg->offset);
+        else
+            n = conn_send_tls(conn, (const char *)seg->iov[seg->iov_index].base + seg->iov_offset,
+                              seg->iov[seg->iov_index].len - seg->iov_offset);
     }
 
+    if (n <= 0)
+    {
 #ifdef _WIN32
-    if (n < 0 && WSAGetLastError() == WSAEWOULDBLOCK)
-        return 1; // Would block, wait for writable
+        if (n < 0 && WSAGetLastError() == WSAEWOULDBLOCK)
+            return 1; // Would block, wait for writable
 #else
-    if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
-        return 1; // Would block, wait for writable
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+            return 1; // Would block, wait for writable
 #endif
+        return -1; // Error
+    }
 
-    return -1; // Error
+    conn->bytes_sent += (uint64_t)n;
+    conn->out_pending -= (size_t)n;
+    size_t left = (size_t)n;
+    while (left > 0 && conn->out_head)
+    {
+        cwh_out_seg_t *seg = conn->out_head;
+        left = seg_advance(seg, left);
+        if (seg_pending(seg) || seg->file_remaining > 0)
+            break;
+        out_pop(conn);
+    }
+    return 0;
+}
+
+// Stream the file body of the head segment; returns 0 when done, 1 if blocked, -1 on error
+static int send_file_body(cwh_async_conn_t *conn, cwh_out_seg_t *seg)
+{
+    while (seg->file_remaining > 0)
+    {
+#ifdef __linux__
+        // Zero-copy path: page cache -> socket, no user-space copy (with
+        // kernel TLS the kernel encrypts on the way)
+        if (!conn->tls_session || conn->ktls)
+        {
+            off_t off = (off_t)seg->file_offset;
+            size_t chunk = seg->file_remaining > CWH_SENDFILE_CHUNK ? CWH_SENDFILE_CHUNK
+                                                                    : (size_t)seg->file_remaining;
+            ssize_t n = conn->loop_io ? cwh_loop_sendfile(conn->server->loop, conn->fd, seg->file->fd,
+                                                          seg->file_offset, chunk)
+                                      : sendfile(conn->fd, seg->file->fd, &off, chunk);
+            if (n > 0)
+            {
+                seg->file_offset += n;
+                seg->file_remaining -= n;
+                conn->bytes_sent += n;
+                continue;
+            }
+            if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+                return 1;
+            return -1; // Error or file truncated under us
+        }
+#endif
+
+        // Portable / TLS path: read a chunk into the segment block and send it
+        size_t want = seg->file_remaining > seg->cap ? seg->cap : (size_t)seg->file_remaining;
+#ifdef _WIN32
+        if (_lseeki64(seg->file->fd, (__int64)seg->file_offset, SEEK_SET) < 0)
+            return -1;
+        int n = _read(seg->file->fd, seg->buf, (unsigned int)want);
+#else
+        ssize_t n = pread(seg->file->fd, seg->buf, want, (off_t)seg->file_offset);
+#endif
+        if (n <= 0)
+            return -1;
+
+        seg->file_offset += n;
+        seg->file_remaining -= n;
+        seg->len = (size_t)n;
+        seg->offset = 0;
+        conn->out_pending += (size_t)n;
+
+        while (seg->offset < seg->len)
+        {
+            ssize_t sent = conn_send_tls(conn, seg->buf + seg->offset, seg->len - seg->offset);
+            if (sent <= 0)
+            {
+#ifdef _WIN32
+                if (sent < 0 && WSAGetLastError() == WSAEWOULDBLOCK)
+                    return 1;
+#else
+                if (sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+                    return 1; // Rest of the chunk goes out via write_blocks
+#endif
+                return -1;
+            }
+            seg->offset += (size_t)sent;
+            conn->bytes_sent += (uint64_t)sent;
+            conn->out_pending -= (size_t)sent;
+        }
+    }
+
+    return 0;
+}
+
+// Write queued output (non-blocking)
+// Returns 0 when everything queued is sent, 1 if more remains, -1 on error
+static int write_response(cwh_async_conn_t *conn)
+{
+    int ret = 0;
+    while (conn->out_head)
+    {
+        cwh_out_seg_t *seg = conn->out_head;
+
+        if (seg_pending(seg))
+        {
+            ret = write_blocks(conn);
+            if (ret != 0)
+                break;
+            continue;
+        }
+
+        if (seg->file_remaining > 0)
+        {
+            ret = send_file_body(conn, seg);
+            if (ret != 0)
+                break;
+            if (seg->offset < seg->len)
+                continue; // Last chunk only partially sent
+        }
+
+        out_pop(conn);
+    }
+
+    if (ret > 0)
+        conn->ready &= ~CWH_EVENT_WRITE; // Socket full: edge mode waits for the next edge
+    return ret;
 }
 
 // Process request and generate response
+// ============================================================================
+// Request Dispatch
+// ============================================================================
+
+// Queue an error reply for a request that cannot be served; the connection
+// closes once it is sent
+static void reject_request(cwh_async_conn_t *conn, int result)
+{
+    if (conn->responded)
+    {
+        // A streamed-body handler already replied; just close after it
+        conn->keep_alive = false;
+        return;
+    }
+
+    bool batching = conn->batching;
+    conn->batching = true;
+    conn->keep_alive = false;
+    conn->request_complete = false;
+    if (result == -2)
+        cwh_async_send_status(conn, 413, "Payload Too Large");
+    else if (conn->parser.error_status == 501)
+        cwh_async_send_status(conn, 501, "Not Implemented");
+    else
+        cwh_async_send_status(conn, 400, "Bad Request");
+    conn->batching = batching;
+}
+
+// Drop the answered request and parse whatever was pipelined behind it
+static void next_request(cwh_async_conn_t *conn)
+{
+    size_t consumed = conn->parser.consumed;
+    size_t leftover = conn->recv_len > consumed ? conn->recv_len - consumed : 0;
+    if (conn->recv_pin)
+    {
+        // Queued output still points into the request (cwh_async_send_iov of
+        // req->body): the buffer goes with that segment, leftover moves out
+        char *old = conn->recv_buf;
+        conn->recv_pin->retired = old;
+        conn->recv_pin->retired_cap = conn->recv_cap;
+        conn->recv_pin = NULL;
+        conn->recv_buf = NULL;
+        conn->recv_cap = 0;
+        if (leftover > 0)
+        {
+            conn->recv_buf = buf_acquire(conn->server, leftover + 1, &conn->recv_cap);
+            if (!conn->recv_buf)
+            {
+                conn->recv_len = 0;
+                out_fail(conn);
+                return;
+            }
+            memcpy(conn->recv_buf, old + consumed, leftover);
+        }
+    }
+    else if (leftover > 0)
+    {
+        memmove(conn->recv_buf, conn->recv_buf + consumed, leftover);
+    }
+    conn->recv_len = leftover;
+    if (conn->recv_buf)
+        conn->recv_buf[leftover] = '\0';
+
+    cwh_parser_init(&conn->parser);
+    memset(&conn->request, 0, sizeof(conn->request));
+    conn->request_complete = false;
+    conn->responded = false;
+    conn->body_route = NULL;
+    conn->body_paused = false;
+
+    if (leftover > 0)
+    {
+        int result = parse_request(conn);
+        if (result == 2)
+            result = start_body_request(conn);
+        if (result == -2 || result == -3)
+            reject_request(conn, result);
+    }
+}
+
+// Run handlers for every complete request in the buffer. Synchronous replies
+// are collected and written together (in request order) afterwards.
+static void dispatch_requests(cwh_async_conn_t *conn)
+{
+    arm_connection_timer(conn, CONN_TIMEOUT_IDLE);
+
+    conn->batching = true;
+    while (conn->request_complete && !conn->responded)
+    {
+        conn->state = CONN_STATE_PROCESSING;
+        if (!conn->body_route)
+            process_request(conn); // Streamed-body handlers ran when the headers arrived
+        if (conn->failed || !conn->responded || conn->streaming || !conn->keep_alive)
+            break; // Error, deferred or streamed reply, or last request on this connection
+        next_request(conn);
+    }
+    conn->batching = false;
+
+    if (conn->failed)
+    {
+        close_connection(conn);
+        return;
+    }
+
+    if (conn->out_head)
+        start_writing(conn);
+    else
+        output_drained(conn);
+}
+
+// Write queued output now, waiting for WRITE events if the socket fills up
+static void start_writing(cwh_async_conn_t *conn)
+{
+    conn->state = CONN_STATE_WRITING_RESPONSE;
+    int result = write_response(conn);
+    if (result < 0)
+    {
+        close_connection(conn);
+        return;
+    }
+
+    if (result > 0)
+    {
+        set_conn_events(conn, CWH_EVENT_WRITE);
+        arm_connection_timer(conn, CONN_TIMEOUT_IDLE);
+        return;
+    }
+
+    output_drained(conn);
+}
+
+// All queued output is sent: wait for a deferred reply, serve the next
+// pipelined request, or go back to reading
+static void output_drained(cwh_async_conn_t *conn)
+{
+    if (conn->streaming)
+    {
+        // Stream still open: nothing to write until the producer adds more
+        conn->state = CONN_STATE_WRITING_RESPONSE;
+        set_conn_events(conn, 0);
+        arm_connection_timer(conn, CONN_TIMEOUT_IDLE);
+        stream_check_drain(conn);
+        return;
+    }
+
+    if (conn->request_complete && !conn->responded)
+    {
+        // Handler replies later (cwh_async_send_* starts the write)
+        conn->state = CONN_STATE_PROCESSING;
+        arm_connection_timer(conn, CONN_TIMEOUT_IDLE);
+        return;
+    }
+
+    if (!conn->keep_alive)
+    {
+        close_connection(conn);
+        return;
+    }
+
+    if (conn->request_complete)
+    {
+        next_request(conn);
+        if (conn->request_complete || conn->responded)
+        {
+            dispatch_requests(conn);
+            return;
+        }
+    }
+
+    conn->state = CONN_STATE_READING_REQUEST;
+    if (conn->body_route)
+    {
+        // Streamed body continues (part of it may be held back by a pause)
+        body_progress(conn, deliver_body(conn));
+        return;
+    }
+
+    set_conn_events(conn, CWH_EVENT_READ);
+    if (conn->recv_len > 0)
+    {
+        // Part of the next request is already buffered
+        arm_connection_timer(conn, CONN_TIMEOUT_HEADER);
+    }
+    else
+    {
+        // Idle connections hold no buffers
+        release_recv_buf(conn);
+        arm_connection_timer(conn, CONN_TIMEOUT_KEEPALIVE);
+    }
+}
+
+// Current request is HTTP/1.0 (request line ends with the version)
+static bool request_is_http10(cwh_async_conn_t *conn)
+{
+    const char *line_end = memchr(conn->recv_buf, '\r', conn->parser.header_len);
+    return line_end && line_end - conn->recv_buf > 0 && line_end[-1] == '0';
+}
+
+// Persistent connection decision for the current request: HTTP/1.1 stays
+// open unless "Connection: close", HTTP/1.0 only with "keep-alive"
+static bool request_keep_alive(cwh_async_conn_t *conn)
+{
+    bool keep_alive = !request_is_http10(conn);
+
+    // Connection is a comma-separated token list (value is not NUL-terminated)
+    const char *value = cwh_get_header(&conn->request, "connection");
+    while (value && *value && *value != '\r' && *value != '\n')
+    {
+        while (*value == ' ' || *value == '\t' || *value == ',')
+            value++;
+        const char *token = value;
+        while (*value && *value != ',' && *value != '\r' && *value != '\n' &&
+               *value != ' ' && *value != '\t')
+            value++;
+        size_t len = (size_t)(value - token);
+        if (len == 5 && strncasecmp(token, "close", 5) == 0)
+            return false;
+        if (len == 10 && strncasecmp(token, "keep-alive", 10) == 0)
+            keep_alive = true;
+        while (*value == ' ' || *value == '\t')
+            value++;
+    }
+    return keep_alive;
+}
+
+// Per-request bookkeeping before the handler runs
+static void begin_request(cwh_async_conn_t *conn)
+{
+    conn->server->total_requests++;
+    conn->requests_served++;
+    conn->keep_alive = request_keep_alive(conn);
+}
+
 static void process_request(cwh_async_conn_t *conn)
 {
     cwh_async_server_t *server = conn->server;
-    server->total_requests++;
-    conn->requests_served++;
+    begin_request(conn);
 
-    // Convert method string to enum
-    cwh_method_t method = parse_method(conn->request.method_str);
+    cwh_method_t method = request_method(&conn->request);
 
     // Find matching route
-    cwh_async_route_t *route = find_route(server, method, conn->request.path);
+    cwh_async_route_t *route = find_route(route_owner(server), method, &conn->request);
 
     if (route)
     {
@@ -974,10 +2649,131 @@ static void process_request(cwh_async_conn_t *conn)
     }
 }
 
+// ============================================================================
+// Streamed Request Bodies
+// ============================================================================
+
+// Headers of a streamed-body request are in: run on_headers, then deliver
+// whatever part of the body is already buffered
+static int start_body_request(cwh_async_conn_t *conn)
+{
+    cwh_async_route_t *route = conn->body_route;
+    begin_request(conn);
+    if (route->handler)
+    {
+        conn->body_delivering = true;
+        route->handler(conn, &conn->request, route->user_data);
+        conn->body_delivering = false;
+    }
+    return deliver_body(conn);
+}
+
+// Hand the body bytes decoded so far to on_body and drop them from the buffer
+// Returns 0 once the body is complete, 1 if more is needed (or delivery is
+// paused), -3 on bad framing
+static int deliver_body(cwh_async_conn_t *conn)
+{
+    cwh_async_route_t *route = conn->body_route;
+    if (conn->request_complete)
+        return 0;
+    if (conn->body_paused)
+        return 1;
+
+    cwh_parse_status_t status = cwh_parser_execute(&conn->parser, conn->recv_buf,
+                                                   conn->recv_len, &conn->request);
+    if (status == CWH_PARSE_ERROR)
+        return -3;
+
+    size_t len = conn->parser.body_end - conn->parser.header_len;
+    if (len > 0)
+    {
+        conn->body_delivering = true;
+        route->on_body(conn, CWH_BODY_DATA, conn->recv_buf + conn->parser.header_len, len,
+                       route->user_data);
+        conn->body_delivering = false;
+        conn->recv_len = cwh_parser_discard_body(&conn->parser, conn->recv_buf, conn->recv_len);
+        conn->recv_buf[conn->recv_len] = '\0';
+    }
+    conn->request.body = NULL;
+    conn->request.body_len = 0;
+
+    if (status != CWH_PARSE_BODY_DONE)
+        return 1;
+
+    conn->request_complete = true;
+    conn->body_delivering = true;
+    route->on_body(conn, CWH_BODY_END, NULL, 0, route->user_data);
+    conn->body_delivering = false;
+    return 0;
+}
+
+// Act on deliver_body's result: reject bad framing, dispatch once the body
+// is complete, otherwise keep reading (unless paused or already replying)
+static void body_progress(cwh_async_conn_t *conn, int result)
+{
+    if (result == -3)
+    {
+        reject_request(conn, result);
+        start_writing(conn);
+        return;
+    }
+
+    if (conn->request_complete)
+    {
+        dispatch_requests(conn);
+        return;
+    }
+
+    if (conn->state == CONN_STATE_READING_REQUEST)
+    {
+        set_conn_events(conn, conn->body_paused ? 0 : CWH_EVENT_READ);
+        arm_connection_timer(conn, CONN_TIMEOUT_IDLE);
+    }
+}
+
+void cwh_async_body_pause(cwh_async_conn_t *conn)
+{
+    if (!conn || !conn->body_route || conn->request_complete)
+        return;
+
+    conn->body_paused = true;
+    if (conn->state == CONN_STATE_READING_REQUEST)
+        set_conn_events(conn, 0);
+}
+
+void cwh_async_body_resume(cwh_async_conn_t *conn)
+{
+    if (!conn || !conn->body_paused)
+        return;
+
+    conn->body_paused = false;
+
+    // Inside a callback (or while a reply is written) the caller picks up from here
+    if (conn->body_delivering || conn->state != CONN_STATE_READING_REQUEST)
+        return;
+
+    // Deliver what arrived before the pause, then read again
+    body_progress(conn, deliver_body(conn));
+}
+
+cwh_loop_t *cwh_async_conn_loop(cwh_async_conn_t *conn)
+{
+    return conn ? conn->server->loop : NULL;
+}
+
 // ============================================================================
 // Response Helpers
 // ============================================================================
 
+// Connection header for the reply being built. Replying before a streamed
+// request body has been read to the end closes the connection afterwards.
+static const char *connection_header(cwh_async_conn_t *conn)
+{
+    if (conn->body_route && !conn->request_complete)
+        conn->keep_alive = false;
+    return conn->keep_alive ? "Connection: keep-alive\r\n" : "Connection: close\r\n";
+}
+
 // Send HTTP response
 void cwh_async_send_response(cwh_async_conn_t *conn,
                              int status,
@@ -988,38 +2784,384 @@ void cwh_async_send_response(cwh_async_conn_t *conn,
     if (!conn)
         return;
 
-    // Build response
-    int written = snprintf(conn->send_buf, sizeof(conn->send_buf),
-                           "HTTP/1.1 %d OK\r\n"
-                           "Content-Type: %s\r\n"
-                           "Content-Length: %lu\r\n"
-                           "%s"
-                           "\r\n",
-                           status,
-                           content_type,
-                           (unsigned long)body_len,
-                           conn->keep_alive ? "Connection: keep-alive\r\n" : "Connection: close\r\n");
-
-    if (written < 0 || (size_t)written >= sizeof(conn->send_buf))
+    // Build headers
+    char header[512];
+    int header_len = snprintf(header, sizeof(header),
+                              "HTTP/1.1 %d OK\r\n"
+                              "Content-Type: %s\r\n"
+                              "Content-Length: %lu\r\n"
+                              "%s"
+                              "\r\n",
+                              status,
+                              content_type,
+                              (unsigned long)body_len,
+                              connection_header(conn));
+
+    if (header_len < 0 || (size_t)header_len >= sizeof(header))
         return;
 
-    // Add body
-    if (body && body_len > 0)
+    if (!body)
+        body_len = 0;
+
+    // Segment sized to the whole response (no truncation)
+    cwh_out_seg_t *seg = out_seg_new(conn, (size_t)header_len + body_len);
+    if (!seg)
     {
-        size_t available = sizeof(conn->send_buf) - written;
-        if (body_len > available)
-            body_len = available;
+        out_fail(conn);
+        return;
+    }
+
+    memcpy(seg->buf, header, header_len);
+    if (body_len > 0)
+        memcpy(seg->buf + header_len, body, body_len);
+    seg->len = (size_t)header_len + body_len;
+
+    // Queue behind earlier (pipelined) responses
+    out_queue(conn, seg);
+}
+
+// Send a response whose body stays in caller-owned buffers; only the headers
+// are formatted into a pooled block, the body is gathered at write time
+int cwh_async_send_iov(cwh_async_conn_t *conn, int status, const char *headers,
+                       const cwh_iovec_t *body, int iovcnt,
+                       cwh_release_cb release, void *release_ctx)
+{
+    if (!conn || iovcnt < 0 || (iovcnt > 0 && !body))
+    {
+        if (release)
+            release(release_ctx);
+        return -1;
+    }
 
-        memcpy(conn->send_buf + written, body, body_len);
-        written += body_len;
+    uint64_t body_len = 0;
+    int pieces = 0;
+    for (int i = 0; i < iovcnt; i++)
+    {
+        body_len += body[i].len;
+        if (body[i].len > 0)
+            pieces++;
     }
 
-    conn->send_len = written;
-    conn->send_offset = 0;
+    // Headers go in one pooled block
+    cwh_out_seg_t *seg = out_seg_new(conn, CWH_CONN_BUF_SIZE);
+    if (seg)
+    {
+        int header_len = snprintf(seg->buf, seg->cap,
+                                  "HTTP/1.1 %d OK\r\n"
+                                  "%s"
+                                  "Content-Length: %llu\r\n"
+                                  "%s"
+                                  "\r\n",
+                                  status,
+                                  headers ? headers : "",
+                                  (unsigned long long)body_len,
+                                  connection_header(conn));
+        if (header_len < 0 || (size_t)header_len >= seg->cap)
+        {
+            out_seg_free(conn, seg);
+            if (release)
+                release(release_ctx);
+            return -1;
+        }
+        seg->len = (size_t)header_len;
 
-    // Switch to WRITING_RESPONSE state and register for WRITE events
-    conn->state = CONN_STATE_WRITING_RESPONSE;
-    cwh_loop_mod(conn->server->loop, conn->fd, CWH_EVENT_WRITE);
+        // Keep references to the non-empty buffers (the array itself is copied)
+        if (pieces > 0)
+        {
+            seg->iov = (cwh_iovec_t *)malloc((size_t)pieces * sizeof(cwh_iovec_t));
+            if (!seg->iov)
+            {
+                out_seg_free(conn, seg);
+                seg = NULL;
+            }
+            else
+            {
+                uintptr_t req_start = (uintptr_t)conn->recv_buf;
+                for (int i = 0; i < iovcnt; i++)
+                {
+                    if (body[i].len == 0)
+                        continue;
+                    seg->iov[seg->iovcnt++] = body[i];
+
+                    // Points into the request: the buffer must outlive the segment
+                    uintptr_t base = (uintptr_t)body[i].base;
+                    if (conn->recv_buf && base >= req_start && base < req_start + conn->recv_cap)
+                        conn->recv_pin = seg;
+                }
+            }
+        }
+    }
+
+    if (!seg)
+    {
+        if (release)
+            release(release_ctx);
+        out_fail(conn);
+        return -1;
+    }
+
+    // From here the segment owns the buffers: release runs when it is freed
+    seg->release = release;
+    seg->release_ctx = release_ctx;
+    out_queue(conn, seg);
+    return 0;
+}
+
+// ============================================================================
+// Streaming Responses
+// ============================================================================
+
+// Copy pieces to the end of the output queue, reusing spare room in the last block
+static int out_append(cwh_async_conn_t *conn, const cwh_iovec_t *parts, int count)
+{
+    size_t total = 0;
+    for (int i = 0; i < count; i++)
+        total += parts[i].len;
+
+    cwh_out_seg_t *seg = conn->out_tail;
+    bool fresh = !seg || seg->file || seg->iovcnt > 0 || seg->cap - seg->len < total;
+    if (fresh)
+    {
+        seg = out_seg_new(conn, total > CWH_CONN_BUF_SIZE ? total : CWH_CONN_BUF_SIZE);
+        if (!seg)
+            return -1;
+    }
+
+    size_t start = seg->len;
+    for (int i = 0; i < count; i++)
+    {
+        memcpy(seg->buf + seg->len, parts[i].base, parts[i].len);
+        seg->len += parts[i].len;
+    }
+
+    if (fresh)
+        out_queue(conn, seg);
+    else
+        conn->out_pending += seg->len - start;
+    return 0;
+}
+
+// Tell a paused producer that the queue drained below the low watermark
+static void stream_check_drain(cwh_async_conn_t *conn)
+{
+    if (conn->streaming && conn->stream_blocked && conn->out_pending <= conn->stream_low)
+    {
+        conn->stream_blocked = false;
+        if (conn->stream_cb)
+            conn->stream_cb(conn, CWH_STREAM_DRAIN, conn->stream_ctx);
+    }
+}
+
+// Start a streamed response (chunked; HTTP/1.0 clients get a close-delimited body)
+int cwh_async_stream_begin(cwh_async_conn_t *conn, int status, const char *headers)
+{
+    if (!conn || conn->responded || conn->streaming)
+        return -1;
+
+    conn->stream_chunked = !request_is_http10(conn);
+    if (!conn->stream_chunked)
+        conn->keep_alive = false;
+
+    cwh_out_seg_t *seg = out_seg_new(conn, CWH_CONN_BUF_SIZE);
+    if (!seg)
+    {
+        out_fail(conn);
+        return -1;
+    }
+
+    int header_len = snprintf(seg->buf, seg->cap,
+                              "HTTP/1.1 %d OK\r\n"
+                              "%s"
+                              "%s"
+                              "%s"
+                              "\r\n",
+                              status,
+                              headers ? headers : "",
+                              conn->stream_chunked ? "Transfer-Encoding: chunked\r\n" : "",
+                              connection_header(conn));
+    if (header_len < 0 || (size_t)header_len >= seg->cap)
+    {
+        out_seg_free(conn, seg);
+        return -1;
+    }
+    seg->len = (size_t)header_len;
+
+    conn->streaming = true;
+    conn->stream_blocked = false;
+    conn->stream_low = CWH_STREAM_LOW_WATERMARK;
+    conn->stream_high = CWH_STREAM_HIGH_WATERMARK;
+    conn->stream_cb = NULL;
+    conn->stream_ctx = NULL;
+    out_queue(conn, seg);
+    return 0;
+}
+
+void cwh_async_stream_set_watermarks(cwh_async_conn_t *conn, size_t low, size_t high,
+                                     cwh_stream_cb cb, void *ctx)
+{
+    if (!conn || !conn->streaming)
+        return;
+    conn->stream_low = low;
+    conn->stream_high = high > low ? high : low;
+    conn->stream_cb = cb;
+    conn->stream_ctx = ctx;
+}
+
+// Queue one chunk; returns 1 once buffered output reaches the high watermark
+int cwh_async_stream_write(cwh_async_conn_t *conn, const void *data, size_t len)
+{
+    if (!conn || !conn->streaming || (len > 0 && !data))
+        return -1;
+
+    if (len > 0)
+    {
+        char size_line[24];
+        int size_len = snprintf(size_line, sizeof(size_line), "%zx\r\n", len);
+        cwh_iovec_t chunk[3] = {{size_line, (size_t)size_len}, {data, len}, {"\r\n", 2}};
+        int first = conn->stream_chunked ? 0 : 1;
+        int count = conn->stream_chunked ? 3 : 1;
+        if (out_append(conn, chunk + first, count) < 0)
+        {
+            out_fail(conn);
+            return -1;
+        }
+    }
+
+    if (conn->out_pending >= conn->stream_high)
+    {
+        conn->stream_blocked = true;
+        return 1;
+    }
+    return 0;
+}
+
+// Finish the stream (terminating chunk); the connection continues as usual
+int cwh_async_stream_end(cwh_async_conn_t *conn)
+{
+    if (!conn || !conn->streaming)
+        return -1;
+
+    conn->streaming = false;
+    if (conn->stream_chunked)
+    {
+        cwh_iovec_t last = {"0\r\n\r\n", 5};
+        if (out_append(conn, &last, 1) < 0)
+        {
+            out_fail(conn);
+            return -1;
+        }
+    }
+
+    // Queue may be empty (everything already sent): let the writer finish up
+    if (!conn->batching)
+    {
+        conn->state = CONN_STATE_WRITING_RESPONSE;
+        set_conn_events(conn, CWH_EVENT_WRITE);
+    }
+    return 0;
+}
+
+// Send file (optionally a byte range) with headers; body is streamed from the
+// file descriptor as the socket becomes writable. The descriptor, MIME type
+// and validators come from the shared file cache; conditional requests
+// (If-None-Match / If-Modified-Since) are answered with 304.
+int cwh_async_send_file(cwh_async_conn_t *conn, const char *path, const char *range_header)
+{
+    if (!conn || !path)
+        return -1;
+
+    cwh_file_entry_t *entry = cwh_file_cache_acquire(path);
+    if (!entry)
+    {
+        cwh_async_send_status(conn, 404, "Not Found");
+        return -1;
+    }
+
+    const char *connection = connection_header(conn);
+    uint64_t file_size = entry->size;
+    size_t range_start = 0, range_end = 0;
+    bool not_modified = cwh_file_not_modified(entry, cwh_get_header(&conn->request, "If-None-Match"),
+                                              cwh_get_header(&conn->request, "If-Modified-Since"));
+    bool is_range = !not_modified && range_header && file_size > 0 &&
+                    cwh_parse_range_header(range_header, (size_t)file_size, &range_start, &range_end);
+    uint64_t content_length = is_range ? (uint64_t)(range_end - range_start + 1) : file_size;
+
+    char header[768];
+    int header_len;
+    if (not_modified)
+    {
+        content_length = 0;
+        header_len = snprintf(header, sizeof(header),
+                              "HTTP/1.1 304 Not Modified\r\n"
+                              "ETag: %s\r\n"
+                              "Last-Modified: %s\r\n"
+                              "%s"
+                              "\r\n",
+                              entry->etag, entry->last_modified, connection);
+    }
+    else if (is_range)
+    {
+        header_len = snprintf(header, sizeof(header),
+                              "HTTP/1.1 206 Partial Content\r\n"
+                              "Content-Type: %s\r\n"
+                              "Content-Length: %llu\r\n"
+                              "Content-Range: bytes %llu-%llu/%llu\r\n"
+                              "Accept-Ranges: bytes\r\n"
+                              "ETag: %s\r\n"
+                              "Last-Modified: %s\r\n"
+                              "%s"
+                              "\r\n",
+                              entry->mime_type,
+                              (unsigned long long)content_length,
+                              (unsigned long long)range_start,
+                              (unsigned long long)range_end,
+                              (unsigned long long)file_size,
+                              entry->etag, entry->last_modified, connection);
+    }
+    else
+    {
+        header_len = snprintf(header, sizeof(header),
+                              "HTTP/1.1 200 OK\r\n"
+                              "Content-Type: %s\r\n"
+                              "Content-Length: %llu\r\n"
+                              "Accept-Ranges: bytes\r\n"
+                              "ETag: %s\r\n"
+                              "Last-Modified: %s\r\n"
+                              "%s"
+                              "\r\n",
+                              entry->mime_type,
+                              (unsigned long long)content_length,
+                              entry->etag, entry->last_modified, connection);
+    }
+
+    if (header_len < 0 || (size_t)header_len >= sizeof(header))
+    {
+        cwh_file_cache_release(entry);
+        return -1;
+    }
+
+    // Headers go in a pooled block (reused as the read buffer on the
+    // non-sendfile body path), the body straight from the file
+    cwh_out_seg_t *seg = out_seg_new(conn, CWH_CONN_BUF_SIZE);
+    if (!seg)
+    {
+        cwh_file_cache_release(entry);
+        out_fail(conn);
+        return -1;
+    }
+
+    memcpy(seg->buf, header, header_len);
+    seg->len = (size_t)header_len;
+
+    if (content_length > 0)
+        seg->file = entry;
+    else
+        cwh_file_cache_release(entry);
+    seg->file_offset = range_start;
+    seg->file_remaining = content_length;
+
+    out_queue(conn, seg);
+    return 0;
 }
 
 // Send status response
@@ -0,0 +1,275 @@
+// timer.c - Hashed timing wheel for the async event loop
+// O(1) add/cancel/reset; expiry cost proportional to elapsed ticks, not timer count
+
+#ifndef _WIN32
+#define _POSIX_C_SOURCE 200112L
+#endif
+
+#include "../../include/cwebhttp_async.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+// Wheel geometry: 512 slots x 10ms = 5.12s per revolution.
+// Longer timeouts simply stay in their slot for several revolutions.
+#define CWH_TIMER_SLOTS 512
+#define CWH_TIMER_SLOT_MASK (CWH_TIMER_SLOTS - 1)
+#define CWH_TIMER_TICK_MS 10
+
+// Timer (one-shot; lives in exactly one list: a wheel slot, expired or idle)
+struct cwh_timer
+{
+    uint64_t expire_tick;     // Absolute tick at which the timer fires
+    cwh_timer_cb callback;    // Expiry callback
+    void *data;               // User data for callback
+    bool active;              // Armed (in a wheel slot or pending expiry)
+    struct cwh_timer **head;  // List the timer is currently linked into
+    struct cwh_timer *prev;   // Doubly linked for O(1) unlink
+    struct cwh_timer *next;
+};
+
+// Timing wheel (one per event loop, not thread-safe)
+typedef struct cwh_timer_wheel
+{
+    cwh_timer_t *slots[CWH_TIMER_SLOTS]; // Armed timers hashed by expire_tick
+    uint64_t slot_min[CWH_TIMER_SLOTS];  // Lower bound of expire_tick per slot
+    cwh_timer_t *expired;                // Timers due, waiting for their callback
+    cwh_timer_t *idle;                   // Fired or never armed timers (owned by wheel)
+    uint64_t start_ms;                   // Monotonic time of tick 0
+    uint64_t current_tick;               // Next tick to be processed
+    size_t active_count;                 // Armed timers
+} cwh_timer_wheel_t;
+
+// Monotonic clock in milliseconds
+static uint64_t monotonic_ms(void)
+{
+#ifdef _WIN32
+    return (uint64_t)GetTickCount64();
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000 + (uint64_t)ts.tv_nsec / 1000000;
+#endif
+}
+
+static void timer_link(cwh_timer_t **head, cwh_timer_t *timer)
+{
+    timer->head = head;
+    timer->prev = NULL;
+    timer->next = *head;
+    if (*head)
+        (*head)->prev = timer;
+    *head = timer;
+}
+
+static void timer_unlink(cwh_timer_t *timer)
+{
+    if (timer->prev)
+        timer->prev->next = timer->next;
+    else
+        *timer->head = timer->next;
+    if (timer->next)
+        timer->next->prev = timer->prev;
+    timer->head = NULL;
+    timer->prev = NULL;
+    timer->next = NULL;
+}
+
+// Put timer into the wheel, firing no earlier than timeout_ms from now
+static void timer_arm(cwh_timer_wheel_t *wheel, cwh_timer_t *timer, uint64_t timeout_ms)
+{
+    uint64_t elapsed = monotonic_ms() - wheel->start_ms + timeout_ms;
+    uint64_t tick = (elapsed + CWH_TIMER_TICK_MS - 1) / CWH_TIMER_TICK_MS;
+    if (tick < wheel->current_tick)
+        tick = wheel->current_tick;
+
+    size_t slot = tick & CWH_TIMER_SLOT_MASK;
+    if (!wheel->slots[slot] || tick < wheel->slot_min[slot])
+        wheel->slot_min[slot] = tick;
+
+    timer->expire_tick = tick;
+    timer->active = true;
+    timer_link(&wheel->slots[slot], timer);
+    wheel->active_count++;
+}
+
+// Take timer out of whatever list it is in (without freeing it)
+static void timer_disarm(cwh_timer_wheel_t *wheel, cwh_timer_t *timer)
+{
+    if (timer->head)
+        timer_unlink(timer);
+    if (timer->active)
+    {
+        timer->active = false;
+        wheel->active_count--;
+    }
+}
+
+// Create timing wheel
+cwh_timer_wheel_t *cwh_timer_wheel_new(void)
+{
+    cwh_timer_wheel_t *wheel = (cwh_timer_wheel_t *)calloc(1, sizeof(cwh_timer_wheel_t));
+    if (!wheel)
+        return NULL;
+
+    wheel->start_ms = monotonic_ms();
+    wheel->current_tick = 0;
+    return wheel;
+}
+
+static void free_timer_list(cwh_timer_t *timer)
+{
+    while (timer)
+    {
+        cwh_timer_t *next = timer->next;
+        free(timer);
+        timer = next;
+    }
+}
+
+// Free wheel and every timer it owns
+void cwh_timer_wheel_free(cwh_timer_wheel_t *wheel)
+{
+    if (!wheel)
+        return;
+
+    for (int i = 0; i < CWH_TIMER_SLOTS; i++)
+        free_timer_list(wheel->slots[i]);
+    free_timer_list(wheel->expired);
+    free_timer_list(wheel->idle);
+    free(wheel);
+}
+
+// Add one-shot timer
+cwh_timer_t *cwh_timer_wheel_add(cwh_timer_wheel_t *wheel, uint64_t timeout_ms, cwh_timer_cb cb, void *data)
+{
+    if (!wheel || !cb)
+        return NULL;
+
+    cwh_timer_t *timer = (cwh_timer_t *)calloc(1, sizeof(cwh_timer_t));
+    if (!timer)
+        return NULL;
+
+    timer->callback = cb;
+    timer->data = data;
+    timer_arm(wheel, timer, timeout_ms);
+    return timer;
+}
+
+// Re-arm timer (armed or already fired)
+int cwh_timer_wheel_reset(cwh_timer_wheel_t *wheel, cwh_timer_t *timer, uint64_t timeout_ms)
+{
+    if (!wheel || !timer)
+        return -1;
+
+    timer_disarm(wheel, timer);
+    timer_arm(wheel, timer, timeout_ms);
+    return 0;
+}
+
+// Cancel and free timer
+void cwh_timer_wheel_cancel(cwh_timer_wheel_t *wheel, cwh_timer_t *timer)
+{
+    if (!wheel || !timer)
+        return;
+
+    timer_disarm(wheel, timer);
+    free(timer);
+}
+
+// Milliseconds until the earliest armed timer is due (0 if overdue, -1 if none)
+int cwh_timer_wheel_next_timeout(cwh_timer_wheel_t *wheel)
+{
+    if (!wheel || wheel->active_count == 0)
+        return -1;
+    if (wheel->expired)
+        return 0;
+
+    // slot_min may be stale-low after cancels, which only causes an early wakeup
+    uint64_t earliest = UINT64_MAX;
+    for (uint64_t i = 0; i < CWH_TIMER_SLOTS; i++)
+    {
+        uint64_t tick = wheel->current_tick + i;
+        size_t slot = tick & CWH_TIMER_SLOT_MASK;
+        if (!wheel->slots[slot])
+            continue;
+
+        if (wheel->slot_min[slot] < earliest)
+            earliest = wheel->slot_min[slot];
+        if (earliest <= tick)
+            break; // Nothing in later slots can be due sooner
+    }
+
+    uint64_t due_ms = wheel->start_ms + earliest * CWH_TIMER_TICK_MS;
+    uint64_t now = monotonic_ms();
+    if (due_ms <= now)
+        return 0;
+    if (due_ms - now > INT32_MAX)
+        return INT32_MAX;
+    return (int)(due_ms - now);
+}
+
+// Move due timers of one slot to the expired list and recompute slot_min
+static void collect_slot(cwh_timer_wheel_t *wheel, size_t slot, uint64_t now_tick)
+{
+    uint64_t min_tick = UINT64_MAX;
+    cwh_timer_t *timer = wheel->slots[slot];
+    while (timer)
+    {
+        cwh_timer_t *next = timer->next;
+        if (timer->expire_tick <= now_tick)
+        {
+            timer_unlink(timer);
+            timer_link(&wheel->expired, timer);
+        }
+        else if (timer->expire_tick < min_tick)
+        {
+            min_tick = timer->expire_tick;
+        }
+        timer = next;
+    }
+    wheel->slot_min[slot] = min_tick;
+}
+
+// Fire all due timers; returns number of callbacks invoked
+int cwh_timer_wheel_expire(cwh_timer_wheel_t *wheel, cwh_loop_t *loop)
+{
+    if (!wheel || wheel->active_count == 0)
+        return 0;
+
+    uint64_t now_tick = (monotonic_ms() - wheel->start_ms) / CWH_TIMER_TICK_MS;
+    if (now_tick >= wheel->current_tick)
+    {
+        // Visit each elapsed slot once (a full revolution at most)
+        uint64_t ticks = now_tick - wheel->current_tick + 1;
+        if (ticks > CWH_TIMER_SLOTS)
+            ticks = CWH_TIMER_SLOTS;
+
+        for (uint64_t i = 0; i < ticks; i++)
+            collect_slot(wheel, (wheel->current_tick + i) & CWH_TIMER_SLOT_MASK, now_tick);
+
+        wheel->current_tick = now_tick + 1;
+    }
+
+    // Callbacks may add, reset or cancel any timer (including other expired ones)
+    int fired = 0;
+    while (wheel->expired)
+    {
+        cwh_timer_t *timer = wheel->expired;
+        timer_unlink(timer);
+        timer->active = false;
+        wheel->active_count--;
+        timer_link(&wheel->idle, timer);
+
+        timer->callback(loop, timer, timer->data);
+        fired++;
+    }
+
+    return fired;
+}
@@ -0,0 +1,1433 @@
+// uring.c - Linux io_uring backend for async event loop
+// Readiness is delivered by one-shot IORING_OP_POLL_ADD requests. Arms, re-arms
+// and removals are queued in the submission ring and handed to the kernel in
+// one io_uring_enter together with the wait, so an iteration of the loop costs
+// a single syscall instead of epoll_wait plus an epoll_ctl per interest change.
+//
+// Sockets added with CWH_EVENT_COMPLETION are read and written by the backend:
+// a RECV is kept in flight on each one, taking a buffer from a ring registered
+// with the kernel (IORING_REGISTER_PBUF_RING, 5.19+), and bytes handed to
+// cwh_loop_send() are queued and go out as SEND requests. Both travel in the
+// same io_uring_enter as the wait, so serving a request costs no recv/send
+// syscall of its own. READ then means "data waits in cwh_loop_recv()" and
+// WRITE "the send queue has room".
+
+#include "../../include/cwebhttp_async.h"
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+#ifdef __linux__
+
+#if defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#define CWH_HAVE_IO_URING 1
+#endif
+#endif
+
+#ifdef CWH_HAVE_IO_URING
+#include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/sendfile.h>
+#include <sys/syscall.h>
+#include <linux/time_types.h>
+#include <linux/io_uring.h>
+
+// Provided buffer rings came with 5.19, together with IORING_RECVSEND_POLL_FIRST
+#ifdef IORING_RECVSEND_POLL_FIRST
+#define CWH_URING_COMPLETION 1
+#else
+#define CWH_URING_COMPLETION 0
+#endif
+
+// Initial size of the fd-indexed handler table (grows by doubling)
+#define CWH_URING_INITIAL_SLOTS 256
+
+// Completion I/O buffers (per loop)
+#define CWH_URING_RECV_BUFS 256        // Receive buffers in the provided ring (power of two)
+#define CWH_URING_RECV_BUF_SIZE 4096   // Bytes per receive buffer
+#define CWH_URING_BUF_GROUP 0          // Buffer group id of the ring
+#define CWH_URING_SEND_BLOCK 4096      // Send queue size for small writes (pooled)
+#define CWH_URING_SEND_MAX (64 * 1024) // Largest send queue
+#define CWH_URING_SEND_POOL 256        // Pooled send blocks kept
+#define CWH_URING_LINGER_MS 30000      // A removed socket's queued output must go within this
+
+// user_data of requests whose completions are not dispatched
+#define CWH_URING_IGNORE UINT64_MAX        // Poll/timeout removals, cancels
+#define CWH_URING_TIMEOUT (UINT64_MAX - 1) // Wait timeouts (kernels without EXT_ARG)
+
+// Low bits of user_data: poll requests carry fd and generation, completion
+// I/O requests the address of their cwh_uring_io_t (8-byte aligned)
+#define CWH_URING_TAG_MASK 7
+#define CWH_URING_TAG_POLL 0
+#define CWH_URING_TAG_RECV 1
+#define CWH_URING_TAG_SEND 2
+#define CWH_URING_TAG_LINGER 3
+
+// Completion I/O state of one socket. Outlives its registration while the
+// kernel still has requests on it: a removed socket with queued output keeps
+// a dup of the fd until the queue is sent (the owner closes its own fd).
+typedef struct cwh_uring_io
+{
+    int fd;
+    bool attached;      // Registered (the handler slot points here)
+    bool lingering;     // Removed with output queued: fd is our dup
+    bool pending;       // On the pending list (ready without a new completion)
+    int error;          // errno of a failed receive or send
+
+    // Receive: one RECV in flight while nothing is buffered
+    bool recv_inflight;
+    bool recv_starved;  // Buffer ring was empty: retried once buffers come back
+    bool eof;
+    char *rbuf;         // Received bytes (a ring buffer, returned once consumed)
+    unsigned rbid;
+    size_t rlen;
+    size_t roff;
+
+    // Send queue: [shead, stail) of sbuf, one SEND in flight at a time
+    bool send_inflight;
+    bool send_queued;   // On the flush list: bytes appended since the last wait
+    char *sbuf;
+    size_t scap;
+    size_t shead;
+    size_t stail;
+    bool wait_drain;    // sendfile waits for the queue to empty
+    bool wait_pollout;  // sendfile hit a full socket: WRITE comes from a poll
+    bool linger_armed;
+    struct __kernel_timespec linger_ts;
+
+    struct cwh_uring_io *pending_next;
+    struct cwh_uring_io *flush_next;
+    struct cwh_uring_io *prev; // All live objects (freed with the ring)
+    struct cwh_uring_io *next;
+} cwh_uring_io_t;
+
+// Event handler entry (slot in the fd-indexed table; callback == NULL means free)
+// gen survives slot reuse so completions of an earlier registration of the same fd never match
+typedef struct cwh_uring_entry
+{
+    int events;
+    cwh_event_cb callback;
+    void *data;
+    uint32_t gen;        // Generation of the outstanding poll request
+    bool armed;          // Poll request queued or in flight
+    cwh_uring_io_t *io;  // Completion I/O (CWH_EVENT_COMPLETION), NULL for readiness
+} cwh_uring_entry_t;
+
+// io_uring-based event loop
+typedef struct cwh_uring
+{
+    int ring_fd;
+
+    // Submission queue (shared with the kernel)
+    unsigned *sq_head;
+    unsigned *sq_tail;
+    unsigned *sq_mask;
+    unsigned *sq_array;
+    unsigned sq_entries;
+    struct io_uring_sqe *sqes;
+    unsigned to_submit; // Queued SQEs the kernel hasn't consumed yet
+
+    // Completion queue (shared with the kernel)
+    unsigned *cq_head;
+    unsigned *cq_tail;
+    unsigned *cq_mask;
+    struct io_uring_cqe *cqes;
+
+    // Ring mappings
+    void *sq_ring;
+    size_t sq_ring_size;
+    void *cq_ring; // == sq_ring with IORING_FEAT_SINGLE_MMAP
+    size_t cq_ring_size;
+    size_t sqes_size;
+
+    struct io_uring_cqe *ready; // Completions copied out of the ring for dispatch
+    unsigned ready_cap;
+    struct __kernel_timespec wait_ts; // Timeout of the pending wait
+    bool ext_arg;                     // io_uring_enter takes the wait timeout (5.11+)
+    unsigned timeouts_pending;        // Wait timeout SQEs not completed yet (no EXT_ARG)
+
+    // Completion I/O (NULL buf_ring: not supported, CWH_EVENT_COMPLETION refused)
+    void *buf_ring;           // struct io_uring_buf_ring shared with the kernel
+    char *recv_bufs;          // CWH_URING_RECV_BUFS buffers of CWH_URING_RECV_BUF_SIZE
+    uint16_t buf_tail;        // Next ring slot to fill
+    unsigned bufs_free;       // Buffers in the ring
+    unsigned starved;         // Sockets whose RECV found the ring empty
+    cwh_uring_io_t *ios;      // Live completion I/O objects
+    cwh_uring_io_t *pending;  // Ready without a new completion (level-triggered)
+    cwh_uring_io_t *flush;    // Send queues to submit with the next wait
+    char *send_pool;          // Free CWH_URING_SEND_BLOCK blocks (linked through their first bytes)
+    int send_pool_count;
+
+    cwh_uring_entry_t *handlers; // Handler table indexed by fd
+    int num_handlers;            // Allocated slots in handlers[]
+    uint64_t syscalls;           // io_uring_enter calls made (and sendfile/dup for completion I/O)
+    int running;
+    void *loop_ptr; // Pointer back to cwh_loop_t for callbacks
+} cwh_uring_t;
+
+static int uring_enter(cwh_uring_t *ur, unsigned to_submit, unsigned min_complete, unsigned flags,
+                       void *arg, size_t arg_size)
+{
+    ur->syscalls++;
+    return (int)syscall(__NR_io_uring_enter, ur->ring_fd, to_submit, min_complete, flags, arg, arg_size);
+}
+
+// Hand queued SQEs to the kernel without waiting
+static int uring_flush(cwh_uring_t *ur)
+{
+    if (ur->to_submit == 0)
+        return 0;
+
+    int ret = uring_enter(ur, ur->to_submit, 0, 0, NULL, 0);
+    if (ret < 0)
+        return -1;
+    ur->to_submit -= (unsigned)ret < ur->to_submit ? (unsigned)ret : ur->to_submit;
+    return 0;
+}
+
+static void uring_unmap(cwh_uring_t *ur)
+{
+    if (ur->sqes && ur->sqes != MAP_FAILED)
+        munmap(ur->sqes, ur->sqes_size);
+    if (ur->cq_ring && ur->cq_ring != MAP_FAILED && ur->cq_ring != ur->sq_ring)
+        munmap(ur->cq_ring, ur->cq_ring_size);
+    if (ur->sq_ring && ur->sq_ring != MAP_FAILED)
+        munmap(ur->sq_ring, ur->sq_ring_size);
+}
+
+#if CWH_URING_COMPLETION
+// Put a receive buffer (back) into the ring
+static void recv_buf_add(cwh_uring_t *ur, unsigned bid)
+{
+    struct io_uring_buf_ring *ring = (struct io_uring_buf_ring *)ur->buf_ring;
+    struct io_uring_buf *buf = &ring->bufs[ur->buf_tail & (CWH_URING_RECV_BUFS - 1)];
+    buf->addr = (uint64_t)(uintptr_t)(ur->recv_bufs + (size_t)bid * CWH_URING_RECV_BUF_SIZE);
+    buf->len = CWH_URING_RECV_BUF_SIZE;
+    buf->bid = (uint16_t)bid;
+    ur->buf_tail++;
+    __atomic_store_n(&ring->tail, ur->buf_tail, __ATOMIC_RELEASE);
+    ur->bufs_free++;
+}
+
+// Register the receive buffer ring; completion I/O stays off if the kernel refuses
+static void uring_setup_buffers(cwh_uring_t *ur)
+{
+    size_t ring_size = CWH_URING_RECV_BUFS * sizeof(struct io_uring_buf);
+    void *ring = mmap(NULL, ring_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (ring == MAP_FAILED)
+        return;
+
+    char *bufs = (char *)malloc((size_t)CWH_URING_RECV_BUFS * CWH_URING_RECV_BUF_SIZE);
+    struct io_uring_buf_reg reg;
+    memset(&reg, 0, sizeof(reg));
+    reg.ring_addr = (uint64_t)(uintptr_t)ring;
+    reg.ring_entries = CWH_URING_RECV_BUFS;
+    reg.bgid = CWH_URING_BUF_GROUP;
+    if (!bufs || syscall(__NR_io_uring_register, ur->ring_fd, IORING_REGISTER_PBUF_RING, &reg, 1) < 0)
+    {
+        free(bufs);
+        munmap(ring, ring_size);
+        return;
+    }
+
+    ur->buf_ring = ring;
+    ur->recv_bufs = bufs;
+    for (unsigned i = 0; i < CWH_URING_RECV_BUFS; i++)
+        recv_buf_add(ur, i);
+}
+#endif
+
+// Create io_uring instance
+// Returns NULL when io_uring is missing or disabled (ENOSYS, EPERM, kernel < 5.5)
+cwh_uring_t *cwh_uring_create(unsigned entries)
+{
+    cwh_uring_t *ur = (cwh_uring_t *)calloc(1, sizeof(cwh_uring_t));
+    if (!ur)
+        return NULL;
+
+    struct io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    ur->ring_fd = (int)syscall(__NR_io_uring_setup, entries, &params);
+    if (ur->ring_fd < 0)
+    {
+        free(ur);
+        return NULL;
+    }
+
+    // NODROP (5.5) guarantees POLL_ADD/POLL_REMOVE/TIMEOUT and no lost completions
+    if (!(params.features & IORING_FEAT_NODROP))
+        goto fail;
+
+#ifdef IORING_FEAT_EXT_ARG
+    ur->ext_arg = (params.features & IORING_FEAT_EXT_ARG) != 0;
+#endif
+
+    ur->sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    ur->cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    if (params.features & IORING_FEAT_SINGLE_MMAP)
+    {
+        if (ur->cq_ring_size > ur->sq_ring_size)
+            ur->sq_ring_size = ur->cq_ring_size;
+        ur->cq_ring_size = ur->sq_ring_size;
+    }
+
+    ur->sq_ring = mmap(NULL, ur->sq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                       ur->ring_fd, IORING_OFF_SQ_RING);
+    if (ur->sq_ring == MAP_FAILED)
+        goto fail;
+
+    if (params.features & IORING_FEAT_SINGLE_MMAP)
+        ur->cq_ring = ur->sq_ring;
+    else
+        ur->cq_ring = mmap(NULL, ur->cq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                           ur->ring_fd, IORING_OFF_CQ_RING);
+    if (ur->cq_ring == MAP_FAILED)
+        goto fail;
+
+    ur->sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+    ur->sqes = (struct io_uring_sqe *)mmap(NULL, ur->sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                                           ur->ring_fd, IORING_OFF_SQES);
+    if (ur->sqes == MAP_FAILED)
+        goto fail;
+
+    char *sq = (char *)ur->sq_ring;
+    ur->sq_head = (unsigned *)(sq + params.sq_off.head);
+    ur->sq_tail = (unsigned *)(sq + params.sq_off.tail);
+    ur->sq_mask = (unsigned *)(sq + params.sq_off.ring_mask);
+    ur->sq_array = (unsigned *)(sq + params.sq_off.array);
+    ur->sq_entries = params.sq_entries;
+
+    char *cq = (char *)ur->cq_ring;
+    ur->cq_head = (unsigned *)(cq + params.cq_off.head);
+    ur->cq_tail = (unsigned *)(cq + params.cq_off.tail);
+    ur->cq_mask = (unsigned *)(cq + params.cq_off.ring_mask);
+    ur->cqes = (struct io_uring_cqe *)(cq + params.cq_off.cqes);
+
+    ur->ready_cap = params.cq_entries;
+    ur->ready = (struct io_uring_cqe *)calloc(ur->ready_cap, sizeof(struct io_uring_cqe));
+    ur->handlers = (cwh_uring_entry_t *)calloc(CWH_URING_INITIAL_SLOTS, sizeof(cwh_uring_entry_t));
+    if (!ur->ready || !ur->handlers)
+        goto fail;
+
+#if CWH_URING_COMPLETION
+    uring_setup_buffers(ur);
+#endif
+
+    ur->num_handlers = CWH_URING_INITIAL_SLOTS;
+    ur->running = 0;
+    ur->loop_ptr = NULL; // Will be set by loop.c
+    return ur;
+
+fail:
+    free(ur->ready);
+    free(ur->handlers);
+    uring_unmap(ur);
+    close(ur->ring_fd);
+    free(ur);
+    return NULL;
+}
+
+// Next free submission entry, flushing the ring when it is full
+// The tail is published right away: without SQPOLL the kernel only reads
+// SQEs inside io_uring_enter, by which time the caller has filled it in.
+static struct io_uring_sqe *uring_sqe(cwh_uring_t *ur)
+{
+    unsigned tail = *ur->sq_tail;
+    if (tail - __atomic_load_n(ur->sq_head, __ATOMIC_ACQUIRE) >= ur->sq_entries)
+    {
+        if (uring_flush(ur) < 0)
+            return NULL;
+        if (tail - __atomic_load_n(ur->sq_head, __ATOMIC_ACQUIRE) >= ur->sq_entries)
+            return NULL;
+    }
+
+    unsigned index = tail & *ur->sq_mask;
+    struct io_uring_sqe *sqe = &ur->sqes[index];
+    memset(sqe, 0, sizeof(*sqe));
+    ur->sq_array[index] = index;
+    __atomic_store_n(ur->sq_tail, tail + 1, __ATOMIC_RELEASE);
+    ur->to_submit++;
+    return sqe;
+}
+
+static uint64_t poll_user_data(int fd, uint32_t gen)
+{
+    return ((uint64_t)gen << 32) | ((uint64_t)(uint32_t)fd << 3) | CWH_URING_TAG_POLL;
+}
+
+static uint64_t io_user_data(cwh_uring_io_t *io, unsigned tag)
+{
+    return (uint64_t)(uintptr_t)io | tag;
+}
+
+// Convert cwebhttp events to poll events
+static unsigned cwh_to_poll_events(int events)
+{
+    unsigned mask = 0;
+    if (events & CWH_EVENT_READ)
+        mask |= POLLIN;
+    if (events & CWH_EVENT_WRITE)
+        mask |= POLLOUT;
+    if (events & CWH_EVENT_ERROR)
+        mask |= POLLERR;
+    return mask;
+}
+
+// Convert poll events to cwebhttp events
+static int poll_to_cwh_events(unsigned mask)
+{
+    int events = 0;
+    if (mask & POLLIN)
+        events |= CWH_EVENT_READ;
+    if (mask & POLLOUT)
+        events |= CWH_EVENT_WRITE;
+    if (mask & (POLLERR | POLLHUP | POLLNVAL))
+        events |= CWH_EVENT_ERROR;
+    return events;
+}
+
+// Queue a poll request for the entry's current interest set
+// (completion I/O only polls for POLLOUT, when sendfile found the socket full)
+static int uring_arm(cwh_uring_t *ur, int fd, cwh_uring_entry_t *entry)
+{
+    struct io_uring_sqe *sqe = uring_sqe(ur);
+    if (!sqe)
+        return -1;
+
+    entry->gen++;
+    entry->armed = true;
+    sqe->opcode = IORING_OP_POLL_ADD;
+    sqe->fd = fd;
+    sqe->poll32_events = entry->io ? POLLOUT : cwh_to_poll_events(entry->events);
+    sqe->user_data = poll_user_data(fd, entry->gen);
+    return 0;
+}
+
+// Queue removal of the entry's outstanding poll request
+static int uring_disarm(cwh_uring_t *ur, int fd, cwh_uring_entry_t *entry)
+{
+    if (!entry->armed)
+        return 0;
+
+    struct io_uring_sqe *sqe = uring_sqe(ur);
+    if (!sqe)
+        return -1;
+
+    entry->armed = false;
+    sqe->opcode = IORING_OP_POLL_REMOVE;
+    sqe->fd = -1;
+    sqe->addr = poll_user_data(fd, entry->gen);
+    sqe->user_data = CWH_URING_IGNORE;
+    return 0;
+}
+
+// Queue a timeout for the coming wait (kernels without EXT_ARG)
+// A timeout left over from an earlier wakeup is cancelled in the same batch
+static int uring_wait_timeout(cwh_uring_t *ur)
+{
+    struct io_uring_sqe *sqe;
+    if (ur->timeouts_pending > 0)
+    {
+        sqe = uring_sqe(ur);
+        if (!sqe)
+            return -1;
+        sqe->opcode = IORING_OP_TIMEOUT_REMOVE;
+        sqe->fd = -1;
+        sqe->addr = CWH_URING_TIMEOUT;
+        sqe->user_data = CWH_URING_IGNORE;
+    }
+
+    sqe = uring_sqe(ur);
+    if (!sqe)
+        return -1;
+    sqe->opcode = IORING_OP_TIMEOUT;
+    sqe->fd = -1;
+    sqe->addr = (uint64_t)(uintptr_t)&ur->wait_ts;
+    sqe->len = 1;
+    sqe->user_data = CWH_URING_TIMEOUT;
+    ur->timeouts_pending++;
+    return 0;
+}
+
+// Find event handler by fd
+static cwh_uring_entry_t *find_handler(cwh_uring_t *ur, int fd)
+{
+    if (fd >= ur->num_handlers || !ur->handlers[fd].callback)
+        return NULL;
+    return &ur->handlers[fd];
+}
+
+// Grow handler table so that fd is a valid index
+static int ensure_slot(cwh_uring_t *ur, int fd)
+{
+    if (fd < ur->num_handlers)
+        return 0;
+
+    int new_size = ur->num_handlers;
+    while (new_size <= fd)
+        new_size *= 2;
+
+    cwh_uring_entry_t *slots = (cwh_uring_entry_t *)realloc(ur->handlers, new_size * sizeof(cwh_uring_entry_t));
+    if (!slots)
+        return -1;
+
+    memset(slots + ur->num_handlers, 0, (new_size - ur->num_handlers) * sizeof(cwh_uring_entry_t));
+    ur->handlers = slots;
+    ur->num_handlers = new_size;
+    return 0;
+}
+
+// ============================================================================
+// Completion I/O
+// ============================================================================
+
+// Queue cancellation of the request with this user_data
+static void uring_cancel(cwh_uring_t *ur, uint64_t user_data)
+{
+    struct io_uring_sqe *sqe = uring_sqe(ur);
+    if (!sqe)
+        return;
+    sqe->opcode = IORING_OP_ASYNC_CANCEL;
+    sqe->fd = -1;
+    sqe->addr = user_data;
+    sqe->user_data = CWH_URING_IGNORE;
+}
+
+// Send queue storage: small queues reuse pooled blocks
+static char *send_buf_acquire(cwh_uring_t *ur, size_t want, size_t *cap)
+{
+    if (want <= CWH_URING_SEND_BLOCK && ur->send_pool)
+    {
+        char *buf = ur->send_pool;
+        memcpy(&ur->send_pool, buf, sizeof(char *));
+        ur->send_pool_count--;
+        *cap = CWH_URING_SEND_BLOCK;
+        return buf;
+    }
+
+    size_t size = CWH_URING_SEND_BLOCK;
+    while (size < want && size < CWH_URING_SEND_MAX)
+        size *= 2;
+    char *buf = (char *)malloc(size);
+    *cap = buf ? size : 0;
+    return buf;
+}
+
+static void send_buf_release(cwh_uring_t *ur, char *buf, size_t cap)
+{
+    if (cap == CWH_URING_SEND_BLOCK && ur->send_pool_count < CWH_URING_SEND_POOL)
+    {
+        memcpy(buf, &ur->send_pool, sizeof(char *));
+        ur->send_pool = buf;
+        ur->send_pool_count++;
+        return;
+    }
+    free(buf);
+}
+
+// Drop the send queue (sent, failed or abandoned)
+static void io_send_reset(cwh_uring_t *ur, cwh_uring_io_t *io)
+{
+    if (io->sbuf)
+        send_buf_release(ur, io->sbuf, io->scap);
+    io->sbuf = NULL;
+    io->scap = 0;
+    io->shead = 0;
+    io->stail = 0;
+    io->wait_drain = false;
+}
+
+// Give the current receive buffer back to the ring
+static void io_recv_release(cwh_uring_t *ur, cwh_uring_io_t *io)
+{
+#if CWH_URING_COMPLETION
+    if (io->rbuf)
+        recv_buf_add(ur, io->rbid);
+#else
+    (void)ur;
+#endif
+    io->rbuf = NULL;
+    io->rlen = 0;
+    io->roff = 0;
+}
+
+static cwh_uring_io_t *io_new(cwh_uring_t *ur, int fd)
+{
+    cwh_uring_io_t *io = (cwh_uring_io_t *)calloc(1, sizeof(cwh_uring_io_t));
+    if (!io)
+        return NULL;
+    io->fd = fd;
+    io->attached = true;
+    io->next = ur->ios;
+    if (ur->ios)
+        ur->ios->prev = io;
+    ur->ios = io;
+    return io;
+}
+
+// Free a detached object once the kernel has no request on it
+static void io_release(cwh_uring_t *ur, cwh_uring_io_t *io)
+{
+    if (io->attached || io->pending || io->send_queued || io->recv_inflight || io->send_inflight ||
+        io->linger_armed)
+        return;
+
+    if (io->recv_starved)
+        ur->starved--;
+    io_recv_release(ur, io);
+    io_send_reset(ur, io);
+    if (io->lingering)
+        close(io->fd);
+
+    if (io->prev)
+        io->prev->next = io->next;
+    else
+        ur->ios = io->next;
+    if (io->next)
+        io->next->prev = io->prev;
+    free(io);
+}
+
+// Keep a RECV in flight while nothing is buffered
+static void io_arm_recv(cwh_uring_t *ur, cwh_uring_io_t *io)
+{
+    if (!io->attached || io->recv_inflight || io->recv_starved || io->rbuf || io->eof || io->error)
+        return;
+
+#if CWH_URING_COMPLETION
+    struct io_uring_sqe *sqe = uring_sqe(ur);
+    if (!sqe)
+        return;
+    sqe->opcode = IORING_OP_RECV;
+    sqe->fd = io->fd;
+    sqe->len = CWH_URING_RECV_BUF_SIZE;
+    sqe->flags = IOSQE_BUFFER_SELECT;
+    sqe->buf_group = CWH_URING_BUF_GROUP;
+    sqe->ioprio = IORING_RECVSEND_POLL_FIRST; // Just drained: wait for data before trying
+    sqe->user_data = io_user_data(io, CWH_URING_TAG_RECV);
+    io->recv_inflight = true;
+#else
+    (void)ur;
+#endif
+}
+
+// Send the queued bytes (one SEND at a time keeps them in order)
+static void io_submit_send(cwh_uring_t *ur, cwh_uring_io_t *io)
+{
+    if (io->send_inflight || io->shead == io->stail)
+        return;
+
+    struct io_uring_sqe *sqe = uring_sqe(ur);
+    if (!sqe)
+        return;
+    sqe->opcode = IORING_OP_SEND;
+    sqe->fd = io->fd;
+    sqe->addr = (uint64_t)(uintptr_t)(io->sbuf + io->shead);
+    sqe->len = (unsigned)(io->stail - io->shead);
+    sqe->msg_flags = MSG_NOSIGNAL;
+    sqe->user_data = io_user_data(io, CWH_URING_TAG_SEND);
+    io->send_inflight = true;
+}
+
+// Events the object is ready for (level-triggered)
+static int io_events(const cwh_uring_io_t *io)
+{
+    int events = 0;
+    if (io->error)
+        events |= CWH_EVENT_ERROR;
+    if (io->rbuf || io->eof)
+        events |= CWH_EVENT_READ;
+    if (!io->wait_pollout && !io->wait_drain && (!io->sbuf || io->stail < io->scap))
+        events |= CWH_EVENT_WRITE;
+    return events;
+}
+
+static void io_pend(cwh_uring_t *ur, cwh_uring_io_t *io)
+{
+    if (io->pending)
+        return;
+    io->pending = true;
+    io->pending_next = ur->pending;
+    ur->pending = io;
+}
+
+// After a change of interest or a callback: keep the requests the
+// registration needs in flight, and report readiness that is already there
+static void io_update(cwh_uring_t *ur, int fd, cwh_uring_entry_t *entry)
+{
+    cwh_uring_io_t *io = entry->io;
+    io_arm_recv(ur, io);
+
+    bool want_poll = (entry->events & CWH_EVENT_WRITE) && io->wait_pollout;
+    if (want_poll && !entry->armed)
+        uring_arm(ur, fd, entry);
+    else if (!want_poll && entry->armed)
+        uring_disarm(ur, fd, entry);
+
+    if (io_events(io) & (entry->events | CWH_EVENT_ERROR))
+        io_pend(ur, io);
+}
+
+// Run the handler for the events the registration is interested in
+static bool io_dispatch(cwh_uring_t *ur, cwh_uring_io_t *io, int events)
+{
+    int fd = io->fd;
+    cwh_uring_entry_t *entry = find_handler(ur, fd);
+    events &= entry->events | CWH_EVENT_ERROR;
+    if (events != 0)
+    {
+        entry->callback((cwh_loop_t *)ur->loop_ptr, fd, events, entry->data);
+        entry = find_handler(ur, fd);
+        if (!entry || entry->io != io)
+            return true; // Removed by the callback
+    }
+
+    io_update(ur, fd, entry);
+    return events != 0;
+}
+
+// A RECV finished: buffer the data (or note EOF/error) for cwh_loop_recv()
+static void io_recv_done(cwh_uring_t *ur, cwh_uring_io_t *io, const struct io_uring_cqe *cqe)
+{
+    io->recv_inflight = false;
+
+#if CWH_URING_COMPLETION
+    if (cqe->flags & IORING_CQE_F_BUFFER)
+    {
+        ur->bufs_free--;
+        io->rbid = cqe->flags >> IORING_CQE_BUFFER_SHIFT;
+        io->rbuf = ur->recv_bufs + (size_t)io->rbid * CWH_URING_RECV_BUF_SIZE;
+        io->rlen = cqe->res > 0 ? (size_t)cqe->res : 0;
+        io->roff = 0;
+        if (cqe->res <= 0 || !io->attached)
+            io_recv_release(ur, io);
+    }
+#endif
+
+    if (!io->attached || cqe->res > 0 || cqe->res == -ECANCELED)
+        return;
+
+    if (cqe->res == 0)
+        io->eof = true;
+    else if (cqe->res == -ENOBUFS)
+    {
+        io->recv_starved = true; // Retried by cwh_uring_wait once buffers come back
+        ur->starved++;
+    }
+    else if (cqe->res != -EAGAIN && cqe->res != -EINTR)
+        io->error = -cqe->res;
+}
+
+// A SEND finished: advance the queue and send the rest
+static void io_send_done(cwh_uring_t *ur, cwh_uring_io_t *io, int res)
+{
+    io->send_inflight = false;
+
+    if (res > 0)
+    {
+        io->shead += (size_t)res;
+        if (io->shead == io->stail)
+            io_send_reset(ur, io); // Drained (wakes a waiting sendfile)
+    }
+    else if (res != -EAGAIN && res != -EINTR)
+    {
+        io_send_reset(ur, io); // Peer gone: the rest can't be delivered
+        if (io->attached)
+            io->error = res < 0 ? -res : EPIPE;
+    }
+
+    io_submit_send(ur, io);
+
+    if (io->lingering && !io->send_inflight && io->linger_armed)
+    {
+        // All sent (or failed): the linger timer is no longer needed
+        struct io_uring_sqe *sqe = uring_sqe(ur);
+        if (sqe)
+        {
+            sqe->opcode = IORING_OP_TIMEOUT_REMOVE;
+            sqe->fd = -1;
+            sqe->addr = io_user_data(io, CWH_URING_TAG_LINGER);
+            sqe->user_data = CWH_URING_IGNORE;
+        }
+    }
+}
+
+// Stop completion I/O for a removed socket. Queued output still goes out on a
+// dup of the fd; SQEs naming the fd are flushed now, before the caller closes it.
+static void io_detach(cwh_uring_t *ur, cwh_uring_io_t *io)
+{
+    io->attached = false;
+    io->error = 0;
+    io_recv_release(ur, io);
+    if (io->recv_starved)
+    {
+        io->recv_starved = false;
+        ur->starved--;
+    }
+    if (io->recv_inflight)
+        uring_cancel(ur, io_user_data(io, CWH_URING_TAG_RECV));
+
+    io_submit_send(ur, io);
+    if (io->shead < io->stail)
+    {
+        int dup_fd = fcntl(io->fd, F_DUPFD_CLOEXEC, 0);
+        ur->syscalls++;
+        struct io_uring_sqe *sqe = dup_fd >= 0 ? uring_sqe(ur) : NULL;
+        if (sqe)
+        {
+            io->fd = dup_fd;
+            io->lingering = true;
+            io->linger_armed = true;
+            io->linger_ts.tv_sec = CWH_URING_LINGER_MS / 1000;
+            io->linger_ts.tv_nsec = (long long)(CWH_URING_LINGER_MS % 1000) * 1000000;
+            sqe->opcode = IORING_OP_TIMEOUT;
+            sqe->fd = -1;
+            sqe->addr = (uint64_t)(uintptr_t)&io->linger_ts;
+            sqe->len = 1;
+            sqe->user_data = io_user_data(io, CWH_URING_TAG_LINGER);
+        }
+        else
+        {
+            if (dup_fd >= 0)
+                close(dup_fd);
+            if (io->send_inflight)
+                uring_cancel(ur, io_user_data(io, CWH_URING_TAG_SEND));
+            io->stail = io->shead; // Dropped; the in-flight part is released on completion
+        }
+    }
+
+    uring_flush(ur);
+    io_release(ur, io);
+}
+
+// Dispatch a completion of a completion I/O request
+static bool io_complete(cwh_uring_t *ur, const struct io_uring_cqe *cqe)
+{
+    unsigned tag = (unsigned)(cqe->user_data & CWH_URING_TAG_MASK);
+    cwh_uring_io_t *io = (cwh_uring_io_t *)(uintptr_t)(cqe->user_data & ~(uint64_t)CWH_URING_TAG_MASK);
+
+    if (tag == CWH_URING_TAG_RECV)
+        io_recv_done(ur, io, cqe);
+    else if (tag == CWH_URING_TAG_SEND)
+        io_send_done(ur, io, cqe->res);
+    else
+    {
+        io->linger_armed = false;
+        if (cqe->res == -ETIME && io->send_inflight)
+            uring_cancel(ur, io_user_data(io, CWH_URING_TAG_SEND)); // Peer stopped reading
+    }
+
+    if (!io->attached)
+    {
+        io_release(ur, io);
+        return false;
+    }
+    return io_dispatch(ur, io, io_events(io));
+}
+
+// Received bytes of a completion registration
+int cwh_uring_recv(cwh_uring_t *ur, int fd, void *buf, size_t len)
+{
+    cwh_uring_entry_t *entry = ur ? find_handler(ur, fd) : NULL;
+    if (!entry || !entry->io)
+    {
+        errno = EINVAL;
+        return -1;
+    }
+
+    cwh_uring_io_t *io = entry->io;
+    if (io->rbuf)
+    {
+        size_t n = io->rlen - io->roff < len ? io->rlen - io->roff : len;
+        memcpy(buf, io->rbuf + io->roff, n);
+        io->roff += n;
+        if (io->roff == io->rlen)
+        {
+            io_recv_release(ur, io);
+            io_arm_recv(ur, io);
+        }
+        return (int)n;
+    }
+
+    if (io->error)
+    {
+        errno = io->error;
+        return -1;
+    }
+    if (io->eof)
+        return 0;
+
+    errno = EAGAIN;
+    return -1;
+}
+
+// Queue bytes on a completion registration (copied; sent with the next wait)
+int cwh_uring_send(cwh_uring_t *ur, int fd, const void *buf, size_t len)
+{
+    cwh_uring_entry_t *entry = ur ? find_handler(ur, fd) : NULL;
+    if (!entry || !entry->io)
+    {
+        errno = EINVAL;
+        return -1;
+    }
+
+    cwh_uring_io_t *io = entry->io;
+    if (io->error)
+    {
+        errno = io->error;
+        return -1;
+    }
+    if (len == 0)
+        return 0;
+
+    if (!io->sbuf)
+    {
+        io->sbuf = send_buf_acquire(ur, len, &io->scap);
+        if (!io->sbuf)
+        {
+            errno = ENOMEM;
+            return -1;
+        }
+    }
+    else if (!io->send_inflight && io->stail + len > io->scap && io->scap < CWH_URING_SEND_MAX)
+    {
+        // The kernel holds no pointer into the queue: grow it for this write
+        size_t used = io->stail - io->shead;
+        memmove(io->sbuf, io->sbuf + io->shead, used);
+        io->shead = 0;
+        io->stail = used;
+
+        size_t size = io->scap;
+        while (size < used + len && size < CWH_URING_SEND_MAX)
+            size *= 2;
+        char *grown = (char *)realloc(io->sbuf, size);
+        if (grown)
+        {
+            io->sbuf = grown;
+            io->scap = size;
+        }
+    }
+
+    size_t n = io->scap - io->stail < len ? io->scap - io->stail : len;
+    if (n == 0)
+    {
+        errno = EAGAIN; // WRITE is reported once the queue drains
+        return -1;
+    }
+
+    memcpy(io->sbuf + io->stail, buf, n);
+    io->stail += n;
+
+    // Sent with the next wait, together with whatever else is written until then
+    if (!io->send_queued)
+    {
+        io->send_queued = true;
+        io->flush_next = ur->flush;
+        ur->flush = io;
+    }
+    return (int)n;
+}
+
+// sendfile on a completion registration, ordered after the queued bytes
+int cwh_uring_sendfile(cwh_uring_t *ur, int fd, int file_fd, uint64_t offset, size_t count)
+{
+    cwh_uring_entry_t *entry = ur ? find_handler(ur, fd) : NULL;
+    if (!entry || !entry->io)
+    {
+        errno = EINVAL;
+        return -1;
+    }
+
+    cwh_uring_io_t *io = entry->io;
+    if (io->error)
+    {
+        errno = io->error;
+        return -1;
+    }
+    if (io->shead < io->stail)
+    {
+        io->wait_drain = true; // WRITE once the queue is out
+        errno = EAGAIN;
+        return -1;
+    }
+
+    off_t off = (off_t)offset;
+    ur->syscalls++;
+    ssize_t n = sendfile(fd, file_fd, &off, count);
+    if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+        io->wait_pollout = true; // Socket full: WRITE comes from a poll
+    return (int)n;
+}
+
+// Registration flags the backend honours
+int cwh_uring_flags(cwh_uring_t *ur)
+{
+    return ur && ur->buf_ring ? CWH_EVENT_COMPLETION : 0;
+}
+
+// ============================================================================
+// Registration
+// ============================================================================
+
+// Add file descriptor to io_uring
+int cwh_uring_add(cwh_uring_t *ur, int fd, int events, cwh_event_cb cb, void *data)
+{
+    if (!ur || fd < 0 || !cb)
+        return -1;
+
+    // Check if already registered
+    if (find_handler(ur, fd))
+        return -1;
+
+    if ((events & CWH_EVENT_COMPLETION) && !ur->buf_ring)
+        return -1;
+
+    if (ensure_slot(ur, fd) < 0)
+        return -1;
+
+    cwh_uring_entry_t *entry = &ur->handlers[fd];
+    entry->events = events & ~CWH_EVENT_COMPLETION;
+    entry->callback = cb;
+    entry->data = data;
+
+    if (events & CWH_EVENT_COMPLETION)
+    {
+        entry->io = io_new(ur, fd);
+        if (!entry->io)
+        {
+            entry->callback = NULL;
+            return -1;
+        }
+        io_update(ur, fd, entry);
+        return 0;
+    }
+
+    if (uring_arm(ur, fd, entry) < 0)
+    {
+        entry->callback = NULL;
+        return -1;
+    }
+
+    return 0;
+}
+
+// Modify file descriptor events
+int cwh_uring_mod(cwh_uring_t *ur, int fd, int events)
+{
+    if (!ur || fd < 0)
+        return -1;
+
+    cwh_uring_entry_t *entry = find_handler(ur, fd);
+    if (!entry)
+        return -1;
+
+    events &= ~CWH_EVENT_COMPLETION;
+    if (entry->events == events)
+        return 0;
+    entry->events = events;
+
+    if (entry->io)
+    {
+        io_update(ur, fd, entry);
+        return 0;
+    }
+
+    // Not armed while its callback runs: re-armed with the new set afterwards
+    if (!entry->armed)
+        return 0;
+
+    if (uring_disarm(ur, fd, entry) < 0)
+        return -1;
+    return uring_arm(ur, fd, entry);
+}
+
+// Remove file descriptor from io_uring
+// The removal goes to the kernel with the next wait, like any other queued SQE
+int cwh_uring_del(cwh_uring_t *ur, int fd)
+{
+    if (!ur || fd < 0)
+        return -1;
+
+    cwh_uring_entry_t *entry = find_handler(ur, fd);
+    if (!entry)
+        return -1;
+
+    if (uring_disarm(ur, fd, entry) < 0)
+        return -1;
+
+    cwh_uring_io_t *io = entry->io;
+
+    // Clear handler slot
+    uint32_t gen = entry->gen;
+    memset(entry, 0, sizeof(*entry));
+    entry->gen = gen;
+
+    if (io)
+        io_detach(ur, io);
+    return 0;
+}
+
+// Re-issue RECVs that found the buffer ring empty, as far as buffers allow
+static void uring_retry_starved(cwh_uring_t *ur)
+{
+    unsigned budget = ur->bufs_free;
+    for (cwh_uring_io_t *io = ur->ios; io && ur->starved > 0 && budget > 0; io = io->next)
+    {
+        if (!io->recv_starved)
+            continue;
+        io->recv_starved = false;
+        ur->starved--;
+        io_arm_recv(ur, io);
+        budget--;
+    }
+}
+
+// Wait for events and dispatch callbacks
+int cwh_uring_wait(cwh_uring_t *ur, int timeout_ms)
+{
+    if (!ur)
+        return -1;
+
+    if (ur->starved > 0 && ur->bufs_free > 0)
+        uring_retry_starved(ur);
+
+    while (ur->flush)
+    {
+        cwh_uring_io_t *io = ur->flush;
+        ur->flush = io->flush_next;
+        io->send_queued = false;
+        io_submit_send(ur, io);
+        if (!io->attached)
+            io_release(ur, io);
+    }
+
+    // Readiness carried over from the last round is dispatched without blocking
+    if (ur->pending)
+        timeout_ms = 0;
+
+    unsigned min_complete = 0;
+    unsigned flags = 0;
+    void *arg = NULL;
+    size_t arg_size = 0;
+#ifdef IORING_FEAT_EXT_ARG
+    struct io_uring_getevents_arg ext;
+#endif
+
+    bool cq_empty = *ur->cq_head == __atomic_load_n(ur->cq_tail, __ATOMIC_ACQUIRE);
+    if (timeout_ms != 0 && cq_empty)
+    {
+        min_complete = 1;
+        flags = IORING_ENTER_GETEVENTS;
+        if (timeout_ms > 0)
+        {
+            ur->wait_ts.tv_sec = timeout_ms / 1000;
+            ur->wait_ts.tv_nsec = (long long)(timeout_ms % 1000) * 1000000;
+#ifdef IORING_FEAT_EXT_ARG
+            if (ur->ext_arg)
+            {
+                memset(&ext, 0, sizeof(ext));
+                ext.ts = (uint64_t)(uintptr_t)&ur->wait_ts;
+                flags |= IORING_ENTER_EXT_ARG;
+                arg = &ext;
+                arg_size = sizeof(ext);
+            }
+#endif
+            if (!arg && uring_wait_timeout(ur) < 0)
+                return -1;
+        }
+    }
+
+    // Submit everything queued since the last wait and block in the same call
+    if (ur->to_submit > 0 || min_complete > 0)
+    {
+        int ret = uring_enter(ur, ur->to_submit, min_complete, flags, arg, arg_size);
+        if (ret < 0)
+        {
+            // Timed out, interrupted or completion backlog: reap what's there
+            if (errno != ETIME && errno != EINTR && errno != EBUSY && errno != EAGAIN)
+                return -1;
+        }
+        else
+        {
+            ur->to_submit -= (unsigned)ret < ur->to_submit ? (unsigned)ret : ur->to_submit;
+        }
+    }
+
+    // Copy completions out before dispatch: callbacks queue new SQEs and may flush
+    unsigned count = 0;
+    unsigned head = *ur->cq_head;
+    unsigned tail = __atomic_load_n(ur->cq_tail, __ATOMIC_ACQUIRE);
+    while (head != tail && count < ur->ready_cap)
+    {
+        struct io_uring_cqe *cqe = &ur->cqes[head & *ur->cq_mask];
+        if (cqe->user_data == CWH_URING_TIMEOUT)
+            ur->timeouts_pending--;
+        else if (cqe->user_data != CWH_URING_IGNORE)
+            ur->ready[count++] = *cqe;
+        head++;
+    }
+    __atomic_store_n(ur->cq_head, head, __ATOMIC_RELEASE);
+
+    // Readiness carried over; dispatched after the completions (a callback
+    // there may add to the list again, for the next round)
+    cwh_uring_io_t *pending = ur->pending;
+    ur->pending = NULL;
+
+    // Dispatch callbacks. Slots are looked up per event because a callback may
+    // remove other fds (slot cleared -> skipped) or add new ones (table may move).
+    int dispatched = 0;
+    for (unsigned i = 0; i < count; i++)
+    {
+        if ((ur->ready[i].user_data & CWH_URING_TAG_MASK) != CWH_URING_TAG_POLL)
+        {
+            dispatched += io_complete(ur, &ur->ready[i]);
+            continue;
+        }
+
+        int fd = (int)((uint32_t)ur->ready[i].user_data >> 3);
+        uint32_t gen = (uint32_t)(ur->ready[i].user_data >> 32);
+        int res = ur->ready[i].res;
+
+        cwh_uring_entry_t *entry = find_handler(ur, fd);
+        if (!entry || !entry->armed || entry->gen != gen)
+            continue; // Stale: removed, re-registered or re-armed since
+
+        entry->armed = false;
+        int events = res < 0 ? CWH_EVENT_ERROR : poll_to_cwh_events((unsigned)res);
+
+        if (entry->io)
+        {
+            // Completion registration: the socket has room again after a full sendfile
+            entry->io->wait_pollout = false;
+            dispatched += io_dispatch(ur, entry->io, events | io_events(entry->io));
+            continue;
+        }
+
+        entry->callback((cwh_loop_t *)ur->loop_ptr, fd, events, entry->data);
+        dispatched++;
+
+        // One-shot poll: re-arm for level-triggered semantics unless the
+        // callback removed the fd or the poll itself failed
+        entry = find_handler(ur, fd);
+        if (entry && !entry->armed && res >= 0)
+            uring_arm(ur, fd, entry);
+    }
+
+    while (pending)
+    {
+        cwh_uring_io_t *io = pending;
+        pending = io->pending_next;
+        io->pending = false;
+        if (!io->attached)
+        {
+            io_release(ur, io);
+            continue;
+        }
+        dispatched += io_dispatch(ur, io, io_events(io));
+    }
+
+    return dispatched;
+}
+
+// Stop io_uring loop
+void cwh_uring_stop(cwh_uring_t *ur)
+{
+    if (ur)
+    {
+        ur->running = 0;
+    }
+}
+
+// Run io_uring loop
+int cwh_uring_run(cwh_uring_t *ur)
+{
+    if (!ur)
+        return -1;
+
+    ur->running = 1;
+    while (ur->running)
+    {
+        int ret = cwh_uring_wait(ur, -1); // Block indefinitely
+        if (ret < 0)
+            return -1;
+    }
+
+    return 0;
+}
+
+// Cleanup io_uring (closing the ring cancels outstanding requests)
+// The kernel tears the ring down asynchronously and then interrupts the
+// threads that used it once (TWA_SIGNAL task_work): a blocking call with a
+// timeout on this thread may fail with EINTR, and should be retried.
+void cwh_uring_free(cwh_uring_t *ur)
+{
+    if (!ur)
+        return;
+
+    if (ur->ring_fd >= 0)
+        close(ur->ring_fd);
+
+    // No request is running any more: completion I/O memory can go
+    while (ur->ios)
+    {
+        cwh_uring_io_t *io = ur->ios;
+        ur->ios = io->next;
+        if (io->lingering)
+            close(io->fd);
+        free(io->sbuf);
+        free(io);
+    }
+    while (ur->send_pool)
+    {
+        char *buf = ur->send_pool;
+        memcpy(&ur->send_pool, buf, sizeof(char *));
+        free(buf);
+    }
+#if CWH_URING_COMPLETION
+    if (ur->buf_ring)
+        munmap(ur->buf_ring, CWH_URING_RECV_BUFS * sizeof(struct io_uring_buf));
+#endif
+    free(ur->recv_bufs);
+
+    free(ur->handlers);
+    free(ur->ready);
+    uring_unmap(ur);
+    free(ur);
+}
+
+// Set loop pointer (called by loop.c after creation)
+void cwh_uring_set_loop(cwh_uring_t *ur, void *loop)
+{
+    if (ur)
+    {
+        ur->loop_ptr = loop;
+    }
+}
+
+// Number of io_uring_enter calls made
+uint64_t cwh_uring_syscalls(cwh_uring_t *ur)
+{
+    return ur ? ur->syscalls : 0;
+}
+
+#else // !CWH_HAVE_IO_URING
+
+// Built without <linux/io_uring.h>: creation fails and loop.c falls back to epoll
+typedef struct cwh_uring cwh_uring_t;
+
+cwh_uring_t *cwh_uring_create(unsigned entries)
+{
+    (void)entries;
+    return NULL;
+}
+
+void cwh_uring_set_loop(cwh_uring_t *ur, void *loop)
+{
+    (void)ur;
+    (void)loop;
+}
+
+int cwh_uring_add(cwh_uring_t *ur, int fd, int events, cwh_event_cb cb, void *data)
+{
+    (void)ur;
+    (void)fd;
+    (void)events;
+    (void)cb;
+    (void)data;
+    return -1;
+}
+
+int cwh_uring_mod(cwh_uring_t *ur, int fd, int events)
+{
+    (void)ur;
+    (void)fd;
+    (void)events;
+    return -1;
+}
+
+int cwh_uring_del(cwh_uring_t *ur, int fd)
+{
+    (void)ur;
+    (void)fd;
+    return -1;
+}
+
+int cwh_uring_wait(cwh_uring_t *ur, int timeout_ms)
+{
+    (void)ur;
+    (void)timeout_ms;
+    return -1;
+}
+
+int cwh_uring_run(cwh_uring_t *ur)
+{
+    (void)ur;
+    return -1;
+}
+
+void cwh_uring_stop(cwh_uring_t *ur)
+{
+    (void)ur;
+}
+
+void cwh_uring_free(cwh_uring_t *ur)
+{
+    (void)ur;
+}
+
+uint64_t cwh_uring_syscalls(cwh_uring_t *ur)
+{
+    (void)ur;
+    return 0;
+}
+
+int cwh_uring_flags(cwh_uring_t *ur)
+{
+    (void)ur;
+    return 0;
+}
+
+int cwh_uring_recv(cwh_uring_t *ur, int fd, void *buf, size_t len)
+{
+    (void)ur;
+    (void)fd;
+    (void)buf;
+    (void)len;
+    errno = EINVAL;
+    return -1;
+}
+
+int cwh_uring_send(cwh_uring_t *ur, int fd, const void *buf, size_t len)
+{
+    (void)ur;
+    (void)fd;
+    (void)buf;
+    (void)len;
+    errno = EINVAL;
+    return -1;
+}
+
+int cwh_uring_sendfile(cwh_uring_t *ur, int fd, int file_fd, uint64_t offset, size_t count)
+{
+    (void)ur;
+    (void)fd;
+    (void)file_fd;
+    (void)offset;
+    (void)count;
+    errno = EINVAL;
+    return -1;
+}
+
+#endif // CWH_HAVE_IO_URING
+
+// Get backend name
+const char *cwh_uring_backend(void)
+{
+    return "io_uring (Linux)";
+}
+
+#endif // __linux__
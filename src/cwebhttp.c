@@ -11,10 +11,12 @@
 #include <stdlib.h>
 #include <time.h>
 #include <zlib.h>
+#include <sys/stat.h>
 
 #if defined(_WIN32) || defined(_WIN64)
 #include <winsock2.h>
 #include <ws2tcpip.h>
+#include <io.h>
 #define strncasecmp _strnicmp
 #define strcasecmp _stricmp
 #else
@@ -28,6 +30,10 @@
 #include <fcntl.h>
 #include <netdb.h>
 #include <errno.h>
+#include <pthread.h>
+#ifdef __linux__
+#include <sys/sendfile.h>
+#endif
 #endif
 
 // Definition of cwh_method_strs
@@ -70,6 +76,62 @@ static int set_nonblocking(int fd)
 #endif
 }
 
+#if CWEBHTTP_ENABLE_TLS
+// One TLS context for every cwh_connect: its per-host session store lets a
+// reconnect resume by ticket or session ID instead of running the full
+// handshake again. Created on first use by whichever thread connects first;
+// the context itself locks its session store. Sessions point into it, so
+// cwh_pool_cleanup() only frees it once the last of them is closed.
+static cwh_tls_context_t *g_tls_client = NULL;
+static int g_tls_client_sessions = 0;    // Open sessions on g_tls_client
+static bool g_tls_client_retire = false; // Free g_tls_client with its last session
+
+#if defined(_WIN32) || defined(_WIN64)
+static SRWLOCK g_tls_client_lock = SRWLOCK_INIT;
+#define TLS_CLIENT_LOCK() AcquireSRWLockExclusive(&g_tls_client_lock)
+#define TLS_CLIENT_UNLOCK() ReleaseSRWLockExclusive(&g_tls_client_lock)
+#else
+static pthread_mutex_t g_tls_client_lock = PTHREAD_MUTEX_INITIALIZER;
+#define TLS_CLIENT_LOCK() pthread_mutex_lock(&g_tls_client_lock)
+#define TLS_CLIENT_UNLOCK() pthread_mutex_unlock(&g_tls_client_lock)
+#endif
+
+// Session on the shared context (*ctx); NULL on failure
+static cwh_tls_session_t *client_tls_session_new(int sock, const char *host, cwh_tls_context_t **ctx)
+{
+    TLS_CLIENT_LOCK();
+    if (!g_tls_client)
+    {
+        cwh_tls_config_t config = cwh_tls_config_default();
+        g_tls_client = cwh_tls_context_new(&config);
+    }
+    cwh_tls_session_t *session = g_tls_client ? cwh_tls_session_new(g_tls_client, sock, host) : NULL;
+    if (session)
+        g_tls_client_sessions++;
+    *ctx = g_tls_client;
+    TLS_CLIENT_UNLOCK();
+    return session;
+}
+
+static void client_tls_session_free(cwh_tls_session_t *session)
+{
+    if (!session)
+        return;
+    cwh_tls_session_free(session); // close_notify still uses the context
+
+    cwh_tls_context_t *retired = NULL;
+    TLS_CLIENT_LOCK();
+    if (--g_tls_client_sessions == 0 && g_tls_client_retire)
+    {
+        retired = g_tls_client;
+        g_tls_client = NULL;
+        g_tls_client_retire = false;
+    }
+    TLS_CLIENT_UNLOCK();
+    cwh_tls_context_free(retired);
+}
+#endif
+
 // ============================================================================
 // Connection Pool for Keep-Alive Support
 // ============================================================================
@@ -110,6 +172,9 @@ cwh_conn_t *cwh_pool_get(const char *host, int port)
             {
                 // Connection expired - remove from pool and close
                 *prev_ptr = curr->next;
+#if CWEBHTTP_ENABLE_TLS
+                client_tls_session_free(curr->tls_session);
+#endif
                 CLOSE_SOCKET(curr->fd);
                 free(curr->host);
                 free(curr);
@@ -143,10 +208,7 @@ void cwh_pool_return(cwh_conn_t *conn)
     if (!conn->keep_alive)
     {
 #if CWEBHTTP_ENABLE_TLS
-        if (conn->tls_session)
-            cwh_tls_session_free(conn->tls_session);
-        if (conn->tls_ctx)
-            cwh_tls_context_free(conn->tls_ctx);
+        client_tls_session_free(conn->tls_session);
 #endif
         if (conn->fd >= 0)
             CLOSE_SOCKET(conn->fd);
@@ -160,10 +222,7 @@ void cwh_pool_return(cwh_conn_t *conn)
     {
         // Close the connection instead of adding to pool
 #if CWEBHTTP_ENABLE_TLS
-        if (conn->tls_session)
-            cwh_tls_session_free(conn->tls_session);
-        if (conn->tls_ctx)
-            cwh_tls_context_free(conn->tls_ctx);
+        client_tls_session_free(conn->tls_session);
 #endif
         if (conn->fd >= 0)
             CLOSE_SOCKET(conn->fd);
@@ -187,10 +246,7 @@ void cwh_pool_cleanup(void)
     {
         cwh_conn_t *next = curr->next;
 #if CWEBHTTP_ENABLE_TLS
-        if (curr->tls_session)
-            cwh_tls_session_free(curr->tls_session);
-        if (curr->tls_ctx)
-            cwh_tls_context_free(curr->tls_ctx);
+        client_tls_session_free(curr->tls_session);
 #endif
         if (curr->fd >= 0)
             CLOSE_SOCKET(curr->fd);
@@ -200,6 +256,24 @@ void cwh_pool_cleanup(void)
     }
     g_connection_pool = NULL;
     g_pool_size = 0;
+
+#if CWEBHTTP_ENABLE_TLS
+    // Pooled sessions are gone; the next cwh_connect() starts a fresh context.
+    // Connections the caller still holds keep it until cwh_close().
+    cwh_tls_context_t *retired = NULL;
+    TLS_CLIENT_LOCK();
+    if (g_tls_client_sessions == 0)
+    {
+        retired = g_tls_client;
+        g_tls_client = NULL;
+    }
+    else
+    {
+        g_tls_client_retire = true;
+    }
+    TLS_CLIENT_UNLOCK();
+    cwh_tls_context_free(retired);
+#endif
 }
 
 #endif // CWEBHTTP_ENABLE_CONNECTION_POOL
@@ -497,6 +571,103 @@ char *cwh_cookie_jar_get(const char *domain, const char *path)
 // End Cookie Jar
 // ============================================================================
 
+// getaddrinfo() answers carry no TTL: cache them this long (seconds, still
+// clamped to the cache's min/max TTL). Short, so a record that changes is
+// picked up about as fast as with a typical DNS TTL.
+#define CWH_GETADDRINFO_TTL 30
+
+// Resolve host into addrs (CWH_DNS_MAX_ADDRS). Literals skip the cache;
+// names come from the shared DNS cache, falling back to getaddrinfo() on a
+// miss or when this caller was picked to refresh a stale entry.
+// Returns the address count, 0 if the name does not resolve.
+static int resolve_host(const char *host, cwh_dns_addr_t *addrs)
+{
+    memset(&addrs[0], 0, sizeof(addrs[0]));
+    if (inet_pton(AF_INET, host, addrs[0].addr) == 1)
+    {
+        addrs[0].family = CWH_DNS_IPV4;
+        return 1;
+    }
+    if (inet_pton(AF_INET6, host, addrs[0].addr) == 1)
+    {
+        addrs[0].family = CWH_DNS_IPV6;
+        return 1;
+    }
+
+    bool refresh = true;
+    int cached = cwh_dns_cache_lookup(host, CWH_DNS_ANY, addrs, CWH_DNS_MAX_ADDRS, &refresh);
+    if (cached >= 0 && !refresh)
+        return cached;
+
+    struct addrinfo hints = {0};
+    hints.ai_family = AF_UNSPEC;     // IPv4 or IPv6
+    hints.ai_socktype = SOCK_STREAM; // TCP
+    hints.ai_protocol = IPPROTO_TCP;
+
+    struct addrinfo *result = NULL;
+    int rc = getaddrinfo(host, NULL, &hints, &result);
+    if (rc != 0)
+    {
+#ifdef EAI_NODATA
+        bool no_name = rc == EAI_NONAME || rc == EAI_NODATA;
+#else
+        bool no_name = rc == EAI_NONAME;
+#endif
+        if (no_name)
+        {
+            cwh_dns_cache_store(host, CWH_DNS_ANY, NULL, 0, 0);
+            return 0;
+        }
+        return cached > 0 ? cached : 0; // Transient failure: keep using stale addresses
+    }
+
+    // getaddrinfo() does not expose TTLs: cache for CWH_GETADDRINFO_TTL
+    int count = 0;
+    for (struct addrinfo *rp = result; rp && count < CWH_DNS_MAX_ADDRS; rp = rp->ai_next)
+    {
+        cwh_dns_addr_t *addr = &addrs[count];
+        memset(addr, 0, sizeof(*addr));
+        if (rp->ai_family == AF_INET)
+        {
+            addr->family = CWH_DNS_IPV4;
+            memcpy(addr->addr, &((struct sockaddr_in *)rp->ai_addr)->sin_addr, 4);
+        }
+        else if (rp->ai_family == AF_INET6)
+        {
+            addr->family = CWH_DNS_IPV6;
+            memcpy(addr->addr, &((struct sockaddr_in6 *)rp->ai_addr)->sin6_addr, 16);
+        }
+        else
+        {
+            continue;
+        }
+        count++;
+    }
+    freeaddrinfo(result);
+
+    cwh_dns_cache_store(host, CWH_DNS_ANY, addrs, count, CWH_GETADDRINFO_TTL);
+    return count;
+}
+
+// Build a socket address for a resolved address and port
+static socklen_t dns_sockaddr(const cwh_dns_addr_t *dns, int port, struct sockaddr_storage *out)
+{
+    memset(out, 0, sizeof(*out));
+    if (dns->family == CWH_DNS_IPV6)
+    {
+        struct sockaddr_in6 *sin6 = (struct sockaddr_in6 *)out;
+        sin6->sin6_family = AF_INET6;
+        sin6->sin6_port = htons((uint16_t)port);
+        memcpy(&sin6->sin6_addr, dns->addr, 16);
+        return sizeof(*sin6);
+    }
+    struct sockaddr_in *sin = (struct sockaddr_in *)out;
+    sin->sin_family = AF_INET;
+    sin->sin_port = htons((uint16_t)port);
+    memcpy(&sin->sin_addr, dns->addr, 4);
+    return sizeof(*sin);
+}
+
 // Connect to host with timeout
 cwh_conn_t *cwh_connect(const char *url, int timeout_ms)
 {
@@ -516,9 +687,8 @@ cwh_conn_t *cwh_connect(const char *url, int timeout_ms)
     if (!parsed.is_valid || !parsed.host)
         return NULL;
 
-    // Convert host and port to null-terminated strings
+    // Convert host to a null-terminated string
     char host[256] = {0};
-    char port_str[16] = {0};
 
     // Extract host (find length until ':' or end)
     const char *host_end = parsed.host;
@@ -533,8 +703,6 @@ cwh_conn_t *cwh_connect(const char *url, int timeout_ms)
     memcpy(host, parsed.host, host_len);
     host[host_len] = '\0';
 
-    snprintf(port_str, sizeof(port_str), "%d", parsed.port);
-
 #if CWEBHTTP_ENABLE_CONNECTION_POOL
     // Try to get an existing connection from the pool
     cwh_conn_t *conn = cwh_pool_get(host, parsed.port);
@@ -549,22 +717,19 @@ cwh_conn_t *cwh_connect(const char *url, int timeout_ms)
 
     // No pooled connection available - create a new one
 
-    // Resolve hostname using getaddrinfo
-    struct addrinfo hints = {0};
-    hints.ai_family = AF_UNSPEC;     // IPv4 or IPv6
-    hints.ai_socktype = SOCK_STREAM; // TCP
-    hints.ai_protocol = IPPROTO_TCP;
-
-    struct addrinfo *result = NULL;
-    if (getaddrinfo(host, port_str, &hints, &result) != 0)
+    // Resolve hostname (DNS cache, getaddrinfo on miss)
+    cwh_dns_addr_t addrs[CWH_DNS_MAX_ADDRS];
+    int num_addrs = resolve_host(host, addrs);
+    if (num_addrs <= 0)
         return NULL;
 
     // Try each address until we successfully connect
     int sock = -1;
-    struct addrinfo *rp;
-    for (rp = result; rp != NULL; rp = rp->ai_next)
+    for (int i = 0; i < num_addrs; i++)
     {
-        sock = socket(rp->ai_family, rp->ai_socktype, rp->ai_protocol);
+        struct sockaddr_storage addr;
+        socklen_t addr_len = dns_sockaddr(&addrs[i], parsed.port, &addr);
+        sock = socket(addr.ss_family, SOCK_STREAM, IPPROTO_TCP);
         if (sock < 0)
             continue;
 
@@ -580,7 +745,7 @@ cwh_conn_t *cwh_connect(const char *url, int timeout_ms)
         }
 
         // Attempt connection
-        int conn_result = connect(sock, rp->ai_addr, (int)rp->ai_addrlen);
+        int conn_result = connect(sock, (struct sockaddr *)&addr, addr_len);
 
         if (conn_result == 0)
         {
@@ -604,7 +769,11 @@ cwh_conn_t *cwh_connect(const char *url, int timeout_ms)
             tv.tv_sec = timeout_ms / 1000;
             tv.tv_usec = (timeout_ms % 1000) * 1000;
 
-            int sel_result = select(sock + 1, NULL, &write_fds, NULL, &tv);
+            // Retried on EINTR: Linux leaves the remaining time in tv
+            int sel_result;
+            do
+                sel_result = select(sock + 1, NULL, &write_fds, NULL, &tv);
+            while (sel_result < 0 && errno == EINTR);
 
             if (sel_result > 0)
             {
@@ -622,8 +791,6 @@ cwh_conn_t *cwh_connect(const char *url, int timeout_ms)
         sock = -1;
     }
 
-    freeaddrinfo(result);
-
     if (sock < 0)
         return NULL;
 
@@ -678,22 +845,10 @@ cwh_conn_t *cwh_connect(const char *url, int timeout_ms)
             return NULL;
         }
 
-        // Create TLS context with default config
-        cwh_tls_config_t tls_config = cwh_tls_config_default();
-        conn->tls_ctx = cwh_tls_context_new(&tls_config);
-        if (!conn->tls_ctx)
-        {
-            CLOSE_SOCKET(sock);
-            free(conn->host);
-            free(conn);
-            return NULL;
-        }
-
-        // Create TLS session
-        conn->tls_session = cwh_tls_session_new(conn->tls_ctx, sock, host);
+        // Session on the shared client context: offers the last session with this host
+        conn->tls_session = client_tls_session_new(sock, host, &conn->tls_ctx);
         if (!conn->tls_session)
         {
-            cwh_tls_context_free(conn->tls_ctx);
             CLOSE_SOCKET(sock);
             free(conn->host);
             free(conn);
@@ -704,8 +859,7 @@ cwh_conn_t *cwh_connect(const char *url, int timeout_ms)
         cwh_tls_error_t tls_err = cwh_tls_handshake(conn->tls_session);
         if (tls_err != CWH_TLS_OK)
         {
-            cwh_tls_session_free(conn->tls_session);
-            cwh_tls_context_free(conn->tls_ctx);
+            client_tls_session_free(conn->tls_session);
             CLOSE_SOCKET(sock);
             free(conn->host);
             free(conn);
@@ -739,7 +893,10 @@ static int send_with_timeout(int fd, const char *buf, size_t len, int timeout_ms
         tv.tv_sec = timeout_ms / 1000;
         tv.tv_usec = (timeout_ms % 1000) * 1000;
 
-        int sel_result = select(fd + 1, NULL, &write_fds, NULL, &tv);
+        int sel_result;
+        do
+            sel_result = select(fd + 1, NULL, &write_fds, NULL, &tv);
+        while (sel_result < 0 && errno == EINTR);
 
         if (sel_result < 0)
             return -1; // Error
@@ -779,7 +936,10 @@ static int recv_with_timeout(int fd, char *buf, size_t len, int timeout_ms)
     tv.tv_sec = timeout_ms / 1000;
     tv.tv_usec = (timeout_ms % 1000) * 1000;
 
-    int sel_result = select(fd + 1, &read_fds, NULL, NULL, &tv);
+    int sel_result;
+    do
+        sel_result = select(fd + 1, &read_fds, NULL, NULL, &tv);
+    while (sel_result < 0 && errno == EINTR);
 
     if (sel_result < 0)
         return -1; // Error
@@ -966,10 +1126,7 @@ void cwh_close(cwh_conn_t *conn)
     if (!conn)
         return;
 #if CWEBHTTP_ENABLE_TLS
-    if (conn->tls_session)
-        cwh_tls_session_free(conn->tls_session);
-    if (conn->tls_ctx)
-        cwh_tls_context_free(conn->tls_ctx);
+    client_tls_session_free(conn->tls_session);
 #endif
     if (conn->fd >= 0)
         CLOSE_SOCKET(conn->fd);
@@ -978,6 +1135,215 @@ void cwh_close(cwh_conn_t *conn)
 #endif
 }
 
+// ============================================================================
+// Delimiter Scanner
+// ============================================================================
+// find_char / skip_to_crlf dominate parse time. On x86 they compare 16 (SSE2)
+// or 32 (AVX2) bytes per step; the implementation is chosen on first use from
+// cpuid and can be forced with cwh_scan_set_impl(). Vector loops only load
+// whole blocks inside [p, end) and leave the tail to the scalar code.
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define CWH_SCAN_X86 1
+#include <immintrin.h>
+#else
+#define CWH_SCAN_X86 0
+#endif
+
+typedef const char *(*scan_char_fn)(const char *p, const char *end, char c);
+typedef const char *(*scan_crlf_fn)(const char *p, const char *end);
+
+// First c in [p, end), or end
+static const char *scan_char_scalar(const char *p, const char *end, char c)
+{
+    while (p < end && *p != c)
+        p++;
+    return p;
+}
+
+// First CRLF in [p, end); if none, the last byte (or p if the range is shorter)
+static const char *scan_crlf_scalar(const char *p, const char *end)
+{
+    while (p + 1 < end && !(p[0] == '\r' && p[1] == '\n'))
+        p++;
+    return p;
+}
+
+#if CWH_SCAN_X86
+__attribute__((target("sse2"))) static const char *scan_char_sse2(const char *p, const char *end, char c)
+{
+    const __m128i needle = _mm_set1_epi8(c);
+    while (end - p >= 16)
+    {
+        __m128i block = _mm_loadu_si128((const __m128i *)p);
+        unsigned mask = (unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(block, needle));
+        if (mask)
+            return p + __builtin_ctz(mask);
+        p += 16;
+    }
+    return scan_char_scalar(p, end, c);
+}
+
+__attribute__((target("sse2"))) static const char *scan_crlf_sse2(const char *p, const char *end)
+{
+    const __m128i cr = _mm_set1_epi8('\r');
+    const __m128i lf = _mm_set1_epi8('\n');
+    while (end - p >= 17) // '\n' block is loaded one byte ahead
+    {
+        __m128i is_cr = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)p), cr);
+        __m128i is_lf = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)(p + 1)), lf);
+        unsigned mask = (unsigned)_mm_movemask_epi8(_mm_and_si128(is_cr, is_lf));
+        if (mask)
+            return p + __builtin_ctz(mask);
+        p += 16;
+    }
+    return scan_crlf_scalar(p, end);
+}
+
+__attribute__((target("avx2"))) static const char *scan_char_avx2(const char *p, const char *end, char c)
+{
+    const __m256i needle = _mm256_set1_epi8(c);
+    while (end - p >= 32)
+    {
+        __m256i block = _mm256_loadu_si256((const __m256i *)p);
+        unsigned mask = (unsigned)_mm256_movemask_epi8(_mm256_cmpeq_epi8(block, needle));
+        if (mask)
+            return p + __builtin_ctz(mask);
+        p += 32;
+    }
+    return scan_char_sse2(p, end, c);
+}
+
+__attribute__((target("avx2"))) static const char *scan_crlf_avx2(const char *p, const char *end)
+{
+    const __m256i cr = _mm256_set1_epi8('\r');
+    const __m256i lf = _mm256_set1_epi8('\n');
+    while (end - p >= 33)
+    {
+        __m256i is_cr = _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *)p), cr);
+        __m256i is_lf = _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *)(p + 1)), lf);
+        unsigned mask = (unsigned)_mm256_movemask_epi8(_mm256_and_si256(is_cr, is_lf));
+        if (mask)
+            return p + __builtin_ctz(mask);
+        p += 32;
+    }
+    return scan_crlf_sse2(p, end);
+}
+#endif
+
+static const char *scan_char_resolve(const char *p, const char *end, char c);
+static const char *scan_crlf_resolve(const char *p, const char *end);
+
+// Scanners in use; they start at the resolvers, which pick them on the first
+// parse. Any thread may get there first, so the pointers are only accessed
+// with __atomic loads and stores.
+static scan_char_fn g_scan_char = scan_char_resolve;
+static scan_crlf_fn g_scan_crlf = scan_crlf_resolve;
+static cwh_scan_impl_t g_scan_impl = CWH_SCAN_AUTO;
+
+bool cwh_cpu_has(cwh_cpu_feature_t feature)
+{
+#if CWH_SCAN_X86
+    __builtin_cpu_init();
+    switch (feature)
+    {
+    case CWH_CPU_SSE2:
+        return __builtin_cpu_supports("sse2");
+    case CWH_CPU_AVX2:
+        return __builtin_cpu_supports("avx2");
+    }
+#endif
+    (void)feature;
+    return false;
+}
+
+static bool scan_impl_supported(cwh_scan_impl_t impl)
+{
+    switch (impl)
+    {
+    case CWH_SCAN_SCALAR:
+        return true;
+    case CWH_SCAN_SSE2:
+        return cwh_cpu_has(CWH_CPU_SSE2);
+    case CWH_SCAN_AVX2:
+        return cwh_cpu_has(CWH_CPU_AVX2);
+    default:
+        return false;
+    }
+}
+
+// Select scanner implementation (CWH_SCAN_AUTO = fastest the CPU supports)
+int cwh_scan_set_impl(cwh_scan_impl_t impl)
+{
+    if (impl == CWH_SCAN_AUTO)
+    {
+        if (scan_impl_supported(CWH_SCAN_AVX2))
+            impl = CWH_SCAN_AVX2;
+        else if (scan_impl_supported(CWH_SCAN_SSE2))
+            impl = CWH_SCAN_SSE2;
+        else
+            impl = CWH_SCAN_SCALAR;
+    }
+    else if (!scan_impl_supported(impl))
+    {
+        return -1;
+    }
+
+    scan_char_fn scan_char = scan_char_scalar;
+    scan_crlf_fn scan_crlf = scan_crlf_scalar;
+#if CWH_SCAN_X86
+    if (impl == CWH_SCAN_AVX2)
+    {
+        scan_char = scan_char_avx2;
+        scan_crlf = scan_crlf_avx2;
+    }
+    else if (impl == CWH_SCAN_SSE2)
+    {
+        scan_char = scan_char_sse2;
+        scan_crlf = scan_crlf_sse2;
+    }
+#endif
+    __atomic_store_n(&g_scan_char, scan_char, __ATOMIC_RELEASE);
+    __atomic_store_n(&g_scan_crlf, scan_crlf, __ATOMIC_RELEASE);
+    __atomic_store_n(&g_scan_impl, impl, __ATOMIC_RELEASE);
+    return 0;
+}
+
+// Active scanner implementation
+cwh_scan_impl_t cwh_scan_get_impl(void)
+{
+    if (__atomic_load_n(&g_scan_impl, __ATOMIC_ACQUIRE) == CWH_SCAN_AUTO)
+        cwh_scan_set_impl(CWH_SCAN_AUTO);
+    return __atomic_load_n(&g_scan_impl, __ATOMIC_ACQUIRE);
+}
+
+const char *cwh_scan_impl_name(cwh_scan_impl_t impl)
+{
+    switch (impl)
+    {
+    case CWH_SCAN_SCALAR:
+        return "scalar";
+    case CWH_SCAN_SSE2:
+        return "sse2";
+    case CWH_SCAN_AVX2:
+        return "avx2";
+    default:
+        return "auto";
+    }
+}
+
+static const char *scan_char_resolve(const char *p, const char *end, char c)
+{
+    cwh_scan_set_impl(CWH_SCAN_AUTO);
+    return __atomic_load_n(&g_scan_char, __ATOMIC_ACQUIRE)(p, end, c);
+}
+
+static const char *scan_crlf_resolve(const char *p, const char *end)
+{
+    cwh_scan_set_impl(CWH_SCAN_AUTO);
+    return __atomic_load_n(&g_scan_crlf, __ATOMIC_ACQUIRE)(p, end);
+}
+
 // Helper: skip whitespace
 static inline const char *skip_ws(const char *p, const char *end)
 {
@@ -989,19 +1355,18 @@ static inline const char *skip_ws(const char *p, const char *end)
 // Helper: skip until CRLF
 static inline const char *skip_to_crlf(const char *p, const char *end)
 {
-    while (p + 1 < end && !(p[0] == '\r' && p[1] == '\n'))
-        p++;
-    return p;
+    return __atomic_load_n(&g_scan_crlf, __ATOMIC_ACQUIRE)(p, end);
 }
 
 // Helper: find character
 static inline const char *find_char(const char *p, const char *end, char c)
 {
-    while (p < end && *p != c)
-        p++;
-    return p;
+    return __atomic_load_n(&g_scan_char, __ATOMIC_ACQUIRE)(p, end, c);
 }
 
+// Key/value pairs that fit in cwh_request_t / cwh_response_t headers[]
+#define CWH_MAX_HEADERS 16
+
 // Parse HTTP method - zero-alloc, returns pointer into buffer
 static cwh_error_t parse_method(const char **p, const char *end, char **method_out, cwh_method_t *method_type)
 {
@@ -1150,7 +1515,7 @@ cwh_error_t cwh_parse_req(const char *buf, size_t len, cwh_request_t *req)
 
     // Parse headers
     req->num_headers = 0;
-    while (p < end && req->num_headers < 32)
+    while (p < end)
     {
         char *key = NULL;
         char *val = NULL;
@@ -1165,7 +1530,8 @@ cwh_error_t cwh_parse_req(const char *buf, size_t len, cwh_request_t *req)
         if (parse_header(&p, end, &key, &val) != CWH_OK)
             break;
 
-        if (key && val)
+        // Headers beyond capacity are skipped, not mistaken for the body
+        if (key && val && req->num_headers < CWH_MAX_HEADERS)
         {
             req->headers[req->num_headers * 2] = key;
             req->headers[req->num_headers * 2 + 1] = val;
@@ -1206,6 +1572,455 @@ cwh_error_t cwh_parse_req(const char *buf, size_t len, cwh_request_t *req)
     return CWH_OK;
 }
 
+// ============================================================================
+// Incremental Request Parser
+// ============================================================================
+// Resumable wrapper around cwh_parse_req for servers that read requests in
+// pieces: every byte is examined once no matter how the request is split.
+// The parser keeps offsets, not pointers, so the caller may move or grow the
+// buffer between calls (request pointers are rebased automatically).
+
+#define CWH_PARSER_MAX_LINE 4096 // Longest chunk-size / trailer line
+
+enum
+{
+    PARSER_HEADERS = 0,
+    PARSER_BODY_LENGTH,
+    PARSER_BODY_EOF, // Response without framing: body runs until close
+    PARSER_CHUNK_SIZE,
+    PARSER_CHUNK_DATA,
+    PARSER_CHUNK_CRLF,
+    PARSER_TRAILERS,
+    PARSER_DONE,
+    PARSER_FAILED
+};
+
+void cwh_parser_init(cwh_parser_t *parser)
+{
+    if (parser)
+        memset(parser, 0, sizeof(*parser));
+}
+
+static cwh_parse_status_t parser_fail(cwh_parser_t *parser, int status)
+{
+    parser->state = PARSER_FAILED;
+    parser->error_status = status;
+    return CWH_PARSE_ERROR;
+}
+
+// End of the header block (just past CRLFCRLF) or NULL
+static const char *find_header_end(const char *p, const char *end)
+{
+    while (end - p >= 4)
+    {
+        p = skip_to_crlf(p, end);
+        if (end - p < 4)
+            break;
+        if (p[2] == '\r' && p[3] == '\n')
+            return p + 4;
+        p += 2;
+    }
+    return NULL;
+}
+
+// Exact, case-insensitive header name match (key runs up to ':')
+static bool header_name_is(const char *key, const char *name)
+{
+    size_t len = strlen(name);
+    return strncasecmp(key, name, len) == 0 && key[len] == ':';
+}
+
+// Content-Length: digits only, repeated headers must agree (RFC 9112 6.3)
+static int parse_content_length(char *const *headers, size_t num_headers, bool *present, uint64_t *out)
+{
+    *present = false;
+    *out = 0;
+
+    for (size_t i = 0; i < num_headers; i++)
+    {
+        if (!header_name_is(headers[i * 2], "Content-Length"))
+            continue;
+
+        const char *v = headers[i * 2 + 1];
+        uint64_t value = 0;
+        int digits = 0;
+        for (; *v >= '0' && *v <= '9'; v++, digits++)
+        {
+            if (value > (UINT64_MAX - 9) / 10)
+                return -1;
+            value = value * 10 + (uint64_t)(*v - '0');
+        }
+        while (*v == ' ' || *v == '\t')
+            v++;
+        if (digits == 0 || *v != '\r')
+            return -1;
+
+        if (*present && value != *out)
+            return -1;
+        *present = true;
+        *out = value;
+    }
+    return 0;
+}
+
+// Move request pointers after the caller relocated the buffer
+static void rebase_request(cwh_request_t *req, const char *old_base, const char *new_base)
+{
+    uintptr_t from = (uintptr_t)old_base;
+    uintptr_t to = (uintptr_t)new_base;
+#define REBASE(ptr) ((ptr) ? (char *)((uintptr_t)(ptr) - from + to) : NULL)
+    req->method_str = REBASE(req->method_str);
+    req->path = REBASE(req->path);
+    req->query = REBASE(req->query);
+    for (size_t i = 0; i < req->num_headers * 2; i++)
+        req->headers[i] = REBASE(req->headers[i]);
+#undef REBASE
+}
+
+// Same for a response
+static void rebase_response(cwh_response_t *res, const char *old_base, const char *new_base)
+{
+    uintptr_t from = (uintptr_t)old_base;
+    uintptr_t to = (uintptr_t)new_base;
+#define REBASE(ptr) ((ptr) ? (char *)((uintptr_t)(ptr) - from + to) : NULL)
+    res->body = REBASE(res->body);
+    for (size_t i = 0; i < res->num_headers * 2; i++)
+        res->headers[i] = REBASE(res->headers[i]);
+#undef REBASE
+}
+
+// Look for the end of the header block; sets header_len once found
+static bool parser_find_headers(cwh_parser_t *parser, const char *buf, size_t len)
+{
+    // Only new bytes (plus 3 for a split terminator) are searched
+    size_t from = parser->scan_pos > 3 ? parser->scan_pos - 3 : 0;
+    const char *header_end = find_header_end(buf + from, buf + len);
+    if (!header_end)
+    {
+        parser->scan_pos = len;
+        return false;
+    }
+    parser->header_len = (size_t)(header_end - buf);
+    return true;
+}
+
+// Parse the header block once CRLFCRLF has arrived
+static cwh_parse_status_t parser_headers(cwh_parser_t *parser, char *buf, size_t len, cwh_request_t *req)
+{
+    if (!parser_find_headers(parser, buf, len))
+        return CWH_PARSE_NEED_MORE;
+
+    if (cwh_parse_req(buf, parser->header_len, req) != CWH_OK)
+        return parser_fail(parser, 400);
+    req->body = NULL;
+    req->body_len = 0;
+
+    bool has_length;
+    if (parse_content_length(req->headers, req->num_headers, &has_length, &parser->content_length) != 0)
+        return parser_fail(parser, 400);
+
+    const char *te = NULL;
+    for (size_t i = 0; i < req->num_headers && !te; i++)
+    {
+        if (header_name_is(req->headers[i * 2], "Transfer-Encoding"))
+            te = req->headers[i * 2 + 1];
+    }
+
+    if (te)
+    {
+        // Only plain "chunked" is supported; with Content-Length it is a smuggling vector
+        if (strncasecmp(te, "chunked", 7) != 0 || (te[7] != '\r' && te[7] != ' '))
+            return parser_fail(parser, 501);
+        if (has_length)
+            return parser_fail(parser, 400);
+        parser->chunked = true;
+        parser->state = PARSER_CHUNK_SIZE;
+    }
+    else
+    {
+        parser->state = PARSER_BODY_LENGTH;
+    }
+
+    parser->raw_pos = parser->header_len;
+    parser->body_end = parser->header_len;
+    return CWH_PARSE_HEADERS_DONE;
+}
+
+// Decode chunked body in place: data is compacted to follow the headers
+static cwh_parse_status_t parser_chunked(cwh_parser_t *parser, char *buf, size_t len)
+{
+    for (;;)
+    {
+        const char *line = buf + parser->raw_pos;
+        const char *end = buf + len;
+
+        switch (parser->state)
+        {
+        case PARSER_CHUNK_SIZE:
+        {
+            const char *crlf = skip_to_crlf(line, end);
+            if (crlf + 1 >= end || crlf[0] != '\r')
+            {
+                if ((size_t)(end - line) > CWH_PARSER_MAX_LINE)
+                    return parser_fail(parser, 400);
+                return CWH_PARSE_NEED_MORE;
+            }
+
+            uint64_t size = 0;
+            int digits = 0;
+            const char *p = line;
+            for (; p < crlf && isxdigit((unsigned char)*p); p++, digits++)
+            {
+                if (size >> 60)
+                    return parser_fail(parser, 400);
+                size = (size << 4) | (uint64_t)(isdigit((unsigned char)*p) ? *p - '0' : (tolower((unsigned char)*p) - 'a' + 10));
+            }
+            // Chunk extensions (";name=value") are ignored
+            while (p < crlf && (*p == ' ' || *p == '\t'))
+                p++;
+            if (digits == 0 || (p < crlf && *p != ';'))
+                return parser_fail(parser, 400);
+
+            parser->raw_pos = (size_t)(crlf + 2 - buf);
+            parser->chunk_remaining = size;
+            parser->state = size > 0 ? PARSER_CHUNK_DATA : PARSER_TRAILERS;
+            break;
+        }
+
+        case PARSER_CHUNK_DATA:
+        {
+            size_t avail = len - parser->raw_pos;
+            size_t n = parser->chunk_remaining < avail ? (size_t)parser->chunk_remaining : avail;
+            if (parser->body_end != parser->raw_pos)
+                memmove(buf + parser->body_end, buf + parser->raw_pos, n);
+            parser->body_end += n;
+            parser->raw_pos += n;
+            parser->chunk_remaining -= n;
+            if (parser->chunk_remaining > 0)
+                return CWH_PARSE_NEED_MORE;
+            parser->state = PARSER_CHUNK_CRLF;
+            break;
+        }
+
+        case PARSER_CHUNK_CRLF:
+            if (end - line < 2)
+                return CWH_PARSE_NEED_MORE;
+            if (line[0] != '\r' || line[1] != '\n')
+                return parser_fail(parser, 400);
+            parser->raw_pos += 2;
+            parser->state = PARSER_CHUNK_SIZE;
+            break;
+
+        case PARSER_TRAILERS:
+        {
+            // Trailer fields are skipped; an empty line ends the message
+            const char *crlf = skip_to_crlf(line, end);
+            if (crlf + 1 >= end || crlf[0] != '\r')
+            {
+                if ((size_t)(end - line) > CWH_PARSER_MAX_LINE)
+                    return parser_fail(parser, 400);
+                return CWH_PARSE_NEED_MORE;
+            }
+            parser->raw_pos = (size_t)(crlf + 2 - buf);
+            if (crlf == line)
+            {
+                parser->consumed = parser->raw_pos;
+                parser->state = PARSER_DONE;
+                return CWH_PARSE_BODY_DONE;
+            }
+            break;
+        }
+
+        default:
+            return parser_fail(parser, 400);
+        }
+    }
+}
+
+// Body phases shared by requests and responses; once BODY_DONE the decoded
+// body is buf[header_len, body_end)
+static cwh_parse_status_t parser_body(cwh_parser_t *parser, char *buf, size_t len)
+{
+    switch (parser->state)
+    {
+    case PARSER_BODY_LENGTH:
+    {
+        // Body bytes received so far are reported through body_end
+        uint64_t remaining = parser->content_length - parser->body_discarded;
+        size_t avail = len - parser->header_len;
+        parser->body_end = parser->header_len + (avail < remaining ? avail : (size_t)remaining);
+        if (avail < remaining)
+            return CWH_PARSE_NEED_MORE;
+        parser->consumed = parser->body_end;
+        parser->state = PARSER_DONE;
+        return CWH_PARSE_BODY_DONE;
+    }
+
+    case PARSER_BODY_EOF:
+        parser->body_end = len;
+        return CWH_PARSE_NEED_MORE;
+
+    case PARSER_DONE:
+        return CWH_PARSE_BODY_DONE;
+
+    case PARSER_FAILED:
+        return CWH_PARSE_ERROR;
+
+    default:
+        return parser_chunked(parser, buf, len);
+    }
+}
+
+// Feed the parser the whole buffer received so far (len bytes; earlier bytes
+// must be unchanged). Returns HEADERS_DONE once when the header block is
+// parsed, then NEED_MORE until the body is complete and BODY_DONE.
+cwh_parse_status_t cwh_parser_execute(cwh_parser_t *parser, char *buf, size_t len, cwh_request_t *req)
+{
+    if (!parser || !buf || !req || parser->response)
+        return CWH_PARSE_ERROR;
+
+    if (parser->state != PARSER_HEADERS && parser->base != buf)
+        rebase_request(req, parser->base, buf);
+    parser->base = buf;
+
+    if (parser->state == PARSER_HEADERS)
+        return parser_headers(parser, buf, len, req);
+    if (parser->state == PARSER_DONE)
+        return CWH_PARSE_BODY_DONE;
+
+    cwh_parse_status_t status = parser_body(parser, buf, len);
+    if (status != CWH_PARSE_BODY_DONE)
+        return status;
+
+    size_t body_len = parser->body_end - parser->header_len;
+    req->body = body_len > 0 ? buf + parser->header_len : NULL;
+    req->body_len = body_len;
+    return CWH_PARSE_BODY_DONE;
+}
+
+void cwh_parser_init_response(cwh_parser_t *parser, bool head_request)
+{
+    if (!parser)
+        return;
+    memset(parser, 0, sizeof(*parser));
+    parser->response = true;
+    parser->head_request = head_request;
+}
+
+// Status line + headers of a response, then pick the body framing
+static cwh_parse_status_t parser_response_headers(cwh_parser_t *parser, char *buf, size_t len, cwh_response_t *res)
+{
+    if (!parser_find_headers(parser, buf, len))
+        return CWH_PARSE_NEED_MORE;
+
+    if (cwh_parse_res(buf, parser->header_len, res) != CWH_OK)
+        return parser_fail(parser, 502);
+    res->body = NULL;
+    res->body_len = 0;
+
+    parser->raw_pos = parser->header_len;
+    parser->body_end = parser->header_len;
+
+    // RFC 9112 6.3: these never carry a body, whatever the headers say
+    if (parser->head_request || res->status < 200 || res->status == 204 || res->status == 304)
+    {
+        parser->consumed = parser->header_len;
+        parser->state = PARSER_DONE;
+        return CWH_PARSE_HEADERS_DONE;
+    }
+
+    const char *te = NULL;
+    for (size_t i = 0; i < res->num_headers && !te; i++)
+    {
+        if (header_name_is(res->headers[i * 2], "Transfer-Encoding"))
+            te = res->headers[i * 2 + 1];
+    }
+
+    bool has_length;
+    if (te)
+    {
+        // Transfer-Encoding overrides Content-Length; without a final
+        // "chunked" the body is delimited by the connection close
+        const char *line_end = skip_to_crlf(te, buf + parser->header_len);
+        while (line_end > te && (line_end[-1] == ' ' || line_end[-1] == '\t'))
+            line_end--;
+        bool chunked = line_end - te >= 7 && strncasecmp(line_end - 7, "chunked", 7) == 0;
+        parser->chunked = chunked;
+        parser->state = chunked ? PARSER_CHUNK_SIZE : PARSER_BODY_EOF;
+    }
+    else if (parse_content_length(res->headers, res->num_headers, &has_length, &parser->content_length) != 0)
+    {
+        return parser_fail(parser, 502);
+    }
+    else
+    {
+        parser->state = has_length ? PARSER_BODY_LENGTH : PARSER_BODY_EOF;
+    }
+    return CWH_PARSE_HEADERS_DONE;
+}
+
+// Response counterpart of cwh_parser_execute (res->body is set on BODY_DONE;
+// before that the decoded body so far is buf[header_len, body_end))
+cwh_parse_status_t cwh_parser_execute_response(cwh_parser_t *parser, char *buf, size_t len, cwh_response_t *res)
+{
+    if (!parser || !buf || !res || !parser->response)
+        return CWH_PARSE_ERROR;
+
+    if (parser->state != PARSER_HEADERS && parser->base != buf)
+        rebase_response(res, parser->base, buf);
+    parser->base = buf;
+
+    if (parser->state == PARSER_HEADERS)
+        return parser_response_headers(parser, buf, len, res);
+
+    cwh_parse_status_t status = parser_body(parser, buf, len);
+    if (status != CWH_PARSE_BODY_DONE)
+        return status;
+
+    size_t body_len = parser->body_end - parser->header_len;
+    res->body = body_len > 0 ? buf + parser->header_len : NULL;
+    res->body_len = body_len;
+    return CWH_PARSE_BODY_DONE;
+}
+
+cwh_parse_status_t cwh_parser_response_eof(cwh_parser_t *parser, char *buf, size_t len, cwh_response_t *res)
+{
+    cwh_parse_status_t status = cwh_parser_execute_response(parser, buf, len, res);
+    if (status == CWH_PARSE_BODY_DONE || status == CWH_PARSE_ERROR)
+        return status;
+    if (parser->state != PARSER_BODY_EOF)
+        return parser_fail(parser, 502); // Truncated
+
+    parser->consumed = parser->body_end;
+    parser->state = PARSER_DONE;
+    return cwh_parser_execute_response(parser, buf, len, res);
+}
+
+// Drop the body bytes decoded so far ([header_len, body_end)); the rest of the
+// buffer moves down behind the headers. Returns the new buffer length.
+size_t cwh_parser_discard_body(cwh_parser_t *parser, char *buf, size_t len)
+{
+    if (!parser || !buf || parser->state == PARSER_HEADERS || parser->state == PARSER_FAILED)
+        return len;
+
+    size_t body = parser->body_end - parser->header_len;
+    size_t tail = parser->state == PARSER_DONE ? parser->consumed
+                                               : (parser->chunked ? parser->raw_pos : parser->body_end);
+    if (tail > len)
+        tail = len;
+
+    memmove(buf + parser->header_len, buf + tail, len - tail);
+    size_t removed = tail - parser->header_len;
+
+    parser->body_discarded += body;
+    parser->body_end = parser->header_len;
+    if (parser->chunked)
+        parser->raw_pos = parser->header_len;
+    if (parser->state == PARSER_DONE)
+        parser->consumed = parser->header_len;
+    return len - removed;
+}
+
 // Parse HTTP response status line
 static cwh_error_t parse_status_line(const char **p, const char *end, int *status_out)
 {
@@ -1260,7 +2075,7 @@ cwh_error_t cwh_parse_res(const char *buf, size_t len, cwh_response_t *res)
 
     // Parse headers (same as request)
     res->num_headers = 0;
-    while (p < end && res->num_headers < 32)
+    while (p < end)
     {
         char *key = NULL;
         char *val = NULL;
@@ -1275,7 +2090,8 @@ cwh_error_t cwh_parse_res(const char *buf, size_t len, cwh_response_t *res)
         if (parse_header(&p, end, &key, &val) != CWH_OK)
             break;
 
-        if (key && val)
+        // Headers beyond capacity are skipped, not mistaken for the body
+        if (key && val && res->num_headers < CWH_MAX_HEADERS)
         {
             res->headers[res->num_headers * 2] = key;
             res->headers[res->num_headers * 2 + 1] = val;
@@ -1898,6 +2714,13 @@ cwh_server_t *cwh_listen(const char *addr_port, int backlog)
 
     srv->sock = sock;
     srv->routes = NULL;
+    srv->router = cwh_router_new();
+    if (!srv->router)
+    {
+        CLOSE_SOCKET(sock);
+        free(srv);
+        return NULL;
+    }
 
     return srv;
 }
@@ -1909,6 +2732,11 @@ cwh_error_t cwh_route(cwh_server_t *srv, const char *method, const char *pattern
     if (!srv || !handler)
         return CWH_ERR_PARSE;
 
+    // NULL method = any method
+    cwh_method_t method_type = method ? cwh_method_from_str(method) : CWH_METHOD_NUM;
+    if (method && method_type == CWH_METHOD_NUM)
+        return CWH_ERR_PARSE;
+
     // Allocate route
     cwh_route_t *route = malloc(sizeof(cwh_route_t));
     if (!route)
@@ -1916,12 +2744,20 @@ cwh_error_t cwh_route(cwh_server_t *srv, const char *method, const char *pattern
 
     // Copy method (can be NULL for any method)
     route->method = method ? strdup(method) : NULL;
-    // Copy pattern (can be NULL for wildcard matching)
+    // Copy pattern (NULL matches any path)
     route->pattern = pattern ? strdup(pattern) : NULL;
     route->handler = handler;
     route->user_data = user_data;
     route->next = NULL;
 
+    if (cwh_router_add(srv->router, method_type, pattern ? pattern : "*", route) < 0)
+    {
+        free(route->method);
+        free(route->pattern);
+        free(route);
+        return CWH_ERR_PARSE;
+    }
+
     // Add to linked list (at end for predictable ordering)
     if (!srv->routes)
     {
@@ -1938,20 +2774,11 @@ cwh_error_t cwh_route(cwh_server_t *srv, const char *method, const char *pattern
     return CWH_OK;
 }
 
-// Find matching route for request
+// Find matching route for request (fills req->params)
 static cwh_route_t *find_route(cwh_server_t *srv, cwh_request_t *req)
 {
-    for (cwh_route_t *r = srv->routes; r; r = r->next)
-    {
-        // Check method match (NULL method = any method)
-        if (r->method && strncasecmp(r->method, req->method_str, strlen(r->method)) != 0)
-            continue;
-
-        // Check pattern match (NULL pattern = match any path, otherwise exact match)
-        if (r->pattern == NULL || strcmp(r->pattern, req->path) == 0)
-            return r;
-    }
-    return NULL;
+    return (cwh_route_t *)cwh_router_find(srv->router, cwh_method_from_str(req->method_str),
+                                          req->path, req);
 }
 
 // Run server event loop (blocking)
@@ -2047,6 +2874,7 @@ void cwh_free_server(cwh_server_t *srv)
         free(r);
         r = next;
     }
+    cwh_router_free(srv->router);
 
     free(srv);
 }
@@ -2078,15 +2906,19 @@ cwh_error_t cwh_send_response(cwh_conn_t *conn, int status, const char *content_
 
     offset += snprintf(resp_buf + offset, sizeof(resp_buf) - offset, "\r\n");
 
-    // Body
-    if (body && body_len > 0)
+    // Body: coalesce small bodies with the headers, send large ones separately
+    if (body && body_len > 0 && body_len <= sizeof(resp_buf) - offset)
     {
         memcpy(resp_buf + offset, body, body_len);
         offset += body_len;
+        body_len = 0;
     }
 
     // Send
-    send(conn->fd, resp_buf, offset, 0);
+    if (conn_send(conn, resp_buf, offset, 30000) < 0)
+        return CWH_ERR_NET;
+    if (body && body_len > 0 && conn_send(conn, body, body_len, 30000) < 0)
+        return CWH_ERR_NET;
 
     return CWH_OK;
 }
@@ -2173,57 +3005,13 @@ const char *cwh_get_mime_type(const char *path)
 // Send a file to the client
 cwh_error_t cwh_send_file(cwh_conn_t *conn, const char *file_path)
 {
-    if (!conn || !file_path)
-        return CWH_ERR_PARSE;
-
-    // Open file
-    FILE *fp = fopen(file_path, "rb");
-    if (!fp)
-        return cwh_send_status(conn, 404, "File Not Found");
-
-    // Get file size
-    fseek(fp, 0, SEEK_END);
-    long file_size = ftell(fp);
-    fseek(fp, 0, SEEK_SET);
-
-    if (file_size < 0 || file_size > 10 * 1024 * 1024) // Max 10MB
-    {
-        fclose(fp);
-        return cwh_send_status(conn, 413, "File Too Large");
-    }
-
-    // Allocate buffer for file
-    char *file_data = (char *)malloc((size_t)file_size);
-    if (!file_data)
-    {
-        fclose(fp);
-        return CWH_ERR_ALLOC;
-    }
-
-    // Read file
-    size_t bytes_read = fread(file_data, 1, (size_t)file_size, fp);
-    fclose(fp);
-
-    if (bytes_read != (size_t)file_size)
-    {
-        free(file_data);
-        return cwh_send_status(conn, 500, "File Read Error");
-    }
-
-    // Get MIME type
-    const char *mime_type = cwh_get_mime_type(file_path);
-
-    // Send file
-    cwh_error_t err = cwh_send_response(conn, 200, mime_type, file_data, bytes_read);
-
-    free(file_data);
-    return err;
+    return cwh_send_file_range(conn, file_path, NULL);
 }
 
 // Parse Range header (supports "bytes=start-end" format)
 // Returns 1 if range parsed successfully, 0 if no range or invalid
-static int parse_range_header(const char *range_header, size_t file_size,
-                              size_t *out_start, size_t *out_end)
+int cwh_parse_range_header(const char *range_header, size_t file_size,
+                           size_t *out_start, size_t *out_end)
 {
     if (!range_header || !out_start || !out_end)
         return 0;
@@ -2284,66 +3072,85 @@ static int parse_range_header(const char *range_header, size_t file_size,
     return 1;
 }
 
-// Send file with Range request support (HTTP 206 Partial Content)
-cwh_error_t cwh_send_file_range(cwh_conn_t *conn, const char *file_path,
-                                const char *range_header)
+// Stream len bytes of an open file starting at offset to the connection.
+// Plain TCP on Linux uses sendfile(2); TLS and other platforms read in chunks.
+// Uses positional I/O only, so cached descriptors can be shared between threads.
+static cwh_error_t send_file_body(cwh_conn_t *conn, int fd, uint64_t offset, uint64_t len)
 {
-    if (!conn || !file_path)
-        return CWH_ERR_PARSE;
-
-    FILE *fp = fopen(file_path, "rb");
-    if (!fp)
-        return cwh_send_status(conn, 404, "File Not Found");
-
-    // Get file size
-    fseek(fp, 0, SEEK_END);
-    long file_size = ftell(fp);
-    fseek(fp, 0, SEEK_SET);
-
-    if (file_size < 0 || file_size > 10 * 1024 * 1024) // Max 10MB
+#ifdef __linux__
+#if CWEBHTTP_ENABLE_TLS
+    if (!(conn->is_https && conn->tls_session))
+#endif
     {
-        fclose(fp);
-        return cwh_send_status(conn, 413, "File Too Large");
+        off_t off = (off_t)offset;
+        while (len > 0)
+        {
+            size_t chunk = len > (1u << 30) ? (1u << 30) : (size_t)len;
+            ssize_t n = sendfile(conn->fd, fd, &off, chunk);
+            if (n < 0 && (errno == EAGAIN || errno == EINTR))
+            {
+                fd_set write_fds;
+                FD_ZERO(&write_fds);
+                FD_SET(conn->fd, &write_fds);
+                struct timeval tv = {30, 0};
+                if (select(conn->fd + 1, NULL, &write_fds, NULL, &tv) <= 0)
+                    return CWH_ERR_NET;
+                continue;
+            }
+            if (n <= 0)
+                return CWH_ERR_NET; // Error or file truncated
+            len -= (uint64_t)n;
+        }
+        return CWH_OK;
     }
+#endif
 
-    // Parse range if present
-    size_t range_start = 0, range_end = (size_t)file_size - 1;
-    int is_range_request = 0;
+#if defined(_WIN32) || defined(_WIN64)
+    // Windows file cache entries are private to the request, seeking is safe
+    if (_lseeki64(fd, (__int64)offset, SEEK_SET) < 0)
+        return CWH_ERR_NET;
+#endif
 
-    if (range_header)
+    char chunk[16384];
+    while (len > 0)
     {
-        is_range_request = parse_range_header(range_header, (size_t)file_size,
-                                              &range_start, &range_end);
+        size_t want = len > sizeof(chunk) ? sizeof(chunk) : (size_t)len;
+#if defined(_WIN32) || defined(_WIN64)
+        int got = _read(fd, chunk, (unsigned int)want);
+#else
+        ssize_t got = pread(fd, chunk, want, (off_t)offset);
+#endif
+        if (got <= 0)
+            return CWH_ERR_NET;
+        if (conn_send(conn, chunk, (size_t)got, 30000) < 0)
+            return CWH_ERR_NET;
+        offset += (uint64_t)got;
+        len -= (uint64_t)got;
     }
+    return CWH_OK;
+}
 
-    // Calculate content length
-    size_t content_length = is_range_request ? (range_end - range_start + 1) : (size_t)file_size;
+// Send a cached file entry (200, or 206 for a valid Range header)
+static cwh_error_t send_file_entry(cwh_conn_t *conn, const cwh_file_entry_t *entry,
+                                   const char *range_header)
+{
+    uint64_t file_size = entry->size;
 
-    // Allocate buffer for content
-    char *file_data = (char *)malloc(content_length);
-    if (!file_data)
-    {
-        fclose(fp);
-        return CWH_ERR_ALLOC;
-    }
+    // Parse range if present
+    size_t range_start = 0, range_end = file_size > 0 ? (size_t)file_size - 1 : 0;
+    int is_range_request = 0;
 
-    // Seek to start position and read
-    if (is_range_request)
+    if (range_header && file_size > 0)
     {
-        fseek(fp, (long)range_start, SEEK_SET);
+        is_range_request = cwh_parse_range_header(range_header, (size_t)file_size,
+                                                  &range_start, &range_end);
     }
 
-    size_t bytes_read = fread(file_data, 1, content_length, fp);
-    fclose(fp);
-
-    if (bytes_read != content_length)
-    {
-        free(file_data);
-        return cwh_send_status(conn, 500, "File Read Error");
-    }
+    // Calculate content length
+    uint64_t content_length = is_range_request ? (uint64_t)(range_end - range_start + 1) : file_size;
 
     // Build response
-    char resp_buf[16384];
+    char resp_buf[1024];
     size_t offset = 0;
 
     // Status line
@@ -2358,34 +3165,50 @@ cwh_error_t cwh_send_file_range(cwh_conn_t *conn, const char *file_path,
                            "HTTP/1.1 200 OK\r\n");
     }
 
-    // Headers
-    const char *mime_type = cwh_get_mime_type(file_path);
+    // Headers (MIME type and validators are precomputed by the file cache)
     offset += snprintf(resp_buf + offset, sizeof(resp_buf) - offset,
-                       "Content-Type: %s\r\n", mime_type);
+                       "Content-Type: %s\r\n", entry->mime_type);
 
     offset += snprintf(resp_buf + offset, sizeof(resp_buf) - offset,
-                       "Content-Length: %lu\r\n", (unsigned long)content_length);
+                       "Content-Length: %llu\r\n", (unsigned long long)content_length);
 
     offset += snprintf(resp_buf + offset, sizeof(resp_buf) - offset,
-                       "Accept-Ranges: bytes\r\n");
+                       "Accept-Ranges: bytes\r\nETag: %s\r\nLast-Modified: %s\r\n",
+                       entry->etag, entry->last_modified);
 
     if (is_range_request)
     {
         offset += snprintf(resp_buf + offset, sizeof(resp_buf) - offset,
-                           "Content-Range: bytes %lu-%lu/%ld\r\n",
-                           (unsigned long)range_start, (unsigned long)range_end, file_size);
+                           "Content-Range: bytes %llu-%llu/%llu\r\n",
+                           (unsigned long long)range_start, (unsigned long long)range_end,
+                           (unsigned long long)file_size);
     }
 
     offset += snprintf(resp_buf + offset, sizeof(resp_buf) - offset, "\r\n");
 
-    // Send headers
-    send(conn->fd, resp_buf, offset, 0);
+    // Send headers, then stream the body
+    if (conn_send(conn, resp_buf, offset, 30000) < 0)
+        return CWH_ERR_NET;
+    if (content_length > 0)
+        return send_file_body(conn, entry->fd, range_start, content_length);
+    return CWH_OK;
+}
+
+// Send file with Range request support (HTTP 206 Partial Content)
+// The body is streamed, so file size is not limited by memory.
+cwh_error_t cwh_send_file_range(cwh_conn_t *conn, const char *file_path,
+                                const char *range_header)
+{
+    if (!conn || !file_path)
+        return CWH_ERR_PARSE;
 
-    // Send body
-    send(conn->fd, file_data, content_length, 0);
+    cwh_file_entry_t *entry = cwh_file_cache_acquire(file_path);
+    if (!entry)
+        return cwh_send_status(conn, 404, "File Not Found");
 
-    free(file_data);
-    return CWH_OK;
+    cwh_error_t err = send_file_entry(conn, entry, range_header);
+    cwh_file_cache_release(entry);
+    return err;
 }
 
 // Handler for serving static files from a directory
@@ -2413,14 +3236,29 @@ cwh_error_t cwh_serve_static(cwh_request_t *req, cwh_conn_t *conn, void *root_di
         snprintf(file_path + path_len, sizeof(file_path) - path_len, "index.html");
     }
 
-    printf("Serving file: %s\n", file_path);
-    fflush(stdout);
+    // Hot files come straight from the cache: no open/stat per request
+    cwh_file_entry_t *entry = cwh_file_cache_acquire(file_path);
+    if (!entry)
+        return cwh_send_status(conn, 404, "File Not Found");
 
-    // Check for Range header
-    const char *range_header = cwh_get_header(req, "Range");
+    cwh_error_t err;
+    if (cwh_file_not_modified(entry, cwh_get_header(req, "If-None-Match"),
+                              cwh_get_header(req, "If-Modified-Since")))
+    {
+        char resp_buf[256];
+        int len = snprintf(resp_buf, sizeof(resp_buf),
+                           "HTTP/1.1 304 Not Modified\r\nETag: %s\r\nLast-Modified: %s\r\n\r\n",
+                           entry->etag, entry->last_modified);
+        err = conn_send(conn, resp_buf, (size_t)len, 30000) < 0 ? CWH_ERR_NET : CWH_OK;
+    }
+    else
+    {
+        // Range-aware file sending
+        err = send_file_entry(conn, entry, cwh_get_header(req, "Range"));
+    }
 
-    // Use range-aware file sending
-    return cwh_send_file_range(conn, file_path, range_header);
+    cwh_file_cache_release(entry);
+    return err;
 }
 
 // ============================================================================
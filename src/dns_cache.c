@@ -0,0 +1,337 @@
+// dns_cache.c - Process-wide DNS cache for cwh_connect and the async resolver
+// Keyed by normalized host name + address family. Positive answers live for
+// their (clamped) TTL and may be served stale for a while afterwards, with a
+// single caller at a time picked to refresh them. Failures (no such name, no
+// address) are cached for a short negative TTL; timeouts are never cached.
+
+#if !defined(_WIN32) && !defined(_WIN64)
+#define _GNU_SOURCE
+#define _POSIX_C_SOURCE 200112L
+#endif
+
+#include "cwebhttp.h"
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#if defined(_WIN32) || defined(_WIN64)
+#include <windows.h>
+#else
+#include <pthread.h>
+#endif
+
+#define CWH_DNS_CACHE_BUCKETS 256            // Hash buckets (power of two)
+#define CWH_DNS_CACHE_DEFAULT_ENTRIES 1024   // Default capacity
+#define CWH_DNS_CACHE_REFRESH_MS 5000        // A refresh claim expires after this
+#define CWH_DNS_CACHE_MAX_NAME 253
+
+typedef struct cwh_dns_entry
+{
+    char *name;
+    cwh_dns_family_t family;
+    uint32_t hash;
+    cwh_dns_addr_t addrs[CWH_DNS_MAX_ADDRS];
+    int count;            // 0 = cached failure
+    uint64_t expires_ms;
+    uint64_t refresh_ms;  // When a caller was picked to refresh (0 = none)
+    struct cwh_dns_entry *hash_next;
+    struct cwh_dns_entry *lru_prev;
+    struct cwh_dns_entry *lru_next;
+} cwh_dns_entry_t;
+
+// Cache state (process-wide, shared by all client threads and loops)
+static struct
+{
+    cwh_dns_entry_t *buckets[CWH_DNS_CACHE_BUCKETS];
+    cwh_dns_entry_t *lru_head; // Most recently used
+    cwh_dns_entry_t *lru_tail; // Least recently used
+    size_t count;
+    size_t capacity;
+    uint32_t min_ttl;
+    uint32_t max_ttl;
+    uint32_t negative_ttl;
+    uint32_t stale_ttl;
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t stale_hits;
+} g_dns = {.capacity = CWH_DNS_CACHE_DEFAULT_ENTRIES,
+           .min_ttl = 1,
+           .max_ttl = 300,
+           .negative_ttl = 5,
+           .stale_ttl = 30};
+
+#if defined(_WIN32) || defined(_WIN64)
+static SRWLOCK g_dns_lock = SRWLOCK_INIT;
+#define DNS_LOCK() AcquireSRWLockExclusive(&g_dns_lock)
+#define DNS_UNLOCK() ReleaseSRWLockExclusive(&g_dns_lock)
+#else
+static pthread_mutex_t g_dns_lock = PTHREAD_MUTEX_INITIALIZER;
+#define DNS_LOCK() pthread_mutex_lock(&g_dns_lock)
+#define DNS_UNLOCK() pthread_mutex_unlock(&g_dns_lock)
+#endif
+
+// ============================================================================
+// Helpers
+// ============================================================================
+
+static uint64_t dns_now_ms(void)
+{
+#if defined(_WIN32) || defined(_WIN64)
+    return (uint64_t)GetTickCount64();
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000 + (uint64_t)ts.tv_nsec / 1000000;
+#endif
+}
+
+// Lowercase, drop one trailing dot; false if empty or too long
+static bool normalize_host(const char *host, char *out)
+{
+    size_t len = host ? strlen(host) : 0;
+    if (len > 0 && host[len - 1] == '.')
+        len--;
+    if (len == 0 || len > CWH_DNS_CACHE_MAX_NAME)
+        return false;
+    for (size_t i = 0; i < len; i++)
+    {
+        char c = host[i];
+        out[i] = (c >= 'A' && c <= 'Z') ? (char)(c - 'A' + 'a') : c;
+    }
+    out[len] = '\0';
+    return true;
+}
+
+// FNV-1a over the name, then the family
+static uint32_t hash_key(const char *name, cwh_dns_family_t family)
+{
+    uint32_t h = 2166136261u;
+    while (*name)
+    {
+        h ^= (unsigned char)*name++;
+        h *= 16777619u;
+    }
+    h ^= (uint32_t)family;
+    h *= 16777619u;
+    return h;
+}
+
+// ============================================================================
+// Cache bookkeeping (called with the lock held)
+// ============================================================================
+
+static void lru_unlink(cwh_dns_entry_t *entry)
+{
+    if (entry->lru_prev)
+        entry->lru_prev->lru_next = entry->lru_next;
+    else
+        g_dns.lru_head = entry->lru_next;
+    if (entry->lru_next)
+        entry->lru_next->lru_prev = entry->lru_prev;
+    else
+        g_dns.lru_tail = entry->lru_prev;
+    entry->lru_prev = entry->lru_next = NULL;
+}
+
+static void lru_push_front(cwh_dns_entry_t *entry)
+{
+    entry->lru_prev = NULL;
+    entry->lru_next = g_dns.lru_head;
+    if (g_dns.lru_head)
+        g_dns.lru_head->lru_prev = entry;
+    g_dns.lru_head = entry;
+    if (!g_dns.lru_tail)
+        g_dns.lru_tail = entry;
+}
+
+static void cache_remove(cwh_dns_entry_t *entry)
+{
+    cwh_dns_entry_t **p = &g_dns.buckets[entry->hash & (CWH_DNS_CACHE_BUCKETS - 1)];
+    while (*p && *p != entry)
+        p = &(*p)->hash_next;
+    if (*p)
+        *p = entry->hash_next;
+
+    lru_unlink(entry);
+    g_dns.count--;
+    free(entry->name);
+    free(entry);
+}
+
+static cwh_dns_entry_t *cache_find(const char *name, cwh_dns_family_t family, uint32_t hash)
+{
+    cwh_dns_entry_t *entry = g_dns.buckets[hash & (CWH_DNS_CACHE_BUCKETS - 1)];
+    while (entry && (entry->hash != hash || entry->family != family || strcmp(entry->name, name) != 0))
+        entry = entry->hash_next;
+    return entry;
+}
+
+// ============================================================================
+// Public API
+// ============================================================================
+
+int cwh_dns_cache_lookup(const char *host, cwh_dns_family_t family,
+                         cwh_dns_addr_t *addrs, int max_addrs, bool *refresh)
+{
+    bool dummy;
+    if (!refresh)
+        refresh = &dummy;
+    *refresh = true;
+
+    char name[CWH_DNS_CACHE_MAX_NAME + 1];
+    if (!addrs || max_addrs <= 0 || !normalize_host(host, name))
+        return -1;
+
+    uint32_t hash = hash_key(name, family);
+    uint64_t now = dns_now_ms();
+
+    DNS_LOCK();
+    cwh_dns_entry_t *entry = g_dns.capacity > 0 ? cache_find(name, family, hash) : NULL;
+
+    // Failures are never served stale
+    if (entry && now >= entry->expires_ms + (entry->count > 0 ? (uint64_t)g_dns.stale_ttl * 1000 : 0))
+    {
+        cache_remove(entry);
+        entry = NULL;
+    }
+    if (!entry)
+    {
+        g_dns.misses++;
+        DNS_UNLOCK();
+        return -1;
+    }
+
+    lru_unlink(entry);
+    lru_push_front(entry);
+
+    if (now < entry->expires_ms)
+    {
+        g_dns.hits++;
+        *refresh = false;
+    }
+    else
+    {
+        // Stale: hand out the old answer, let one caller refresh it
+        g_dns.stale_hits++;
+        *refresh = entry->refresh_ms == 0 || now - entry->refresh_ms >= CWH_DNS_CACHE_REFRESH_MS;
+        if (*refresh)
+            entry->refresh_ms = now;
+    }
+
+    int count = entry->count < max_addrs ? entry->count : max_addrs;
+    memcpy(addrs, entry->addrs, (size_t)count * sizeof(cwh_dns_addr_t));
+    DNS_UNLOCK();
+    return count;
+}
+
+void cwh_dns_cache_store(const char *host, cwh_dns_family_t family,
+                         const cwh_dns_addr_t *addrs, int count, uint32_t ttl_sec)
+{
+    char name[CWH_DNS_CACHE_MAX_NAME + 1];
+    if (!normalize_host(host, name) || count < 0 || (count > 0 && !addrs))
+        return;
+    if (count > CWH_DNS_MAX_ADDRS)
+        count = CWH_DNS_MAX_ADDRS;
+
+    uint32_t hash = hash_key(name, family);
+
+    DNS_LOCK();
+    if (count > 0)
+    {
+        if (ttl_sec < g_dns.min_ttl)
+            ttl_sec = g_dns.min_ttl;
+        if (ttl_sec > g_dns.max_ttl)
+            ttl_sec = g_dns.max_ttl;
+    }
+    else
+    {
+        ttl_sec = g_dns.negative_ttl;
+    }
+
+    cwh_dns_entry_t *entry = cache_find(name, family, hash);
+    if (g_dns.capacity == 0 || ttl_sec == 0)
+    {
+        if (entry)
+            cache_remove(entry);
+        DNS_UNLOCK();
+        return;
+    }
+
+    if (!entry)
+    {
+        entry = (cwh_dns_entry_t *)calloc(1, sizeof(cwh_dns_entry_t));
+        if (entry)
+            entry->name = strdup(name);
+        if (!entry || !entry->name)
+        {
+            free(entry);
+            DNS_UNLOCK();
+            return;
+        }
+        entry->family = family;
+        entry->hash = hash;
+        cwh_dns_entry_t **bucket = &g_dns.buckets[hash & (CWH_DNS_CACHE_BUCKETS - 1)];
+        entry->hash_next = *bucket;
+        *bucket = entry;
+        g_dns.count++;
+    }
+    else
+    {
+        lru_unlink(entry);
+    }
+    lru_push_front(entry);
+
+    if (count > 0)
+        memcpy(entry->addrs, addrs, (size_t)count * sizeof(cwh_dns_addr_t));
+    entry->count = count;
+    entry->expires_ms = dns_now_ms() + (uint64_t)ttl_sec * 1000;
+    entry->refresh_ms = 0;
+
+    while (g_dns.count > g_dns.capacity && g_dns.lru_tail)
+        cache_remove(g_dns.lru_tail);
+    DNS_UNLOCK();
+}
+
+void cwh_dns_cache_set_ttl(uint32_t min_ttl, uint32_t max_ttl, uint32_t negative_ttl, uint32_t stale_ttl)
+{
+    DNS_LOCK();
+    g_dns.min_ttl = min_ttl;
+    g_dns.max_ttl = max_ttl > min_ttl ? max_ttl : min_ttl;
+    g_dns.negative_ttl = negative_ttl;
+    g_dns.stale_ttl = stale_ttl;
+    DNS_UNLOCK();
+}
+
+void cwh_dns_cache_set_capacity(size_t max_entries)
+{
+    DNS_LOCK();
+    g_dns.capacity = max_entries;
+    while (g_dns.count > g_dns.capacity && g_dns.lru_tail)
+        cache_remove(g_dns.lru_tail);
+    DNS_UNLOCK();
+}
+
+// Drop all entries and reset the counters
+void cwh_dns_cache_clear(void)
+{
+    DNS_LOCK();
+    while (g_dns.lru_tail)
+        cache_remove(g_dns.lru_tail);
+    g_dns.hits = g_dns.misses = g_dns.stale_hits = 0;
+    DNS_UNLOCK();
+}
+
+// Cache statistics
+void cwh_dns_cache_stats(size_t *entries, uint64_t *hits, uint64_t *misses, uint64_t *stale_hits)
+{
+    DNS_LOCK();
+    if (entries)
+        *entries = g_dns.count;
+    if (hits)
+        *hits = g_dns.hits;
+    if (misses)
+        *misses = g_dns.misses;
+    if (stale_hits)
+        *stale_hits = g_dns.stale_hits;
+    DNS_UNLOCK();
+}
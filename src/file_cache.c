@@ -0,0 +1,455 @@
+// file_cache.c - Open file descriptor + metadata cache for static file serving
+// Hot files are served without open/stat: the cache keeps the fd, size,
+// MIME type and precomputed ETag / Last-Modified header values.
+// Linux: invalidated through inotify. Other POSIX: revalidated with stat().
+// Windows: no caching (positional reads need a private fd), entries are
+// opened per request so callers can use one code path.
+
+#if !defined(_WIN32) && !defined(_WIN64)
+#define _GNU_SOURCE
+#define _POSIX_C_SOURCE 200112L
+#endif
+
+#include "cwebhttp.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+
+#if defined(_WIN32) || defined(_WIN64)
+#include <windows.h>
+#include <io.h>
+#define strncasecmp _strnicmp
+#else
+#include <unistd.h>
+#include <errno.h>
+#include <strings.h>
+#include <pthread.h>
+#ifdef __linux__
+#include <sys/inotify.h>
+#endif
+#endif
+
+#define CWH_FILE_CACHE_BUCKETS 1024        // Hash buckets (power of two)
+#define CWH_FILE_CACHE_DEFAULT_ENTRIES 256 // Default capacity (= max cached fds)
+#define CWH_FILE_CACHE_POLL_MS 50          // inotify drain interval
+#define CWH_FILE_CACHE_REVALIDATE_MS 1000  // stat() revalidation without inotify
+
+// Cache state (process-wide, shared by all server threads)
+static struct
+{
+    cwh_file_entry_t *buckets[CWH_FILE_CACHE_BUCKETS];
+    cwh_file_entry_t *lru_head; // Most recently used
+    cwh_file_entry_t *lru_tail; // Least recently used
+    size_t count;
+    size_t capacity;
+    bool initialized;
+    int inotify_fd;
+    uint64_t last_poll_ms;
+    uint64_t hits;
+    uint64_t misses;
+} g_cache = {.capacity = CWH_FILE_CACHE_DEFAULT_ENTRIES, .inotify_fd = -1};
+
+#if !defined(_WIN32) && !defined(_WIN64)
+static pthread_mutex_t g_cache_lock = PTHREAD_MUTEX_INITIALIZER;
+#define CACHE_LOCK() pthread_mutex_lock(&g_cache_lock)
+#define CACHE_UNLOCK() pthread_mutex_unlock(&g_cache_lock)
+#else
+#define CACHE_LOCK()
+#define CACHE_UNLOCK()
+#endif
+
+// ============================================================================
+// Helpers
+// ============================================================================
+
+static uint64_t cache_now_ms(void)
+{
+#if defined(_WIN32) || defined(_WIN64)
+    return (uint64_t)GetTickCount64();
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000 + (uint64_t)ts.tv_nsec / 1000000;
+#endif
+}
+
+// FNV-1a
+static uint32_t hash_path(const char *path)
+{
+    uint32_t h = 2166136261u;
+    while (*path)
+    {
+        h ^= (unsigned char)*path++;
+        h *= 16777619u;
+    }
+    return h;
+}
+
+static void close_fd(int fd)
+{
+#if defined(_WIN32) || defined(_WIN64)
+    _close(fd);
+#else
+    close(fd);
+#endif
+}
+
+// Open path and fill a new entry (not linked into the cache)
+static cwh_file_entry_t *entry_open(const char *path)
+{
+#if defined(_WIN32) || defined(_WIN64)
+    int fd = _open(path, _O_RDONLY | _O_BINARY);
+#else
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+#endif
+    if (fd < 0)
+        return NULL;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode))
+    {
+        close_fd(fd);
+        return NULL;
+    }
+
+    cwh_file_entry_t *entry = (cwh_file_entry_t *)calloc(1, sizeof(cwh_file_entry_t));
+    if (entry)
+        entry->path = strdup(path);
+    if (!entry || !entry->path)
+    {
+        free(entry);
+        close_fd(fd);
+        return NULL;
+    }
+
+    entry->fd = fd;
+    entry->size = (uint64_t)st.st_size;
+    entry->mtime = st.st_mtime;
+    entry->mime_type = cwh_get_mime_type(path);
+    entry->refcount = 1;
+    entry->watch = -1;
+
+    // Weak validator: size + mtime
+    snprintf(entry->etag, sizeof(entry->etag), "W/\"%llx-%llx\"",
+             (unsigned long long)entry->size, (unsigned long long)entry->mtime);
+
+    struct tm tm_buf;
+#if defined(_WIN32) || defined(_WIN64)
+    gmtime_s(&tm_buf, &entry->mtime);
+#else
+    gmtime_r(&entry->mtime, &tm_buf);
+#endif
+    strftime(entry->last_modified, sizeof(entry->last_modified),
+             "%a, %d %b %Y %H:%M:%S GMT", &tm_buf);
+
+    entry->checked_ms = cache_now_ms();
+    return entry;
+}
+
+static void entry_destroy(cwh_file_entry_t *entry)
+{
+    close_fd(entry->fd);
+    free(entry->path);
+    free(entry);
+}
+
+// ============================================================================
+// Cache bookkeeping (called with the lock held)
+// ============================================================================
+
+static void lru_unlink(cwh_file_entry_t *entry)
+{
+    if (entry->lru_prev)
+        entry->lru_prev->lru_next = entry->lru_next;
+    else
+        g_cache.lru_head = entry->lru_next;
+    if (entry->lru_next)
+        entry->lru_next->lru_prev = entry->lru_prev;
+    else
+        g_cache.lru_tail = entry->lru_prev;
+    entry->lru_prev = entry->lru_next = NULL;
+}
+
+static void lru_push_front(cwh_file_entry_t *entry)
+{
+    entry->lru_prev = NULL;
+    entry->lru_next = g_cache.lru_head;
+    if (g_cache.lru_head)
+        g_cache.lru_head->lru_prev = entry;
+    g_cache.lru_head = entry;
+    if (!g_cache.lru_tail)
+        g_cache.lru_tail = entry;
+}
+
+// Drop entry from the cache; freed now or when its last user releases it
+static void cache_remove(cwh_file_entry_t *entry)
+{
+    cwh_file_entry_t **p = &g_cache.buckets[entry->hash & (CWH_FILE_CACHE_BUCKETS - 1)];
+    while (*p && *p != entry)
+        p = &(*p)->hash_next;
+    if (*p)
+        *p = entry->hash_next;
+    entry->hash_next = NULL;
+
+    lru_unlink(entry);
+    g_cache.count--;
+    entry->cached = false;
+
+#ifdef __linux__
+    if (entry->watch >= 0 && g_cache.inotify_fd >= 0)
+    {
+        // Several paths (links) may share one watch
+        bool shared = false;
+        for (cwh_file_entry_t *e = g_cache.lru_head; e && !shared; e = e->lru_next)
+            shared = e->watch == entry->watch;
+        if (!shared)
+            inotify_rm_watch(g_cache.inotify_fd, entry->watch);
+    }
+#endif
+    entry->watch = -1;
+
+    if (--entry->refcount == 0)
+        entry_destroy(entry);
+}
+
+#ifdef __linux__
+// Apply pending inotify events (rate limited; one read() per interval)
+static void cache_poll_inotify(void)
+{
+    uint64_t now = cache_now_ms();
+    if (now - g_cache.last_poll_ms < CWH_FILE_CACHE_POLL_MS)
+        return;
+    g_cache.last_poll_ms = now;
+
+    char buf[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+    for (;;)
+    {
+        ssize_t len = read(g_cache.inotify_fd, buf, sizeof(buf));
+        if (len <= 0)
+            break;
+
+        for (char *p = buf; p < buf + len;)
+        {
+            struct inotify_event *ev = (struct inotify_event *)p;
+            p += sizeof(struct inotify_event) + ev->len;
+            if (ev->mask & IN_Q_OVERFLOW)
+            {
+                // Events were lost: any entry may be stale
+                while (g_cache.lru_tail)
+                    cache_remove(g_cache.lru_tail);
+                continue;
+            }
+            if (ev->wd < 0)
+                continue;
+
+            cwh_file_entry_t *e = g_cache.lru_head;
+            while (e)
+            {
+                cwh_file_entry_t *next = e->lru_next;
+                if (e->watch == ev->wd)
+                {
+                    e->watch = -1; // Kernel drops the watch on IN_IGNORED; don't rm twice
+                    cache_remove(e);
+                }
+                e = next;
+            }
+        }
+    }
+}
+#endif
+
+// ============================================================================
+// Public API
+// ============================================================================
+
+// Open (or reuse) path; returns NULL if it is not a readable regular file
+cwh_file_entry_t *cwh_file_cache_acquire(const char *path)
+{
+    if (!path)
+        return NULL;
+
+#if defined(_WIN32) || defined(_WIN64)
+    return entry_open(path);
+#else
+    CACHE_LOCK();
+
+    if (g_cache.capacity == 0)
+    {
+        CACHE_UNLOCK();
+        return entry_open(path);
+    }
+
+    if (!g_cache.initialized)
+    {
+        g_cache.initialized = true;
+#ifdef __linux__
+        g_cache.inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+#endif
+    }
+
+#ifdef __linux__
+    if (g_cache.inotify_fd >= 0)
+        cache_poll_inotify();
+#endif
+
+    uint32_t hash = hash_path(path);
+    size_t bucket = hash & (CWH_FILE_CACHE_BUCKETS - 1);
+    cwh_file_entry_t *entry = g_cache.buckets[bucket];
+    while (entry && (entry->hash != hash || strcmp(entry->path, path) != 0))
+        entry = entry->hash_next;
+
+    // Without inotify, revalidate with stat() at most once per interval
+    if (entry && entry->watch < 0)
+    {
+        uint64_t now = cache_now_ms();
+        if (now - entry->checked_ms >= CWH_FILE_CACHE_REVALIDATE_MS)
+        {
+            struct stat st;
+            if (stat(path, &st) != 0 || (uint64_t)st.st_size != entry->size || st.st_mtime != entry->mtime)
+            {
+                cache_remove(entry);
+                entry = NULL;
+            }
+            else
+            {
+                entry->checked_ms = now;
+            }
+        }
+    }
+
+    if (entry)
+    {
+        g_cache.hits++;
+        lru_unlink(entry);
+        lru_push_front(entry);
+        entry->refcount++;
+        CACHE_UNLOCK();
+        return entry;
+    }
+
+    g_cache.misses++;
+    entry = entry_open(path);
+    if (!entry)
+    {
+        CACHE_UNLOCK();
+        return NULL;
+    }
+
+    // Make room (LRU entries still in use stay alive until released)
+    while (g_cache.count >= g_cache.capacity && g_cache.lru_tail)
+        cache_remove(g_cache.lru_tail);
+
+#ifdef __linux__
+    if (g_cache.inotify_fd >= 0)
+        entry->watch = inotify_add_watch(g_cache.inotify_fd, path,
+                                         IN_MODIFY | IN_ATTRIB | IN_CLOSE_WRITE |
+                                             IN_DELETE_SELF | IN_MOVE_SELF);
+#endif
+
+    entry->hash = hash;
+    entry->cached = true;
+    entry->refcount++; // Cache reference
+    entry->hash_next = g_cache.buckets[bucket];
+    g_cache.buckets[bucket] = entry;
+    lru_push_front(entry);
+    g_cache.count++;
+
+    CACHE_UNLOCK();
+    return entry;
+#endif
+}
+
+// Release an entry obtained from cwh_file_cache_acquire
+void cwh_file_cache_release(cwh_file_entry_t *entry)
+{
+    if (!entry)
+        return;
+
+    CACHE_LOCK();
+    bool last = --entry->refcount == 0;
+    CACHE_UNLOCK();
+
+    if (last)
+        entry_destroy(entry);
+}
+
+// Set max cached files (0 disables caching); shrinks the cache if needed
+void cwh_file_cache_set_capacity(size_t max_entries)
+{
+    CACHE_LOCK();
+    g_cache.capacity = max_entries;
+    while (g_cache.count > g_cache.capacity && g_cache.lru_tail)
+        cache_remove(g_cache.lru_tail);
+    CACHE_UNLOCK();
+}
+
+// Drop all cached entries (entries in use are freed on release)
+void cwh_file_cache_clear(void)
+{
+    CACHE_LOCK();
+    while (g_cache.lru_tail)
+        cache_remove(g_cache.lru_tail);
+#ifdef __linux__
+    if (g_cache.inotify_fd >= 0)
+    {
+        close(g_cache.inotify_fd);
+        g_cache.inotify_fd = -1;
+    }
+#endif
+    g_cache.initialized = false;
+    CACHE_UNLOCK();
+}
+
+// Cache statistics
+void cwh_file_cache_stats(size_t *entries, uint64_t *hits, uint64_t *misses)
+{
+    CACHE_LOCK();
+    if (entries)
+        *entries = g_cache.count;
+    if (hits)
+        *hits = g_cache.hits;
+    if (misses)
+        *misses = g_cache.misses;
+    CACHE_UNLOCK();
+}
+
+// Compare a raw header value (may not be NUL-terminated) with s
+static bool header_equals(const char *value, const char *s)
+{
+    size_t len = strlen(s);
+    if (strncmp(value, s, len) != 0)
+        return false;
+    return value[len] == '\0' || value[len] == '\r' || value[len] == '\n' ||
+           value[len] == ',' || value[len] == ' ';
+}
+
+// Check conditional request headers against an entry (1 = send 304)
+int cwh_file_not_modified(const cwh_file_entry_t *entry,
+                          const char *if_none_match,
+                          const char *if_modified_since)
+{
+    if (!entry)
+        return 0;
+
+    // If-None-Match takes precedence (RFC 9110 13.2.2)
+    if (if_none_match)
+    {
+        if (if_none_match[0] == '*')
+            return 1;
+        // List of tags: match any
+        for (const char *p = if_none_match; *p && *p != '\r' && *p != '\n'; p++)
+        {
+            if ((p == if_none_match || p[-1] == ' ' || p[-1] == ',') && header_equals(p, entry->etag))
+                return 1;
+        }
+        return 0;
+    }
+
+    if (if_modified_since)
+        return strncasecmp(if_modified_since, entry->last_modified, strlen(entry->last_modified)) == 0;
+
+    return 0;
+}
@@ -0,0 +1,402 @@
+// router.c - Radix-tree request router
+// One compressed path trie per method (plus one for any-method routes).
+// Patterns may contain ":name" (one path segment) and a trailing "*" or
+// "*name" (rest of the path). Lookups walk the trie once; static text is
+// preferred over parameters, parameters over wildcards, with backtracking.
+
+#include "cwebhttp.h"
+#include <stdlib.h>
+#include <string.h>
+
+typedef enum
+{
+    NODE_STATIC,   // Matches prefix literally
+    NODE_PARAM,    // Matches one non-empty segment (up to '/')
+    NODE_WILDCARD  // Matches the rest of the path (may be empty)
+} cwh_node_type_t;
+
+typedef struct cwh_router_node
+{
+    cwh_node_type_t type;
+    char *prefix;        // Static text (NODE_STATIC)
+    size_t prefix_len;
+    char *name;          // Capture name (NODE_PARAM / NODE_WILDCARD)
+    void *data;          // Route registered at this node, NULL if none
+
+    char *indices;                      // First byte of each static child
+    struct cwh_router_node **children;  // Static children
+    size_t num_children;
+    struct cwh_router_node *param;      // ":name" child
+    struct cwh_router_node *wildcard;   // "*" child
+} cwh_router_node_t;
+
+struct cwh_router
+{
+    cwh_router_node_t *roots[CWH_METHOD_NUM + 1]; // Per method, [CWH_METHOD_NUM] = any
+    size_t num_routes;
+};
+
+// ============================================================================
+// Tree construction
+// ============================================================================
+
+static cwh_router_node_t *node_new(cwh_node_type_t type, const char *text, size_t len)
+{
+    cwh_router_node_t *node = (cwh_router_node_t *)calloc(1, sizeof(cwh_router_node_t));
+    if (!node)
+        return NULL;
+
+    node->type = type;
+    char *copy = (char *)malloc(len + 1);
+    if (!copy)
+    {
+        free(node);
+        return NULL;
+    }
+    memcpy(copy, text, len);
+    copy[len] = '\0';
+
+    if (type == NODE_STATIC)
+    {
+        node->prefix = copy;
+        node->prefix_len = len;
+    }
+    else
+    {
+        node->name = copy;
+    }
+    return node;
+}
+
+static void node_free(cwh_router_node_t *node)
+{
+    if (!node)
+        return;
+    for (size_t i = 0; i < node->num_children; i++)
+        node_free(node->children[i]);
+    node_free(node->param);
+    node_free(node->wildcard);
+    free(node->children);
+    free(node->indices);
+    free(node->prefix);
+    free(node->name);
+    free(node);
+}
+
+static int add_child(cwh_router_node_t *parent, cwh_router_node_t *child)
+{
+    size_t n = parent->num_children;
+    cwh_router_node_t **children = (cwh_router_node_t **)realloc(parent->children, (n + 1) * sizeof(*children));
+    if (!children)
+        return -1;
+    parent->children = children;
+
+    char *indices = (char *)realloc(parent->indices, n + 1);
+    if (!indices)
+        return -1;
+    parent->indices = indices;
+
+    children[n] = child;
+    indices[n] = child->prefix[0];
+    parent->num_children = n + 1;
+    return 0;
+}
+
+// Insert static text below node, splitting edges as needed; returns the node
+// where the text ends
+static cwh_router_node_t *insert_static(cwh_router_node_t *node, const char *text, size_t len)
+{
+    while (len > 0)
+    {
+        cwh_router_node_t *child = NULL;
+        size_t index = 0;
+        for (; index < node->num_children; index++)
+        {
+            if (node->indices[index] == text[0])
+            {
+                child = node->children[index];
+                break;
+            }
+        }
+
+        if (!child)
+        {
+            child = node_new(NODE_STATIC, text, len);
+            if (!child || add_child(node, child) < 0)
+            {
+                node_free(child);
+                return NULL;
+            }
+            return child;
+        }
+
+        // Longest common prefix with the existing edge
+        size_t common = 0;
+        while (common < len && common < child->prefix_len && text[common] == child->prefix[common])
+            common++;
+
+        if (common < child->prefix_len)
+        {
+            // Split: new node takes the shared part, old child keeps the rest
+            cwh_router_node_t *split = node_new(NODE_STATIC, child->prefix, common);
+            if (!split)
+                return NULL;
+            memmove(child->prefix, child->prefix + common, child->prefix_len - common + 1);
+            child->prefix_len -= common;
+            if (add_child(split, child) < 0)
+            {
+                node_free(split);
+                return NULL;
+            }
+            node->children[index] = split;
+            child = split;
+        }
+
+        node = child;
+        text += common;
+        len -= common;
+    }
+    return node;
+}
+
+// Capture child (":name" or "*name"); conflicting names are rejected
+static cwh_router_node_t *insert_capture(cwh_router_node_t *node, cwh_node_type_t type,
+                                         const char *name, size_t len)
+{
+    cwh_router_node_t **slot = type == NODE_PARAM ? &node->param : &node->wildcard;
+    if (*slot)
+    {
+        if (strlen((*slot)->name) != len || memcmp((*slot)->name, name, len) != 0)
+            return NULL;
+        return *slot;
+    }
+
+    *slot = node_new(type, name, len);
+    return *slot;
+}
+
+// ============================================================================
+// Public API
+// ============================================================================
+
+cwh_router_t *cwh_router_new(void)
+{
+    return (cwh_router_t *)calloc(1, sizeof(cwh_router_t));
+}
+
+void cwh_router_free(cwh_router_t *router)
+{
+    if (!router)
+        return;
+    for (int i = 0; i <= CWH_METHOD_NUM; i++)
+        node_free(router->roots[i]);
+    free(router);
+}
+
+size_t cwh_router_count(const cwh_router_t *router)
+{
+    return router ? router->num_routes : 0;
+}
+
+int cwh_router_add(cwh_router_t *router, cwh_method_t method, const char *pattern, void *data)
+{
+    if (!router || !pattern || !data || (int)method < 0 || method > CWH_METHOD_NUM)
+        return -1;
+
+    if (!router->roots[method])
+    {
+        router->roots[method] = node_new(NODE_STATIC, "", 0);
+        if (!router->roots[method])
+            return -1;
+    }
+
+    cwh_router_node_t *node = router->roots[method];
+    const char *p = pattern;
+    int captures = 0;
+
+    while (*p)
+    {
+        if (*p == ':' || *p == '*')
+        {
+            bool wildcard = *p == '*';
+            const char *name = ++p;
+            while (*p && *p != '/')
+                p++;
+            size_t name_len = (size_t)(p - name);
+
+            if (++captures > CWH_MAX_PARAMS)
+                return -1;
+            if (wildcard && *p)
+                return -1; // "*" must end the pattern
+            if (!wildcard && name_len == 0)
+                return -1; // ":" needs a name
+            if (wildcard && name_len == 0)
+            {
+                name = "*";
+                name_len = 1;
+            }
+
+            node = insert_capture(node, wildcard ? NODE_WILDCARD : NODE_PARAM, name, name_len);
+        }
+        else
+        {
+            const char *text = p;
+            while (*p && *p != ':' && *p != '*')
+                p++;
+            node = insert_static(node, text, (size_t)(p - text));
+        }
+
+        if (!node)
+            return -1;
+    }
+
+    if (!node->data)
+        router->num_routes++;
+    node->data = data; // Re-registering a pattern replaces it
+    return 0;
+}
+
+// Match path[0..len) below node (node's own text already consumed)
+static void *match_children(const cwh_router_node_t *node, const char *path, size_t len,
+                            cwh_param_t *params, size_t *num_params);
+
+static void *match_node(const cwh_router_node_t *node, const char *path, size_t len,
+                        cwh_param_t *params, size_t *num_params)
+{
+    size_t used;
+    switch (node->type)
+    {
+    case NODE_STATIC:
+        if (len < node->prefix_len || memcmp(path, node->prefix, node->prefix_len) != 0)
+            return NULL;
+        used = node->prefix_len;
+        break;
+
+    case NODE_PARAM:
+    {
+        const char *slash = memchr(path, '/', len);
+        used = slash ? (size_t)(slash - path) : len;
+        if (used == 0)
+            return NULL;
+        break;
+    }
+
+    default: // NODE_WILDCARD
+        used = len;
+        break;
+    }
+
+    size_t saved = *num_params;
+    if (node->type != NODE_STATIC)
+    {
+        params[*num_params].name = node->name;
+        params[*num_params].value = path;
+        params[*num_params].len = used;
+        (*num_params)++;
+    }
+
+    void *data = match_children(node, path + used, len - used, params, num_params);
+    if (!data)
+        *num_params = saved;
+    return data;
+}
+
+// Static child starting with c, NULL if none
+static inline const cwh_router_node_t *static_child(const cwh_router_node_t *node, char c)
+{
+    for (size_t i = 0; i < node->num_children; i++)
+    {
+        if (node->indices[i] == c)
+            return node->children[i];
+    }
+    return NULL;
+}
+
+static void *match_children(const cwh_router_node_t *node, const char *path, size_t len,
+                            cwh_param_t *params, size_t *num_params)
+{
+    // Fast path: while there is nothing to backtrack to, follow static edges
+    // iteratively
+    while (len > 0 && !node->param && !node->wildcard)
+    {
+        const cwh_router_node_t *child = static_child(node, path[0]);
+        if (!child || len < child->prefix_len || memcmp(path, child->prefix, child->prefix_len) != 0)
+            return NULL;
+        path += child->prefix_len;
+        len -= child->prefix_len;
+        node = child;
+    }
+
+    if (len == 0 && node->data)
+        return node->data;
+
+    void *data = NULL;
+    if (len > 0)
+    {
+        const cwh_router_node_t *child = static_child(node, path[0]);
+        if (child)
+            data = match_node(child, path, len, params, num_params);
+        if (!data && node->param)
+            data = match_node(node->param, path, len, params, num_params);
+    }
+    if (!data && node->wildcard)
+        data = match_node(node->wildcard, path, len, params, num_params);
+    return data;
+}
+
+void *cwh_router_find(const cwh_router_t *router, cwh_method_t method, const char *path, cwh_request_t *req)
+{
+    if (!router || !path)
+        return NULL;
+
+    // The query string is not part of the route
+    size_t len = 0;
+    while (path[len] && path[len] != '?')
+        len++;
+
+    cwh_param_t params[CWH_MAX_PARAMS];
+    size_t num_params = 0;
+    void *data = NULL;
+
+    if ((int)method >= 0 && method < CWH_METHOD_NUM && router->roots[method])
+        data = match_node(router->roots[method], path, len, params, &num_params);
+    if (!data && router->roots[CWH_METHOD_NUM])
+        data = match_node(router->roots[CWH_METHOD_NUM], path, len, params, &num_params);
+
+    if (data && req)
+    {
+        memcpy(req->params, params, num_params * sizeof(cwh_param_t));
+        req->num_params = num_params;
+    }
+    return data;
+}
+
+cwh_method_t cwh_method_from_str(const char *method)
+{
+    if (method)
+    {
+        for (int i = 0; i < CWH_METHOD_NUM; i++)
+        {
+            if (strcmp(method, cwh_method_strs[i]) == 0)
+                return (cwh_method_t)i;
+        }
+    }
+    return CWH_METHOD_NUM;
+}
+
+const char *cwh_get_param(const cwh_request_t *req, const char *name, size_t *len)
+{
+    if (!req || !name)
+        return NULL;
+
+    for (size_t i = 0; i < req->num_params; i++)
+    {
+        if (strcmp(req->params[i].name, name) == 0)
+        {
+            if (len)
+                *len = req->params[i].len;
+            return req->params[i].value;
+        }
+    }
+    return NULL;
+}
@@ -4,23 +4,70 @@
 
 #include <string.h>
 #include <stdlib.h>
+#include <errno.h>
 
 #ifdef _WIN32
 #include <winsock2.h>
 #include <ws2tcpip.h>
+#include <windows.h>
 #else
 #include <sys/socket.h>
 #include <netdb.h>
 #include <unistd.h>
+#include <pthread.h>
 #endif
 
 #include "mbedtls/net_sockets.h"
 #include "mbedtls/ssl.h"
 #include "mbedtls/ssl_cache.h"
+#include "mbedtls/ssl_ticket.h"
 #include "mbedtls/entropy.h"
 #include "mbedtls/ctr_drbg.h"
 #include "mbedtls/error.h"
 #include "mbedtls/x509.h"
+#include "mbedtls/platform_util.h"
+
+// Kernel TLS (Linux 4.13+ TX, 4.17+ RX): needs the negotiated keys, which
+// mbedTLS only hands out through its export callback
+#if defined(__linux__) && defined(MBEDTLS_SSL_EXPORT_KEYS) && defined(__has_include)
+#if __has_include(<linux/tls.h>)
+#include <netinet/tcp.h>
+#include <linux/tls.h>
+#define CWH_TLS_KTLS 1
+#ifndef SOL_TLS
+#define SOL_TLS 282
+#endif
+#ifndef TCP_ULP
+#define TCP_ULP 31
+#endif
+#endif
+#endif
+
+#define CWH_TLS_CLIENT_SESSIONS 32 // Servers a client context remembers a session for
+
+// Sessions of one context may handshake on several threads (server shards and
+// handshake workers, cwh_connect() callers), so the state they share is locked
+#ifdef _WIN32
+typedef CRITICAL_SECTION cwh_tls_mutex_t;
+#define tls_mutex_init(m) InitializeCriticalSection(m)
+#define tls_mutex_destroy(m) DeleteCriticalSection(m)
+#define tls_mutex_lock(m) EnterCriticalSection(m)
+#define tls_mutex_unlock(m) LeaveCriticalSection(m)
+#else
+typedef pthread_mutex_t cwh_tls_mutex_t;
+#define tls_mutex_init(m) pthread_mutex_init(m, NULL)
+#define tls_mutex_destroy(m) pthread_mutex_destroy(m)
+#define tls_mutex_lock(m) pthread_mutex_lock(m)
+#define tls_mutex_unlock(m) pthread_mutex_unlock(m)
+#endif
+
+// Last session with one server, offered again on the next connection
+typedef struct
+{
+    char host[256]; // Empty = free slot
+    mbedtls_ssl_session session;
+    uint64_t last_used;
+} cwh_tls_saved_session_t;
 
 // TLS context (global state)
 struct cwh_tls_context
@@ -31,17 +78,31 @@ struct cwh_tls_context
     mbedtls_x509_crt client_cert;
     mbedtls_pk_context client_key;
     mbedtls_ssl_cache_context cache;
+#if defined(MBEDTLS_SSL_TICKET_C)
+    mbedtls_ssl_ticket_context ticket; // Server: ticket keys, rotated every ticket_lifetime
+#endif
     cwh_tls_config_t config;
     bool has_cacert;
     bool has_client_cert;
     bool has_cache;
+    bool has_ticket;
+    cwh_tls_saved_session_t saved[CWH_TLS_CLIENT_SESSIONS];
+    uint64_t saved_clock;
+    mbedtls_ssl_config client_conf; // Shared by every client session
+    mbedtls_ssl_config server_conf; // Shared by every server session
+    bool has_server_conf;           // Only with an own certificate
+    cwh_tls_mutex_t rng_lock;       // ctr_drbg
+    cwh_tls_mutex_t state_lock;     // Session cache and ticket keys
+    cwh_tls_mutex_t handshake_lock; // Without MBEDTLS_THREADING_C: one server handshake step at a time
+#if CWH_TLS_KTLS
+    int *server_suites; // Server preference, AES-GCM first (0-terminated)
+#endif
 };
 
 // TLS session (per-connection)
 struct cwh_tls_session
 {
-    mbedtls_ssl_context ssl;
-    mbedtls_ssl_config conf;
+    mbedtls_ssl_context ssl; // First member: the SNI callback maps ssl back to the session
     cwh_tls_context_t *ctx;
     int socket_fd;
     char *hostname;
@@ -49,6 +110,17 @@ struct cwh_tls_session
     char sni_hostname[256];
     char client_cert_subject[512];
     bool client_cert_verified;
+    int want;                     // Last MBEDTLS_ERR_SSL_WANT_READ / _WRITE
+    bool eof;                     // Peer closed the connection
+    unsigned char offered_master[48]; // Master secret of the session we offered
+    bool offered;
+    bool resumed;
+#if CWH_TLS_KTLS
+    unsigned char key_block[2 * 32 + 2 * 4]; // Client/server write keys, then their salts
+    size_t key_len;                          // 0 = not exported (suite without AEAD keys)
+#endif
+    bool ktls_tx; // The kernel encrypts what is sent on the socket
+    bool ktls_rx; // The kernel decrypts what arrives
 };
 
 // Error string mapping
@@ -72,6 +144,10 @@ const char *cwh_tls_error_string(cwh_tls_error_t error)
         return "Memory allocation failed";
     case CWH_TLS_ERR_INVALID:
         return "Invalid parameter";
+    case CWH_TLS_WANT_READ:
+        return "Waiting for the socket to become readable";
+    case CWH_TLS_WANT_WRITE:
+        return "Waiting for the socket to become writable";
     default:
         return "Unknown error";
     }
@@ -83,6 +159,275 @@ bool cwh_tls_is_available(void)
     return true;
 }
 
+bool cwh_tls_threading_available(void)
+{
+#if defined(MBEDTLS_THREADING_C)
+    return true;
+#else
+    return false;
+#endif
+}
+
+// SNI callback for server-side (registered once on the shared config, so
+// the session is recovered from the ssl context embedded at its start)
+static int sni_callback(void *param, mbedtls_ssl_context *ssl,
+                        const unsigned char *hostname, size_t len)
+{
+    (void)param;
+    cwh_tls_session_t *session = (cwh_tls_session_t *)ssl;
+    if (session && hostname && len > 0 && len < sizeof(session->sni_hostname))
+    {
+        memcpy(session->sni_hostname, hostname, len);
+        session->sni_hostname[len] = '\0';
+    }
+    return 0;
+}
+
+// RNG for the configs, the ticket keys and record IVs
+static int tls_random(void *param, unsigned char *out, size_t len)
+{
+    cwh_tls_context_t *ctx = (cwh_tls_context_t *)param;
+    tls_mutex_lock(&ctx->rng_lock);
+    int ret = mbedtls_ctr_drbg_random(&ctx->ctr_drbg, out, len);
+    tls_mutex_unlock(&ctx->rng_lock);
+    return ret;
+}
+
+// Session cache lookups/stores from concurrent server handshakes
+static int tls_cache_get(void *param, mbedtls_ssl_session *session)
+{
+    cwh_tls_context_t *ctx = (cwh_tls_context_t *)param;
+    tls_mutex_lock(&ctx->state_lock);
+    int ret = mbedtls_ssl_cache_get(&ctx->cache, session);
+    tls_mutex_unlock(&ctx->state_lock);
+    return ret;
+}
+
+static int tls_cache_set(void *param, const mbedtls_ssl_session *session)
+{
+    cwh_tls_context_t *ctx = (cwh_tls_context_t *)param;
+    tls_mutex_lock(&ctx->state_lock);
+    int ret = mbedtls_ssl_cache_set(&ctx->cache, session);
+    tls_mutex_unlock(&ctx->state_lock);
+    return ret;
+}
+
+#if defined(MBEDTLS_SSL_TICKET_C)
+// Ticket keys rotate inside write/parse
+static int tls_ticket_write(void *param, const mbedtls_ssl_session *session, unsigned char *start,
+                            const unsigned char *end, size_t *tlen, uint32_t *lifetime)
+{
+    cwh_tls_context_t *ctx = (cwh_tls_context_t *)param;
+    tls_mutex_lock(&ctx->state_lock);
+    int ret = mbedtls_ssl_ticket_write(&ctx->ticket, session, start, end, tlen, lifetime);
+    tls_mutex_unlock(&ctx->state_lock);
+    return ret;
+}
+
+static int tls_ticket_parse(void *param, mbedtls_ssl_session *session, unsigned char *buf, size_t len)
+{
+    cwh_tls_context_t *ctx = (cwh_tls_context_t *)param;
+    tls_mutex_lock(&ctx->state_lock);
+    int ret = mbedtls_ssl_ticket_parse(&ctx->ticket, session, buf, len);
+    tls_mutex_unlock(&ctx->state_lock);
+    return ret;
+}
+#endif
+
+#if CWH_TLS_KTLS
+// Session whose handshake runs on this thread: the export callback is set on
+// the shared config, so it doesn't learn which ssl context derived the keys
+static _Thread_local cwh_tls_session_t *tls_handshaking;
+
+// Keep the write keys of an AEAD suite (no MAC keys, 4-byte salts) for
+// cwh_tls_enable_ktls
+static int tls_export_keys(void *param, const unsigned char *master, const unsigned char *key_block,
+                           size_t mac_len, size_t key_len, size_t iv_len,
+                           const unsigned char client_random[32], const unsigned char server_random[32],
+                           mbedtls_tls_prf_types prf)
+{
+    (void)param;
+    (void)master;
+    (void)client_random;
+    (void)server_random;
+    (void)prf;
+
+    cwh_tls_session_t *session = tls_handshaking;
+    if (session && mac_len == 0 && iv_len == 4 && key_len <= 32)
+    {
+        memcpy(session->key_block, key_block, 2 * key_len + 2 * iv_len);
+        session->key_len = key_len;
+    }
+    return 0;
+}
+
+// Prefer the AES-GCM suites on the server: mbedTLS lists ChaCha20-Poly1305
+// first, and with it cwh_tls_enable_ktls would never apply
+static int tls_prefer_gcm_suites(cwh_tls_context_t *ctx, mbedtls_ssl_config *conf)
+{
+    const int *all = mbedtls_ssl_list_ciphersuites();
+    size_t n = 0;
+    while (all[n])
+    {
+        n++;
+    }
+
+    ctx->server_suites = calloc(n + 1, sizeof(int));
+    if (!ctx->server_suites)
+    {
+        return MBEDTLS_ERR_SSL_ALLOC_FAILED;
+    }
+
+    size_t k = 0;
+    for (int pass = 0; pass < 2; pass++)
+    {
+        for (size_t i = 0; i < n; i++)
+        {
+            const mbedtls_ssl_ciphersuite_t *suite = mbedtls_ssl_ciphersuite_from_id(all[i]);
+            bool gcm = suite && (suite->cipher == MBEDTLS_CIPHER_AES_128_GCM ||
+                                 suite->cipher == MBEDTLS_CIPHER_AES_256_GCM);
+            if (gcm == (pass == 0))
+            {
+                ctx->server_suites[k++] = all[i];
+            }
+        }
+    }
+
+    mbedtls_ssl_conf_ciphersuites(conf, ctx->server_suites);
+    return 0;
+}
+#endif
+
+// Minimum protocol version from config.min_tls_version (TLS 1.2 default)
+static int tls_min_minor_version(const cwh_tls_context_t *ctx)
+{
+    switch (ctx->config.min_tls_version)
+    {
+    case 0:
+        return MBEDTLS_SSL_MINOR_VERSION_1; // TLS 1.0
+    case 1:
+        return MBEDTLS_SSL_MINOR_VERSION_2; // TLS 1.1
+    case 3:
+        return MBEDTLS_SSL_MINOR_VERSION_4; // TLS 1.3
+    default:
+        return MBEDTLS_SSL_MINOR_VERSION_3; // TLS 1.2
+    }
+}
+
+// Shared client configuration (read-only once sessions use it)
+static int tls_setup_client_conf(cwh_tls_context_t *ctx)
+{
+    mbedtls_ssl_config *conf = &ctx->client_conf;
+
+    int ret = mbedtls_ssl_config_defaults(conf,
+                                          MBEDTLS_SSL_IS_CLIENT,
+                                          MBEDTLS_SSL_TRANSPORT_STREAM,
+                                          MBEDTLS_SSL_PRESET_DEFAULT);
+    if (ret != 0)
+    {
+        return ret;
+    }
+
+    mbedtls_ssl_conf_rng(conf, tls_random, ctx);
+
+    if (ctx->has_cacert)
+    {
+        mbedtls_ssl_conf_ca_chain(conf, &ctx->cacert, NULL);
+    }
+
+    mbedtls_ssl_conf_authmode(conf, ctx->config.verify_peer ? MBEDTLS_SSL_VERIFY_REQUIRED
+                                                            : MBEDTLS_SSL_VERIFY_NONE);
+
+    // Client certificate if available
+    if (ctx->has_client_cert)
+    {
+        ret = mbedtls_ssl_conf_own_cert(conf, &ctx->client_cert, &ctx->client_key);
+        if (ret != 0)
+        {
+            return ret;
+        }
+    }
+
+    mbedtls_ssl_conf_min_version(conf, MBEDTLS_SSL_MAJOR_VERSION_3, tls_min_minor_version(ctx));
+
+    if (ctx->has_cache)
+    {
+        mbedtls_ssl_conf_session_cache(conf, ctx, tls_cache_get, tls_cache_set);
+    }
+
+#if defined(MBEDTLS_SSL_SESSION_TICKETS)
+    // Ask for a ticket: the saved session then resumes even on a server
+    // that no longer has it in its cache
+    mbedtls_ssl_conf_session_tickets(conf, ctx->config.session_cache ? MBEDTLS_SSL_SESSION_TICKETS_ENABLED
+                                                                     : MBEDTLS_SSL_SESSION_TICKETS_DISABLED);
+#endif
+
+#if CWH_TLS_KTLS
+    mbedtls_ssl_conf_export_keys_ext_cb(conf, tls_export_keys, NULL);
+#endif
+    return 0;
+}
+
+// Shared server configuration (the context's certificate is the server's own)
+static int tls_setup_server_conf(cwh_tls_context_t *ctx)
+{
+    mbedtls_ssl_config *conf = &ctx->server_conf;
+
+    int ret = mbedtls_ssl_config_defaults(conf,
+                                          MBEDTLS_SSL_IS_SERVER,
+                                          MBEDTLS_SSL_TRANSPORT_STREAM,
+                                          MBEDTLS_SSL_PRESET_DEFAULT);
+    if (ret != 0)
+    {
+        return ret;
+    }
+
+    mbedtls_ssl_conf_rng(conf, tls_random, ctx);
+
+    ret = mbedtls_ssl_conf_own_cert(conf, &ctx->client_cert, &ctx->client_key);
+    if (ret != 0)
+    {
+        return ret;
+    }
+
+    // Client certificate verification mode
+    if (ctx->config.require_client_cert)
+    {
+        mbedtls_ssl_conf_authmode(conf, MBEDTLS_SSL_VERIFY_REQUIRED);
+        if (ctx->has_cacert)
+        {
+            mbedtls_ssl_conf_ca_chain(conf, &ctx->cacert, NULL);
+        }
+    }
+    else
+    {
+        mbedtls_ssl_conf_authmode(conf, MBEDTLS_SSL_VERIFY_NONE);
+    }
+
+    mbedtls_ssl_conf_min_version(conf, MBEDTLS_SSL_MAJOR_VERSION_3, tls_min_minor_version(ctx));
+
+    if (ctx->has_cache)
+    {
+        mbedtls_ssl_conf_session_cache(conf, ctx, tls_cache_get, tls_cache_set);
+    }
+
+#if defined(MBEDTLS_SSL_TICKET_C)
+    if (ctx->has_ticket)
+    {
+        mbedtls_ssl_conf_session_tickets_cb(conf, tls_ticket_write, tls_ticket_parse, ctx);
+    }
+#endif
+
+    mbedtls_ssl_conf_sni(conf, sni_callback, NULL);
+
+#if CWH_TLS_KTLS
+    mbedtls_ssl_conf_export_keys_ext_cb(conf, tls_export_keys, NULL);
+    return tls_prefer_gcm_suites(ctx, conf);
+#else
+    return 0;
+#endif
+}
+
 // Create TLS context
 cwh_tls_context_t *cwh_tls_context_new(const cwh_tls_config_t *config)
 {
@@ -99,6 +444,10 @@ cwh_tls_context_t *cwh_tls_context_new(const cwh_tls_config_t *config)
 
     // Copy configuration
     ctx->config = *config;
+    for (int i = 0; i < CWH_TLS_CLIENT_SESSIONS; i++)
+    {
+        mbedtls_ssl_session_init(&ctx->saved[i].session);
+    }
 
     // Initialize entropy and RNG
     mbedtls_entropy_init(&ctx->entropy);
@@ -113,6 +462,10 @@ cwh_tls_context_t *cwh_tls_context_new(const cwh_tls_config_t *config)
         return NULL;
     }
 
+    tls_mutex_init(&ctx->rng_lock);
+    tls_mutex_init(&ctx->state_lock);
+    tls_mutex_init(&ctx->handshake_lock);
+
     // Load CA certificates if specified
     ctx->has_cacert = false;
     if (config->ca_cert_path)
@@ -161,6 +514,33 @@ cwh_tls_context_t *cwh_tls_context_new(const cwh_tls_config_t *config)
         ctx->has_cache = true;
     }
 
+    // Session tickets (RFC 5077): the server keeps no per-session state, the
+    // client carries it encrypted. mbedtls_ssl_ticket switches to a fresh key
+    // every ticket_lifetime and still accepts the previous one, so a stolen
+    // key only opens tickets from the last two periods.
+    ctx->has_ticket = false;
+#if defined(MBEDTLS_SSL_TICKET_C)
+    mbedtls_ssl_ticket_init(&ctx->ticket);
+    if (config->session_tickets && ctx->has_client_cert && config->ticket_lifetime > 0)
+    {
+        ctx->has_ticket = mbedtls_ssl_ticket_setup(&ctx->ticket, tls_random, ctx,
+                                                   MBEDTLS_CIPHER_AES_256_GCM,
+                                                   (uint32_t)config->ticket_lifetime) == 0;
+    }
+#endif
+
+    // Build the configurations once: sessions only reference them, so a
+    // connection costs an ssl context instead of a full config setup
+    mbedtls_ssl_config_init(&ctx->client_conf);
+    mbedtls_ssl_config_init(&ctx->server_conf);
+    if (tls_setup_client_conf(ctx) != 0 ||
+        (ctx->has_client_cert && tls_setup_server_conf(ctx) != 0))
+    {
+        cwh_tls_context_free(ctx);
+        return NULL;
+    }
+    ctx->has_server_conf = ctx->has_client_cert;
+
     return ctx;
 }
 
@@ -188,19 +568,49 @@ void cwh_tls_context_free(cwh_tls_context_t *ctx)
         mbedtls_ssl_cache_free(&ctx->cache);
     }
 
+    for (int i = 0; i < CWH_TLS_CLIENT_SESSIONS; i++)
+    {
+        mbedtls_ssl_session_free(&ctx->saved[i].session);
+    }
+
+    mbedtls_ssl_config_free(&ctx->client_conf);
+    mbedtls_ssl_config_free(&ctx->server_conf);
+#if defined(MBEDTLS_SSL_TICKET_C)
+    mbedtls_ssl_ticket_free(&ctx->ticket);
+#endif
     mbedtls_ctr_drbg_free(&ctx->ctr_drbg);
     mbedtls_entropy_free(&ctx->entropy);
+    tls_mutex_destroy(&ctx->rng_lock);
+    tls_mutex_destroy(&ctx->state_lock);
+    tls_mutex_destroy(&ctx->handshake_lock);
+#if CWH_TLS_KTLS
+    free(ctx->server_suites);
+#endif
     free(ctx);
 }
 
+// Non-blocking socket has nothing to give / no room right now
+static bool tls_net_would_block(void)
+{
+#ifdef _WIN32
+    return WSAGetLastError() == WSAEWOULDBLOCK;
+#else
+    return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+#endif
+}
+
 // Network send/recv callbacks for mbedTLS
 static int tls_net_send(void *ctx, const unsigned char *buf, size_t len)
 {
     int fd = *(int *)ctx;
+#ifdef MSG_NOSIGNAL
+    int ret = send(fd, (const char *)buf, (int)len, MSG_NOSIGNAL);
+#else
     int ret = send(fd, (const char *)buf, (int)len, 0);
+#endif
     if (ret < 0)
     {
-        return MBEDTLS_ERR_NET_SEND_FAILED;
+        return tls_net_would_block() ? MBEDTLS_ERR_SSL_WANT_WRITE : MBEDTLS_ERR_NET_SEND_FAILED;
     }
     return ret;
 }
@@ -211,26 +621,66 @@ static int tls_net_recv(void *ctx, unsigned char *buf, size_t len)
     int ret = recv(fd, (char *)buf, (int)len, 0);
     if (ret < 0)
     {
-        return MBEDTLS_ERR_NET_RECV_FAILED;
+        return tls_net_would_block() ? MBEDTLS_ERR_SSL_WANT_READ : MBEDTLS_ERR_NET_RECV_FAILED;
     }
-    if (ret == 0)
+    return ret; // 0: transport EOF
+}
+
+// Session saved for this server name, if any (caller holds state_lock)
+static cwh_tls_saved_session_t *find_saved_session(cwh_tls_context_t *ctx, const char *hostname)
+{
+    for (int i = 0; i < CWH_TLS_CLIENT_SESSIONS; i++)
     {
-        return MBEDTLS_ERR_SSL_PEER_CLOSE_NOTIFY;
+        if (ctx->saved[i].host[0] && strcmp(ctx->saved[i].host, hostname) == 0)
+        {
+            return &ctx->saved[i];
+        }
     }
-    return ret;
+    return NULL;
 }
 
-// SNI callback for server-side
-static int sni_callback(void *param, mbedtls_ssl_context *ssl,
-                        const unsigned char *hostname, size_t len)
+// Remember the negotiated session (replacing the least recently used slot)
+static void save_client_session(cwh_tls_session_t *session)
 {
-    cwh_tls_session_t *session = (cwh_tls_session_t *)param;
-    if (session && hostname && len > 0 && len < sizeof(session->sni_hostname))
+    cwh_tls_context_t *ctx = session->ctx;
+    if (strlen(session->hostname) >= sizeof(ctx->saved[0].host))
     {
-        memcpy(session->sni_hostname, hostname, len);
-        session->sni_hostname[len] = '\0';
+        return;
     }
-    return 0;
+
+    tls_mutex_lock(&ctx->state_lock);
+    cwh_tls_saved_session_t *slot = find_saved_session(ctx, session->hostname);
+    for (int i = 0; !slot && i < CWH_TLS_CLIENT_SESSIONS; i++)
+    {
+        if (!ctx->saved[i].host[0])
+        {
+            slot = &ctx->saved[i];
+        }
+    }
+    if (!slot)
+    {
+        slot = &ctx->saved[0];
+        for (int i = 1; i < CWH_TLS_CLIENT_SESSIONS; i++)
+        {
+            if (ctx->saved[i].last_used < slot->last_used)
+            {
+                slot = &ctx->saved[i];
+            }
+        }
+    }
+
+    mbedtls_ssl_session_free(&slot->session);
+    mbedtls_ssl_session_init(&slot->session);
+    if (mbedtls_ssl_get_session(&session->ssl, &slot->session) != 0)
+    {
+        slot->host[0] = '\0';
+    }
+    else
+    {
+        strcpy(slot->host, session->hostname);
+        slot->last_used = ++ctx->saved_clock;
+    }
+    tls_mutex_unlock(&ctx->state_lock);
 }
 
 // Create TLS session (client mode)
@@ -261,90 +711,38 @@ cwh_tls_session_t *cwh_tls_session_new(cwh_tls_context_t *ctx, int socket_fd, co
         return NULL;
     }
 
-    // Initialize SSL structures
     mbedtls_ssl_init(&session->ssl);
-    mbedtls_ssl_config_init(&session->conf);
 
     int ret;
 
-    // Setup SSL configuration
-    ret = mbedtls_ssl_config_defaults(&session->conf,
-                                      MBEDTLS_SSL_IS_CLIENT,
-                                      MBEDTLS_SSL_TRANSPORT_STREAM,
-                                      MBEDTLS_SSL_PRESET_DEFAULT);
+    // Setup SSL context on the shared client configuration
+    ret = mbedtls_ssl_setup(&session->ssl, &ctx->client_conf);
     if (ret != 0)
     {
         goto cleanup;
     }
 
-    // Set RNG
-    mbedtls_ssl_conf_rng(&session->conf, mbedtls_ctr_drbg_random, &ctx->ctr_drbg);
-
-    // Set CA certificates
-    if (ctx->has_cacert)
-    {
-        mbedtls_ssl_conf_ca_chain(&session->conf, &ctx->cacert, NULL);
-    }
-
-    // Set certificate verification mode
-    if (ctx->config.verify_peer)
-    {
-        mbedtls_ssl_conf_authmode(&session->conf, MBEDTLS_SSL_VERIFY_REQUIRED);
-    }
-    else
-    {
-        mbedtls_ssl_conf_authmode(&session->conf, MBEDTLS_SSL_VERIFY_NONE);
-    }
-
-    // Set client certificate if available
-    if (ctx->has_client_cert)
-    {
-        ret = mbedtls_ssl_conf_own_cert(&session->conf, &ctx->client_cert, &ctx->client_key);
-        if (ret != 0)
-        {
-            goto cleanup;
-        }
-    }
-
-    // Set minimum TLS version
-    int min_version = MBEDTLS_SSL_MINOR_VERSION_3; // TLS 1.2 default
-    switch (ctx->config.min_tls_version)
-    {
-    case 0:
-        min_version = MBEDTLS_SSL_MINOR_VERSION_1;
-        break; // TLS 1.0
-    case 1:
-        min_version = MBEDTLS_SSL_MINOR_VERSION_2;
-        break; // TLS 1.1
-    case 2:
-        min_version = MBEDTLS_SSL_MINOR_VERSION_3;
-        break; // TLS 1.2
-    case 3:
-        min_version = MBEDTLS_SSL_MINOR_VERSION_4;
-        break; // TLS 1.3
-    }
-    mbedtls_ssl_conf_min_version(&session->conf, MBEDTLS_SSL_MAJOR_VERSION_3, min_version);
-
-    // Enable session cache for resumption
-    if (ctx->has_cache)
-    {
-        mbedtls_ssl_conf_session_cache(&session->conf, &ctx->cache,
-                                       mbedtls_ssl_cache_get,
-                                       mbedtls_ssl_cache_set);
-    }
-
-    // Setup SSL context
-    ret = mbedtls_ssl_setup(&session->ssl, &session->conf);
+    // Set hostname for SNI
+    ret = mbedtls_ssl_set_hostname(&session->ssl, hostname);
     if (ret != 0)
     {
         goto cleanup;
     }
 
-    // Set hostname for SNI
-    ret = mbedtls_ssl_set_hostname(&session->ssl, hostname);
-    if (ret != 0)
+    // Offer the last session with this server (its ticket, else its ID): the
+    // handshake is abbreviated (no certificate exchange or key agreement) if
+    // the server can still decrypt the ticket or has the ID cached. The copy
+    // is made under the lock: another connection may replace the slot.
+    if (ctx->config.session_cache)
     {
-        goto cleanup;
+        tls_mutex_lock(&ctx->state_lock);
+        cwh_tls_saved_session_t *saved = find_saved_session(ctx, hostname);
+        if (saved && mbedtls_ssl_set_session(&session->ssl, &saved->session) == 0)
+        {
+            session->offered = true;
+            memcpy(session->offered_master, saved->session.master, sizeof(session->offered_master));
+        }
+        tls_mutex_unlock(&ctx->state_lock);
     }
 
     // Set I/O callbacks
@@ -353,7 +751,6 @@ cwh_tls_session_t *cwh_tls_session_new(cwh_tls_context_t *ctx, int socket_fd, co
     return session;
 
 cleanup:
-    mbedtls_ssl_config_free(&session->conf);
     mbedtls_ssl_free(&session->ssl);
     free(session->hostname);
     free(session);
@@ -363,7 +760,7 @@ cleanup:
 // Create TLS session (server mode)
 cwh_tls_session_t *cwh_tls_session_new_server(cwh_tls_context_t *ctx, int socket_fd)
 {
-    if (!ctx || socket_fd < 0 || !ctx->has_client_cert)
+    if (!ctx || socket_fd < 0 || !ctx->has_server_conf)
     {
         return NULL;
     }
@@ -382,114 +779,64 @@ cwh_tls_session_t *cwh_tls_session_new_server(cwh_tls_context_t *ctx, int socket
     session->client_cert_subject[0] = '\0';
     session->client_cert_verified = false;
 
-    // Initialize SSL structures
     mbedtls_ssl_init(&session->ssl);
-    mbedtls_ssl_config_init(&session->conf);
-
-    int ret;
-
-    // Setup SSL configuration for server
-    ret = mbedtls_ssl_config_defaults(&session->conf,
-                                      MBEDTLS_SSL_IS_SERVER,
-                                      MBEDTLS_SSL_TRANSPORT_STREAM,
-                                      MBEDTLS_SSL_PRESET_DEFAULT);
-    if (ret != 0)
-    {
-        goto cleanup;
-    }
-
-    // Set RNG
-    mbedtls_ssl_conf_rng(&session->conf, mbedtls_ctr_drbg_random, &ctx->ctr_drbg);
-
-    // Set server certificate and key
-    ret = mbedtls_ssl_conf_own_cert(&session->conf, &ctx->client_cert, &ctx->client_key);
-    if (ret != 0)
-    {
-        goto cleanup;
-    }
-
-    // Set client certificate verification mode
-    if (ctx->config.require_client_cert)
-    {
-        mbedtls_ssl_conf_authmode(&session->conf, MBEDTLS_SSL_VERIFY_REQUIRED);
-        if (ctx->has_cacert)
-        {
-            mbedtls_ssl_conf_ca_chain(&session->conf, &ctx->cacert, NULL);
-        }
-    }
-    else
-    {
-        mbedtls_ssl_conf_authmode(&session->conf, MBEDTLS_SSL_VERIFY_NONE);
-    }
-
-    // Set minimum TLS version
-    int min_version = MBEDTLS_SSL_MINOR_VERSION_3;
-    switch (ctx->config.min_tls_version)
-    {
-    case 0:
-        min_version = MBEDTLS_SSL_MINOR_VERSION_1;
-        break;
-    case 1:
-        min_version = MBEDTLS_SSL_MINOR_VERSION_2;
-        break;
-    case 2:
-        min_version = MBEDTLS_SSL_MINOR_VERSION_3;
-        break;
-    case 3:
-        min_version = MBEDTLS_SSL_MINOR_VERSION_4;
-        break;
-    }
-    mbedtls_ssl_conf_min_version(&session->conf, MBEDTLS_SSL_MAJOR_VERSION_3, min_version);
 
-    // Enable session cache for resumption
-    if (ctx->has_cache)
+    // Setup SSL context on the shared server configuration
+    if (mbedtls_ssl_setup(&session->ssl, &ctx->server_conf) != 0)
     {
-        mbedtls_ssl_conf_session_cache(&session->conf, &ctx->cache,
-                                       mbedtls_ssl_cache_get,
-                                       mbedtls_ssl_cache_set);
-    }
-
-    // Setup SSL context
-    ret = mbedtls_ssl_setup(&session->ssl, &session->conf);
-    if (ret != 0)
-    {
-        goto cleanup;
+        mbedtls_ssl_free(&session->ssl);
+        free(session);
+        return NULL;
     }
 
-    // Set SNI callback
-    mbedtls_ssl_conf_sni(&session->conf, sni_callback, session);
-
     // Set I/O callbacks
     mbedtls_ssl_set_bio(&session->ssl, &session->socket_fd, tls_net_send, tls_net_recv, NULL);
 
     return session;
-
-cleanup:
-    mbedtls_ssl_config_free(&session->conf);
-    mbedtls_ssl_free(&session->ssl);
-    free(session);
-    return NULL;
 }
 
-// Perform TLS handshake
-cwh_tls_error_t cwh_tls_handshake(cwh_tls_session_t *session)
+// Perform one non-blocking handshake step
+cwh_tls_error_t cwh_tls_handshake_step(cwh_tls_session_t *session)
 {
     if (!session)
     {
         return CWH_TLS_ERR_INVALID;
     }
 
-    int ret;
-    while ((ret = mbedtls_ssl_handshake(&session->ssl)) != 0)
+#if CWH_TLS_KTLS
+    tls_handshaking = session;
+#endif
+#if defined(MBEDTLS_THREADING_C)
+    int ret = mbedtls_ssl_handshake(&session->ssl);
+#else
+    // Without threading support mbedTLS doesn't lock the private key (RSA
+    // blinding state), so server steps of one context take turns (shards of
+    // a multi-threaded server; TLS workers require MBEDTLS_THREADING_C)
+    if (session->is_server)
+    {
+        tls_mutex_lock(&session->ctx->handshake_lock);
+    }
+    int ret = mbedtls_ssl_handshake(&session->ssl);
+    if (session->is_server)
+    {
+        tls_mutex_unlock(&session->ctx->handshake_lock);
+    }
+#endif
+#if CWH_TLS_KTLS
+    tls_handshaking = NULL;
+#endif
+    if (ret == MBEDTLS_ERR_SSL_WANT_READ || ret == MBEDTLS_ERR_SSL_WANT_WRITE)
+    {
+        session->want = ret;
+        return ret == MBEDTLS_ERR_SSL_WANT_READ ? CWH_TLS_WANT_READ : CWH_TLS_WANT_WRITE;
+    }
+    if (ret != 0)
     {
-        if (ret != MBEDTLS_ERR_SSL_WANT_READ && ret != MBEDTLS_ERR_SSL_WANT_WRITE)
+        if (ret == MBEDTLS_ERR_X509_CERT_VERIFY_FAILED)
         {
-            if (ret == MBEDTLS_ERR_X509_CERT_VERIFY_FAILED)
-            {
-                return CWH_TLS_ERR_CERT;
-            }
-            return CWH_TLS_ERR_HANDSHAKE;
+            return CWH_TLS_ERR_CERT;
         }
+        return CWH_TLS_ERR_HANDSHAKE;
     }
 
     // Verify certificate (if required)
@@ -525,9 +872,218 @@ cwh_tls_error_t cwh_tls_handshake(cwh_tls_session_t *session)
         }
     }
 
+    // Client: a resumed session keeps the offered master secret (the session
+    // ID can't tell: with a ticket the client sends a random one). Save it
+    // either way, since the server may have sent a fresh ticket.
+    if (!session->is_server && session->ctx->config.session_cache)
+    {
+        const mbedtls_ssl_session *negotiated = session->ssl.session;
+        session->resumed = session->offered && negotiated &&
+                           memcmp(negotiated->master, session->offered_master, sizeof(session->offered_master)) == 0;
+        save_client_session(session);
+    }
+
     return CWH_TLS_OK;
 }
 
+// Perform TLS handshake (spins on a non-blocking socket; see _step)
+cwh_tls_error_t cwh_tls_handshake(cwh_tls_session_t *session)
+{
+    cwh_tls_error_t err;
+    do
+    {
+        err = cwh_tls_handshake_step(session);
+    } while (err == CWH_TLS_WANT_READ || err == CWH_TLS_WANT_WRITE);
+    return err;
+}
+
+#if CWH_TLS_KTLS
+// Give one direction's record protection (TLS 1.2 AES-GCM) to the kernel
+static bool ktls_install(int fd, int direction, const unsigned char *key, size_t key_len,
+                         const unsigned char *salt, const unsigned char *seq)
+{
+    union
+    {
+        struct tls12_crypto_info_aes_gcm_128 gcm128;
+        struct tls12_crypto_info_aes_gcm_256 gcm256;
+    } info;
+    memset(&info, 0, sizeof(info));
+
+    // The explicit nonce starts at the record number, as mbedTLS does it
+    socklen_t len;
+    if (key_len == TLS_CIPHER_AES_GCM_128_KEY_SIZE)
+    {
+        info.gcm128.info.version = TLS_1_2_VERSION;
+        info.gcm128.info.cipher_type = TLS_CIPHER_AES_GCM_128;
+        memcpy(info.gcm128.key, key, TLS_CIPHER_AES_GCM_128_KEY_SIZE);
+        memcpy(info.gcm128.salt, salt, TLS_CIPHER_AES_GCM_128_SALT_SIZE);
+        memcpy(info.gcm128.iv, seq, TLS_CIPHER_AES_GCM_128_IV_SIZE);
+        memcpy(info.gcm128.rec_seq, seq, TLS_CIPHER_AES_GCM_128_REC_SEQ_SIZE);
+        len = sizeof(info.gcm128);
+    }
+    else
+    {
+        info.gcm256.info.version = TLS_1_2_VERSION;
+        info.gcm256.info.cipher_type = TLS_CIPHER_AES_GCM_256;
+        memcpy(info.gcm256.key, key, TLS_CIPHER_AES_GCM_256_KEY_SIZE);
+        memcpy(info.gcm256.salt, salt, TLS_CIPHER_AES_GCM_256_SALT_SIZE);
+        memcpy(info.gcm256.iv, seq, TLS_CIPHER_AES_GCM_256_IV_SIZE);
+        memcpy(info.gcm256.rec_seq, seq, TLS_CIPHER_AES_GCM_256_REC_SEQ_SIZE);
+        len = sizeof(info.gcm256);
+    }
+
+    bool ok = setsockopt(fd, SOL_TLS, direction, &info, len) == 0;
+    mbedtls_platform_zeroize(&info, sizeof(info));
+    return ok;
+}
+
+// Read through kernel TLS: application data comes back as plaintext, any
+// other record type (alert, post-handshake message) ends the connection
+static int ktls_read(cwh_tls_session_t *session, void *buf, size_t len)
+{
+    char control[CMSG_SPACE(sizeof(unsigned char))];
+    struct iovec iov = {buf, len};
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+
+    ssize_t n = recvmsg(session->socket_fd, &msg, 0);
+    if (n < 0)
+    {
+        if (tls_net_would_block())
+        {
+            session->want = MBEDTLS_ERR_SSL_WANT_READ;
+            return 0;
+        }
+        return -1;
+    }
+    if (n == 0)
+    {
+        session->eof = true;
+        return -1;
+    }
+
+    struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+    if (cmsg && cmsg->cmsg_level == SOL_TLS && cmsg->cmsg_type == TLS_GET_RECORD_TYPE &&
+        *CMSG_DATA(cmsg) != MBEDTLS_SSL_MSG_APPLICATION_DATA)
+    {
+        const unsigned char *record = (const unsigned char *)buf;
+        if (*CMSG_DATA(cmsg) == MBEDTLS_SSL_MSG_ALERT && n >= 2 &&
+            record[1] == MBEDTLS_SSL_ALERT_MSG_CLOSE_NOTIFY)
+        {
+            session->eof = true;
+        }
+        return -1;
+    }
+    return (int)n;
+}
+
+// Write through kernel TLS: the kernel cuts the records
+static int ktls_write(cwh_tls_session_t *session, const void *buf, size_t len)
+{
+    ssize_t n = send(session->socket_fd, buf, len, MSG_NOSIGNAL);
+    if (n < 0)
+    {
+        if (tls_net_would_block())
+        {
+            session->want = MBEDTLS_ERR_SSL_WANT_WRITE;
+            return 0;
+        }
+        return -1;
+    }
+    return (int)n;
+}
+
+// mbedTLS no longer knows the send sequence number: the alert goes as a
+// kernel record of its own type
+static void ktls_close_notify(cwh_tls_session_t *session)
+{
+    unsigned char alert[2] = {MBEDTLS_SSL_ALERT_LEVEL_WARNING, MBEDTLS_SSL_ALERT_MSG_CLOSE_NOTIFY};
+    char control[CMSG_SPACE(sizeof(unsigned char))];
+    struct iovec iov = {alert, sizeof(alert)};
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    memset(control, 0, sizeof(control));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+
+    struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+    cmsg->cmsg_level = SOL_TLS;
+    cmsg->cmsg_type = TLS_SET_RECORD_TYPE;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(unsigned char));
+    *CMSG_DATA(cmsg) = MBEDTLS_SSL_MSG_ALERT;
+
+    sendmsg(session->socket_fd, &msg, MSG_DONTWAIT | MSG_NOSIGNAL);
+}
+#endif
+
+// Move the record layer of an established session into the kernel
+bool cwh_tls_enable_ktls(cwh_tls_session_t *session)
+{
+    if (!session)
+    {
+        return false;
+    }
+
+#if CWH_TLS_KTLS
+    if (session->ktls_tx)
+    {
+        return true;
+    }
+
+    // TLS 1.2 AES-GCM, handshake flushed, and no records mbedTLS has read
+    // ahead (the kernel would never see them)
+    const mbedtls_ssl_ciphersuite_t *suite =
+        session->ssl.session ? mbedtls_ssl_ciphersuite_from_id(session->ssl.session->ciphersuite) : NULL;
+    if (session->key_len == 0 || !suite ||
+        (suite->cipher != MBEDTLS_CIPHER_AES_128_GCM && suite->cipher != MBEDTLS_CIPHER_AES_256_GCM) ||
+        session->ssl.state != MBEDTLS_SSL_HANDSHAKE_OVER ||
+        session->ssl.minor_ver != MBEDTLS_SSL_MINOR_VERSION_3 ||
+        session->ssl.out_left != 0 || mbedtls_ssl_check_pending(&session->ssl))
+    {
+        return false;
+    }
+
+    // ENOENT without the tls module. Until TLS_TX/TLS_RX succeed the socket
+    // passes bytes through unchanged, so mbedTLS carries on as before.
+    if (setsockopt(session->socket_fd, SOL_TCP, TCP_ULP, "tls", sizeof("tls")) == 0)
+    {
+        size_t key_len = session->key_len;
+        const unsigned char *client_key = session->key_block;
+        const unsigned char *server_key = client_key + key_len;
+        const unsigned char *client_salt = server_key + key_len;
+        const unsigned char *server_salt = client_salt + 4;
+
+        // Receive first: once sends bypass mbedTLS, it must not read either
+        // (it would answer some records itself)
+        session->ktls_rx = ktls_install(session->socket_fd, TLS_RX,
+                                        session->is_server ? client_key : server_key, key_len,
+                                        session->is_server ? client_salt : server_salt, session->ssl.in_ctr);
+        session->ktls_tx = session->ktls_rx &&
+                           ktls_install(session->socket_fd, TLS_TX,
+                                        session->is_server ? server_key : client_key, key_len,
+                                        session->is_server ? server_salt : client_salt, session->ssl.out_ctr);
+    }
+
+    mbedtls_platform_zeroize(session->key_block, sizeof(session->key_block));
+    session->key_len = 0;
+    return session->ktls_tx;
+#else
+    return false;
+#endif
+}
+
+// Sends on the socket are encrypted by the kernel
+bool cwh_tls_ktls_enabled(cwh_tls_session_t *session)
+{
+    return session && session->ktls_tx;
+}
+
 // Read data from TLS connection
 int cwh_tls_read(cwh_tls_session_t *session, void *buf, size_t len)
 {
@@ -536,11 +1092,24 @@ int cwh_tls_read(cwh_tls_session_t *session, void *buf, size_t len)
         return -1;
     }
 
+#if CWH_TLS_KTLS
+    if (session->ktls_rx)
+    {
+        return ktls_read(session, buf, len);
+    }
+#endif
+
     int ret = mbedtls_ssl_read(&session->ssl, (unsigned char *)buf, len);
     if (ret == MBEDTLS_ERR_SSL_WANT_READ || ret == MBEDTLS_ERR_SSL_WANT_WRITE)
     {
+        session->want = ret;
         return 0; // Would block
     }
+    if (ret == 0 || ret == MBEDTLS_ERR_SSL_PEER_CLOSE_NOTIFY || ret == MBEDTLS_ERR_SSL_CONN_EOF)
+    {
+        session->eof = true;
+        return -1;
+    }
     if (ret < 0)
     {
         return -1;
@@ -556,9 +1125,17 @@ int cwh_tls_write(cwh_tls_session_t *session, const void *buf, size_t len)
         return -1;
     }
 
+#if CWH_TLS_KTLS
+    if (session->ktls_tx)
+    {
+        return ktls_write(session, buf, len);
+    }
+#endif
+
     int ret = mbedtls_ssl_write(&session->ssl, (const unsigned char *)buf, len);
     if (ret == MBEDTLS_ERR_SSL_WANT_READ || ret == MBEDTLS_ERR_SSL_WANT_WRITE)
     {
+        session->want = ret;
         return 0; // Would block
     }
     if (ret < 0)
@@ -568,6 +1145,24 @@ int cwh_tls_write(cwh_tls_session_t *session, const void *buf, size_t len)
     return ret;
 }
 
+// Which socket event the last would-block result is waiting for
+bool cwh_tls_want_write(cwh_tls_session_t *session)
+{
+    return session && session->want == MBEDTLS_ERR_SSL_WANT_WRITE;
+}
+
+// Peer closed the connection (close_notify or transport EOF)
+bool cwh_tls_eof(cwh_tls_session_t *session)
+{
+    return session && session->eof;
+}
+
+// Client: the handshake resumed a saved session
+bool cwh_tls_session_resumed(cwh_tls_session_t *session)
+{
+    return session && session->resumed;
+}
+
 // Get SNI hostname (server-side)
 const char *cwh_tls_get_sni_hostname(cwh_tls_session_t *session)
 {
@@ -606,9 +1201,20 @@ void cwh_tls_session_free(cwh_tls_session_t *session)
         return;
     }
 
-    mbedtls_ssl_close_notify(&session->ssl);
+#if CWH_TLS_KTLS
+    if (session->ktls_tx)
+    {
+        ktls_close_notify(session);
+    }
+    else
+#endif
+    {
+        mbedtls_ssl_close_notify(&session->ssl);
+    }
     mbedtls_ssl_free(&session->ssl);
-    mbedtls_ssl_config_free(&session->conf);
+#if CWH_TLS_KTLS
+    mbedtls_platform_zeroize(session->key_block, sizeof(session->key_block));
+#endif
     free(session->hostname);
     free(session);
 }
@@ -626,6 +1232,11 @@ bool cwh_tls_is_available(void)
     return false;
 }
 
+bool cwh_tls_threading_available(void)
+{
+    return false;
+}
+
 cwh_tls_context_t *cwh_tls_context_new(const cwh_tls_config_t *config)
 {
     (void)config;
@@ -658,6 +1269,12 @@ cwh_tls_error_t cwh_tls_handshake(cwh_tls_session_t *session)
     return CWH_TLS_ERR_INIT;
 }
 
+cwh_tls_error_t cwh_tls_handshake_step(cwh_tls_session_t *session)
+{
+    (void)session;
+    return CWH_TLS_ERR_INIT;
+}
+
 int cwh_tls_read(cwh_tls_session_t *session, void *buf, size_t len)
 {
     (void)session;
@@ -674,6 +1291,24 @@ int cwh_tls_write(cwh_tls_session_t *session, const void *buf, size_t len)
     return -1;
 }
 
+bool cwh_tls_want_write(cwh_tls_session_t *session)
+{
+    (void)session;
+    return false;
+}
+
+bool cwh_tls_eof(cwh_tls_session_t *session)
+{
+    (void)session;
+    return false;
+}
+
+bool cwh_tls_session_resumed(cwh_tls_session_t *session)
+{
+    (void)session;
+    return false;
+}
+
 const char *cwh_tls_get_sni_hostname(cwh_tls_session_t *session)
 {
     (void)session;
@@ -692,6 +1327,18 @@ const char *cwh_tls_get_client_cert_subject(cwh_tls_session_t *session)
     return NULL;
 }
 
+bool cwh_tls_enable_ktls(cwh_tls_session_t *session)
+{
+    (void)session;
+    return false;
+}
+
+bool cwh_tls_ktls_enabled(cwh_tls_session_t *session)
+{
+    (void)session;
+    return false;
+}
+
 void cwh_tls_session_free(cwh_tls_session_t *session)
 {
     (void)session;
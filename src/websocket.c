@@ -1,4 +1,5 @@
 #include "../include/cwebhttp_ws.h"
+#include "../include/cwebhttp.h"
 #include <string.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -183,12 +184,249 @@ int cwh_ws_parse_frame_header(const uint8_t *data, size_t len, cwh_ws_frame_head
     return (int)header_len;
 }
 
-void cwh_ws_decode_payload(uint8_t *data, uint64_t len, const uint8_t masking_key[4])
+// === Masking ===
+// Unmasking XORs every payload byte, so large binary frames spend most of
+// their time here. The word kernel XORs 8 bytes per step, SSE2/AVX2 16/32;
+// each masks the unaligned head in smaller steps, then XORs whole aligned
+// blocks with the key rotated to that offset. Frames shorter than two vectors
+// take the word path. The implementation is chosen on first use from cpuid
+// and can be forced with cwh_ws_mask_set_impl().
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define CWH_WS_MASK_X86 1
+#include <immintrin.h>
+#else
+#define CWH_WS_MASK_X86 0
+#endif
+
+// phase: index into the key of data[0]
+typedef void (*ws_mask_fn)(uint8_t *data, uint64_t len, const uint8_t key[4], unsigned phase);
+
+// Helpers are inlined into each kernel: a vector kernel calling out to code
+// built for another instruction set pays for the AVX/SSE state switch
+
+static inline __attribute__((always_inline)) void mask_bytes(uint8_t *data, uint64_t len, const uint8_t key[4],
+                                                             unsigned phase)
 {
     for (uint64_t i = 0; i < len; i++)
     {
-        data[i] ^= masking_key[i % 4];
+        data[i] ^= key[(phase + i) & 3];
+    }
+}
+
+// The 4 key bytes starting at phase, in memory order. One load and a rotate:
+// assembling it byte by byte on the stack defeats store forwarding, which
+// costs more than a whole small frame
+static inline __attribute__((always_inline)) uint32_t mask_pattern(const uint8_t key[4], unsigned phase)
+{
+    uint32_t pattern;
+    memcpy(&pattern, key, sizeof(pattern));
+    unsigned shift = (phase & 3) * 8;
+    if (shift == 0)
+        return pattern;
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    return (pattern << shift) | (pattern >> (32 - shift));
+#else
+    return (pattern >> shift) | (pattern << (32 - shift));
+#endif
+}
+
+// 8 bytes per step (whole words keep the phase), then the last 0-7 bytes
+static inline __attribute__((always_inline)) void mask_words(uint8_t *data, uint64_t len, const uint8_t key[4],
+                                                             unsigned phase)
+{
+    uint32_t pattern = mask_pattern(key, phase);
+    uint64_t wide = ((uint64_t)pattern << 32) | pattern; // Same bytes either endianness
+    for (; len >= 8; data += 8, len -= 8)
+    {
+        uint64_t word;
+        memcpy(&word, data, sizeof(word));
+        word ^= wide;
+        memcpy(data, &word, sizeof(word));
+    }
+    mask_bytes(data, len, key, phase);
+}
+
+// Bytes before the next multiple of align (at most len)
+static inline __attribute__((always_inline)) uint64_t mask_head_len(const uint8_t *data, uint64_t len,
+                                                                    uintptr_t align)
+{
+    uint64_t head = (align - ((uintptr_t)data & (align - 1))) & (align - 1);
+    return head < len ? head : len;
+}
+
+static void mask_scalar(uint8_t *data, uint64_t len, const uint8_t key[4], unsigned phase)
+{
+    mask_bytes(data, len, key, phase);
+}
+
+// Bytes up to a word boundary, then aligned words
+static inline __attribute__((always_inline)) void mask_aligned_words(uint8_t *data, uint64_t len,
+                                                                     const uint8_t key[4], unsigned phase)
+{
+    uint64_t head = mask_head_len(data, len, 8);
+    mask_bytes(data, head, key, phase);
+    mask_words(data + head, len - head, key, (phase + (unsigned)head) & 3);
+}
+
+static void mask_word(uint8_t *data, uint64_t len, const uint8_t key[4], unsigned phase)
+{
+    mask_aligned_words(data, len, key, phase);
+}
+
+#if CWH_WS_MASK_X86
+__attribute__((target("sse2"))) static void mask_sse2(uint8_t *data, uint64_t len, const uint8_t key[4],
+                                                      unsigned phase)
+{
+    if (len < 32) // Head and tail would be the whole frame
+    {
+        mask_aligned_words(data, len, key, phase);
+        return;
+    }
+
+    uint64_t head = mask_head_len(data, len, 16);
+    mask_words(data, head, key, phase);
+    data += head;
+    len -= head;
+    phase = (phase + (unsigned)head) & 3;
+
+    const __m128i k = _mm_set1_epi32((int)mask_pattern(key, phase));
+    for (; len >= 16; data += 16, len -= 16)
+    {
+        __m128i block = _mm_load_si128((const __m128i *)data);
+        _mm_store_si128((__m128i *)data, _mm_xor_si128(block, k));
+    }
+    mask_words(data, len, key, phase);
+}
+
+__attribute__((target("avx2"))) static void mask_avx2(uint8_t *data, uint64_t len, const uint8_t key[4],
+                                                      unsigned phase)
+{
+    if (len < 64) // Head and tail would be the whole frame
+    {
+        mask_aligned_words(data, len, key, phase);
+        return;
+    }
+
+    uint64_t head = mask_head_len(data, len, 32);
+    mask_words(data, head, key, phase);
+    data += head;
+    len -= head;
+    phase = (phase + (unsigned)head) & 3;
+
+    const __m256i k = _mm256_set1_epi32((int)mask_pattern(key, phase));
+    for (; len >= 64; data += 64, len -= 64)
+    {
+        __m256i a = _mm256_load_si256((const __m256i *)data);
+        __m256i b = _mm256_load_si256((const __m256i *)(data + 32));
+        _mm256_store_si256((__m256i *)data, _mm256_xor_si256(a, k));
+        _mm256_store_si256((__m256i *)(data + 32), _mm256_xor_si256(b, k));
+    }
+    if (len >= 32)
+    {
+        __m256i block = _mm256_load_si256((const __m256i *)data);
+        _mm256_store_si256((__m256i *)data, _mm256_xor_si256(block, k));
+        data += 32;
+        len -= 32;
+    }
+    mask_words(data, len, key, phase);
+}
+#endif
+
+static void mask_resolve(uint8_t *data, uint64_t len, const uint8_t key[4], unsigned phase);
+
+// Kernel in use, picked by mask_resolve on the first frame (__atomic access:
+// that can happen on several threads at once)
+static ws_mask_fn g_mask = mask_resolve;
+static cwh_ws_mask_impl_t g_mask_impl = CWH_WS_MASK_AUTO;
+
+static bool mask_impl_supported(cwh_ws_mask_impl_t impl)
+{
+    switch (impl)
+    {
+    case CWH_WS_MASK_SCALAR:
+    case CWH_WS_MASK_WORD:
+        return true;
+    case CWH_WS_MASK_SSE2:
+        return cwh_cpu_has(CWH_CPU_SSE2);
+    case CWH_WS_MASK_AVX2:
+        return cwh_cpu_has(CWH_CPU_AVX2);
+    default:
+        return false;
+    }
+}
+
+int cwh_ws_mask_set_impl(cwh_ws_mask_impl_t impl)
+{
+    if (impl == CWH_WS_MASK_AUTO)
+    {
+        if (mask_impl_supported(CWH_WS_MASK_AVX2))
+            impl = CWH_WS_MASK_AVX2;
+        else if (mask_impl_supported(CWH_WS_MASK_SSE2))
+            impl = CWH_WS_MASK_SSE2;
+        else
+            impl = CWH_WS_MASK_WORD;
     }
+    else if (!mask_impl_supported(impl))
+    {
+        return -1;
+    }
+
+    ws_mask_fn mask = mask_scalar;
+    switch (impl)
+    {
+#if CWH_WS_MASK_X86
+    case CWH_WS_MASK_AVX2:
+        mask = mask_avx2;
+        break;
+    case CWH_WS_MASK_SSE2:
+        mask = mask_sse2;
+        break;
+#endif
+    case CWH_WS_MASK_WORD:
+        mask = mask_word;
+        break;
+    default:
+        break;
+    }
+    __atomic_store_n(&g_mask, mask, __ATOMIC_RELEASE);
+    __atomic_store_n(&g_mask_impl, impl, __ATOMIC_RELEASE);
+    return 0;
+}
+
+cwh_ws_mask_impl_t cwh_ws_mask_get_impl(void)
+{
+    if (__atomic_load_n(&g_mask_impl, __ATOMIC_ACQUIRE) == CWH_WS_MASK_AUTO)
+        cwh_ws_mask_set_impl(CWH_WS_MASK_AUTO);
+    return __atomic_load_n(&g_mask_impl, __ATOMIC_ACQUIRE);
+}
+
+const char *cwh_ws_mask_impl_name(cwh_ws_mask_impl_t impl)
+{
+    switch (impl)
+    {
+    case CWH_WS_MASK_SCALAR:
+        return "scalar";
+    case CWH_WS_MASK_WORD:
+        return "word64";
+    case CWH_WS_MASK_SSE2:
+        return "sse2";
+    case CWH_WS_MASK_AVX2:
+        return "avx2";
+    default:
+        return "auto";
+    }
+}
+
+static void mask_resolve(uint8_t *data, uint64_t len, const uint8_t key[4], unsigned phase)
+{
+    cwh_ws_mask_set_impl(CWH_WS_MASK_AUTO);
+    __atomic_load_n(&g_mask, __ATOMIC_ACQUIRE)(data, len, key, phase);
+}
+
+void cwh_ws_decode_payload(uint8_t *data, uint64_t len, const uint8_t masking_key[4])
+{
+    __atomic_load_n(&g_mask, __ATOMIC_ACQUIRE)(data, len, masking_key, 0);
 }
 
 // === Frame Encoding ===
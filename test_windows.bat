@@ -10,7 +10,7 @@ REM Create build directory if it doesn't exist
 if not exist build mkdir build
 
 echo [1/5] Building IOCP test server...
-gcc -Wall -Wextra -std=c11 -O2 -Iinclude test_iocp_server.c src/cwebhttp.c src/async/loop.c src/async/epoll.c src/async/kqueue.c src/async/iocp.c src/async/wsapoll.c src/async/select.c src/async/nonblock.c src/async/client.c src/async/server.c -o build/test_iocp_server.exe -lws2_32 -lz 2>&1
+gcc -Wall -Wextra -std=c11 -O2 -Iinclude test_iocp_server.c src/cwebhttp.c src/async/loop.c src/async/timer.c src/async/dns.c src/async/epoll.c src/async/uring.c src/async/kqueue.c src/async/iocp.c src/async/wsapoll.c src/async/select.c src/async/nonblock.c src/async/client.c src/async/server.c -o build/test_iocp_server.exe -lws2_32 -lz 2>&1
 
 if %ERRORLEVEL% NEQ 0 (
     echo ERROR: Build failed!
@@ -20,7 +20,7 @@ echo SUCCESS: Build complete
 echo.
 
 echo [2/5] Building async server example...
-gcc -Wall -Wextra -std=c11 -O2 -Iinclude examples/async_server.c src/cwebhttp.c src/async/loop.c src/async/epoll.c src/async/kqueue.c src/async/iocp.c src/async/wsapoll.c src/async/select.c src/async/nonblock.c src/async/client.c src/async/server.c -o build/examples/async_server.exe -lws2_32 -lz 2>&1
+gcc -Wall -Wextra -std=c11 -O2 -Iinclude examples/async_server.c src/cwebhttp.c src/async/loop.c src/async/timer.c src/async/dns.c src/async/epoll.c src/async/uring.c src/async/kqueue.c src/async/iocp.c src/async/wsapoll.c src/async/select.c src/async/nonblock.c src/async/client.c src/async/server.c -o build/examples/async_server.exe -lws2_32 -lz 2>&1
 
 if %ERRORLEVEL% NEQ 0 (
     echo ERROR: Example build failed!
@@ -0,0 +1,771 @@
+// test_async_dns.c - Async DNS resolver tests
+// Answers queries from a stub nameserver registered on the same loop
+
+#include "cwebhttp_async.h"
+#include "unity.h"
+#include <stdio.h>
+#include <string.h>
+
+#ifndef _WIN32
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#endif
+
+void setUp(void)
+{
+    cwh_dns_cache_clear();
+}
+
+void tearDown(void)
+{
+}
+
+#ifndef _WIN32
+
+// ============================================================================
+// Stub Nameserver
+// ============================================================================
+
+// a.test          -> A 10.0.0.1, AAAA 2001:db8::1
+// web.test        -> A 127.0.0.1
+// web.corp.test   -> A 10.0.0.2
+// big.test        -> truncated (TC, no answer) over UDP, A 10.0.0.3 over TCP
+// nx.test         -> NXDOMAIN, and so is anything else under empty.test or
+//                    corp.test
+// fail.test       -> SERVFAIL
+// anything else is never answered
+
+typedef struct
+{
+    int fd;
+    int tcp_fd;
+    int conn_fd;
+    int port;
+    int queries;
+    int tcp_queries;
+    unsigned ttl;
+    unsigned char in[1024];
+    size_t in_len;
+} stub_dns_t;
+
+static size_t put16(unsigned char *p, size_t off, unsigned v)
+{
+    p[off] = (unsigned char)(v >> 8);
+    p[off + 1] = (unsigned char)v;
+    return off + 2;
+}
+
+// Decode the question name into dotted form; returns offset past it
+static size_t question_name(const unsigned char *p, size_t len, char *out)
+{
+    size_t off = 12, o = 0;
+    while (off < len && p[off] != 0)
+    {
+        size_t n = p[off++];
+        if (o)
+            out[o++] = '.';
+        memcpy(out + o, p + off, n);
+        o += n;
+        off += n;
+    }
+    out[o] = '\0';
+    return off + 1;
+}
+
+static bool ends_with(const char *name, const char *suffix)
+{
+    size_t n = strlen(name), s = strlen(suffix);
+    return n >= s && strcmp(name + n - s, suffix) == 0;
+}
+
+// Build the response to query q into r; returns its length, 0 for no answer
+static size_t stub_answer(stub_dns_t *stub, const unsigned char *q, size_t n, unsigned char *r, bool tcp)
+{
+    char name[256];
+    size_t qend = question_name(q, n, name);
+    unsigned type = ((unsigned)q[qend] << 8) | q[qend + 1];
+    qend += 4;
+
+    unsigned flags = 0x8180;
+    int rcode = 0;
+    unsigned char rdata[16];
+    int rdlen = 0;
+    if (strcmp(name, "a.test") == 0 && type == 1)
+        rdlen = inet_pton(AF_INET, "10.0.0.1", rdata) == 1 ? 4 : 0;
+    else if (strcmp(name, "a.test") == 0 && type == 28)
+        rdlen = inet_pton(AF_INET6, "2001:db8::1", rdata) == 1 ? 16 : 0;
+    else if (strcmp(name, "web.test") == 0 && type == 1)
+        rdlen = inet_pton(AF_INET, "127.0.0.1", rdata) == 1 ? 4 : 0;
+    else if (strcmp(name, "web.corp.test") == 0 && type == 1)
+        rdlen = inet_pton(AF_INET, "10.0.0.2", rdata) == 1 ? 4 : 0;
+    else if (strcmp(name, "big.test") == 0 && !tcp)
+        flags |= 0x0200; // TC
+    else if (strcmp(name, "big.test") == 0 && type == 1)
+        rdlen = inet_pton(AF_INET, "10.0.0.3", rdata) == 1 ? 4 : 0;
+    else if (strcmp(name, "nx.test") == 0 || ends_with(name, ".empty.test") ||
+             (ends_with(name, ".corp.test") && strcmp(name, "web.corp.test") != 0))
+        rcode = 3;
+    else if (strcmp(name, "fail.test") == 0)
+        rcode = 2;
+    else if (strcmp(name, "web.test") != 0 && strcmp(name, "web.corp.test") != 0 && strcmp(name, "big.test") != 0)
+        return 0; // Silent
+
+    memcpy(r, q, qend);
+    put16(r, 2, flags | (unsigned)rcode);
+    put16(r, 6, rdlen ? 1 : 0);
+    put16(r, 8, 0);
+    put16(r, 10, 0);
+    size_t off = qend;
+    if (rdlen)
+    {
+        off = put16(r, off, 0xC00C); // Name: pointer to the question
+        off = put16(r, off, type);
+        off = put16(r, off, 1);
+        off = put16(r, off, stub->ttl >> 16);
+        off = put16(r, off, stub->ttl & 0xFFFF);
+        off = put16(r, off, (unsigned)rdlen);
+        memcpy(r + off, rdata, (size_t)rdlen);
+        off += (size_t)rdlen;
+    }
+    return off;
+}
+
+static void stub_event(cwh_loop_t *loop, int fd, int events, void *data)
+{
+    (void)loop;
+    (void)events;
+    stub_dns_t *stub = (stub_dns_t *)data;
+
+    unsigned char q[512];
+    struct sockaddr_in from;
+    socklen_t from_len = sizeof(from);
+    ssize_t n;
+    while ((n = recvfrom(fd, q, sizeof(q), 0, (struct sockaddr *)&from, &from_len)) > 0)
+    {
+        stub->queries++;
+        unsigned char r[600];
+        size_t len = stub_answer(stub, q, (size_t)n, r, false);
+        if (len)
+            sendto(fd, r, len, 0, (struct sockaddr *)&from, from_len);
+        from_len = sizeof(from);
+    }
+}
+
+// One TCP client at a time: answer each length-prefixed query
+static void stub_conn_event(cwh_loop_t *loop, int fd, int events, void *data)
+{
+    (void)events;
+    stub_dns_t *stub = (stub_dns_t *)data;
+
+    ssize_t n;
+    while ((n = recv(fd, stub->in + stub->in_len, sizeof(stub->in) - stub->in_len, 0)) > 0)
+        stub->in_len += (size_t)n;
+
+    while (stub->in_len >= 2)
+    {
+        size_t len = ((size_t)stub->in[0] << 8) | stub->in[1];
+        if (stub->in_len < 2 + len)
+            break;
+        stub->tcp_queries++;
+        unsigned char r[602];
+        size_t rlen = stub_answer(stub, stub->in + 2, len, r + 2, true);
+        if (rlen)
+        {
+            put16(r, 0, (unsigned)rlen);
+            send(fd, r, rlen + 2, 0);
+        }
+        stub->in_len -= 2 + len;
+        memmove(stub->in, stub->in + 2 + len, stub->in_len);
+    }
+
+    if (n == 0)
+    {
+        cwh_loop_del(loop, fd);
+        close(fd);
+        stub->conn_fd = -1;
+    }
+}
+
+static void stub_accept(cwh_loop_t *loop, int fd, int events, void *data)
+{
+    (void)events;
+    stub_dns_t *stub = (stub_dns_t *)data;
+    int conn = accept(fd, NULL, NULL);
+    if (conn < 0)
+        return;
+    if (stub->conn_fd >= 0)
+    {
+        cwh_loop_del(loop, stub->conn_fd);
+        close(stub->conn_fd);
+    }
+    stub->conn_fd = conn;
+    stub->in_len = 0;
+    cwh_set_nonblocking(conn);
+    cwh_loop_add(loop, conn, CWH_EVENT_READ, stub_conn_event, stub);
+}
+
+static void stub_start(cwh_loop_t *loop, stub_dns_t *stub)
+{
+    memset(stub, 0, sizeof(*stub));
+    stub->ttl = 300;
+    stub->conn_fd = -1;
+    stub->fd = socket(AF_INET, SOCK_DGRAM, 0);
+    TEST_ASSERT_TRUE(stub->fd >= 0);
+
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    TEST_ASSERT_EQUAL_INT(0, bind(stub->fd, (struct sockaddr *)&addr, sizeof(addr)));
+    socklen_t len = sizeof(addr);
+    getsockname(stub->fd, (struct sockaddr *)&addr, &len);
+    stub->port = ntohs(addr.sin_port);
+
+    TEST_ASSERT_EQUAL_INT(0, cwh_set_nonblocking(stub->fd));
+    TEST_ASSERT_EQUAL_INT(0, cwh_loop_add(loop, stub->fd, CWH_EVENT_READ, stub_event, stub));
+
+    // TCP on the same port, for truncated answers
+    stub->tcp_fd = socket(AF_INET, SOCK_STREAM, 0);
+    TEST_ASSERT_TRUE(stub->tcp_fd >= 0);
+    TEST_ASSERT_EQUAL_INT(0, bind(stub->tcp_fd, (struct sockaddr *)&addr, sizeof(addr)));
+    TEST_ASSERT_EQUAL_INT(0, listen(stub->tcp_fd, 4));
+    TEST_ASSERT_EQUAL_INT(0, cwh_set_nonblocking(stub->tcp_fd));
+    TEST_ASSERT_EQUAL_INT(0, cwh_loop_add(loop, stub->tcp_fd, CWH_EVENT_READ, stub_accept, stub));
+}
+
+static void stub_stop(cwh_loop_t *loop, stub_dns_t *stub)
+{
+    cwh_loop_del(loop, stub->fd);
+    close(stub->fd);
+    cwh_loop_del(loop, stub->tcp_fd);
+    close(stub->tcp_fd);
+    if (stub->conn_fd >= 0)
+    {
+        cwh_loop_del(loop, stub->conn_fd);
+        close(stub->conn_fd);
+    }
+}
+
+// ============================================================================
+// Helpers
+// ============================================================================
+
+typedef struct
+{
+    int calls;
+    cwh_error_t err;
+    int count;
+    cwh_dns_addr_t addrs[CWH_DNS_MAX_ADDRS];
+} result_t;
+
+static void on_resolved(cwh_error_t err, const cwh_dns_addr_t *addrs, int count, void *data)
+{
+    result_t *r = (result_t *)data;
+    r->calls++;
+    r->err = err;
+    r->count = count;
+    if (count > 0)
+        memcpy(r->addrs, addrs, (size_t)count * sizeof(*addrs));
+}
+
+static void run_until(cwh_loop_t *loop, const int *calls, int want)
+{
+    for (int i = 0; i < 200 && *calls < want; i++)
+        cwh_loop_run_once(loop, 50);
+}
+
+static void assert_addr(const cwh_dns_addr_t *addr, int family, const char *text)
+{
+    unsigned char expect[16];
+    TEST_ASSERT_EQUAL_INT(family, addr->family);
+    TEST_ASSERT_EQUAL_INT(1, inet_pton(family == CWH_DNS_IPV4 ? AF_INET : AF_INET6, text, expect));
+    TEST_ASSERT_EQUAL_MEMORY(expect, addr->addr, family == CWH_DNS_IPV4 ? 4 : 16);
+}
+
+static cwh_resolver_t *stub_resolver(cwh_loop_t *loop, stub_dns_t *stub)
+{
+    cwh_resolver_t *res = cwh_resolver_new(loop);
+    TEST_ASSERT_NOT_NULL(res);
+    TEST_ASSERT_EQUAL_INT(0, cwh_resolver_set_nameserver(res, "127.0.0.1", stub->port));
+    TEST_ASSERT_EQUAL_INT(0, cwh_resolver_load_hosts(res, NULL));
+    TEST_ASSERT_EQUAL_INT(0, cwh_resolver_set_search(res, NULL, 1));
+    cwh_resolver_set_timeout(res, 100, 2);
+    return res;
+}
+
+// ============================================================================
+// Tests
+// ============================================================================
+
+// Literals, localhost and hosts entries answer before cwh_resolve returns
+void test_resolve_static(void)
+{
+    cwh_loop_t *loop = cwh_loop_new();
+    cwh_resolver_t *res = cwh_resolver_new(loop);
+
+    const char *hosts_path = "/tmp/cwh_test_hosts";
+    FILE *f = fopen(hosts_path, "w");
+    TEST_ASSERT_NOT_NULL(f);
+    fprintf(f, "# comment\n2001:db8::7 db.internal\n192.0.2.7  db.internal db # inline\n");
+    fclose(f);
+    TEST_ASSERT_EQUAL_INT(0, cwh_resolver_load_hosts(res, hosts_path));
+    unlink(hosts_path);
+
+    result_t r;
+    memset(&r, 0, sizeof(r));
+    TEST_ASSERT_NULL(cwh_resolve(res, "10.1.2.3", CWH_DNS_ANY, on_resolved, &r));
+    TEST_ASSERT_EQUAL_INT(1, r.calls);
+    TEST_ASSERT_EQUAL_INT(CWH_OK, r.err);
+    assert_addr(&r.addrs[0], CWH_DNS_IPV4, "10.1.2.3");
+
+    memset(&r, 0, sizeof(r));
+    TEST_ASSERT_NULL(cwh_resolve(res, "DB.Internal.", CWH_DNS_ANY, on_resolved, &r));
+    TEST_ASSERT_EQUAL_INT(1, r.calls);
+    TEST_ASSERT_EQUAL_INT(2, r.count);
+    assert_addr(&r.addrs[0], CWH_DNS_IPV4, "192.0.2.7");
+    assert_addr(&r.addrs[1], CWH_DNS_IPV6, "2001:db8::7");
+
+    memset(&r, 0, sizeof(r));
+    TEST_ASSERT_NULL(cwh_resolve(res, "localhost", CWH_DNS_IPV4, on_resolved, &r));
+    TEST_ASSERT_EQUAL_INT(1, r.count);
+    assert_addr(&r.addrs[0], CWH_DNS_IPV4, "127.0.0.1");
+
+    memset(&r, 0, sizeof(r));
+    TEST_ASSERT_NULL(cwh_resolve(res, "::1", CWH_DNS_IPV4, on_resolved, &r));
+    TEST_ASSERT_EQUAL_INT(1, r.calls);
+    TEST_ASSERT_EQUAL_INT(CWH_ERR_NET, r.err);
+
+    memset(&r, 0, sizeof(r));
+    TEST_ASSERT_NULL(cwh_resolve(res, "bad..name", CWH_DNS_ANY, on_resolved, &r));
+    TEST_ASSERT_EQUAL_INT(CWH_ERR_PARSE, r.err);
+
+    cwh_resolver_free(res);
+    cwh_loop_free(loop);
+}
+
+// A and AAAA over UDP; two callers share one lookup
+void test_resolve_query(void)
+{
+    cwh_loop_t *loop = cwh_loop_new();
+    stub_dns_t stub;
+    stub_start(loop, &stub);
+    cwh_resolver_t *res = stub_resolver(loop, &stub);
+
+    result_t r1, r2;
+    memset(&r1, 0, sizeof(r1));
+    memset(&r2, 0, sizeof(r2));
+    TEST_ASSERT_NOT_NULL(cwh_resolve(res, "a.test", CWH_DNS_ANY, on_resolved, &r1));
+    TEST_ASSERT_NOT_NULL(cwh_resolve(res, "A.TEST", CWH_DNS_ANY, on_resolved, &r2));
+    TEST_ASSERT_EQUAL_INT(0, r1.calls);
+
+    run_until(loop, &r2.calls, 1);
+    TEST_ASSERT_EQUAL_INT(1, r1.calls);
+    TEST_ASSERT_EQUAL_INT(1, r2.calls);
+    TEST_ASSERT_EQUAL_INT(CWH_OK, r1.err);
+    TEST_ASSERT_EQUAL_INT(2, r1.count);
+    assert_addr(&r1.addrs[0], CWH_DNS_IPV4, "10.0.0.1");
+    assert_addr(&r1.addrs[1], CWH_DNS_IPV6, "2001:db8::1");
+    TEST_ASSERT_EQUAL_INT(2, r2.count);
+    TEST_ASSERT_EQUAL_INT(2, stub.queries); // One A + one AAAA for both
+
+    memset(&r1, 0, sizeof(r1));
+    TEST_ASSERT_NOT_NULL(cwh_resolve(res, "a.test", CWH_DNS_IPV6, on_resolved, &r1));
+    run_until(loop, &r1.calls, 1);
+    TEST_ASSERT_EQUAL_INT(1, r1.count);
+    assert_addr(&r1.addrs[0], CWH_DNS_IPV6, "2001:db8::1");
+
+    cwh_resolver_free(res);
+    stub_stop(loop, &stub);
+    cwh_loop_free(loop);
+}
+
+// NXDOMAIN and SERVFAIL fail without waiting for the timeout
+void test_resolve_errors(void)
+{
+    cwh_loop_t *loop = cwh_loop_new();
+    stub_dns_t stub;
+    stub_start(loop, &stub);
+    cwh_resolver_t *res = stub_resolver(loop, &stub);
+    cwh_resolver_set_timeout(res, 5000, 1);
+
+    result_t r;
+    memset(&r, 0, sizeof(r));
+    TEST_ASSERT_NOT_NULL(cwh_resolve(res, "nx.test", CWH_DNS_ANY, on_resolved, &r));
+    run_until(loop, &r.calls, 1);
+    TEST_ASSERT_EQUAL_INT(1, r.calls);
+    TEST_ASSERT_EQUAL_INT(CWH_ERR_NET, r.err);
+    TEST_ASSERT_EQUAL_INT(0, r.count);
+
+    memset(&r, 0, sizeof(r));
+    TEST_ASSERT_NOT_NULL(cwh_resolve(res, "fail.test", CWH_DNS_IPV4, on_resolved, &r));
+    run_until(loop, &r.calls, 1);
+    TEST_ASSERT_EQUAL_INT(1, r.calls);
+    TEST_ASSERT_EQUAL_INT(CWH_ERR_NET, r.err);
+
+    cwh_resolver_free(res);
+    stub_stop(loop, &stub);
+    cwh_loop_free(loop);
+}
+
+// Unanswered queries are retried, then time out; cancel drops the lookup
+void test_resolve_timeout_and_cancel(void)
+{
+    cwh_loop_t *loop = cwh_loop_new();
+    stub_dns_t stub;
+    stub_start(loop, &stub);
+    cwh_resolver_t *res = stub_resolver(loop, &stub);
+
+    result_t r;
+    memset(&r, 0, sizeof(r));
+    TEST_ASSERT_NOT_NULL(cwh_resolve(res, "silent.test", CWH_DNS_IPV4, on_resolved, &r));
+    run_until(loop, &r.calls, 1);
+    TEST_ASSERT_EQUAL_INT(1, r.calls);
+    TEST_ASSERT_EQUAL_INT(CWH_ERR_TIMEOUT, r.err);
+    TEST_ASSERT_EQUAL_INT(2, stub.queries); // attempts = 2
+
+    result_t c1, c2;
+    memset(&c1, 0, sizeof(c1));
+    memset(&c2, 0, sizeof(c2));
+    cwh_dns_query_t *q1 = cwh_resolve(res, "a.test", CWH_DNS_IPV4, on_resolved, &c1);
+    cwh_dns_query_t *q2 = cwh_resolve(res, "a.test", CWH_DNS_IPV4, on_resolved, &c2);
+    TEST_ASSERT_TRUE(q1 != q2);
+    cwh_resolve_cancel(q1);
+    run_until(loop, &c2.calls, 1);
+    TEST_ASSERT_EQUAL_INT(0, c1.calls);
+    TEST_ASSERT_EQUAL_INT(1, c2.calls);
+    TEST_ASSERT_EQUAL_INT(CWH_OK, c2.err);
+
+    memset(&c1, 0, sizeof(c1));
+    q1 = cwh_resolve(res, "silent.test", CWH_DNS_IPV4, on_resolved, &c1);
+    cwh_resolve_cancel(q1);
+    for (int i = 0; i < 5; i++)
+        cwh_loop_run_once(loop, 50);
+    TEST_ASSERT_EQUAL_INT(0, c1.calls);
+
+    // Pending lookups fail when the resolver goes away
+    memset(&c1, 0, sizeof(c1));
+    TEST_ASSERT_NOT_NULL(cwh_resolve(res, "silent.test", CWH_DNS_IPV4, on_resolved, &c1));
+    cwh_resolver_free(res);
+    TEST_ASSERT_EQUAL_INT(1, c1.calls);
+    TEST_ASSERT_EQUAL_INT(CWH_ERR_NET, c1.err);
+
+    stub_stop(loop, &stub);
+    cwh_loop_free(loop);
+}
+
+// Short names go through the search list, others are tried as given first
+void test_resolve_search(void)
+{
+    cwh_loop_t *loop = cwh_loop_new();
+    stub_dns_t stub;
+    stub_start(loop, &stub);
+    cwh_resolver_t *res = stub_resolver(loop, &stub);
+    TEST_ASSERT_EQUAL_INT(0, cwh_resolver_set_search(res, "empty.test corp.test", 1));
+
+    // web.empty.test is NXDOMAIN, web.corp.test answers
+    result_t r;
+    memset(&r, 0, sizeof(r));
+    TEST_ASSERT_NOT_NULL(cwh_resolve(res, "web", CWH_DNS_IPV4, on_resolved, &r));
+    run_until(loop, &r.calls, 1);
+    TEST_ASSERT_EQUAL_INT(CWH_OK, r.err);
+    TEST_ASSERT_EQUAL_INT(1, r.count);
+    assert_addr(&r.addrs[0], CWH_DNS_IPV4, "10.0.0.2");
+    TEST_ASSERT_EQUAL_INT(2, stub.queries);
+
+    // ndots reached: the name as given answers, no search domain is tried
+    stub.queries = 0;
+    memset(&r, 0, sizeof(r));
+    TEST_ASSERT_NOT_NULL(cwh_resolve(res, "a.test", CWH_DNS_IPV4, on_resolved, &r));
+    run_until(loop, &r.calls, 1);
+    assert_addr(&r.addrs[0], CWH_DNS_IPV4, "10.0.0.1");
+    TEST_ASSERT_EQUAL_INT(1, stub.queries);
+
+    // ...and then with each search domain when it has no address
+    stub.queries = 0;
+    memset(&r, 0, sizeof(r));
+    TEST_ASSERT_NOT_NULL(cwh_resolve(res, "nx.test", CWH_DNS_IPV4, on_resolved, &r));
+    run_until(loop, &r.calls, 1);
+    TEST_ASSERT_EQUAL_INT(CWH_ERR_NET, r.err);
+    TEST_ASSERT_EQUAL_INT(3, stub.queries);
+
+    // Absolute names are never expanded
+    stub.queries = 0;
+    memset(&r, 0, sizeof(r));
+    cwh_resolver_set_timeout(res, 50, 1);
+    TEST_ASSERT_NOT_NULL(cwh_resolve(res, "web.", CWH_DNS_IPV4, on_resolved, &r));
+    run_until(loop, &r.calls, 1);
+    TEST_ASSERT_EQUAL_INT(CWH_ERR_TIMEOUT, r.err); // "web" itself is never answered
+    TEST_ASSERT_EQUAL_INT(1, stub.queries);
+
+    cwh_resolver_free(res);
+    stub_stop(loop, &stub);
+    cwh_loop_free(loop);
+}
+
+// A truncated UDP answer is asked again over TCP
+void test_resolve_truncated(void)
+{
+    cwh_loop_t *loop = cwh_loop_new();
+    stub_dns_t stub;
+    stub_start(loop, &stub);
+    cwh_resolver_t *res = stub_resolver(loop, &stub);
+
+    result_t r;
+    memset(&r, 0, sizeof(r));
+    TEST_ASSERT_NOT_NULL(cwh_resolve(res, "big.test", CWH_DNS_ANY, on_resolved, &r));
+    run_until(loop, &r.calls, 1);
+    TEST_ASSERT_EQUAL_INT(1, r.calls);
+    TEST_ASSERT_EQUAL_INT(CWH_OK, r.err);
+    TEST_ASSERT_EQUAL_INT(1, r.count);
+    assert_addr(&r.addrs[0], CWH_DNS_IPV4, "10.0.0.3");
+    TEST_ASSERT_EQUAL_INT(2, stub.queries);     // A and AAAA over UDP
+    TEST_ASSERT_EQUAL_INT(2, stub.tcp_queries); // Both again over TCP
+
+    cwh_resolver_free(res);
+    stub_stop(loop, &stub);
+    cwh_loop_free(loop);
+}
+
+// Answers are cached for their TTL; failures briefly; timeouts not at all
+void test_resolve_cache(void)
+{
+    cwh_loop_t *loop = cwh_loop_new();
+    stub_dns_t stub;
+    stub_start(loop, &stub);
+    cwh_resolver_t *res = stub_resolver(loop, &stub);
+
+    result_t r;
+    memset(&r, 0, sizeof(r));
+    TEST_ASSERT_NOT_NULL(cwh_resolve(res, "a.test", CWH_DNS_ANY, on_resolved, &r));
+    run_until(loop, &r.calls, 1);
+    TEST_ASSERT_EQUAL_INT(2, stub.queries);
+
+    memset(&r, 0, sizeof(r));
+    TEST_ASSERT_NULL(cwh_resolve(res, "A.test.", CWH_DNS_ANY, on_resolved, &r));
+    TEST_ASSERT_EQUAL_INT(1, r.calls);
+    TEST_ASSERT_EQUAL_INT(CWH_OK, r.err);
+    TEST_ASSERT_EQUAL_INT(2, r.count);
+    assert_addr(&r.addrs[0], CWH_DNS_IPV4, "10.0.0.1");
+    TEST_ASSERT_EQUAL_INT(2, stub.queries);
+
+    memset(&r, 0, sizeof(r));
+    TEST_ASSERT_NOT_NULL(cwh_resolve(res, "nx.test", CWH_DNS_IPV4, on_resolved, &r));
+    run_until(loop, &r.calls, 1);
+    memset(&r, 0, sizeof(r));
+    TEST_ASSERT_NULL(cwh_resolve(res, "nx.test", CWH_DNS_IPV4, on_resolved, &r));
+    TEST_ASSERT_EQUAL_INT(1, r.calls);
+    TEST_ASSERT_EQUAL_INT(CWH_ERR_NET, r.err);
+    TEST_ASSERT_EQUAL_INT(3, stub.queries);
+
+    memset(&r, 0, sizeof(r));
+    TEST_ASSERT_NOT_NULL(cwh_resolve(res, "silent.test", CWH_DNS_IPV4, on_resolved, &r));
+    run_until(loop, &r.calls, 1);
+    TEST_ASSERT_EQUAL_INT(CWH_ERR_TIMEOUT, r.err);
+    memset(&r, 0, sizeof(r));
+    cwh_dns_query_t *q = cwh_resolve(res, "silent.test", CWH_DNS_IPV4, on_resolved, &r);
+    TEST_ASSERT_NOT_NULL(q);
+    cwh_resolve_cancel(q);
+    for (int i = 0; i < 3; i++)
+        cwh_loop_run_once(loop, 20); // Let the stub see the query
+
+    size_t entries;
+    uint64_t hits, misses, stale;
+    cwh_dns_cache_stats(&entries, &hits, &misses, &stale);
+    TEST_ASSERT_EQUAL_INT(2, (int)entries);
+    TEST_ASSERT_EQUAL_INT(2, (int)hits);
+    TEST_ASSERT_EQUAL_INT(4, (int)misses);
+    TEST_ASSERT_EQUAL_INT(0, (int)stale);
+
+    // Expired answers are served stale while one refresh goes out
+    cwh_dns_cache_set_ttl(1, 1, 1, 30);
+    int before = stub.queries;
+    memset(&r, 0, sizeof(r));
+    TEST_ASSERT_NOT_NULL(cwh_resolve(res, "web.test", CWH_DNS_IPV4, on_resolved, &r));
+    run_until(loop, &r.calls, 1);
+    TEST_ASSERT_EQUAL_INT(before + 1, stub.queries);
+
+    usleep(1100 * 1000);
+    memset(&r, 0, sizeof(r));
+    TEST_ASSERT_NULL(cwh_resolve(res, "web.test", CWH_DNS_IPV4, on_resolved, &r));
+    TEST_ASSERT_EQUAL_INT(CWH_OK, r.err);
+    assert_addr(&r.addrs[0], CWH_DNS_IPV4, "127.0.0.1");
+    memset(&r, 0, sizeof(r));
+    TEST_ASSERT_NULL(cwh_resolve(res, "web.test", CWH_DNS_IPV4, on_resolved, &r));
+    for (int i = 0; i < 5; i++)
+        cwh_loop_run_once(loop, 20);
+    TEST_ASSERT_EQUAL_INT(before + 2, stub.queries); // One refresh for both
+
+    memset(&r, 0, sizeof(r));
+    TEST_ASSERT_NULL(cwh_resolve(res, "web.test", CWH_DNS_IPV4, on_resolved, &r));
+    TEST_ASSERT_EQUAL_INT(before + 2, stub.queries);
+    cwh_dns_cache_stats(NULL, NULL, NULL, &stale);
+    TEST_ASSERT_EQUAL_INT(2, (int)stale);
+    cwh_dns_cache_set_ttl(1, 300, 5, 30);
+
+    cwh_resolver_free(res);
+    stub_stop(loop, &stub);
+    cwh_loop_free(loop);
+}
+
+// Cache API: TTL clamps, capacity, and the sync client using cached names
+void test_dns_cache_api(void)
+{
+    cwh_dns_addr_t addr, out[CWH_DNS_MAX_ADDRS];
+    memset(&addr, 0, sizeof(addr));
+    addr.family = CWH_DNS_IPV4;
+    inet_pton(AF_INET, "127.0.0.1", addr.addr);
+
+    bool refresh = false;
+    TEST_ASSERT_EQUAL_INT(-1, cwh_dns_cache_lookup("x.test", CWH_DNS_ANY, out, CWH_DNS_MAX_ADDRS, &refresh));
+    TEST_ASSERT_TRUE(refresh);
+
+    cwh_dns_cache_store("X.Test", CWH_DNS_ANY, &addr, 1, 60);
+    TEST_ASSERT_EQUAL_INT(1, cwh_dns_cache_lookup("x.test.", CWH_DNS_ANY, out, CWH_DNS_MAX_ADDRS, &refresh));
+    TEST_ASSERT_FALSE(refresh);
+    TEST_ASSERT_EQUAL_INT(-1, cwh_dns_cache_lookup("x.test", CWH_DNS_IPV6, out, CWH_DNS_MAX_ADDRS, NULL));
+
+    cwh_dns_cache_store("gone.test", CWH_DNS_ANY, NULL, 0, 0);
+    TEST_ASSERT_EQUAL_INT(0, cwh_dns_cache_lookup("gone.test", CWH_DNS_ANY, out, CWH_DNS_MAX_ADDRS, &refresh));
+    TEST_ASSERT_FALSE(refresh);
+
+    cwh_dns_cache_set_capacity(1);
+    size_t entries;
+    cwh_dns_cache_stats(&entries, NULL, NULL, NULL);
+    TEST_ASSERT_EQUAL_INT(1, (int)entries);
+    TEST_ASSERT_EQUAL_INT(-1, cwh_dns_cache_lookup("x.test", CWH_DNS_ANY, out, CWH_DNS_MAX_ADDRS, NULL));
+    cwh_dns_cache_set_capacity(0);
+    cwh_dns_cache_store("x.test", CWH_DNS_ANY, &addr, 1, 60);
+    TEST_ASSERT_EQUAL_INT(-1, cwh_dns_cache_lookup("x.test", CWH_DNS_ANY, out, CWH_DNS_MAX_ADDRS, NULL));
+    cwh_dns_cache_set_capacity(1024);
+
+    // cwh_connect takes the address from the cache (no such name in DNS)
+    int listener = socket(AF_INET, SOCK_STREAM, 0);
+    struct sockaddr_in sin;
+    memset(&sin, 0, sizeof(sin));
+    sin.sin_family = AF_INET;
+    sin.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    TEST_ASSERT_EQUAL_INT(0, bind(listener, (struct sockaddr *)&sin, sizeof(sin)));
+    socklen_t len = sizeof(sin);
+    getsockname(listener, (struct sockaddr *)&sin, &len);
+    TEST_ASSERT_EQUAL_INT(0, listen(listener, 1));
+
+    cwh_dns_cache_store("cached.invalid", CWH_DNS_ANY, &addr, 1, 60);
+    char url[64];
+    snprintf(url, sizeof(url), "http://cached.invalid:%d/", ntohs(sin.sin_port));
+    cwh_conn_t *conn = cwh_connect(url, 1000);
+    TEST_ASSERT_NOT_NULL(conn);
+    cwh_close(conn);
+
+    cwh_dns_cache_store("missing.invalid", CWH_DNS_ANY, NULL, 0, 0);
+    snprintf(url, sizeof(url), "http://missing.invalid:%d/", ntohs(sin.sin_port));
+    TEST_ASSERT_NULL(cwh_connect(url, 1000));
+    close(listener);
+}
+
+// The async client resolves through the loop's resolver
+static int http_fd = -1;
+
+static void *http_thread(void *arg)
+{
+    (void)arg;
+    int fd = accept(http_fd, NULL, NULL);
+    if (fd < 0)
+        return NULL;
+    char buf[2048];
+    size_t got = 0;
+    ssize_t n;
+    while (got < sizeof(buf) - 1 && (n = recv(fd, buf + got, sizeof(buf) - 1 - got, 0)) > 0)
+    {
+        got += (size_t)n;
+        buf[got] = '\0';
+        if (strstr(buf, "\r\n\r\n"))
+            break;
+    }
+    const char *reply = "HTTP/1.1 200 OK\r\nContent-Length: 2\r\nConnection: close\r\n\r\nok";
+    send(fd, reply, strlen(reply), 0);
+    close(fd);
+    return NULL;
+}
+
+typedef struct
+{
+    int calls;
+    int status;
+    cwh_error_t err;
+} http_result_t;
+
+static void on_response(cwh_response_t *res, cwh_error_t err, void *data)
+{
+    http_result_t *r = (http_result_t *)data;
+    r->calls++;
+    r->err = err;
+    r->status = res ? res->status : 0;
+}
+
+void test_async_client_resolves(void)
+{
+    http_fd = socket(AF_INET, SOCK_STREAM, 0);
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    TEST_ASSERT_EQUAL_INT(0, bind(http_fd, (struct sockaddr *)&addr, sizeof(addr)));
+    socklen_t len = sizeof(addr);
+    getsockname(http_fd, (struct sockaddr *)&addr, &len);
+    TEST_ASSERT_EQUAL_INT(0, listen(http_fd, 1));
+    pthread_t thread;
+    pthread_create(&thread, NULL, http_thread, NULL);
+
+    cwh_loop_t *loop = cwh_loop_new();
+    stub_dns_t stub;
+    stub_start(loop, &stub);
+    cwh_resolver_t *res = cwh_loop_resolver(loop);
+    TEST_ASSERT_NOT_NULL(res);
+    TEST_ASSERT_EQUAL_INT(0, cwh_resolver_set_nameserver(res, "127.0.0.1", stub.port));
+    cwh_resolver_load_hosts(res, NULL);
+    cwh_resolver_set_search(res, NULL, 1);
+
+    char url[64];
+    snprintf(url, sizeof(url), "http://web.test:%d/", ntohs(addr.sin_port));
+    http_result_t r;
+    memset(&r, 0, sizeof(r));
+    cwh_async_get(loop, url, on_response, &r);
+    run_until(loop, &r.calls, 1);
+
+    TEST_ASSERT_EQUAL_INT(1, r.calls);
+    TEST_ASSERT_EQUAL_INT(CWH_OK, r.err);
+    TEST_ASSERT_EQUAL_INT(200, r.status);
+    TEST_ASSERT_TRUE(stub.queries >= 1);
+
+    pthread_join(thread, NULL);
+    close(http_fd);
+    stub_stop(loop, &stub);
+    cwh_loop_free(loop);
+}
+#endif
+
+int main(void)
+{
+    UNITY_BEGIN();
+
+    printf("\n=== cwebhttp Async DNS Tests ===\n\n");
+
+#ifndef _WIN32
+    RUN_TEST(test_resolve_static);
+    RUN_TEST(test_resolve_query);
+    RUN_TEST(test_resolve_errors);
+    RUN_TEST(test_resolve_timeout_and_cancel);
+    RUN_TEST(test_resolve_search);
+    RUN_TEST(test_resolve_truncated);
+    RUN_TEST(test_resolve_cache);
+    RUN_TEST(test_dns_cache_api);
+    RUN_TEST(test_async_client_resolves);
+#else
+    printf("\nNote: DNS tests skipped on Windows\n");
+#endif
+
+    return UNITY_END();
+}
@@ -5,6 +5,8 @@
 #include "unity.h"
 #include <stdio.h>
 #include <string.h>
+#include <stdint.h>
+#include <time.h>
 
 #ifndef _WIN32
 #include <unistd.h>
@@ -201,6 +203,228 @@ void test_loop_modify(void)
 #endif
 }
 
+#ifdef __linux__
+static int seen_events = 0;
+
+static void count_events(cwh_loop_t *loop, int fd, int events, void *data)
+{
+    (void)loop;
+    (void)fd;
+    (void)data;
+    seen_events |= events;
+    callback_count++;
+}
+
+// Test 7: io_uring backend keeps level-triggered semantics
+void test_loop_io_uring(void)
+{
+    cwh_loop_t *loop = cwh_loop_new_backend(CWH_BACKEND_IO_URING);
+    TEST_ASSERT_NOT_NULL(loop);
+    if (strstr(cwh_loop_backend(loop), "io_uring") == NULL)
+    {
+        cwh_loop_free(loop);
+        TEST_IGNORE_MESSAGE("io_uring unavailable, fell back to epoll");
+    }
+
+    int fds[2];
+    TEST_ASSERT_EQUAL(0, pipe(fds));
+    cwh_set_nonblocking(fds[0]);
+    TEST_ASSERT_EQUAL(0, cwh_loop_add(loop, fds[0], CWH_EVENT_READ, count_events, NULL));
+
+    // Nothing readable: the wait times out
+    callback_count = 0;
+    TEST_ASSERT_EQUAL(0, cwh_loop_run_once(loop, 20));
+    TEST_ASSERT_EQUAL(0, callback_count);
+
+    // Readable and never drained: reported on every iteration
+    TEST_ASSERT_EQUAL(4, write(fds[1], "ping", 4));
+    TEST_ASSERT_EQUAL(1, cwh_loop_run_once(loop, 100));
+    TEST_ASSERT_EQUAL(1, cwh_loop_run_once(loop, 100));
+    TEST_ASSERT_EQUAL(2, callback_count);
+    TEST_ASSERT_TRUE(seen_events & CWH_EVENT_READ);
+
+    // Drained: quiet again
+    char buf[8];
+    TEST_ASSERT_EQUAL(4, read(fds[0], buf, sizeof(buf)));
+    TEST_ASSERT_EQUAL(0, cwh_loop_run_once(loop, 20));
+
+    // Interest change and writer registration
+    TEST_ASSERT_EQUAL(0, cwh_loop_mod(loop, fds[0], CWH_EVENT_READ | CWH_EVENT_WRITE));
+    TEST_ASSERT_EQUAL(0, cwh_loop_add(loop, fds[1], CWH_EVENT_WRITE, count_events, NULL));
+    seen_events = 0;
+    TEST_ASSERT_EQUAL(1, cwh_loop_run_once(loop, 100));
+    TEST_ASSERT_EQUAL(CWH_EVENT_WRITE, seen_events);
+
+    // Removed fds are not reported
+    TEST_ASSERT_EQUAL(0, cwh_loop_del(loop, fds[1]));
+    TEST_ASSERT_EQUAL(-1, cwh_loop_del(loop, fds[1]));
+    close(fds[1]); // Read end now reports hangup
+    callback_count = 0;
+    TEST_ASSERT_EQUAL(1, cwh_loop_run_once(loop, 100));
+    TEST_ASSERT_EQUAL(1, callback_count);
+
+    TEST_ASSERT_EQUAL(0, cwh_loop_del(loop, fds[0]));
+    close(fds[0]);
+    TEST_ASSERT_EQUAL(0, cwh_loop_run_once(loop, 20));
+    TEST_ASSERT_TRUE(cwh_loop_syscalls(loop) > 0);
+
+    cwh_loop_free(loop);
+}
+
+// Test 8: epoll honours edge-triggered and exclusive registrations
+void test_loop_edge_triggered(void)
+{
+    cwh_loop_t *loop = cwh_loop_new_backend(CWH_BACKEND_EPOLL);
+    TEST_ASSERT_NOT_NULL(loop);
+    TEST_ASSERT_TRUE(cwh_loop_flags(loop) & CWH_EVENT_EDGE);
+
+    int fds[2];
+    TEST_ASSERT_EQUAL(0, pipe(fds));
+    cwh_set_nonblocking(fds[0]);
+    TEST_ASSERT_EQUAL(0, cwh_loop_add(loop, fds[0], CWH_EVENT_READ | CWH_EVENT_EDGE, count_events, NULL));
+
+    // Readable but not drained: reported once
+    callback_count = 0;
+    TEST_ASSERT_EQUAL(4, write(fds[1], "ping", 4));
+    TEST_ASSERT_EQUAL(1, cwh_loop_run_once(loop, 100));
+    TEST_ASSERT_EQUAL(0, cwh_loop_run_once(loop, 20));
+    TEST_ASSERT_EQUAL(1, callback_count);
+
+    // New data is a new edge; so is re-registering while still readable
+    TEST_ASSERT_EQUAL(4, write(fds[1], "pong", 4));
+    TEST_ASSERT_EQUAL(1, cwh_loop_run_once(loop, 100));
+    TEST_ASSERT_EQUAL(0, cwh_loop_mod(loop, fds[0], CWH_EVENT_READ | CWH_EVENT_EDGE));
+    TEST_ASSERT_EQUAL(1, cwh_loop_run_once(loop, 100));
+    TEST_ASSERT_EQUAL(0, cwh_loop_run_once(loop, 20));
+    TEST_ASSERT_EQUAL(3, callback_count);
+
+    TEST_ASSERT_EQUAL(0, cwh_loop_del(loop, fds[0]));
+
+    // Exclusive wakeup registration (shared listeners)
+    if (cwh_loop_flags(loop) & CWH_EVENT_EXCLUSIVE)
+    {
+        TEST_ASSERT_EQUAL(0, cwh_loop_add(loop, fds[0], CWH_EVENT_READ | CWH_EVENT_EXCLUSIVE,
+                                          count_events, NULL));
+        TEST_ASSERT_EQUAL(1, cwh_loop_run_once(loop, 100));
+        TEST_ASSERT_EQUAL(0, cwh_loop_del(loop, fds[0]));
+    }
+
+    close(fds[0]);
+    close(fds[1]);
+    cwh_loop_free(loop);
+}
+#endif
+
+// ============================================================================
+// Timer tests
+// ============================================================================
+
+static int fired_ids[8];
+static int fired_count = 0;
+
+static void record_timer(cwh_loop_t *loop, cwh_timer_t *timer, void *data)
+{
+    (void)loop;
+    (void)timer;
+    if (fired_count < 8)
+        fired_ids[fired_count++] = (int)(intptr_t)data;
+}
+
+static void stop_timer(cwh_loop_t *loop, cwh_timer_t *timer, void *data)
+{
+    (void)data;
+    fired_count++;
+    cwh_loop_timer_cancel(loop, timer); // Freeing itself from its callback is allowed
+    cwh_loop_stop(loop);
+}
+
+static uint64_t test_now_ms(void)
+{
+#ifdef _WIN32
+    return (uint64_t)GetTickCount64();
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000 + (uint64_t)ts.tv_nsec / 1000000;
+#endif
+}
+
+// Test 7: Timers fire in deadline order and never early
+void test_timer_order(void)
+{
+    cwh_loop_t *loop = cwh_loop_new();
+    TEST_ASSERT_NOT_NULL(loop);
+
+    fired_count = 0;
+    uint64_t start = test_now_ms();
+    TEST_ASSERT_NOT_NULL(cwh_loop_timer_add(loop, 60, record_timer, (void *)(intptr_t)1));
+    TEST_ASSERT_NOT_NULL(cwh_loop_timer_add(loop, 20, record_timer, (void *)(intptr_t)2));
+    TEST_ASSERT_NOT_NULL(cwh_loop_timer_add(loop, 40, record_timer, (void *)(intptr_t)3));
+
+    // No fds registered: run_once must sleep until the next timer, not forever
+    while (fired_count < 3 && test_now_ms() - start < 2000)
+        cwh_loop_run_once(loop, -1);
+
+    TEST_ASSERT_EQUAL(3, fired_count);
+    TEST_ASSERT_EQUAL(2, fired_ids[0]);
+    TEST_ASSERT_EQUAL(3, fired_ids[1]);
+    TEST_ASSERT_EQUAL(1, fired_ids[2]);
+    TEST_ASSERT_TRUE(test_now_ms() - start >= 60);
+
+    cwh_loop_free(loop); // Frees the fired timers
+}
+
+// Test 8: Cancel and reset
+void test_timer_cancel_reset(void)
+{
+    cwh_loop_t *loop = cwh_loop_new();
+    TEST_ASSERT_NOT_NULL(loop);
+
+    fired_count = 0;
+    cwh_timer_t *cancelled = cwh_loop_timer_add(loop, 10, record_timer, (void *)(intptr_t)1);
+    cwh_timer_t *pushed = cwh_loop_timer_add(loop, 10, record_timer, (void *)(intptr_t)2);
+    cwh_timer_t *long_timer = cwh_loop_timer_add(loop, 100000, record_timer, (void *)(intptr_t)3);
+    TEST_ASSERT_NOT_NULL(cancelled);
+    TEST_ASSERT_NOT_NULL(pushed);
+    TEST_ASSERT_NOT_NULL(long_timer);
+
+    cwh_loop_timer_cancel(loop, cancelled);
+    TEST_ASSERT_EQUAL(0, cwh_loop_timer_reset(loop, pushed, 80));
+
+    uint64_t start = test_now_ms();
+    while (test_now_ms() - start < 40)
+        cwh_loop_run_once(loop, 10);
+    TEST_ASSERT_EQUAL(0, fired_count);
+
+    while (fired_count < 1 && test_now_ms() - start < 2000)
+        cwh_loop_run_once(loop, -1);
+    TEST_ASSERT_EQUAL(1, fired_count);
+    TEST_ASSERT_EQUAL(2, fired_ids[0]);
+
+    // Fired timers can be re-armed
+    TEST_ASSERT_EQUAL(0, cwh_loop_timer_reset(loop, pushed, 0));
+    cwh_loop_run_once(loop, 100);
+    TEST_ASSERT_EQUAL(2, fired_count);
+
+    cwh_loop_timer_cancel(loop, pushed);
+    cwh_loop_timer_cancel(loop, long_timer);
+    cwh_loop_free(loop);
+}
+
+// Test 9: cwh_loop_run() wakes up for timers
+void test_timer_loop_run(void)
+{
+    cwh_loop_t *loop = cwh_loop_new();
+    TEST_ASSERT_NOT_NULL(loop);
+
+    fired_count = 0;
+    TEST_ASSERT_NOT_NULL(cwh_loop_timer_add(loop, 30, stop_timer, NULL));
+    TEST_ASSERT_EQUAL(0, cwh_loop_run(loop));
+    TEST_ASSERT_EQUAL(1, fired_count);
+
+    cwh_loop_free(loop);
+}
+
 int main(void)
 {
     UNITY_BEGIN();
@@ -212,12 +436,19 @@ int main(void)
     RUN_TEST(test_loop_create_free);
     RUN_TEST(test_loop_backend);
     RUN_TEST(test_set_nonblocking);
+    RUN_TEST(test_timer_order);
+    RUN_TEST(test_timer_cancel_reset);
+    RUN_TEST(test_timer_loop_run);
 
     // Event tests (Unix only for now)
 #ifndef _WIN32
     RUN_TEST(test_loop_add_del);
     RUN_TEST(test_loop_callback);
     RUN_TEST(test_loop_modify);
+#ifdef __linux__
+    RUN_TEST(test_loop_io_uring);
+    RUN_TEST(test_loop_edge_triggered);
+#endif
 #else
     printf("\nNote: Event tests skipped on Windows (epoll not available)\n");
 #endif
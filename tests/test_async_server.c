@@ -0,0 +1,1357 @@
+// test_async_server.c - Async server tests
+// Spins up the async server on localhost and talks to it over real sockets
+
+#include "cwebhttp_async.h"
+#include "unity.h"
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#ifndef _WIN32
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#endif
+
+#define TEST_PORT 18471
+
+void setUp(void)
+{
+}
+
+void tearDown(void)
+{
+}
+
+#ifndef _WIN32
+static void hello_handler(cwh_async_conn_t *conn, cwh_request_t *req, void *data)
+{
+    (void)req;
+    (void)data;
+    cwh_async_send_response(conn, 200, "text/plain", "hello", 5);
+}
+
+#define BIG_BODY_SIZE (200 * 1024)
+static char big_body[BIG_BODY_SIZE];
+
+static void big_handler(cwh_async_conn_t *conn, cwh_request_t *req, void *data)
+{
+    (void)data;
+    const char *big = cwh_get_header(req, "X-Big");
+    if (!big || strncmp(big, "xxxx", 4) != 0)
+    {
+        cwh_async_send_status(conn, 400, "Bad Request");
+        return;
+    }
+    cwh_async_send_response(conn, 200, "application/octet-stream", big_body, sizeof(big_body));
+}
+
+#define FILE_SIZE (3 * 1024 * 1024 + 123)
+static char file_path[64];
+
+static void file_handler(cwh_async_conn_t *conn, cwh_request_t *req, void *data)
+{
+    (void)data;
+    cwh_async_send_file(conn, file_path, cwh_get_header(req, "Range"));
+}
+
+static void missing_file_handler(cwh_async_conn_t *conn, cwh_request_t *req, void *data)
+{
+    (void)req;
+    (void)data;
+    cwh_async_send_file(conn, "/nonexistent/cwebhttp-test-file", NULL);
+}
+
+// Echo the request body back
+static void echo_handler(cwh_async_conn_t *conn, cwh_request_t *req, void *data)
+{
+    (void)data;
+    cwh_async_send_response(conn, 200, "text/plain", req->body ? req->body : "", req->body_len);
+}
+
+// Body from caller-owned buffers (not copied by the server)
+#define IOV_PART_SIZE (256 * 1024)
+static char iov_part[IOV_PART_SIZE];
+static int iov_released;
+
+static void iov_release(void *ctx)
+{
+    __atomic_add_fetch((int *)ctx, 1, __ATOMIC_SEQ_CST);
+}
+
+static void iov_handler(cwh_async_conn_t *conn, cwh_request_t *req, void *data)
+{
+    (void)req;
+    (void)data;
+    cwh_iovec_t body[] = {{"head-", 5}, {"", 0}, {iov_part, sizeof(iov_part)}, {"-tail", 5}};
+    cwh_async_send_iov(conn, 200, "Content-Type: application/octet-stream\r\n",
+                       body, 4, iov_release, &iov_released);
+}
+
+// Echo the request body without copying it (the buffers point into the request)
+static void echo_iov_handler(cwh_async_conn_t *conn, cwh_request_t *req, void *data)
+{
+    (void)data;
+    cwh_iovec_t body[] = {{req->body, req->body_len}};
+    cwh_async_send_iov(conn, 200, NULL, body, 1, NULL, NULL);
+}
+
+// Streamed body produced in pieces, pausing at the high watermark
+#define STREAM_TOTAL (2 * 1024 * 1024)
+#define STREAM_PIECE (8 * 1024)
+
+typedef struct
+{
+    size_t sent;
+    int drains;
+    int closed;
+} stream_state_t;
+
+static stream_state_t stream_state;
+
+static unsigned char stream_byte(size_t offset)
+{
+    return (unsigned char)(offset % 251);
+}
+
+static void stream_pump(cwh_async_conn_t *conn, stream_state_t *st)
+{
+    unsigned char piece[STREAM_PIECE];
+    while (st->sent < STREAM_TOTAL)
+    {
+        for (size_t i = 0; i < sizeof(piece); i++)
+            piece[i] = stream_byte(st->sent + i);
+        st->sent += sizeof(piece);
+        int ret = cwh_async_stream_write(conn, piece, sizeof(piece));
+        if (ret < 0)
+            return;
+        if (ret == 1)
+            return; // Resume on CWH_STREAM_DRAIN
+    }
+    cwh_async_stream_end(conn);
+}
+
+static void stream_event(cwh_async_conn_t *conn, cwh_stream_event_t event, void *ctx)
+{
+    stream_state_t *st = (stream_state_t *)ctx;
+    if (event == CWH_STREAM_CLOSED)
+    {
+        st->closed++;
+        return;
+    }
+    st->drains++;
+    stream_pump(conn, st);
+}
+
+static void stream_handler(cwh_async_conn_t *conn, cwh_request_t *req, void *data)
+{
+    (void)req;
+    (void)data;
+    stream_state.sent = 0;
+    cwh_async_stream_begin(conn, 200, "Content-Type: application/octet-stream\r\n");
+    cwh_async_stream_set_watermarks(conn, 16 * 1024, 64 * 1024, stream_event, &stream_state);
+    stream_pump(conn, &stream_state);
+}
+
+#define UPLOAD_PAUSE_EVERY (1024 * 1024)
+
+typedef struct
+{
+    size_t received;
+    size_t next_pause;
+    int pauses;
+    int mismatches;
+    int ended;
+    int aborted;
+    cwh_async_conn_t *conn;
+    cwh_timer_t *resume_timer;
+} upload_state_t;
+
+static upload_state_t upload_state;
+
+static void upload_resume(cwh_loop_t *loop, cwh_timer_t *timer, void *data)
+{
+    (void)loop;
+    (void)timer;
+    upload_state_t *st = (upload_state_t *)data;
+    st->resume_timer = NULL;
+    cwh_async_body_resume(st->conn);
+}
+
+static void upload_headers(cwh_async_conn_t *conn, cwh_request_t *req, void *data)
+{
+    (void)req;
+    upload_state_t *st = (upload_state_t *)data;
+    st->received = 0;
+    st->next_pause = UPLOAD_PAUSE_EVERY;
+    if (strcmp(req->path, "/upload/reject") == 0)
+        cwh_async_send_status(conn, 413, "Payload Too Large");
+}
+
+// Checks the body pattern; pauses reading for a moment every megabyte
+static void upload_body(cwh_async_conn_t *conn, cwh_body_event_t event,
+                        const char *data, size_t len, void *ctx)
+{
+    upload_state_t *st = (upload_state_t *)ctx;
+    if (event != CWH_BODY_DATA && st->resume_timer)
+    {
+        cwh_loop_timer_cancel(cwh_async_conn_loop(conn), st->resume_timer);
+        st->resume_timer = NULL;
+    }
+    if (event == CWH_BODY_ABORTED)
+    {
+        st->aborted++;
+        return;
+    }
+    if (event == CWH_BODY_END)
+    {
+        char reply[64];
+        snprintf(reply, sizeof(reply), "%zu", st->received);
+        st->ended++;
+        cwh_async_send_response(conn, 200, "text/plain", reply, strlen(reply));
+        return;
+    }
+
+    for (size_t i = 0; i < len; i++)
+    {
+        if ((unsigned char)data[i] != stream_byte(st->received + i))
+            st->mismatches++;
+    }
+    st->received += len;
+    if (st->received >= st->next_pause)
+    {
+        st->next_pause += UPLOAD_PAUSE_EVERY;
+        st->pauses++;
+        cwh_async_body_pause(conn);
+        st->conn = conn;
+        st->resume_timer = cwh_loop_timer_add(cwh_async_conn_loop(conn), 20, upload_resume, st);
+    }
+}
+
+static void *server_thread(void *arg)
+{
+    cwh_async_server_run((cwh_async_server_t *)arg);
+    return NULL;
+}
+
+// Connect to the test port (retries while the server thread starts up)
+static int connect_local(int port)
+{
+    for (int attempt = 0; attempt < 50; attempt++)
+    {
+        int fd = socket(AF_INET, SOCK_STREAM, 0);
+        if (fd < 0)
+            return -1;
+
+        struct sockaddr_in addr = {0};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(port);
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+        if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) == 0)
+            return fd;
+
+        close(fd);
+        usleep(20000);
+    }
+    return -1;
+}
+
+// Send raw request bytes and read until the server closes the connection
+static int roundtrip(int port, const char *request, char *out, size_t out_size)
+{
+    int fd = connect_local(port);
+    if (fd < 0)
+        return -1;
+
+    struct timeval tv = {2, 0};
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+
+    if (send(fd, request, strlen(request), 0) < 0)
+    {
+        close(fd);
+        return -1;
+    }
+
+    size_t total = 0;
+    while (total < out_size - 1)
+    {
+        ssize_t n = recv(fd, out + total, out_size - 1 - total, 0);
+        if (n <= 0)
+            break;
+        total += (size_t)n;
+    }
+    out[total] = '\0';
+    close(fd);
+    return (int)total;
+}
+
+// Test 1: Multi-threaded server answers on every shard, and again after
+// stop, listen and run
+void test_multi_server_serves_requests(void)
+{
+    cwh_async_server_t *server = cwh_async_server_new_multi(2);
+    TEST_ASSERT_NOT_NULL(server);
+    TEST_ASSERT_EQUAL(2, cwh_async_server_thread_count(server));
+
+    cwh_async_route(server, "GET", "/", hello_handler, NULL);
+
+    for (int round = 0; round < 2; round++)
+    {
+        TEST_ASSERT_EQUAL(0, cwh_async_listen(server, TEST_PORT));
+
+        pthread_t tid;
+        TEST_ASSERT_EQUAL(0, pthread_create(&tid, NULL, server_thread, server));
+
+        char buf[1024];
+        for (int i = 0; i < 8; i++)
+        {
+            int n = roundtrip(TEST_PORT, "GET / HTTP/1.1\r\nHost: localhost\r\nConnection: close\r\n\r\n", buf, sizeof(buf));
+            TEST_ASSERT_TRUE(n > 0);
+            TEST_ASSERT_NOT_NULL(strstr(buf, "HTTP/1.1 200"));
+            TEST_ASSERT_NOT_NULL(strstr(buf, "hello"));
+        }
+
+        cwh_async_server_stop(server);
+        pthread_join(tid, NULL);
+    }
+
+    cwh_async_server_free(server);
+}
+
+// Test 2: Multi-threaded server can be freed without ever running
+void test_multi_server_free_without_run(void)
+{
+    cwh_async_server_t *server = cwh_async_server_new_multi(3);
+    TEST_ASSERT_NOT_NULL(server);
+    cwh_async_server_set_cpu_pinning(server, true);
+    TEST_ASSERT_EQUAL(0, cwh_async_listen(server, TEST_PORT + 1));
+    cwh_async_server_free(server);
+}
+
+// Wait until the server closes fd; returns elapsed ms, or -1 on timeout
+static int wait_for_close(int fd)
+{
+    struct timeval tv = {3, 0};
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    char buf[1024];
+    ssize_t n;
+    while ((n = recv(fd, buf, sizeof(buf), 0)) > 0)
+        ;
+    if (n < 0)
+        return -1;
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    return (int)((end.tv_sec - start.tv_sec) * 1000 + (end.tv_nsec - start.tv_nsec) / 1000000);
+}
+
+// Test 3: Idle, slow-header and keep-alive connections are reaped by timers
+// even when no new clients connect
+void test_server_timeouts(void)
+{
+    cwh_async_server_t *server = cwh_async_server_new_multi(1);
+    TEST_ASSERT_NOT_NULL(server);
+    cwh_async_server_set_timeouts(server, 200, 300, -1);
+    cwh_async_route(server, "GET", "/", hello_handler, NULL);
+    TEST_ASSERT_EQUAL(0, cwh_async_listen(server, TEST_PORT + 2));
+
+    pthread_t tid;
+    TEST_ASSERT_EQUAL(0, pthread_create(&tid, NULL, server_thread, server));
+
+    // Connected but silent: header timeout
+    int idle_fd = connect_local(TEST_PORT + 2);
+    TEST_ASSERT_TRUE(idle_fd >= 0);
+
+    // Incomplete request headers: header timeout
+    int slow_fd = connect_local(TEST_PORT + 2);
+    TEST_ASSERT_TRUE(slow_fd >= 0);
+    const char *partial = "GET / HTTP/1.";
+    TEST_ASSERT_TRUE(send(slow_fd, partial, strlen(partial), 0) > 0);
+
+    int ms = wait_for_close(idle_fd);
+    TEST_ASSERT_TRUE(ms >= 0 && ms < 1500);
+    ms = wait_for_close(slow_fd);
+    TEST_ASSERT_TRUE(ms >= 0 && ms < 1500);
+    close(idle_fd);
+    close(slow_fd);
+
+    // Keep-alive: response, then closed after the keep-alive timeout
+    int ka_fd = connect_local(TEST_PORT + 2);
+    TEST_ASSERT_TRUE(ka_fd >= 0);
+    const char *req = "GET / HTTP/1.1\r\nHost: localhost\r\nConnection: keep-alive\r\n\r\n";
+    TEST_ASSERT_TRUE(send(ka_fd, req, strlen(req), 0) > 0);
+    ms = wait_for_close(ka_fd);
+    TEST_ASSERT_TRUE(ms >= 250 && ms < 1500);
+    close(ka_fd);
+
+    cwh_async_server_stop(server);
+    pthread_join(tid, NULL);
+    cwh_async_server_free(server);
+}
+
+// Test 4: Large requests/responses are not truncated and idle keep-alive
+// connections give their buffers back to the pool
+void test_server_buffers(void)
+{
+    memset(big_body, 'b', sizeof(big_body));
+
+    cwh_async_server_t *server = cwh_async_server_new_multi(1);
+    TEST_ASSERT_NOT_NULL(server);
+    cwh_async_route(server, "GET", "/big", big_handler, NULL);
+    TEST_ASSERT_EQUAL(0, cwh_async_listen(server, TEST_PORT + 3));
+
+    pthread_t tid;
+    TEST_ASSERT_EQUAL(0, pthread_create(&tid, NULL, server_thread, server));
+
+    int fd = connect_local(TEST_PORT + 3);
+    TEST_ASSERT_TRUE(fd >= 0);
+    struct timeval tv = {3, 0};
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+
+    // 20KB request header (several times the pooled block size)
+    static char request[24 * 1024];
+    int len = snprintf(request, sizeof(request),
+                       "GET /big HTTP/1.1\r\nHost: localhost\r\nConnection: keep-alive\r\nX-Big: ");
+    memset(request + len, 'x', 20 * 1024);
+    len += 20 * 1024;
+    len += snprintf(request + len, sizeof(request) - len, "\r\n\r\n");
+    TEST_ASSERT_EQUAL(len, send(fd, request, len, 0));
+
+    // Read headers + full 200KB body
+    static char response[BIG_BODY_SIZE + 1024];
+    size_t total = 0;
+    char *body = NULL;
+    while (total < sizeof(response) - 1)
+    {
+        ssize_t n = recv(fd, response + total, sizeof(response) - 1 - total, 0);
+        if (n <= 0)
+            break;
+        total += (size_t)n;
+        response[total] = '\0';
+        body = strstr(response, "\r\n\r\n");
+        if (body && total - (size_t)(body + 4 - response) >= BIG_BODY_SIZE)
+            break;
+    }
+    TEST_ASSERT_NOT_NULL(strstr(response, "HTTP/1.1 200"));
+    TEST_ASSERT_NOT_NULL(strstr(response, "Content-Length: 204800"));
+    TEST_ASSERT_NOT_NULL(body);
+    TEST_ASSERT_EQUAL(BIG_BODY_SIZE, total - (size_t)(body + 4 - response));
+
+    // Connection stays open but idle: no buffers attached to it
+    cwh_async_server_stats_t stats;
+    for (int i = 0; i < 100; i++)
+    {
+        cwh_async_server_get_stats(server, &stats);
+        if (stats.buffers_in_use == 0)
+            break;
+        usleep(10000);
+    }
+    TEST_ASSERT_EQUAL(1, stats.connections);
+    TEST_ASSERT_EQUAL(0, stats.buffers_in_use);
+    TEST_ASSERT_TRUE(stats.memory_bytes < 16 * 1024);
+
+    close(fd);
+    cwh_async_server_stop(server);
+    pthread_join(tid, NULL);
+    cwh_async_server_free(server);
+}
+
+// Fetch a response with a known-size body; returns body length or -1
+static long fetch(int port, const char *request, char *out, size_t out_size, char **body_out)
+{
+    int fd = connect_local(port);
+    if (fd < 0)
+        return -1;
+    struct timeval tv = {3, 0};
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    send(fd, request, strlen(request), 0);
+
+    size_t total = 0;
+    ssize_t n;
+    while (total < out_size - 1 && (n = recv(fd, out + total, out_size - 1 - total, 0)) > 0)
+        total += (size_t)n;
+    out[total] = '\0';
+    close(fd);
+
+    char *body = strstr(out, "\r\n\r\n");
+    if (!body)
+        return -1;
+    *body_out = body + 4;
+    return (long)(total - (size_t)(body + 4 - out));
+}
+
+// Test 5: Files (full, ranged, missing) are streamed by cwh_async_send_file
+void test_server_send_file(void)
+{
+    // Deterministic file content: byte i = i % 251
+    snprintf(file_path, sizeof(file_path), "/tmp/cwh_test_file_%d", (int)getpid());
+    FILE *fp = fopen(file_path, "wb");
+    TEST_ASSERT_NOT_NULL(fp);
+    for (long i = 0; i < FILE_SIZE; i++)
+        fputc((int)(i % 251), fp);
+    fclose(fp);
+
+    cwh_async_server_t *server = cwh_async_server_new_multi(1);
+    TEST_ASSERT_NOT_NULL(server);
+    cwh_async_route(server, "GET", "/file", file_handler, NULL);
+    cwh_async_route(server, "GET", "/missing", missing_file_handler, NULL);
+    TEST_ASSERT_EQUAL(0, cwh_async_listen(server, TEST_PORT + 4));
+
+    pthread_t tid;
+    TEST_ASSERT_EQUAL(0, pthread_create(&tid, NULL, server_thread, server));
+
+    static char response[FILE_SIZE + 4096];
+    char *body = NULL;
+
+    // Whole file (larger than any connection buffer)
+    long len = fetch(TEST_PORT + 4, "GET /file HTTP/1.1\r\nHost: localhost\r\nConnection: close\r\n\r\n",
+                     response, sizeof(response), &body);
+    TEST_ASSERT_EQUAL(FILE_SIZE, len);
+    TEST_ASSERT_NOT_NULL(strstr(response, "HTTP/1.1 200"));
+    int mismatches = 0;
+    for (long i = 0; i < len; i++)
+        mismatches += (unsigned char)body[i] != (unsigned char)(i % 251);
+    TEST_ASSERT_EQUAL(0, mismatches);
+
+    // Byte range
+    len = fetch(TEST_PORT + 4, "GET /file HTTP/1.1\r\nHost: localhost\r\nConnection: close\r\nRange: bytes=1000000-1000099\r\n\r\n",
+                response, sizeof(response), &body);
+    TEST_ASSERT_EQUAL(100, len);
+    TEST_ASSERT_NOT_NULL(strstr(response, "HTTP/1.1 206"));
+    TEST_ASSERT_NOT_NULL(strstr(response, "Content-Range: bytes 1000000-1000099/3145851"));
+    TEST_ASSERT_EQUAL((unsigned char)(1000000 % 251), (unsigned char)body[0]);
+    TEST_ASSERT_EQUAL((unsigned char)(1000099 % 251), (unsigned char)body[99]);
+
+    // Missing file
+    len = fetch(TEST_PORT + 4, "GET /missing HTTP/1.1\r\nHost: localhost\r\nConnection: close\r\n\r\n",
+                response, sizeof(response), &body);
+    TEST_ASSERT_NOT_NULL(strstr(response, "HTTP/1.1 404"));
+
+    cwh_async_server_stop(server);
+    pthread_join(tid, NULL);
+    cwh_async_server_free(server);
+    unlink(file_path);
+}
+
+static void write_file(const char *path, const char *content)
+{
+    FILE *fp = fopen(path, "wb");
+    TEST_ASSERT_NOT_NULL(fp);
+    fputs(content, fp);
+    fclose(fp);
+}
+
+// Test 6: File cache reuses fds, answers conditional requests, sees file changes
+void test_server_file_cache(void)
+{
+    snprintf(file_path, sizeof(file_path), "/tmp/cwh_test_cache_%d.txt", (int)getpid());
+    write_file(file_path, "version one");
+    cwh_file_cache_clear();
+
+    cwh_async_server_t *server = cwh_async_server_new_multi(1);
+    TEST_ASSERT_NOT_NULL(server);
+    cwh_async_route(server, "GET", "/file", file_handler, NULL);
+    TEST_ASSERT_EQUAL(0, cwh_async_listen(server, TEST_PORT + 5));
+
+    pthread_t tid;
+    TEST_ASSERT_EQUAL(0, pthread_create(&tid, NULL, server_thread, server));
+
+    char response[2048];
+    char *body = NULL;
+    long len = fetch(TEST_PORT + 5, "GET /file HTTP/1.1\r\nHost: localhost\r\nConnection: close\r\n\r\n",
+                     response, sizeof(response), &body);
+    TEST_ASSERT_EQUAL(11, len);
+    TEST_ASSERT_NOT_NULL(strstr(response, "Content-Type: text/plain"));
+    char *etag = strstr(response, "ETag: ");
+    TEST_ASSERT_NOT_NULL(etag);
+    char etag_value[64];
+    TEST_ASSERT_EQUAL(1, sscanf(etag + 6, "%63[^\r]", etag_value));
+
+    // Second request is a cache hit
+    uint64_t hits_before = 0, misses_before = 0, hits = 0, misses = 0;
+    cwh_file_cache_stats(NULL, &hits_before, &misses_before);
+    len = fetch(TEST_PORT + 5, "GET /file HTTP/1.1\r\nHost: localhost\r\nConnection: close\r\n\r\n",
+                response, sizeof(response), &body);
+    TEST_ASSERT_EQUAL(11, len);
+    cwh_file_cache_stats(NULL, &hits, &misses);
+    TEST_ASSERT_EQUAL(misses_before, misses);
+    TEST_ASSERT_EQUAL(hits_before + 1, hits);
+
+    // Matching validator: 304 without body
+    char request[256];
+    snprintf(request, sizeof(request),
+             "GET /file HTTP/1.1\r\nHost: localhost\r\nConnection: close\r\nIf-None-Match: %s\r\n\r\n", etag_value);
+    len = fetch(TEST_PORT + 5, request, response, sizeof(response), &body);
+    TEST_ASSERT_EQUAL(0, len);
+    TEST_ASSERT_NOT_NULL(strstr(response, "HTTP/1.1 304"));
+
+    // Changed file is picked up and the old validator no longer matches
+    write_file(file_path, "version two!");
+    usleep(1100 * 1000); // Covers both inotify and stat() revalidation
+    len = fetch(TEST_PORT + 5, request, response, sizeof(response), &body);
+    TEST_ASSERT_EQUAL(12, len);
+    TEST_ASSERT_NOT_NULL(strstr(response, "HTTP/1.1 200"));
+    TEST_ASSERT_EQUAL_STRING("version two!", body);
+
+    cwh_async_server_stop(server);
+    pthread_join(tid, NULL);
+    cwh_async_server_free(server);
+    unlink(file_path);
+    cwh_file_cache_clear();
+}
+
+// Test 7: Bodies arriving in pieces are assembled; bad framing is rejected
+void test_server_incremental_body(void)
+{
+    cwh_async_server_t *server = cwh_async_server_new_multi(1);
+    TEST_ASSERT_NOT_NULL(server);
+    cwh_async_route(server, "POST", "/echo", echo_handler, NULL);
+    TEST_ASSERT_EQUAL(0, cwh_async_listen(server, TEST_PORT + 6));
+
+    pthread_t tid;
+    TEST_ASSERT_EQUAL(0, pthread_create(&tid, NULL, server_thread, server));
+
+    // Content-Length body trickled after the headers
+    int fd = connect_local(TEST_PORT + 6);
+    TEST_ASSERT_TRUE(fd >= 0);
+    struct timeval tv = {2, 0};
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    const char *parts[] = {"POST /echo HTTP/1.1\r\nConnection: close\r\nContent-Le", "ngth: 10\r\n\r\n", "01234", "56789"};
+    for (int i = 0; i < 4; i++)
+    {
+        send(fd, parts[i], strlen(parts[i]), 0);
+        usleep(30000);
+    }
+    char response[1024];
+    ssize_t total = 0, n;
+    while ((n = recv(fd, response + total, sizeof(response) - 1 - total, 0)) > 0)
+        total += n;
+    response[total] = '\0';
+    close(fd);
+    TEST_ASSERT_NOT_NULL(strstr(response, "HTTP/1.1 200"));
+    TEST_ASSERT_NOT_NULL(strstr(response, "\r\n\r\n0123456789"));
+
+    // Chunked body
+    TEST_ASSERT_TRUE(roundtrip(TEST_PORT + 6,
+                               "POST /echo HTTP/1.1\r\nConnection: close\r\nTransfer-Encoding: chunked\r\n\r\n"
+                               "3\r\nabc\r\n4\r\ndefg\r\n0\r\n\r\n",
+                               response, sizeof(response)) > 0);
+    TEST_ASSERT_NOT_NULL(strstr(response, "\r\n\r\nabcdefg"));
+
+    // Conflicting framing
+    TEST_ASSERT_TRUE(roundtrip(TEST_PORT + 6,
+                               "POST /echo HTTP/1.1\r\nConnection: close\r\nContent-Length: 3\r\nTransfer-Encoding: chunked\r\n\r\nabc",
+                               response, sizeof(response)) > 0);
+    TEST_ASSERT_NOT_NULL(strstr(response, "HTTP/1.1 400"));
+
+    cwh_async_server_stop(server);
+    pthread_join(tid, NULL);
+    cwh_async_server_free(server);
+}
+
+// Test 8: Pipelined requests are answered back-to-back, in order
+void test_server_pipelining(void)
+{
+    cwh_async_server_t *server = cwh_async_server_new_multi(1);
+    TEST_ASSERT_NOT_NULL(server);
+    cwh_async_route(server, "POST", "/echo", echo_handler, NULL);
+    TEST_ASSERT_EQUAL(0, cwh_async_listen(server, TEST_PORT + 7));
+
+    pthread_t tid;
+    TEST_ASSERT_EQUAL(0, pthread_create(&tid, NULL, server_thread, server));
+
+    // Three requests in one write; HTTP/1.1 stays open until Connection: close
+    char response[2048];
+    TEST_ASSERT_TRUE(roundtrip(TEST_PORT + 7,
+                               "POST /echo HTTP/1.1\r\nContent-Length: 3\r\n\r\none"
+                               "POST /echo HTTP/1.1\r\nContent-Length: 3\r\n\r\ntwo"
+                               "POST /echo HTTP/1.1\r\nConnection: close\r\nContent-Length: 5\r\n\r\nthree",
+                               response, sizeof(response)) > 0);
+    char *one = strstr(response, "\r\n\r\none");
+    char *two = strstr(response, "\r\n\r\ntwo");
+    char *three = strstr(response, "\r\n\r\nthree");
+    TEST_ASSERT_NOT_NULL(one);
+    TEST_ASSERT_NOT_NULL(two);
+    TEST_ASSERT_NOT_NULL(three);
+    TEST_ASSERT_TRUE(one < two && two < three);
+
+    // A request split across writes after a pipelined one
+    int fd = connect_local(TEST_PORT + 7);
+    TEST_ASSERT_TRUE(fd >= 0);
+    struct timeval tv = {2, 0};
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    const char *parts[] = {"POST /echo HTTP/1.1\r\nContent-Length: 2\r\n\r\nabPOST /echo HTTP/1.0\r\nContent-Le",
+                           "ngth: 2\r\n\r\ncd"};
+    for (int i = 0; i < 2; i++)
+    {
+        send(fd, parts[i], strlen(parts[i]), 0);
+        usleep(30000);
+    }
+    ssize_t total = 0, n;
+    while ((n = recv(fd, response + total, sizeof(response) - 1 - total, 0)) > 0)
+        total += n;
+    response[total] = '\0';
+    close(fd);
+    one = strstr(response, "\r\n\r\nab");
+    two = strstr(response, "\r\n\r\ncd");
+    TEST_ASSERT_NOT_NULL(one);
+    TEST_ASSERT_NOT_NULL(two);
+    TEST_ASSERT_TRUE(one < two);
+    TEST_ASSERT_NOT_NULL(strstr(response, "Connection: close")); // HTTP/1.0 without keep-alive
+
+    // Keep-alive request sent together with the client's FIN: answered, then
+    // closed right away rather than after the keep-alive timeout
+    fd = connect_local(TEST_PORT + 7);
+    TEST_ASSERT_TRUE(fd >= 0);
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    const char *last = "POST /echo HTTP/1.1\r\nContent-Length: 4\r\n\r\nlast";
+    send(fd, last, strlen(last), 0);
+    shutdown(fd, SHUT_WR);
+    total = 0;
+    while ((n = recv(fd, response + total, sizeof(response) - 1 - total, 0)) > 0)
+        total += n;
+    response[total] = '\0';
+    TEST_ASSERT_EQUAL(0, n);
+    TEST_ASSERT_NOT_NULL(strstr(response, "\r\n\r\nlast"));
+    close(fd);
+
+    cwh_async_server_stop(server);
+    pthread_join(tid, NULL);
+    cwh_async_server_free(server);
+}
+
+// Test 9: Scatter/gather responses keep caller buffers and release them once
+void test_server_send_iov(void)
+{
+    memset(iov_part, 'v', sizeof(iov_part));
+    iov_released = 0;
+
+    cwh_async_server_t *server = cwh_async_server_new_multi(1);
+    TEST_ASSERT_NOT_NULL(server);
+    cwh_async_route(server, "GET", "/iov", iov_handler, NULL);
+    cwh_async_route(server, "POST", "/echo", echo_iov_handler, NULL);
+    TEST_ASSERT_EQUAL(0, cwh_async_listen(server, TEST_PORT + 8));
+
+    pthread_t tid;
+    TEST_ASSERT_EQUAL(0, pthread_create(&tid, NULL, server_thread, server));
+
+    static char response[IOV_PART_SIZE + 1024];
+    char *body = NULL;
+    long len = fetch(TEST_PORT + 8, "GET /iov HTTP/1.1\r\nHost: localhost\r\nConnection: close\r\n\r\n",
+                     response, sizeof(response), &body);
+    TEST_ASSERT_EQUAL(IOV_PART_SIZE + 10, len);
+    TEST_ASSERT_NOT_NULL(strstr(response, "Content-Type: application/octet-stream"));
+    TEST_ASSERT_EQUAL(0, memcmp(body, "head-", 5));
+    TEST_ASSERT_EQUAL(0, memcmp(body + len - 5, "-tail", 5));
+    TEST_ASSERT_EQUAL(0, memcmp(body + 5, iov_part, IOV_PART_SIZE));
+    TEST_ASSERT_EQUAL(1, __atomic_load_n(&iov_released, __ATOMIC_SEQ_CST));
+
+    // Pipelined requests whose bodies are sent straight from the request buffer:
+    // parsing the next request must not overwrite a body still to be sent
+    char pipelined[2048];
+    TEST_ASSERT_TRUE(roundtrip(TEST_PORT + 8,
+                               "POST /echo HTTP/1.1\r\nContent-Length: 5\r\n\r\nfirst"
+                               "POST /echo HTTP/1.1\r\nContent-Length: 6\r\n\r\nsecond"
+                               "POST /echo HTTP/1.1\r\nConnection: close\r\nContent-Length: 5\r\n\r\nthird",
+                               pipelined, sizeof(pipelined)) > 0);
+    char *first = strstr(pipelined, "\r\n\r\nfirst");
+    char *second = strstr(pipelined, "\r\n\r\nsecond");
+    char *third = strstr(pipelined, "\r\n\r\nthird");
+    TEST_ASSERT_NOT_NULL(first);
+    TEST_ASSERT_NOT_NULL(second);
+    TEST_ASSERT_NOT_NULL(third);
+    TEST_ASSERT_TRUE(first < second && second < third);
+
+    cwh_async_server_stop(server);
+    pthread_join(tid, NULL);
+    cwh_async_server_free(server);
+}
+
+// Decode a chunked body in place; returns decoded length, -1 if malformed
+static long decode_chunked(char *body, size_t len, char **end_out)
+{
+    char *p = body, *end = body + len, *out = body;
+    while (p < end)
+    {
+        char *line_end;
+        unsigned long size = strtoul(p, &line_end, 16);
+        if (line_end + 2 > end || memcmp(line_end, "\r\n", 2) != 0)
+            return -1;
+        p = line_end + 2;
+        if (size == 0)
+        {
+            *end_out = p + 2; // Final CRLF
+            return (long)(out - body);
+        }
+        if (p + size + 2 > end)
+            return -1;
+        memmove(out, p, size);
+        out += size;
+        p += size + 2;
+    }
+    return -1;
+}
+
+// Test 10: Streamed responses are chunked, flow-controlled and keep the connection usable
+void test_server_stream(void)
+{
+    memset(&stream_state, 0, sizeof(stream_state));
+
+    cwh_async_server_t *server = cwh_async_server_new_multi(1);
+    TEST_ASSERT_NOT_NULL(server);
+    cwh_async_route(server, "GET", "/stream", stream_handler, NULL);
+    cwh_async_route(server, "GET", "/", hello_handler, NULL);
+    TEST_ASSERT_EQUAL(0, cwh_async_listen(server, TEST_PORT + 9));
+
+    pthread_t tid;
+    TEST_ASSERT_EQUAL(0, pthread_create(&tid, NULL, server_thread, server));
+
+    // Stream followed by a pipelined request on the same connection
+    static char response[STREAM_TOTAL + 64 * 1024];
+    char *body = NULL;
+    long len = fetch(TEST_PORT + 9,
+                     "GET /stream HTTP/1.1\r\nHost: localhost\r\n\r\n"
+                     "GET / HTTP/1.1\r\nHost: localhost\r\nConnection: close\r\n\r\n",
+                     response, sizeof(response), &body);
+    TEST_ASSERT_TRUE(len > STREAM_TOTAL);
+    TEST_ASSERT_NOT_NULL(strstr(response, "Transfer-Encoding: chunked"));
+    char *next = NULL;
+    long body_len = decode_chunked(body, (size_t)len, &next);
+    TEST_ASSERT_EQUAL(STREAM_TOTAL, body_len);
+    for (long i = 0; i < body_len; i++)
+    {
+        if ((unsigned char)body[i] != stream_byte((size_t)i))
+            TEST_FAIL_MESSAGE("stream body mismatch");
+    }
+    TEST_ASSERT_EQUAL(0, strncmp(next, "HTTP/1.1 200", 12));
+    TEST_ASSERT_NOT_NULL(strstr(next, "\r\n\r\nhello"));
+    TEST_ASSERT_TRUE(stream_state.drains > 0); // Producer was paused and resumed
+
+    // HTTP/1.0: no chunked framing, body ends at close
+    len = fetch(TEST_PORT + 9, "GET /stream HTTP/1.0\r\n\r\n", response, sizeof(response), &body);
+    TEST_ASSERT_EQUAL(STREAM_TOTAL, len);
+    TEST_ASSERT_NULL(strstr(response, "Transfer-Encoding"));
+    TEST_ASSERT_NOT_NULL(strstr(response, "Connection: close"));
+    TEST_ASSERT_EQUAL(0, stream_state.closed);
+
+    cwh_async_server_stop(server);
+    pthread_join(tid, NULL);
+    cwh_async_server_free(server);
+}
+
+// Send all bytes (blocking socket)
+static int send_all(int fd, const char *data, size_t len)
+{
+    while (len > 0)
+    {
+        ssize_t n = send(fd, data, len, 0);
+        if (n <= 0)
+            return -1;
+        data += n;
+        len -= (size_t)n;
+    }
+    return 0;
+}
+
+// Read until the server closes the connection
+static size_t recv_all(int fd, char *out, size_t out_size)
+{
+    size_t total = 0;
+    ssize_t n;
+    while (total < out_size - 1 && (n = recv(fd, out + total, out_size - 1 - total, 0)) > 0)
+        total += (size_t)n;
+    out[total] = '\0';
+    return total;
+}
+
+// Test 11: Request bodies larger than the request limit are streamed to on_body
+void test_server_stream_upload(void)
+{
+    memset(&upload_state, 0, sizeof(upload_state));
+
+    cwh_async_server_t *server = cwh_async_server_new_multi(1);
+    TEST_ASSERT_NOT_NULL(server);
+    cwh_async_route_body(server, "POST", "/upload/*", upload_headers, upload_body, &upload_state);
+    cwh_async_route(server, "GET", "/", hello_handler, NULL);
+    TEST_ASSERT_EQUAL(0, cwh_async_listen(server, TEST_PORT + 10));
+
+    pthread_t tid;
+    TEST_ASSERT_EQUAL(0, pthread_create(&tid, NULL, server_thread, server));
+
+    static char piece[64 * 1024];
+    char head[256];
+    char response[1024];
+    const size_t total = 4 * 1024 * 1024;
+
+    // Content-Length body, four times CWH_MAX_REQUEST_SIZE
+    int fd = connect_local(TEST_PORT + 10);
+    TEST_ASSERT_TRUE(fd >= 0);
+    struct timeval tv = {5, 0};
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    int n = snprintf(head, sizeof(head),
+                     "POST /upload/a HTTP/1.1\r\nConnection: close\r\nContent-Length: %zu\r\n\r\n", total);
+    TEST_ASSERT_EQUAL(0, send_all(fd, head, (size_t)n));
+    for (size_t off = 0; off < total; off += sizeof(piece))
+    {
+        for (size_t i = 0; i < sizeof(piece); i++)
+            piece[i] = (char)stream_byte(off + i);
+        TEST_ASSERT_EQUAL(0, send_all(fd, piece, sizeof(piece)));
+    }
+    recv_all(fd, response, sizeof(response));
+    close(fd);
+    TEST_ASSERT_NOT_NULL(strstr(response, "HTTP/1.1 200"));
+    TEST_ASSERT_NOT_NULL(strstr(response, "\r\n\r\n4194304"));
+    TEST_ASSERT_EQUAL(0, upload_state.mismatches);
+    TEST_ASSERT_EQUAL(4, upload_state.pauses);
+
+    // Chunked body followed by a pipelined request on the same connection
+    const size_t chunked_total = 2 * 1024 * 1024;
+    fd = connect_local(TEST_PORT + 10);
+    TEST_ASSERT_TRUE(fd >= 0);
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    const char *chunked_head = "POST /upload/b HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n";
+    TEST_ASSERT_EQUAL(0, send_all(fd, chunked_head, strlen(chunked_head)));
+    for (size_t off = 0; off < chunked_total; off += 32 * 1024)
+    {
+        for (size_t i = 0; i < 32 * 1024; i++)
+            piece[i] = (char)stream_byte(off + i);
+        n = snprintf(head, sizeof(head), "%x\r\n", 32 * 1024);
+        TEST_ASSERT_EQUAL(0, send_all(fd, head, (size_t)n));
+        TEST_ASSERT_EQUAL(0, send_all(fd, piece, 32 * 1024));
+        TEST_ASSERT_EQUAL(0, send_all(fd, "\r\n", 2));
+    }
+    const char *tail = "0\r\n\r\nGET / HTTP/1.1\r\nConnection: close\r\n\r\n";
+    TEST_ASSERT_EQUAL(0, send_all(fd, tail, strlen(tail)));
+    recv_all(fd, response, sizeof(response));
+    close(fd);
+    char *second = strstr(response, "\r\n\r\n2097152");
+    TEST_ASSERT_NOT_NULL(second);
+    TEST_ASSERT_NOT_NULL(strstr(second, "\r\n\r\nhello"));
+    TEST_ASSERT_EQUAL(0, upload_state.mismatches);
+    TEST_ASSERT_EQUAL(2, upload_state.ended);
+    TEST_ASSERT_EQUAL(0, upload_state.aborted);
+
+    // Early reply: the rest of the body is not read, the connection closes
+    fd = connect_local(TEST_PORT + 10);
+    TEST_ASSERT_TRUE(fd >= 0);
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    const char *reject = "POST /upload/reject HTTP/1.1\r\nContent-Length: 100000000\r\n\r\nxyz";
+    TEST_ASSERT_EQUAL(0, send_all(fd, reject, strlen(reject)));
+    recv_all(fd, response, sizeof(response));
+    close(fd);
+    TEST_ASSERT_NOT_NULL(strstr(response, "HTTP/1.1 413"));
+    TEST_ASSERT_NOT_NULL(strstr(response, "Connection: close"));
+
+    cwh_async_server_stop(server);
+    pthread_join(tid, NULL);
+    cwh_async_server_free(server);
+    TEST_ASSERT_EQUAL(1, upload_state.aborted);
+}
+
+// Test 12: Async client pool caps connections per host, queues the rest,
+// reuses warm sockets and skips ones the server has closed
+typedef struct
+{
+    int done;
+    int ok;
+} client_count_t;
+
+static void count_response(cwh_response_t *res, cwh_error_t err, void *data)
+{
+    client_count_t *count = (client_count_t *)data;
+    count->done++;
+    if (err == CWH_OK && res && res->status == 200 && res->body_len == 5 &&
+        memcmp(res->body, "hello", 5) == 0)
+        count->ok++;
+}
+
+static void run_client(cwh_loop_t *loop, client_count_t *count, int want)
+{
+    for (int i = 0; i < 300 && count->done < want; i++)
+        cwh_loop_run_once(loop, 10);
+}
+
+void test_client_pool(void)
+{
+    cwh_async_server_t *server = cwh_async_server_new_multi(1);
+    TEST_ASSERT_NOT_NULL(server);
+    cwh_async_server_set_timeouts(server, 2000, 300, -1);
+    cwh_async_route(server, "GET", "/", hello_handler, NULL);
+    TEST_ASSERT_EQUAL(0, cwh_async_listen(server, TEST_PORT + 11));
+
+    pthread_t tid;
+    TEST_ASSERT_EQUAL(0, pthread_create(&tid, NULL, server_thread, server));
+    int probe = connect_local(TEST_PORT + 11);
+    TEST_ASSERT_TRUE(probe >= 0);
+    close(probe);
+
+    cwh_loop_t *loop = cwh_loop_new();
+    TEST_ASSERT_NOT_NULL(loop);
+    cwh_async_pool_set_host_limit(2);
+
+    char url[64];
+    snprintf(url, sizeof(url), "http://127.0.0.1:%d/", TEST_PORT + 11);
+
+    client_count_t count = {0, 0};
+    for (int i = 0; i < 5; i++)
+        cwh_async_get(loop, url, count_response, &count);
+
+    int active, idle, waiting;
+    cwh_async_pool_host_stats("127.0.0.1", TEST_PORT + 11, &active, &idle, &waiting);
+    TEST_ASSERT_EQUAL(2, active);
+    TEST_ASSERT_EQUAL(3, waiting);
+
+    run_client(loop, &count, 5);
+    TEST_ASSERT_EQUAL(5, count.done);
+    TEST_ASSERT_EQUAL(5, count.ok);
+
+    cwh_async_pool_host_stats("127.0.0.1", TEST_PORT + 11, &active, &idle, &waiting);
+    TEST_ASSERT_EQUAL(0, active);
+    TEST_ASSERT_EQUAL(0, waiting);
+    TEST_ASSERT_TRUE(idle >= 1 && idle <= 2);
+
+    cwh_async_server_stats_t stats;
+    cwh_async_server_get_stats(server, &stats);
+    TEST_ASSERT_EQUAL(2, (int)stats.total_connections - 1); // Minus the probe
+
+    // Warm socket: no new connection
+    cwh_async_get(loop, url, count_response, &count);
+    run_client(loop, &count, 6);
+    TEST_ASSERT_EQUAL(6, count.ok);
+    cwh_async_server_get_stats(server, &stats);
+    TEST_ASSERT_EQUAL(3, (int)stats.total_connections);
+
+    // Server closes idle keep-alive sockets: checkout notices and reconnects
+    usleep(600 * 1000);
+    cwh_async_get(loop, url, count_response, &count);
+    run_client(loop, &count, 7);
+    TEST_ASSERT_EQUAL(7, count.ok);
+    cwh_async_server_get_stats(server, &stats);
+    TEST_ASSERT_EQUAL(4, (int)stats.total_connections);
+
+    cwh_async_pool_shutdown();
+    cwh_async_pool_set_host_limit(32);
+    int total;
+    cwh_async_pool_stats(&active, &total);
+    TEST_ASSERT_EQUAL(0, total);
+    cwh_loop_free(loop);
+
+    cwh_async_server_stop(server);
+    pthread_join(tid, NULL);
+    cwh_async_server_free(server);
+}
+
+// Test 13: Async client reads responses far larger than one recv, buffered
+// or streamed piece by piece to a body callback
+typedef struct
+{
+    int done;
+    cwh_error_t err;
+    int status;
+    size_t body_len;
+    size_t streamed;
+    size_t abort_at; // Abort once this much has streamed (0 = never)
+    int pieces;
+    int mismatches;
+} download_t;
+
+static void download_done(cwh_response_t *res, cwh_error_t err, void *data)
+{
+    download_t *dl = (download_t *)data;
+    dl->done++;
+    dl->err = err;
+    if (!res)
+        return;
+    dl->status = res->status;
+    dl->body_len = res->body_len;
+    for (size_t i = 0; i < res->body_len; i++)
+    {
+        if ((unsigned char)res->body[i] != stream_byte(i))
+            dl->mismatches++;
+    }
+}
+
+static int download_data(const cwh_response_t *res, const char *chunk, size_t len, void *data)
+{
+    download_t *dl = (download_t *)data;
+    if (res->status != 200)
+        dl->mismatches++;
+    for (size_t i = 0; i < len; i++)
+    {
+        if ((unsigned char)chunk[i] != stream_byte(dl->streamed + i))
+            dl->mismatches++;
+    }
+    dl->streamed += len;
+    dl->pieces++;
+    return dl->abort_at && dl->streamed >= dl->abort_at ? 1 : 0;
+}
+
+static void run_download(cwh_loop_t *loop, download_t *dl)
+{
+    for (int i = 0; i < 1000 && dl->done == 0; i++)
+        cwh_loop_run_once(loop, 10);
+}
+
+void test_client_large_response(void)
+{
+    cwh_async_server_t *server = cwh_async_server_new_multi(1);
+    TEST_ASSERT_NOT_NULL(server);
+    cwh_async_route(server, "GET", "/stream", stream_handler, NULL);
+    TEST_ASSERT_EQUAL(0, cwh_async_listen(server, TEST_PORT + 12));
+
+    pthread_t tid;
+    TEST_ASSERT_EQUAL(0, pthread_create(&tid, NULL, server_thread, server));
+    int probe = connect_local(TEST_PORT + 12);
+    TEST_ASSERT_TRUE(probe >= 0);
+    close(probe);
+
+    cwh_loop_t *loop = cwh_loop_new();
+    TEST_ASSERT_NOT_NULL(loop);
+    char url[64];
+    snprintf(url, sizeof(url), "http://127.0.0.1:%d/stream", TEST_PORT + 12);
+
+    // Buffered: the whole chunked body, decoded
+    download_t dl = {0};
+    cwh_async_get(loop, url, download_done, &dl);
+    run_download(loop, &dl);
+    TEST_ASSERT_EQUAL(1, dl.done);
+    TEST_ASSERT_EQUAL(CWH_OK, dl.err);
+    TEST_ASSERT_EQUAL(200, dl.status);
+    TEST_ASSERT_EQUAL(STREAM_TOTAL, dl.body_len);
+    TEST_ASSERT_EQUAL(0, dl.mismatches);
+
+    // Streamed: many pieces, empty body in the final callback, socket reused
+    memset(&dl, 0, sizeof(dl));
+    cwh_async_request_stream(loop, CWH_METHOD_GET, url, NULL, NULL, 0, download_data, download_done, &dl);
+    run_download(loop, &dl);
+    TEST_ASSERT_EQUAL(CWH_OK, dl.err);
+    TEST_ASSERT_EQUAL(0, dl.body_len);
+    TEST_ASSERT_EQUAL(STREAM_TOTAL, dl.streamed);
+    TEST_ASSERT_TRUE(dl.pieces > 1);
+    TEST_ASSERT_EQUAL(0, dl.mismatches);
+
+    cwh_async_server_stats_t stats;
+    cwh_async_server_get_stats(server, &stats);
+    TEST_ASSERT_EQUAL(2, (int)stats.total_connections); // Probe + one pooled socket
+
+    // Aborting from the body callback fails the request
+    memset(&dl, 0, sizeof(dl));
+    dl.abort_at = STREAM_TOTAL / 2;
+    cwh_async_request_stream(loop, CWH_METHOD_GET, url, NULL, NULL, 0, download_data, download_done, &dl);
+    run_download(loop, &dl);
+    TEST_ASSERT_EQUAL(1, dl.done);
+    TEST_ASSERT_EQUAL(CWH_ERR_NET, dl.err);
+    TEST_ASSERT_TRUE(dl.streamed < STREAM_TOTAL);
+
+    cwh_async_pool_shutdown();
+    cwh_loop_free(loop);
+
+    cwh_async_server_stop(server);
+    pthread_join(tid, NULL);
+    cwh_async_server_free(server);
+}
+
+// Test 14: Edge-triggered connections (opt-in) serve pipelined requests
+// and responses that fill the socket
+void test_server_edge_triggered(void)
+{
+    memset(big_body, 'b', sizeof(big_body));
+
+    cwh_async_server_t *server = cwh_async_server_new_multi(1);
+    TEST_ASSERT_NOT_NULL(server);
+    cwh_async_server_set_edge_triggered(server, true);
+    cwh_async_route(server, "POST", "/echo", echo_handler, NULL);
+    cwh_async_route(server, "GET", "/big", big_handler, NULL);
+    TEST_ASSERT_EQUAL(0, cwh_async_listen(server, TEST_PORT + 13));
+
+    pthread_t tid;
+    TEST_ASSERT_EQUAL(0, pthread_create(&tid, NULL, server_thread, server));
+
+    char response[2048];
+    TEST_ASSERT_TRUE(roundtrip(TEST_PORT + 13,
+                               "POST /echo HTTP/1.1\r\nContent-Length: 3\r\n\r\none"
+                               "POST /echo HTTP/1.1\r\nConnection: close\r\nContent-Length: 3\r\n\r\ntwo",
+                               response, sizeof(response)) > 0);
+    char *one = strstr(response, "\r\n\r\none");
+    char *two = strstr(response, "\r\n\r\ntwo");
+    TEST_ASSERT_NOT_NULL(one);
+    TEST_ASSERT_NOT_NULL(two);
+    TEST_ASSERT_TRUE(one < two);
+
+    static char big[BIG_BODY_SIZE + 1024];
+    char *body = NULL;
+    long len = fetch(TEST_PORT + 13, "GET /big HTTP/1.1\r\nX-Big: xxxx\r\nConnection: close\r\n\r\n",
+                     big, sizeof(big), &body);
+    TEST_ASSERT_EQUAL(BIG_BODY_SIZE, len);
+    TEST_ASSERT_EQUAL_MEMORY(big_body, body, BIG_BODY_SIZE);
+
+    cwh_async_server_stop(server);
+    pthread_join(tid, NULL);
+    cwh_async_server_free(server);
+}
+
+// Test 15: Route registration reports bad methods and patterns; a NULL
+// method matches any method
+void test_server_route_registration(void)
+{
+    cwh_async_server_t *server = cwh_async_server_new_multi(1);
+    TEST_ASSERT_NOT_NULL(server);
+    TEST_ASSERT_EQUAL(0, cwh_async_route(server, "GET", "/users/:id", hello_handler, NULL));
+    TEST_ASSERT_EQUAL(-1, cwh_async_route(server, "GET", "/users/:name", hello_handler, NULL));
+    TEST_ASSERT_EQUAL(-1, cwh_async_route(server, "BREW", "/pot", hello_handler, NULL));
+    TEST_ASSERT_EQUAL(-1, cwh_async_route(server, "GET", "/", NULL, NULL));
+    TEST_ASSERT_EQUAL(0, cwh_async_route(server, NULL, "/any", hello_handler, NULL));
+    TEST_ASSERT_EQUAL(0, cwh_async_listen(server, TEST_PORT + 15));
+
+    pthread_t tid;
+    TEST_ASSERT_EQUAL(0, pthread_create(&tid, NULL, server_thread, server));
+
+    char out[1024];
+    TEST_ASSERT_TRUE(roundtrip(TEST_PORT + 15, "POST /any HTTP/1.1\r\nContent-Length: 0\r\nConnection: close\r\n\r\n",
+                               out, sizeof(out)) > 0);
+    TEST_ASSERT_NOT_NULL(strstr(out, "200 OK"));
+
+    // Method routes only answer their method (and GET routes HEAD)
+    TEST_ASSERT_TRUE(roundtrip(TEST_PORT + 15, "HEAD /users/7 HTTP/1.1\r\nConnection: close\r\n\r\n", out, sizeof(out)) > 0);
+    TEST_ASSERT_NOT_NULL(strstr(out, "200 OK"));
+    TEST_ASSERT_TRUE(roundtrip(TEST_PORT + 15, "DELETE /users/7 HTTP/1.1\r\nConnection: close\r\n\r\n", out, sizeof(out)) > 0);
+    TEST_ASSERT_NOT_NULL(strstr(out, "404"));
+
+    cwh_async_server_stop(server);
+    pthread_join(tid, NULL);
+    cwh_async_server_free(server);
+}
+
+// Client side of test_server_io_uring (blocking sockets, own thread)
+typedef struct
+{
+    int port;
+    char pipelined[2048];
+    int pipelined_len;
+    char *big;
+    long big_len;
+    char *big_body;
+    char *file;
+    long file_len;
+    char *file_body;
+    int done;
+} uring_client_t;
+
+static void *uring_client_thread(void *arg)
+{
+    uring_client_t *c = (uring_client_t *)arg;
+    c->pipelined_len = roundtrip(c->port,
+                                 "POST /echo HTTP/1.1\r\nContent-Length: 3\r\n\r\none"
+                                 "POST /echo HTTP/1.1\r\nContent-Length: 3\r\n\r\ntwo"
+                                 "POST /echo HTTP/1.1\r\nConnection: close\r\nContent-Length: 5\r\n\r\nthree",
+                                 c->pipelined, sizeof(c->pipelined));
+    c->big_len = fetch(c->port, "GET /big HTTP/1.1\r\nX-Big: xxxx\r\nConnection: close\r\n\r\n",
+                       c->big, BIG_BODY_SIZE + 1024, &c->big_body);
+    c->file_len = fetch(c->port, "GET /file HTTP/1.1\r\nConnection: close\r\n\r\n",
+                        c->file, FILE_SIZE + 4096, &c->file_body);
+    __atomic_store_n(&c->done, 1, __ATOMIC_RELEASE);
+    return NULL;
+}
+
+// Test 16: On io_uring the loop does the connections' recv/send
+// (CWH_EVENT_COMPLETION); responses queued when a connection closes still go out
+// Runs last: closing a ring makes the next blocking call with a timeout on
+// the loop's thread fail once with EINTR
+void test_server_io_uring(void)
+{
+    cwh_loop_t *loop = cwh_loop_new_backend(CWH_BACKEND_IO_URING);
+    TEST_ASSERT_NOT_NULL(loop);
+    if (!(cwh_loop_flags(loop) & CWH_EVENT_COMPLETION))
+    {
+        cwh_loop_free(loop);
+        TEST_IGNORE_MESSAGE("io_uring completion I/O not available");
+    }
+
+    memset(big_body, 'b', sizeof(big_body));
+    snprintf(file_path, sizeof(file_path), "/tmp/cwh_test_uring_%d", (int)getpid());
+    FILE *fp = fopen(file_path, "wb");
+    TEST_ASSERT_NOT_NULL(fp);
+    for (long i = 0; i < FILE_SIZE; i++)
+        fputc((int)(i % 251), fp);
+    fclose(fp);
+
+    cwh_async_server_t *server = cwh_async_server_new(loop);
+    TEST_ASSERT_NOT_NULL(server);
+    cwh_async_route(server, "POST", "/echo", echo_handler, NULL);
+    cwh_async_route(server, "GET", "/big", big_handler, NULL);
+    cwh_async_route(server, "GET", "/file", file_handler, NULL);
+    TEST_ASSERT_EQUAL(0, cwh_async_listen(server, TEST_PORT + 14));
+
+    static char big[BIG_BODY_SIZE + 1024];
+    static char file[FILE_SIZE + 4096];
+    static uring_client_t client;
+    memset(&client, 0, sizeof(client));
+    client.port = TEST_PORT + 14;
+    client.big = big;
+    client.file = file;
+
+    pthread_t tid;
+    TEST_ASSERT_EQUAL(0, pthread_create(&tid, NULL, uring_client_thread, &client));
+    while (!__atomic_load_n(&client.done, __ATOMIC_ACQUIRE))
+        cwh_loop_run_once(loop, 10);
+    pthread_join(tid, NULL);
+
+    cwh_async_server_free(server);
+    cwh_loop_free(loop);
+    unlink(file_path);
+
+    TEST_ASSERT_TRUE(client.pipelined_len > 0);
+    char *one = strstr(client.pipelined, "\r\n\r\none");
+    char *two = strstr(client.pipelined, "\r\n\r\ntwo");
+    char *three = strstr(client.pipelined, "\r\n\r\nthree");
+    TEST_ASSERT_NOT_NULL(one);
+    TEST_ASSERT_NOT_NULL(two);
+    TEST_ASSERT_NOT_NULL(three);
+    TEST_ASSERT_TRUE(one < two && two < three);
+
+    TEST_ASSERT_EQUAL(BIG_BODY_SIZE, client.big_len);
+    TEST_ASSERT_EQUAL_MEMORY(big_body, client.big_body, BIG_BODY_SIZE);
+
+    TEST_ASSERT_EQUAL(FILE_SIZE, client.file_len);
+    int mismatches = 0;
+    for (long i = 0; i < client.file_len; i++)
+        mismatches += (unsigned char)client.file_body[i] != (unsigned char)(i % 251);
+    TEST_ASSERT_EQUAL(0, mismatches);
+}
+#endif
+
+int main(void)
+{
+    UNITY_BEGIN();
+
+    printf("\n=== cwebhttp Async Server Tests ===\n\n");
+
+#ifndef _WIN32
+    RUN_TEST(test_multi_server_serves_requests);
+    RUN_TEST(test_multi_server_free_without_run);
+    RUN_TEST(test_server_timeouts);
+    RUN_TEST(test_server_buffers);
+    RUN_TEST(test_server_send_file);
+    RUN_TEST(test_server_file_cache);
+    RUN_TEST(test_server_incremental_body);
+    RUN_TEST(test_server_pipelining);
+    RUN_TEST(test_server_send_iov);
+    RUN_TEST(test_server_stream);
+    RUN_TEST(test_server_stream_upload);
+    RUN_TEST(test_client_pool);
+    RUN_TEST(test_client_large_response);
+    RUN_TEST(test_server_edge_triggered);
+    RUN_TEST(test_server_route_registration);
+    RUN_TEST(test_server_io_uring);
+#else
+    printf("\nNote: Server tests skipped on Windows\n");
+#endif
+
+    return UNITY_END();
+}
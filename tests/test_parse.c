@@ -1,5 +1,6 @@
 #include "unity.h"
 #include "cwebhttp.h"
+#include <stdio.h>
 #include <string.h>
 
 void setUp(void)
@@ -126,6 +127,397 @@ void test_parse_empty_buffer()
     TEST_ASSERT_EQUAL(CWH_ERR_PARSE, cwh_parse_req(buf, 0, &req));
 }
 
+void test_parse_range_header()
+{
+    size_t start = 0, end = 0;
+
+    TEST_ASSERT_EQUAL(1, cwh_parse_range_header("bytes=100-199", 1000, &start, &end));
+    TEST_ASSERT_EQUAL(100, start);
+    TEST_ASSERT_EQUAL(199, end);
+
+    // Open-ended, terminated by CRLF as in a raw request buffer
+    TEST_ASSERT_EQUAL(1, cwh_parse_range_header("bytes=900-\r\n", 1000, &start, &end));
+    TEST_ASSERT_EQUAL(900, start);
+    TEST_ASSERT_EQUAL(999, end);
+
+    // Suffix range and clamping past EOF
+    TEST_ASSERT_EQUAL(1, cwh_parse_range_header("bytes=-10", 1000, &start, &end));
+    TEST_ASSERT_EQUAL(990, start);
+    TEST_ASSERT_EQUAL(999, end);
+    TEST_ASSERT_EQUAL(1, cwh_parse_range_header("bytes=500-5000", 1000, &start, &end));
+    TEST_ASSERT_EQUAL(999, end);
+
+    TEST_ASSERT_EQUAL(0, cwh_parse_range_header("bytes=1000-", 1000, &start, &end));
+    TEST_ASSERT_EQUAL(0, cwh_parse_range_header("items=0-1", 1000, &start, &end));
+    TEST_ASSERT_EQUAL(0, cwh_parse_range_header(NULL, 1000, &start, &end));
+}
+
+void test_parse_too_many_headers()
+{
+    char buf[1024];
+    int len = snprintf(buf, sizeof(buf), "POST / HTTP/1.1\r\n");
+    for (int i = 0; i < 20; i++)
+        len += snprintf(buf + len, sizeof(buf) - len, "X-H%d: %d\r\n", i, i);
+    len += snprintf(buf + len, sizeof(buf) - len, "\r\nbody");
+
+    cwh_request_t req = {0};
+    TEST_ASSERT_EQUAL(CWH_OK, cwh_parse_req(buf, (size_t)len, &req));
+    TEST_ASSERT_EQUAL(16, req.num_headers);
+    TEST_ASSERT_EQUAL(4, req.body_len);
+    TEST_ASSERT_TRUE(str_eq_len(req.body, "body", 4));
+}
+
+// Every scanner implementation must find the same delimiters as the scalar
+// one, including matches straddling 16/32-byte blocks and the buffer tail
+void test_parse_scan_impls()
+{
+    const cwh_scan_impl_t impls[] = {CWH_SCAN_SCALAR, CWH_SCAN_SSE2, CWH_SCAN_AVX2};
+    int tested = 0;
+
+    for (size_t i = 0; i < sizeof(impls) / sizeof(impls[0]); i++)
+    {
+        if (cwh_scan_set_impl(impls[i]) != 0)
+            continue; // Not supported by this CPU
+        tested++;
+
+        for (int pad = 0; pad < 80; pad++)
+        {
+            char buf[512];
+            char value[128];
+            memset(value, 'v', (size_t)pad);
+            value[pad] = '\0';
+            int len = snprintf(buf, sizeof(buf),
+                               "GET /p%s?q=%s HTTP/1.1\r\nX-%s: %s\r\nHost: h\r\n\r\n",
+                               value, value, value, value);
+
+            cwh_request_t req = {0};
+            TEST_ASSERT_EQUAL(CWH_OK, cwh_parse_req(buf, (size_t)len, &req));
+            TEST_ASSERT_EQUAL(2 + pad, (int)strlen(req.path));
+            TEST_ASSERT_TRUE(str_eq_len(req.query, "q=", 2));
+            TEST_ASSERT_EQUAL(2, req.num_headers);
+            TEST_ASSERT_TRUE(str_eq_len(req.headers[1] + pad, "\r\nHost", 6));
+            TEST_ASSERT_TRUE(str_eq_len(req.headers[3], "h\r\n", 3));
+
+            // Header line cut before its CRLF is not returned
+            len = snprintf(buf, sizeof(buf), "GET / HTTP/1.1\r\nX: %s", value);
+            TEST_ASSERT_EQUAL(CWH_OK, cwh_parse_req(buf, (size_t)len, &req));
+            TEST_ASSERT_EQUAL(0, req.num_headers);
+
+            len = snprintf(buf, sizeof(buf), "HTTP/1.1 200 OK%s\r\nA: %s\r\n\r\nbody", value, value);
+            cwh_response_t res = {0};
+            TEST_ASSERT_EQUAL(CWH_OK, cwh_parse_res(buf, (size_t)len, &res));
+            TEST_ASSERT_EQUAL(200, res.status);
+            TEST_ASSERT_EQUAL(1, res.num_headers);
+            TEST_ASSERT_EQUAL(4, (int)res.body_len);
+        }
+    }
+
+    TEST_ASSERT_TRUE(tested >= 1);
+    TEST_ASSERT_EQUAL(0, cwh_scan_set_impl(CWH_SCAN_AUTO));
+}
+
+// Feed req one byte at a time; returns final status, counts HEADERS_DONE
+static cwh_parse_status_t feed_bytewise(char *buf, const char *req_text, size_t len,
+                                        cwh_parser_t *parser, cwh_request_t *req, int *headers_done)
+{
+    cwh_parse_status_t status = CWH_PARSE_NEED_MORE;
+    cwh_parser_init(parser);
+    *headers_done = 0;
+    for (size_t i = 1; i <= len; i++)
+    {
+        buf[i - 1] = req_text[i - 1];
+        buf[i] = '\0';
+        do
+        {
+            status = cwh_parser_execute(parser, buf, i, req);
+            *headers_done += status == CWH_PARSE_HEADERS_DONE;
+        } while (status == CWH_PARSE_HEADERS_DONE);
+        if (status != CWH_PARSE_NEED_MORE)
+            break;
+    }
+    return status;
+}
+
+void test_parser_incremental_content_length()
+{
+    const char *text = "POST /upload HTTP/1.1\r\nHost: x\r\nContent-Length: 11\r\n\r\nhello worldGET /next";
+    char buf[256];
+    cwh_parser_t parser;
+    cwh_request_t req = {0};
+    int headers_done;
+
+    cwh_parse_status_t status = feed_bytewise(buf, text, strlen(text), &parser, &req, &headers_done);
+    TEST_ASSERT_EQUAL(CWH_PARSE_BODY_DONE, status);
+    TEST_ASSERT_EQUAL(1, headers_done);
+    TEST_ASSERT_EQUAL_STRING("/upload", req.path);
+    TEST_ASSERT_EQUAL(11, req.body_len);
+    TEST_ASSERT_TRUE(str_eq_len(req.body, "hello world", 11));
+    TEST_ASSERT_EQUAL(strlen(text) - strlen("GET /next"), parser.consumed);
+
+    // Request without body completes right after the headers
+    char get[] = "GET / HTTP/1.1\r\nHost: x\r\n\r\n";
+    cwh_parser_init(&parser);
+    TEST_ASSERT_EQUAL(CWH_PARSE_NEED_MORE, cwh_parser_execute(&parser, get, 10, &req));
+    TEST_ASSERT_EQUAL(CWH_PARSE_HEADERS_DONE, cwh_parser_execute(&parser, get, strlen(get), &req));
+    TEST_ASSERT_EQUAL(CWH_PARSE_BODY_DONE, cwh_parser_execute(&parser, get, strlen(get), &req));
+    TEST_ASSERT_NULL(req.body);
+    TEST_ASSERT_EQUAL(sizeof(get) - 1, parser.consumed);
+}
+
+void test_parser_chunked()
+{
+    const char *text = "POST /c HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n"
+                       "5;ext=1\r\nhello\r\n"
+                       "6\r\n world\r\n"
+                       "0\r\nX-Trailer: t\r\n\r\n"
+                       "GET /";
+    char buf[256];
+    cwh_parser_t parser;
+    cwh_request_t req = {0};
+    int headers_done;
+
+    cwh_parse_status_t status = feed_bytewise(buf, text, strlen(text), &parser, &req, &headers_done);
+    TEST_ASSERT_EQUAL(CWH_PARSE_BODY_DONE, status);
+    TEST_ASSERT_EQUAL(1, headers_done);
+    TEST_ASSERT_TRUE(parser.chunked);
+    TEST_ASSERT_EQUAL(11, req.body_len);
+    TEST_ASSERT_TRUE(str_eq_len(req.body, "hello world", 11));
+    TEST_ASSERT_EQUAL(strlen(text) - 5, parser.consumed);
+
+    // Whole buffer at once: pipelined bytes after the request are untouched
+    snprintf(buf, sizeof(buf), "%s", text);
+    cwh_parser_init(&parser);
+    TEST_ASSERT_EQUAL(CWH_PARSE_HEADERS_DONE, cwh_parser_execute(&parser, buf, strlen(text), &req));
+    TEST_ASSERT_EQUAL(CWH_PARSE_BODY_DONE, cwh_parser_execute(&parser, buf, strlen(text), &req));
+    TEST_ASSERT_TRUE(str_eq_len(req.body, "hello world", 11));
+    TEST_ASSERT_TRUE(str_eq_len(buf + parser.consumed, "GET /", 5));
+}
+
+void test_parser_moved_buffer()
+{
+    const char *head = "POST /moved HTTP/1.1\r\nContent-Length: 4\r\n\r\n";
+    size_t head_len = strlen(head);
+    char first[128];
+    char second[128];
+    cwh_parser_t parser;
+    cwh_request_t req = {0};
+
+    snprintf(first, sizeof(first), "%sab", head);
+    cwh_parser_init(&parser);
+    TEST_ASSERT_EQUAL(CWH_PARSE_HEADERS_DONE, cwh_parser_execute(&parser, first, head_len + 2, &req));
+    TEST_ASSERT_EQUAL(CWH_PARSE_NEED_MORE, cwh_parser_execute(&parser, first, head_len + 2, &req));
+
+    // Caller grows its buffer (new address), then more data arrives
+    memcpy(second, first, head_len + 2);
+    memset(first, 0, sizeof(first));
+    memcpy(second + head_len + 2, "cd", 3);
+    TEST_ASSERT_EQUAL(CWH_PARSE_BODY_DONE, cwh_parser_execute(&parser, second, head_len + 4, &req));
+    TEST_ASSERT_EQUAL_STRING("/moved", req.path);
+    TEST_ASSERT_TRUE(str_eq_len(req.body, "abcd", 4));
+    TEST_ASSERT_TRUE(str_eq_len(cwh_get_header(&req, "Content-Length"), "4\r\n", 3));
+}
+
+void test_parser_framing_errors()
+{
+    const char *bad[] = {
+        "POST / HTTP/1.1\r\nContent-Length: 12x\r\n\r\n",
+        "POST / HTTP/1.1\r\nContent-Length: 5\r\nContent-Length: 6\r\n\r\n",
+        "POST / HTTP/1.1\r\nContent-Length: 5\r\nTransfer-Encoding: chunked\r\n\r\n",
+        "POST / HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\nzz\r\n",
+        "POST / HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n2\r\nabX\r\n",
+        "BREW / HTTP/1.1\r\n\r\n",
+    };
+    for (size_t i = 0; i < sizeof(bad) / sizeof(bad[0]); i++)
+    {
+        char buf[256];
+        cwh_parser_t parser;
+        cwh_request_t req = {0};
+        int headers_done;
+        TEST_ASSERT_EQUAL(CWH_PARSE_ERROR, feed_bytewise(buf, bad[i], strlen(bad[i]), &parser, &req, &headers_done));
+        TEST_ASSERT_EQUAL(400, parser.error_status);
+    }
+
+    // Unsupported transfer coding
+    char gz[] = "POST / HTTP/1.1\r\nTransfer-Encoding: gzip\r\n\r\n";
+    cwh_parser_t parser;
+    cwh_request_t req = {0};
+    cwh_parser_init(&parser);
+    TEST_ASSERT_EQUAL(CWH_PARSE_ERROR, cwh_parser_execute(&parser, gz, strlen(gz), &req));
+    TEST_ASSERT_EQUAL(501, parser.error_status);
+}
+
+// Feed text a few bytes at a time, discarding the body as it is decoded;
+// the discarded bytes are collected into out
+static size_t stream_body(const char *text, char *out, size_t *max_buffered, size_t *tail_len, char *tail)
+{
+    char buf[256];
+    size_t len = 0, total = 0, pos = 0, text_len = strlen(text);
+    cwh_parser_t parser;
+    cwh_request_t req = {0};
+    cwh_parse_status_t status = CWH_PARSE_NEED_MORE;
+    cwh_parser_init(&parser);
+    *max_buffered = 0;
+
+    while (status != CWH_PARSE_BODY_DONE && pos < text_len)
+    {
+        size_t n = text_len - pos < 3 ? text_len - pos : 3;
+        memcpy(buf + len, text + pos, n);
+        len += n;
+        pos += n;
+        if (len > *max_buffered)
+            *max_buffered = len;
+
+        do
+        {
+            status = cwh_parser_execute(&parser, buf, len, &req);
+        } while (status == CWH_PARSE_HEADERS_DONE);
+        TEST_ASSERT_NOT_EQUAL(CWH_PARSE_ERROR, status);
+
+        if (parser.header_len > 0)
+        {
+            memcpy(out + total, buf + parser.header_len, parser.body_end - parser.header_len);
+            total += parser.body_end - parser.header_len;
+            len = cwh_parser_discard_body(&parser, buf, len);
+        }
+    }
+    TEST_ASSERT_EQUAL(CWH_PARSE_BODY_DONE, status);
+    TEST_ASSERT_EQUAL(total, parser.body_discarded);
+    TEST_ASSERT_EQUAL_STRING("/s", req.path);
+
+    // Pipelined bytes follow the request, behind the headers
+    *tail_len = len - parser.consumed + (text_len - pos);
+    memcpy(tail, buf + parser.consumed, len - parser.consumed);
+    memcpy(tail + len - parser.consumed, text + pos, text_len - pos);
+    return total;
+}
+
+void test_parser_discard_body()
+{
+    char body[1200];
+    char text[2048];
+    char out[1200];
+    char tail[64];
+    size_t max_buffered, tail_len;
+    for (size_t i = 0; i < sizeof(body); i++)
+        body[i] = (char)('a' + i % 26);
+
+    // Content-Length body much larger than the 256-byte buffer
+    int n = snprintf(text, sizeof(text), "POST /s HTTP/1.1\r\nContent-Length: %zu\r\n\r\n", sizeof(body));
+    memcpy(text + n, body, sizeof(body));
+    memcpy(text + n + sizeof(body), "GET /", 6);
+    TEST_ASSERT_EQUAL(sizeof(body), stream_body(text, out, &max_buffered, &tail_len, tail));
+    TEST_ASSERT_EQUAL_MEMORY(body, out, sizeof(body));
+    TEST_ASSERT_TRUE(max_buffered < 100);
+    TEST_ASSERT_EQUAL(5, tail_len);
+    TEST_ASSERT_TRUE(str_eq_len(tail, "GET /", 5));
+
+    // Chunked body, 100-byte chunks
+    n = snprintf(text, sizeof(text), "POST /s HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n");
+    for (size_t off = 0; off < 1000; off += 100)
+    {
+        n += snprintf(text + n, sizeof(text) - (size_t)n, "64\r\n");
+        memcpy(text + n, body + off, 100);
+        n += 100;
+        n += snprintf(text + n, sizeof(text) - (size_t)n, "\r\n");
+    }
+    snprintf(text + n, sizeof(text) - (size_t)n, "0\r\n\r\nGET /");
+    TEST_ASSERT_EQUAL(1000, stream_body(text, out, &max_buffered, &tail_len, tail));
+    TEST_ASSERT_EQUAL_MEMORY(body, out, 1000);
+    TEST_ASSERT_TRUE(max_buffered < 100);
+    TEST_ASSERT_EQUAL(5, tail_len);
+    TEST_ASSERT_TRUE(str_eq_len(tail, "GET /", 5));
+}
+
+// Feed a response one byte at a time; eof reports the close at the end
+static cwh_parse_status_t feed_response(char *buf, const char *text, bool head, bool eof,
+                                        cwh_parser_t *parser, cwh_response_t *res)
+{
+    size_t len = strlen(text);
+    cwh_parser_init_response(parser, head);
+    cwh_parse_status_t status = CWH_PARSE_NEED_MORE;
+    for (size_t i = 1; i <= len && status != CWH_PARSE_BODY_DONE && status != CWH_PARSE_ERROR; i++)
+    {
+        buf[i - 1] = text[i - 1];
+        do
+            status = cwh_parser_execute_response(parser, buf, i, res);
+        while (status == CWH_PARSE_HEADERS_DONE);
+    }
+    if (eof && status == CWH_PARSE_NEED_MORE)
+        status = cwh_parser_response_eof(parser, buf, len, res);
+    return status;
+}
+
+void test_parser_response()
+{
+    char buf[256];
+    cwh_parser_t parser;
+    cwh_response_t res;
+
+    // Chunked wins over Content-Length; trailers are skipped
+    const char *chunked = "HTTP/1.1 200 OK\r\nContent-Length: 99\r\nTransfer-Encoding: chunked\r\n\r\n"
+                          "5\r\nhello\r\n6\r\n world\r\n0\r\nX-Trailer: t\r\n\r\nHTTP/1.1";
+    TEST_ASSERT_EQUAL(CWH_PARSE_BODY_DONE, feed_response(buf, chunked, false, false, &parser, &res));
+    TEST_ASSERT_EQUAL(200, res.status);
+    TEST_ASSERT_EQUAL(11, res.body_len);
+    TEST_ASSERT_TRUE(str_eq_len(res.body, "hello world", 11));
+    TEST_ASSERT_EQUAL(strlen(chunked) - 8, parser.consumed);
+
+    // Content-Length body, then pipelined bytes
+    const char *sized = "HTTP/1.1 404 Not Found\r\nContent-Length: 4\r\n\r\nnopeHTTP";
+    TEST_ASSERT_EQUAL(CWH_PARSE_BODY_DONE, feed_response(buf, sized, false, false, &parser, &res));
+    TEST_ASSERT_EQUAL(404, res.status);
+    TEST_ASSERT_TRUE(str_eq_len(res.body, "nope", 4));
+    TEST_ASSERT_EQUAL(strlen(sized) - 4, parser.consumed);
+
+    // No framing: the body runs until the connection closes
+    const char *until_eof = "HTTP/1.0 200 OK\r\nServer: x\r\n\r\nall of it";
+    TEST_ASSERT_EQUAL(CWH_PARSE_BODY_DONE, feed_response(buf, until_eof, false, true, &parser, &res));
+    TEST_ASSERT_EQUAL(9, res.body_len);
+    TEST_ASSERT_TRUE(str_eq_len(res.body, "all of it", 9));
+
+    // HEAD and 204/304 responses end with the headers
+    const char *head = "HTTP/1.1 200 OK\r\nContent-Length: 1000\r\n\r\n";
+    TEST_ASSERT_EQUAL(CWH_PARSE_BODY_DONE, feed_response(buf, head, true, false, &parser, &res));
+    TEST_ASSERT_EQUAL(0, res.body_len);
+    const char *no_content = "HTTP/1.1 204 No Content\r\nContent-Length: 5\r\n\r\n";
+    TEST_ASSERT_EQUAL(CWH_PARSE_BODY_DONE, feed_response(buf, no_content, false, false, &parser, &res));
+    TEST_ASSERT_EQUAL(0, res.body_len);
+
+    // Closed before Content-Length bytes arrived: truncated
+    const char *truncated = "HTTP/1.1 200 OK\r\nContent-Length: 10\r\n\r\nshort";
+    TEST_ASSERT_EQUAL(CWH_PARSE_ERROR, feed_response(buf, truncated, false, true, &parser, &res));
+    TEST_ASSERT_EQUAL(502, parser.error_status);
+
+    // Body streamed through a small buffer with discard_body
+    char body[1000];
+    char text[1200];
+    for (size_t i = 0; i < sizeof(body); i++)
+        body[i] = (char)('a' + i % 26);
+    int n = snprintf(text, sizeof(text), "HTTP/1.1 200 OK\r\nContent-Length: %zu\r\n\r\n", sizeof(body));
+    memcpy(text + n, body, sizeof(body));
+
+    size_t len = 0, got = 0, max_len = 0;
+    cwh_parser_init_response(&parser, false);
+    cwh_parse_status_t status = CWH_PARSE_NEED_MORE;
+    for (size_t i = 0; i < (size_t)n + sizeof(body) && status != CWH_PARSE_BODY_DONE; i++)
+    {
+        buf[len++] = text[i];
+        do
+            status = cwh_parser_execute_response(&parser, buf, len, &res);
+        while (status == CWH_PARSE_HEADERS_DONE);
+        size_t piece = parser.body_end - parser.header_len;
+        if (piece > 0)
+            TEST_ASSERT_EQUAL_MEMORY(body + got, buf + parser.header_len, piece);
+        got += piece;
+        len = cwh_parser_discard_body(&parser, buf, len);
+        if (len > max_len)
+            max_len = len;
+    }
+    TEST_ASSERT_EQUAL(CWH_PARSE_BODY_DONE, status);
+    TEST_ASSERT_EQUAL(sizeof(body), got);
+    TEST_ASSERT_EQUAL((size_t)n, max_len); // Only the headers stay buffered
+}
+
 int main()
 {
     UNITY_BEGIN();
@@ -139,5 +531,14 @@ int main()
     RUN_TEST(test_parse_invalid_bad_version);
     RUN_TEST(test_parse_null_buffer);
     RUN_TEST(test_parse_empty_buffer);
+    RUN_TEST(test_parse_range_header);
+    RUN_TEST(test_parse_too_many_headers);
+    RUN_TEST(test_parse_scan_impls);
+    RUN_TEST(test_parser_incremental_content_length);
+    RUN_TEST(test_parser_chunked);
+    RUN_TEST(test_parser_moved_buffer);
+    RUN_TEST(test_parser_framing_errors);
+    RUN_TEST(test_parser_discard_body);
+    RUN_TEST(test_parser_response);
     return UNITY_END();
 }
\ No newline at end of file
@@ -0,0 +1,176 @@
+#include "unity.h"
+#include "cwebhttp.h"
+#include <stdio.h>
+#include <string.h>
+
+static int route_a, route_b, route_c, route_d, route_e;
+
+void setUp(void)
+{
+}
+
+void tearDown(void)
+{
+}
+
+// Helper to compare a capture with an expected value
+static int param_eq(const cwh_request_t *req, const char *name, const char *expected)
+{
+    size_t len = 0;
+    const char *value = cwh_get_param(req, name, &len);
+    return value && len == strlen(expected) && memcmp(value, expected, len) == 0;
+}
+
+void test_router_static_routes()
+{
+    cwh_router_t *router = cwh_router_new();
+    TEST_ASSERT_NOT_NULL(router);
+    TEST_ASSERT_EQUAL(0, cwh_router_add(router, CWH_METHOD_GET, "/", &route_a));
+    TEST_ASSERT_EQUAL(0, cwh_router_add(router, CWH_METHOD_GET, "/users", &route_b));
+    TEST_ASSERT_EQUAL(0, cwh_router_add(router, CWH_METHOD_GET, "/users/all", &route_c));
+    TEST_ASSERT_EQUAL(0, cwh_router_add(router, CWH_METHOD_GET, "/uploads", &route_d));
+    TEST_ASSERT_EQUAL(4, cwh_router_count(router));
+
+    TEST_ASSERT_EQUAL_PTR(&route_a, cwh_router_find(router, CWH_METHOD_GET, "/", NULL));
+    TEST_ASSERT_EQUAL_PTR(&route_b, cwh_router_find(router, CWH_METHOD_GET, "/users", NULL));
+    TEST_ASSERT_EQUAL_PTR(&route_c, cwh_router_find(router, CWH_METHOD_GET, "/users/all", NULL));
+    TEST_ASSERT_EQUAL_PTR(&route_d, cwh_router_find(router, CWH_METHOD_GET, "/uploads", NULL));
+    TEST_ASSERT_EQUAL_PTR(&route_b, cwh_router_find(router, CWH_METHOD_GET, "/users?page=2", NULL));
+    TEST_ASSERT_NULL(cwh_router_find(router, CWH_METHOD_GET, "/user", NULL));
+    TEST_ASSERT_NULL(cwh_router_find(router, CWH_METHOD_GET, "/users/", NULL));
+    TEST_ASSERT_NULL(cwh_router_find(router, CWH_METHOD_GET, "/users/allx", NULL));
+
+    // Re-adding a pattern replaces it
+    TEST_ASSERT_EQUAL(0, cwh_router_add(router, CWH_METHOD_GET, "/users", &route_e));
+    TEST_ASSERT_EQUAL(4, cwh_router_count(router));
+    TEST_ASSERT_EQUAL_PTR(&route_e, cwh_router_find(router, CWH_METHOD_GET, "/users", NULL));
+
+    cwh_router_free(router);
+}
+
+void test_router_method_tables()
+{
+    cwh_router_t *router = cwh_router_new();
+    TEST_ASSERT_EQUAL(0, cwh_router_add(router, CWH_METHOD_GET, "/items", &route_a));
+    TEST_ASSERT_EQUAL(0, cwh_router_add(router, CWH_METHOD_POST, "/items", &route_b));
+    TEST_ASSERT_EQUAL(0, cwh_router_add(router, CWH_METHOD_NUM, "/health", &route_c));
+
+    TEST_ASSERT_EQUAL_PTR(&route_a, cwh_router_find(router, CWH_METHOD_GET, "/items", NULL));
+    TEST_ASSERT_EQUAL_PTR(&route_b, cwh_router_find(router, CWH_METHOD_POST, "/items", NULL));
+    TEST_ASSERT_NULL(cwh_router_find(router, CWH_METHOD_DELETE, "/items", NULL));
+    TEST_ASSERT_EQUAL_PTR(&route_c, cwh_router_find(router, CWH_METHOD_PUT, "/health", NULL));
+    TEST_ASSERT_EQUAL_PTR(&route_c, cwh_router_find(router, CWH_METHOD_NUM, "/health", NULL));
+
+    // Exact method names only (no prefix matches)
+    TEST_ASSERT_EQUAL(CWH_METHOD_POST, cwh_method_from_str("POST"));
+    TEST_ASSERT_EQUAL(CWH_METHOD_NUM, cwh_method_from_str("POSTX"));
+    TEST_ASSERT_EQUAL(CWH_METHOD_NUM, cwh_method_from_str("P"));
+
+    cwh_router_free(router);
+}
+
+void test_router_params()
+{
+    cwh_router_t *router = cwh_router_new();
+    TEST_ASSERT_EQUAL(0, cwh_router_add(router, CWH_METHOD_GET, "/users/:id", &route_a));
+    TEST_ASSERT_EQUAL(0, cwh_router_add(router, CWH_METHOD_GET, "/users/:id/posts/:post", &route_b));
+    TEST_ASSERT_EQUAL(0, cwh_router_add(router, CWH_METHOD_GET, "/users/new", &route_c));
+
+    cwh_request_t req = {0};
+    TEST_ASSERT_EQUAL_PTR(&route_a, cwh_router_find(router, CWH_METHOD_GET, "/users/42", &req));
+    TEST_ASSERT_EQUAL(1, req.num_params);
+    TEST_ASSERT_TRUE(param_eq(&req, "id", "42"));
+
+    TEST_ASSERT_EQUAL_PTR(&route_b, cwh_router_find(router, CWH_METHOD_GET, "/users/7/posts/hello?x=1", &req));
+    TEST_ASSERT_EQUAL(2, req.num_params);
+    TEST_ASSERT_TRUE(param_eq(&req, "id", "7"));
+    TEST_ASSERT_TRUE(param_eq(&req, "post", "hello"));
+    TEST_ASSERT_NULL(cwh_get_param(&req, "missing", NULL));
+
+    // Static beats param, backtracking to the param on a dead end
+    TEST_ASSERT_EQUAL_PTR(&route_c, cwh_router_find(router, CWH_METHOD_GET, "/users/new", &req));
+    TEST_ASSERT_EQUAL(0, req.num_params);
+    TEST_ASSERT_EQUAL_PTR(&route_a, cwh_router_find(router, CWH_METHOD_GET, "/users/newest", &req));
+    TEST_ASSERT_TRUE(param_eq(&req, "id", "newest"));
+
+    // Params never match empty segments
+    TEST_ASSERT_NULL(cwh_router_find(router, CWH_METHOD_GET, "/users/", &req));
+    TEST_ASSERT_NULL(cwh_router_find(router, CWH_METHOD_GET, "/users/7/posts/", &req));
+
+    cwh_router_free(router);
+}
+
+void test_router_wildcards()
+{
+    cwh_router_t *router = cwh_router_new();
+    TEST_ASSERT_EQUAL(0, cwh_router_add(router, CWH_METHOD_GET, "/static/*", &route_a));
+    TEST_ASSERT_EQUAL(0, cwh_router_add(router, CWH_METHOD_GET, "/static/app.js", &route_b));
+    TEST_ASSERT_EQUAL(0, cwh_router_add(router, CWH_METHOD_GET, "/files/:user/*path", &route_c));
+    TEST_ASSERT_EQUAL(0, cwh_router_add(router, CWH_METHOD_NUM, "*", &route_d));
+
+    cwh_request_t req = {0};
+    TEST_ASSERT_EQUAL_PTR(&route_a, cwh_router_find(router, CWH_METHOD_GET, "/static/css/site.css", &req));
+    TEST_ASSERT_TRUE(param_eq(&req, "*", "css/site.css"));
+    TEST_ASSERT_EQUAL_PTR(&route_a, cwh_router_find(router, CWH_METHOD_GET, "/static/", &req));
+    TEST_ASSERT_TRUE(param_eq(&req, "*", ""));
+    TEST_ASSERT_EQUAL_PTR(&route_b, cwh_router_find(router, CWH_METHOD_GET, "/static/app.js", &req));
+
+    TEST_ASSERT_EQUAL_PTR(&route_c, cwh_router_find(router, CWH_METHOD_GET, "/files/bob/a/b.txt", &req));
+    TEST_ASSERT_TRUE(param_eq(&req, "user", "bob"));
+    TEST_ASSERT_TRUE(param_eq(&req, "path", "a/b.txt"));
+
+    // Any-method catch-all
+    TEST_ASSERT_EQUAL_PTR(&route_d, cwh_router_find(router, CWH_METHOD_POST, "/static/x", &req));
+    TEST_ASSERT_TRUE(param_eq(&req, "*", "/static/x"));
+
+    cwh_router_free(router);
+}
+
+void test_router_invalid_patterns()
+{
+    cwh_router_t *router = cwh_router_new();
+    TEST_ASSERT_EQUAL(0, cwh_router_add(router, CWH_METHOD_GET, "/users/:id", &route_a));
+    TEST_ASSERT_EQUAL(-1, cwh_router_add(router, CWH_METHOD_GET, "/users/:name/x", &route_b));
+    TEST_ASSERT_EQUAL(-1, cwh_router_add(router, CWH_METHOD_GET, "/a/*/b", &route_b));
+    TEST_ASSERT_EQUAL(-1, cwh_router_add(router, CWH_METHOD_GET, "/a/:/b", &route_b));
+    TEST_ASSERT_EQUAL(-1, cwh_router_add(router, CWH_METHOD_GET, NULL, &route_b));
+    TEST_ASSERT_EQUAL(-1, cwh_router_add(router, CWH_METHOD_GET,
+                                         "/:a/:b/:c/:d/:e/:f/:g/:h/:i", &route_b));
+    TEST_ASSERT_EQUAL(1, cwh_router_count(router));
+    cwh_router_free(router);
+}
+
+void test_router_many_routes()
+{
+    cwh_router_t *router = cwh_router_new();
+    static int data[1000];
+    char pattern[64];
+    for (int i = 0; i < 1000; i++)
+    {
+        snprintf(pattern, sizeof(pattern), "/api/v%d/resource%d/:id", i % 7, i);
+        TEST_ASSERT_EQUAL(0, cwh_router_add(router, (cwh_method_t)(i % CWH_METHOD_NUM), pattern, &data[i]));
+    }
+
+    cwh_request_t req = {0};
+    for (int i = 0; i < 1000; i++)
+    {
+        snprintf(pattern, sizeof(pattern), "/api/v%d/resource%d/%d", i % 7, i, i * 3);
+        TEST_ASSERT_EQUAL_PTR(&data[i], cwh_router_find(router, (cwh_method_t)(i % CWH_METHOD_NUM), pattern, &req));
+        char id[16];
+        snprintf(id, sizeof(id), "%d", i * 3);
+        TEST_ASSERT_TRUE(param_eq(&req, "id", id));
+    }
+    cwh_router_free(router);
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_router_static_routes);
+    RUN_TEST(test_router_method_tables);
+    RUN_TEST(test_router_params);
+    RUN_TEST(test_router_wildcards);
+    RUN_TEST(test_router_invalid_patterns);
+    RUN_TEST(test_router_many_routes);
+    return UNITY_END();
+}
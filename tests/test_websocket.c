@@ -137,6 +137,54 @@ bool test_frame_decoding()
     return true;
 }
 
+// === Test: Masking Implementations ===
+// Every kernel must match the byte-wise XOR at any alignment and length,
+// including the unaligned head and the tail after the last whole block
+bool test_mask_impls()
+{
+    const cwh_ws_mask_impl_t impls[] = {CWH_WS_MASK_SCALAR, CWH_WS_MASK_WORD, CWH_WS_MASK_SSE2,
+                                        CWH_WS_MASK_AVX2};
+    const uint8_t masking_key[] = {0x37, 0xfa, 0x21, 0x3d};
+    uint8_t original[300];
+    uint8_t expected[300];
+    uint8_t buf[300 + 64];
+    int tested = 0;
+
+    for (size_t i = 0; i < sizeof(original); i++)
+    {
+        original[i] = (uint8_t)(i * 7 + 3);
+        expected[i] = original[i] ^ masking_key[i % 4];
+    }
+
+    for (size_t i = 0; i < sizeof(impls) / sizeof(impls[0]); i++)
+    {
+        if (cwh_ws_mask_set_impl(impls[i]) != 0)
+        {
+            continue; // Not supported by this CPU
+        }
+        tested++;
+
+        for (size_t offset = 0; offset < 64; offset++)
+        {
+            for (size_t len = 0; len <= sizeof(original); len += (len < 80 ? 1 : 37))
+            {
+                memset(buf, 0xAA, sizeof(buf));
+                memcpy(buf + offset, original, len);
+                cwh_ws_decode_payload(buf + offset, len, masking_key);
+                assert(memcmp(buf + offset, expected, len) == 0);
+                assert(offset == 0 || buf[offset - 1] == 0xAA);
+                assert(buf[offset + len] == 0xAA);
+            }
+        }
+        printf("  %s matches\n", cwh_ws_mask_impl_name(impls[i]));
+    }
+
+    assert(tested >= 2);
+    assert(cwh_ws_mask_set_impl(CWH_WS_MASK_AUTO) == 0);
+    printf("  Auto-selected: %s\n", cwh_ws_mask_impl_name(cwh_ws_mask_get_impl()));
+    return true;
+}
+
 // === Test: Opcode Strings ===
 bool test_opcode_strings()
 {
@@ -321,6 +369,7 @@ int main()
     TEST(frame_header_parsing);
     TEST(frame_encoding);
     TEST(frame_decoding);
+    TEST(mask_impls);
     TEST(opcode_strings);
     TEST(close_code_strings);
     TEST(client_handshake);